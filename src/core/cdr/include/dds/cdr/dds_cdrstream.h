@@ -142,6 +142,45 @@ struct dds_cdrstream_desc_mid {
   uint32_t mid;
 };
 
+/**
+ * @brief Type-specific serialization functions
+ *
+ * Generated by the IDL compiler (option "-f specialized-ops") for types that it can
+ * handle without interpreting the serializer instructions: final structs containing
+ * only primitives, enums, strings, arrays, sequences and such structs. They operate on
+ * native-endian streams and take precedence over the instructions in the entry points
+ * that use native endianness; all other functions interpret the instructions.  A NULL
+ * function means the instructions are used for that operation.
+ */
+struct dds_cdrstream_specialized_ops {
+  bool (*write) (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const void *sample);
+  void (*read) (dds_istream_t *is, void *sample, const struct dds_cdrstream_allocator *allocator);
+  size_t (*getsize) (const void *sample, uint32_t xcdr_version);
+  bool (*normalize) (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t xcdr_version);
+  bool (*extract_key_from_data) (dds_istream_t *is, dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator);
+};
+
+/**
+ * @brief Segmented memcpy plan
+ *
+ * Sequence of contiguous runs of primitive members for which the layout in memory matches
+ * the layout in CDR, interleaved with the (length-prefixed) members in between. Computed
+ * once per type and XCDR version by @ref dds_stream_memcpy_plan, used instead of the
+ * instructions for writing and reading samples.
+ */
+struct dds_cdrstream_memcpy_plan;
+
+/**
+ * @brief Key extraction plan
+ *
+ * Sequence of steps for extracting the key from the serialized representation of a final
+ * type: runs of adjacent key members are copied at once, the members preceding the
+ * last key member are skipped (by their size if it is fixed) and the remainder of the data
+ * is not looked at. Computed once per type by @ref dds_stream_key_plan, the same plan
+ * applies to all XCDR versions.
+ */
+struct dds_cdrstream_key_plan;
+
 struct dds_cdrstream_desc {
   uint32_t size;    /* Size of type */
   uint32_t align;   /* Alignment of top-level type */
@@ -151,6 +190,12 @@ struct dds_cdrstream_desc {
   size_t opt_size_xcdr1;
   size_t opt_size_xcdr2;
   struct dds_cdrstream_desc_mid_table member_ids;
+  const struct dds_cdrstream_specialized_ops *specialized; /* Generated functions, or NULL */
+  struct dds_cdrstream_memcpy_plan *plan_xcdr1; /* Segmented memcpy plan for XCDR1, or NULL */
+  struct dds_cdrstream_memcpy_plan *plan_xcdr2; /* Segmented memcpy plan for XCDR2, or NULL */
+  size_t fixed_size_xcdr1; /* Serialized size in XCDR1 if the same for all samples, or 0 */
+  size_t fixed_size_xcdr2; /* Serialized size in XCDR2 if the same for all samples, or 0 */
+  struct dds_cdrstream_key_plan *key_plan; /* Key extraction plan, or NULL */
 };
 
 
@@ -274,6 +319,41 @@ DDS_EXPORT uint32_t dds_stream_countops (const uint32_t *ops, uint32_t nkeys, co
 size_t dds_stream_check_optimize (const struct dds_cdrstream_desc *desc, uint32_t xcdr_version)
   ddsrt_nonnull_all;
 
+/**
+ * @brief Computes the segmented memcpy plan for a type
+ * @component cdr_serializer
+ *
+ * @param[in] desc CDR stream descriptor of the type
+ * @param[in] allocator Allocator for the plan
+ * @param[in] xcdr_version XCDR version the plan is computed for
+ * @returns The plan, or NULL if the type is not final or has members the plan can't handle
+ */
+struct dds_cdrstream_memcpy_plan *dds_stream_memcpy_plan (const struct dds_cdrstream_desc *desc, const struct dds_cdrstream_allocator *allocator, uint32_t xcdr_version)
+  ddsrt_nonnull_all;
+
+/**
+ * @brief Computes the plan for extracting the key from serialized data of a type
+ * @component cdr_serializer
+ *
+ * @param[in] desc CDR stream descriptor of the type
+ * @param[in] allocator Allocator for the plan
+ * @returns The plan, or NULL if the type has no key, keys in non-final types or key members the plan can't handle
+ */
+struct dds_cdrstream_key_plan *dds_stream_key_plan (const struct dds_cdrstream_desc *desc, const struct dds_cdrstream_allocator *allocator)
+  ddsrt_nonnull_all;
+
+/**
+ * @brief Computes the serialized size of the type if it is independent of the contents of the sample
+ * @component cdr_serializer
+ *
+ * @param[in] desc CDR stream descriptor of the type
+ * @param[in] allocator Allocator for the temporary sample used for computing the size
+ * @param[in] xcdr_version XCDR version to compute the size for
+ * @returns The size in bytes, or 0 if it depends on the contents of the sample
+ */
+size_t dds_stream_fixed_serialized_size (const struct dds_cdrstream_desc *desc, const struct dds_cdrstream_allocator *allocator, uint32_t xcdr_version)
+  ddsrt_nonnull_all;
+
 /** @component cdr_serializer */
 bool dds_stream_write_key (dds_ostream_t *os, enum dds_cdr_key_serialization_kind ser_kind, const struct dds_cdrstream_allocator *allocator, const char *sample, const struct dds_cdrstream_desc *desc)
   ddsrt_attribute_warn_unused_result ddsrt_nonnull_all;
@@ -0,0 +1,350 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+/** @file
+ *
+ * @brief Support functions for the type-specific serializers generated by the IDL compiler
+ *
+ * The IDL compiler (with "-f specialized-ops") generates, for each type it supports, functions
+ * that serialize, deserialize, validate and normalize samples of that type in native endianness
+ * (see struct dds_cdrstream_specialized_ops).  The generated code uses the functions in this file
+ * and is not intended for direct use.
+ *
+ * Serializing is done in two passes: a first pass computes the exact size and validates the
+ * sample, the second writes the data in a buffer that is known to be large enough, so that the
+ * second pass need not check anything.  All offsets are relative to the start of the buffer,
+ * which is assumed to be the start of the CDR data for alignment purposes.
+ */
+#ifndef DDS_CDRSTREAM_SPECIALIZED_H
+#define DDS_CDRSTREAM_SPECIALIZED_H
+
+#include <string.h>
+#include "dds/cdr/dds_cdrstream.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/** @component cdr_serializer */
+DDS_EXPORT void dds_ostream_reserve (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, uint32_t size)
+  ddsrt_nonnull_all;
+
+/**
+ * @brief Prepares the buffer of a sequence in a sample for deserializing `num` elements
+ * @component cdr_serializer
+ *
+ * This follows the rules for reusing sequence buffers in deserializing into an initialized
+ * sample and sets `_length` to the number of elements that is to be deserialized, which is
+ * less than `num` if the buffer is not owned by the sample and too small.
+ *
+ * @param[in,out] seq        sequence
+ * @param[in]     allocator  allocator
+ * @param[in]     num        number of elements in the serialized data
+ * @param[in]     elem_size  size of an element in memory
+ * @param[in]     initialize whether the elements must be zero-initialized (for elements that contain pointers)
+ */
+DDS_EXPORT void dds_stream_adjust_sequence_buffer (dds_sequence_t *seq, const struct dds_cdrstream_allocator *allocator, uint32_t num, uint32_t elem_size, bool initialize)
+  ddsrt_nonnull_all;
+
+/* Alignment of primitives of size sz, in XCDR2 8-byte types are 4-byte aligned */
+static inline uint32_t dds_cdrspec_align (uint32_t off, uint32_t sz, uint32_t xcdrv)
+{
+  const uint32_t a = (sz == 8 && xcdrv == DDSI_RTPS_CDR_ENC_VERSION_2) ? 4 : sz;
+  return (off + a - 1) & ~(a - 1);
+}
+
+/* Size computation: these return the offset following the value */
+
+static inline uint32_t dds_cdrspec_size_prim (uint32_t off, uint32_t sz, uint32_t n, uint32_t xcdrv)
+{
+  return (n == 0) ? off : dds_cdrspec_align (off, sz, xcdrv) + sz * n;
+}
+
+static inline uint32_t dds_cdrspec_size_string (uint32_t off, const char *s)
+{
+  return dds_cdrspec_align (off, 4, 0) + 4 + (s ? (uint32_t) strlen (s) : 0) + 1;
+}
+
+static inline bool dds_cdrspec_size_bstring (uint32_t *off, const char *s, uint32_t bound)
+{
+  const char *end = (const char *) memchr (s, 0, (size_t) bound + 1);
+  if (end == NULL)
+    return false;
+  *off = dds_cdrspec_align (*off, 4, 0) + 4 + (uint32_t) (end - s) + 1;
+  return true;
+}
+
+/* Writing into a buffer that is large enough: these return the offset following the value */
+
+static inline uint32_t dds_cdrspec_pad (unsigned char *buf, uint32_t off, uint32_t sz, uint32_t xcdrv)
+{
+  const uint32_t off1 = dds_cdrspec_align (off, sz, xcdrv);
+  while (off < off1)
+    buf[off++] = 0;
+  return off1;
+}
+
+static inline uint32_t dds_cdrspec_put_prim (unsigned char *buf, uint32_t off, const void *src, uint32_t sz, uint32_t n, uint32_t xcdrv)
+{
+  if (n == 0)
+    return off;
+  off = dds_cdrspec_pad (buf, off, sz, xcdrv);
+  memcpy (buf + off, src, (size_t) sz * n);
+  return off + sz * n;
+}
+
+static inline uint32_t dds_cdrspec_put_bool (unsigned char *buf, uint32_t off, const bool *src, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    buf[off + i] = src[i] ? 1 : 0;
+  return off + n;
+}
+
+static inline uint32_t dds_cdrspec_put_uint32 (unsigned char *buf, uint32_t off, uint32_t v)
+{
+  return dds_cdrspec_put_prim (buf, off, &v, 4, 1, 0);
+}
+
+static inline uint32_t dds_cdrspec_put_enum (unsigned char *buf, uint32_t off, uint32_t v, uint32_t sz)
+{
+  switch (sz)
+  {
+    case 1: { const uint8_t v1 = (uint8_t) v; return dds_cdrspec_put_prim (buf, off, &v1, 1, 1, 0); }
+    case 2: { const uint16_t v2 = (uint16_t) v; return dds_cdrspec_put_prim (buf, off, &v2, 2, 1, 0); }
+    default: return dds_cdrspec_put_prim (buf, off, &v, 4, 1, 0);
+  }
+}
+
+static inline uint32_t dds_cdrspec_put_string (unsigned char *buf, uint32_t off, const char *s)
+{
+  const uint32_t len = (s ? (uint32_t) strlen (s) : 0) + 1;
+  off = dds_cdrspec_put_uint32 (buf, off, len);
+  memcpy (buf + off, s ? s : "", len);
+  return off + len;
+}
+
+/* Reserves space for a DHEADER, setting *dhoff to its offset for use in dds_cdrspec_put_dheader */
+static inline uint32_t dds_cdrspec_reserve_dheader (unsigned char *buf, uint32_t off, uint32_t *dhoff)
+{
+  *dhoff = dds_cdrspec_pad (buf, off, 4, 0);
+  return *dhoff + 4;
+}
+
+/* Fills in a DHEADER reserved at offset dhoff, off is the offset following the data */
+static inline void dds_cdrspec_put_dheader (unsigned char *buf, uint32_t dhoff, uint32_t off)
+{
+  const uint32_t dh = off - dhoff - 4;
+  memcpy (buf + dhoff, &dh, 4);
+}
+
+/* Reading normalized data */
+
+static inline void dds_cdrspec_get_prim (dds_istream_t *is, void *dst, uint32_t sz, uint32_t n)
+{
+  if (n == 0)
+    return;
+  is->m_index = dds_cdrspec_align (is->m_index, sz, is->m_xcdr_version);
+  memcpy (dst, is->m_buffer + is->m_index, (size_t) sz * n);
+  is->m_index += sz * n;
+}
+
+static inline uint32_t dds_cdrspec_get_uint32 (dds_istream_t *is)
+{
+  uint32_t v;
+  dds_cdrspec_get_prim (is, &v, 4, 1);
+  return v;
+}
+
+static inline uint32_t dds_cdrspec_get_enum (dds_istream_t *is, uint32_t sz)
+{
+  switch (sz)
+  {
+    case 1: { uint8_t v; dds_cdrspec_get_prim (is, &v, 1, 1); return v; }
+    case 2: { uint16_t v; dds_cdrspec_get_prim (is, &v, 2, 1); return v; }
+    default: return dds_cdrspec_get_uint32 (is);
+  }
+}
+
+static inline char *dds_cdrspec_get_string (dds_istream_t *is, char *str, const struct dds_cdrstream_allocator *allocator)
+{
+  const uint32_t len = dds_cdrspec_get_uint32 (is);
+  const unsigned char *src = is->m_buffer + is->m_index;
+  is->m_index += len;
+  if (str != NULL)
+  {
+    if (len == 1 && str[0] == '\0')
+      return str;
+    allocator->free (str);
+  }
+  str = (char *) allocator->malloc (len);
+  memcpy (str, src, len);
+  return str;
+}
+
+/* size = bound + 1, normalized data never has a longer string */
+static inline void dds_cdrspec_get_bstring (dds_istream_t *is, char *str, uint32_t size)
+{
+  const uint32_t len = dds_cdrspec_get_uint32 (is);
+  memcpy (str, is->m_buffer + is->m_index, len > size ? size : len);
+  if (len > size)
+    str[size - 1] = '\0';
+  is->m_index += len;
+}
+
+static inline void dds_cdrspec_skip_prim (dds_istream_t *is, uint32_t sz, uint32_t n)
+{
+  if (n > 0)
+    is->m_index = dds_cdrspec_align (is->m_index, sz, is->m_xcdr_version) + sz * n;
+}
+
+static inline void dds_cdrspec_skip_string (dds_istream_t *is)
+{
+  const uint32_t len = dds_cdrspec_get_uint32 (is);
+  is->m_index += len;
+}
+
+/* Writing a value read from an input stream to an output stream, for extracting keys; these
+   grow the output stream by no more than strictly necessary because the key may be written
+   into a fixed-size buffer */
+
+static inline void dds_cdrspec_copy_prim (dds_istream_t *is, dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, uint32_t sz)
+{
+  unsigned char v[8];
+  dds_cdrspec_get_prim (is, v, sz, 1);
+  dds_ostream_reserve (os, allocator, dds_cdrspec_size_prim (os->m_index, sz, 1, os->m_xcdr_version) - os->m_index);
+  os->m_index = dds_cdrspec_put_prim (os->m_buffer, os->m_index, v, sz, 1, os->m_xcdr_version);
+}
+
+static inline void dds_cdrspec_copy_string (dds_istream_t *is, dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator)
+{
+  const uint32_t len = dds_cdrspec_get_uint32 (is);
+  dds_ostream_reserve (os, allocator, dds_cdrspec_align (os->m_index, 4, 0) + 4 + len - os->m_index);
+  os->m_index = dds_cdrspec_put_uint32 (os->m_buffer, os->m_index, len);
+  memcpy (os->m_buffer + os->m_index, is->m_buffer + is->m_index, len);
+  os->m_index += len;
+  is->m_index += len;
+}
+
+/* Validating and normalizing: these update *off and return false if the data is invalid */
+
+static inline bool dds_cdrspec_norm_prim (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t sz, uint32_t n, uint32_t xcdrv)
+{
+  if (n == 0)
+    return true;
+  const uint32_t off1 = dds_cdrspec_align (*off, sz, xcdrv);
+  if (off1 > size || (size - off1) / sz < n)
+    return false;
+  if (bswap)
+  {
+    char *p = data + off1;
+    switch (sz)
+    {
+      case 2:
+        for (uint32_t i = 0; i < n; i++, p += 2) {
+          uint16_t v; memcpy (&v, p, 2); v = ddsrt_bswap2u (v); memcpy (p, &v, 2);
+        }
+        break;
+      case 4:
+        for (uint32_t i = 0; i < n; i++, p += 4) {
+          uint32_t v; memcpy (&v, p, 4); v = ddsrt_bswap4u (v); memcpy (p, &v, 4);
+        }
+        break;
+      case 8:
+        for (uint32_t i = 0; i < n; i++, p += 8) {
+          uint64_t v; memcpy (&v, p, 8); v = ddsrt_bswap8u (v); memcpy (p, &v, 8);
+        }
+        break;
+    }
+  }
+  *off = off1 + sz * n;
+  return true;
+}
+
+static inline bool dds_cdrspec_norm_uint32 (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t *val)
+{
+  const uint32_t off1 = dds_cdrspec_align (*off, 4, 0);
+  if (!dds_cdrspec_norm_prim (data, off, size, bswap, 4, 1, 0))
+    return false;
+  memcpy (val, data + off1, 4);
+  return true;
+}
+
+/* Booleans other than 0 and 1 are corrected to 1 in structs and arrays, but are rejected
+   in sequences (strict = true) */
+static inline bool dds_cdrspec_norm_bool (char *data, uint32_t *off, uint32_t size, uint32_t n, bool strict)
+{
+  if (size - *off < n)
+    return false;
+  unsigned char *p = (unsigned char *) data + *off;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    if (p[i] > 1)
+    {
+      if (strict)
+        return false;
+      p[i] = 1;
+    }
+  }
+  *off += n;
+  return true;
+}
+
+static inline bool dds_cdrspec_norm_enum (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t sz, uint32_t n, uint32_t max)
+{
+  const uint32_t off1 = dds_cdrspec_align (*off, sz, 0);
+  if (!dds_cdrspec_norm_prim (data, off, size, bswap, sz, n, 0))
+    return false;
+  const unsigned char *p = (const unsigned char *) data + off1;
+  for (uint32_t i = 0; i < n; i++, p += sz)
+  {
+    uint32_t v;
+    switch (sz)
+    {
+      case 1: v = *p; break;
+      case 2: { uint16_t v2; memcpy (&v2, p, 2); v = v2; break; }
+      default: memcpy (&v, p, 4); break;
+    }
+    if (v > max)
+      return false;
+  }
+  return true;
+}
+
+/* maxsz is the bound + 1 for bounded strings, UINT32_MAX otherwise */
+static inline bool dds_cdrspec_norm_string (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t maxsz)
+{
+  uint32_t sz;
+  if (!dds_cdrspec_norm_uint32 (data, off, size, bswap, &sz))
+    return false;
+  if (sz == 0 || size - *off < sz || maxsz < sz)
+    return false;
+  if (data[*off + sz - 1] != 0)
+    return false;
+  *off += sz;
+  return true;
+}
+
+/* Reads the DHEADER of a collection and sets *size1 to the offset where the collection ends */
+static inline bool dds_cdrspec_norm_dheader (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t *size1)
+{
+  uint32_t dh;
+  if (!dds_cdrspec_norm_uint32 (data, off, size, bswap, &dh))
+    return false;
+  if (dh > size - *off)
+    return false;
+  *size1 = *off + dh;
+  return true;
+}
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDS_CDRSTREAM_SPECIALIZED_H */
@@ -21,6 +21,7 @@
 #include "dds/ddsrt/string.h"
 #include "dds/ddsrt/static_assert.h"
 #include "dds/cdr/dds_cdrstream.h"
+#include "dds/cdr/dds_cdrstream_specialized.h"
 #include "dds/ddsc/dds_data_type_properties.h"
 
 typedef struct restrict_ostream_base {
@@ -115,6 +116,8 @@ typedef struct restrict_ostreamLE {
 #define dds_stream_write_union_discriminantBO               NAME_BYTE_ORDER(dds_stream_write_union_discriminant)
 #define dds_stream_write_uniBO                              NAME_BYTE_ORDER(dds_stream_write_uni)
 #define dds_stream_write_with_midBO                         NAME_BYTE_ORDER(dds_stream_write_with_mid)
+#define dds_stream_write_planBO                             NAME_BYTE_ORDER(dds_stream_write_plan)
+#define dds_stream_write_plan_implBO                        NAME2_BYTE_ORDER(dds_stream_write_plan, _impl)
 #define dds_stream_writeBO                                  NAME_BYTE_ORDER(dds_stream_write)
 #define dds_stream_write_implBO                             NAME_BYTE_ORDER(dds_stream_write_impl)
 #define dds_stream_write_xcdr1_paramheaderBO                NAME_BYTE_ORDER(dds_stream_write_xcdr1_paramheader)
@@ -178,6 +181,58 @@ struct dds_cdrstream_ops_info {
   dds_data_type_properties_t data_types;
 };
 
+enum memcpy_plan_kind {
+  PLAN_RUN, /* contiguous primitives, same layout in memory and CDR if aligned to run_align */
+  PLAN_BLN, /* boolean, written as 0 or 1 */
+  PLAN_ENU, /* enum, checked against the max value */
+  PLAN_STR, /* unbounded string */
+  PLAN_BST, /* bounded string */
+  PLAN_SEQ  /* (bounded) sequence of primitives */
+};
+
+struct memcpy_plan_elem {
+  uint32_t offs; /* offset in sample */
+  uint32_t size; /* primitive size */
+  uint32_t num;  /* number of elements for arrays, 1 otherwise */
+};
+
+struct memcpy_plan_step {
+  enum memcpy_plan_kind kind;
+  uint32_t offs;      /* offset in sample */
+  uint32_t size;      /* RUN: size in bytes, ENU: size in CDR, BST: size including terminator, SEQ: element size */
+  uint32_t run_align; /* RUN: largest CDR alignment of the elements */
+  uint32_t arg;       /* ENU: max value, SEQ: bound or 0 */
+  uint32_t elem0;     /* RUN: index of first element in the element table */
+  uint32_t nelems;    /* RUN: number of elements */
+};
+
+struct dds_cdrstream_memcpy_plan {
+  uint32_t nsteps;
+  uint32_t nelems;
+  struct memcpy_plan_step *steps;
+  struct memcpy_plan_elem *elems;
+};
+
+enum key_plan_kind {
+  KEY_PLAN_SKIP,  /* non-key primitives of non-increasing size, no padding after the first */
+  KEY_PLAN_COPY,  /* key primitives of non-increasing size, no padding after the first */
+  KEY_PLAN_STR,   /* key string */
+  KEY_PLAN_MEMBER /* any other non-key member, skipped using its instructions */
+};
+
+struct key_plan_step {
+  enum key_plan_kind kind;
+  uint32_t first_size; /* SKIP, COPY: element size of the first element, determines the alignment */
+  uint32_t last_size;  /* SKIP, COPY: element size of the last element */
+  uint32_t size;       /* SKIP, COPY: size in bytes */
+  const uint32_t *ops; /* MEMBER: ADR instruction of the member */
+};
+
+struct dds_cdrstream_key_plan {
+  uint32_t nsteps;
+  struct key_plan_step *steps;
+};
+
 static const struct dds_cdrstream_desc_mid_table static_empty_mid_table = { .table = (struct ddsrt_hh *) &ddsrt_hh_empty, .op0 = NULL };
 
 static const uint32_t *dds_stream_skip_adr (uint32_t insn, const uint32_t *ops)
@@ -190,6 +245,10 @@ static const uint32_t *dds_stream_extract_key_from_data1 (dds_istream_t *is, res
   const uint32_t *ops, bool mutable_member, uint32_t n_keys, uint32_t * restrict keys_remaining)
   ddsrt_nonnull ((1, 3, 4, 5, 8));
 
+static const uint32_t *dds_stream_extract_key_from_data_adr (uint32_t insn, dds_istream_t *is, restrict_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const struct dds_cdrstream_desc_mid_table *mid_table,
+  const uint32_t *ops, bool mutable_member, uint32_t n_keys, uint32_t * restrict keys_remaining)
+  ddsrt_attribute_warn_unused_result ddsrt_nonnull ((2, 4, 5, 6, 9));
+
 #if DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN
 static const uint32_t *dds_stream_extract_keyBE_from_data1 (dds_istream_t *is, restrict_ostreamBE_t *os, const struct dds_cdrstream_allocator *allocator, const struct dds_cdrstream_desc_mid_table *mid_table,
   const uint32_t *ops, bool mutable_member, uint32_t n_keys, uint32_t * restrict keys_remaining)
@@ -345,6 +404,15 @@ static uint32_t dds_cdr_alignto_clear_and_resize_base (restrict_ostream_base_t *
   }
 }
 
+void dds_ostream_reserve (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, uint32_t size)
+{
+  restrict_ostream_base_t ros;
+  memcpy (&ros, os, sizeof (*os));
+  ros.m_align_off = 0;
+  dds_cdr_resize (&ros, allocator, size);
+  memcpy (os, &ros, sizeof (*os));
+}
+
 uint32_t dds_cdr_alignto4_clear_and_resize (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, uint32_t xcdr_version)
 {
   restrict_ostream_base_t ros;
@@ -499,10 +567,152 @@ static uint32_t dds_os_reserve4BE (restrict_ostreamBE_t *os, const struct dds_cd
 ddsrt_nonnull_all
 static uint32_t dds_os_reserve8BE (restrict_ostreamBE_t *os, const struct dds_cdrstream_allocator *allocator) { return dds_os_reserve8_base (&os->x, allocator); }
 
+/* Bulk byte-swapping of arrays of 2, 4 and 8-byte primitives. The vector kernels handle
+   whole blocks using unaligned loads and stores (XCDR2 only guarantees 4-byte alignment
+   for 8-byte types, and data in a received message has no alignment guarantee relative
+   to the vector width), leaving the remainder to the scalar code. The source and the
+   destination may be the same. The kernel is selected at compile time, except that AVX2
+   is used if the CPU supports it when building for x86-64 with gcc or clang. */
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DDS_STREAM_SWAP_SSE2 1
+#if defined __AVX2__
+#include <immintrin.h>
+#define DDS_STREAM_SWAP_AVX2 1
+#elif defined __x86_64__ && ((defined __clang__ && __clang_major__ >= 6) || (!defined __clang__ && defined __GNUC__ && __GNUC__ >= 6))
+#include <immintrin.h>
+#define DDS_STREAM_SWAP_AVX2 1
+#define DDS_STREAM_SWAP_AVX2_RUNTIME 1
+#endif
+#elif defined __ARM_NEON || defined __ARM_NEON__
+#include <arm_neon.h>
+#define DDS_STREAM_SWAP_NEON 1
+#endif
+
+#ifdef DDS_STREAM_SWAP_SSE2
+static inline __m128i dds_stream_bswap16_sse2 (__m128i v)
+{
+  return _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+}
+
+ddsrt_nonnull_all
+static uint32_t dds_stream_swap_copy_sse2 (unsigned char *dst, const unsigned char *src, uint32_t size, uint32_t nbytes)
+{
+  uint32_t i = 0;
+  switch (size)
+  {
+    case 2:
+      for (; nbytes - i >= 16; i += 16)
+      {
+        const __m128i v = _mm_loadu_si128 ((const __m128i *) (src + i));
+        _mm_storeu_si128 ((__m128i *) (dst + i), dds_stream_bswap16_sse2 (v));
+      }
+      break;
+    case 4:
+      for (; nbytes - i >= 16; i += 16)
+      {
+        __m128i v = _mm_loadu_si128 ((const __m128i *) (src + i));
+        v = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1)), _MM_SHUFFLE (2, 3, 0, 1));
+        _mm_storeu_si128 ((__m128i *) (dst + i), dds_stream_bswap16_sse2 (v));
+      }
+      break;
+    case 8:
+      for (; nbytes - i >= 16; i += 16)
+      {
+        __m128i v = _mm_loadu_si128 ((const __m128i *) (src + i));
+        v = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (v, _MM_SHUFFLE (0, 1, 2, 3)), _MM_SHUFFLE (0, 1, 2, 3));
+        _mm_storeu_si128 ((__m128i *) (dst + i), dds_stream_bswap16_sse2 (v));
+      }
+      break;
+  }
+  return i;
+}
+#endif
+
+#ifdef DDS_STREAM_SWAP_AVX2
+#ifdef DDS_STREAM_SWAP_AVX2_RUNTIME
+__attribute__ ((target ("avx2")))
+#endif
+ddsrt_nonnull_all
+static uint32_t dds_stream_swap_copy_avx2 (unsigned char *dst, const unsigned char *src, uint32_t size, uint32_t nbytes)
+{
+  __m256i mask;
+  switch (size)
+  {
+    case 2: mask = _mm256_setr_epi8 (1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14); break;
+    case 4: mask = _mm256_setr_epi8 (3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12); break;
+    default: mask = _mm256_setr_epi8 (7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8); break;
+  }
+  uint32_t i = 0;
+  for (; nbytes - i >= 32; i += 32)
+  {
+    const __m256i v = _mm256_loadu_si256 ((const __m256i *) (src + i));
+    _mm256_storeu_si256 ((__m256i *) (dst + i), _mm256_shuffle_epi8 (v, mask));
+  }
+  return i;
+}
+#endif
+
+#ifdef DDS_STREAM_SWAP_NEON
+ddsrt_nonnull_all
+static uint32_t dds_stream_swap_copy_neon (unsigned char *dst, const unsigned char *src, uint32_t size, uint32_t nbytes)
+{
+  uint32_t i = 0;
+  switch (size)
+  {
+    case 2:
+      for (; nbytes - i >= 16; i += 16)
+        vst1q_u8 (dst + i, vrev16q_u8 (vld1q_u8 (src + i)));
+      break;
+    case 4:
+      for (; nbytes - i >= 16; i += 16)
+        vst1q_u8 (dst + i, vrev32q_u8 (vld1q_u8 (src + i)));
+      break;
+    case 8:
+      for (; nbytes - i >= 16; i += 16)
+        vst1q_u8 (dst + i, vrev64q_u8 (vld1q_u8 (src + i)));
+      break;
+  }
+  return i;
+}
+#endif
+
+/* Returns the number of elements that were swapped, which is always a multiple of the
+   number of elements that fit in a vector register and may be 0 */
+ddsrt_nonnull_all
+static uint32_t dds_stream_swap_copy_vec (void *vdst, const void *vsrc, uint32_t size, uint32_t num)
+{
+  unsigned char *dst = vdst;
+  const unsigned char *src = vsrc;
+  // size * num < 4GB because it is a sequence or an array in a sample
+  const uint32_t nbytes = size * num;
+  uint32_t done = 0;
+  (void) dst; (void) src; (void) nbytes;
+#ifdef DDS_STREAM_SWAP_AVX2
+#ifdef DDS_STREAM_SWAP_AVX2_RUNTIME
+  if (nbytes >= 64 && __builtin_cpu_supports ("avx2"))
+#else
+  if (nbytes >= 32)
+#endif
+    done = dds_stream_swap_copy_avx2 (dst, src, size, nbytes);
+#endif
+#ifdef DDS_STREAM_SWAP_SSE2
+  done += dds_stream_swap_copy_sse2 (dst + done, src + done, size, nbytes - done);
+#elif defined DDS_STREAM_SWAP_NEON
+  done += dds_stream_swap_copy_neon (dst + done, src + done, size, nbytes - done);
+#endif
+  return done / size;
+}
+
 ddsrt_nonnull_all
 static void dds_stream_swap (void *vbuf, uint32_t size, uint32_t num)
 {
   assert (size == 1 || size == 2 || size == 4 || size == 8);
+  if (size == 1)
+    return;
+  const uint32_t done = dds_stream_swap_copy_vec (vbuf, vbuf, size, num);
+  vbuf = (char *) vbuf + done * size;
+  num -= done;
   switch (size)
   {
     case 1:
@@ -844,6 +1054,357 @@ size_t dds_stream_check_optimize (const struct dds_cdrstream_desc *desc, uint32_
   return opt_size;
 }
 
+struct memcpy_plan_builder {
+  struct dds_cdrstream_memcpy_plan *plan;
+  const struct dds_cdrstream_allocator *allocator;
+  uint32_t xcdr_version;
+  uint32_t steps_size;
+  uint32_t elems_size;
+};
+
+ddsrt_nonnull_all
+static struct memcpy_plan_step *memcpy_plan_add_step (struct memcpy_plan_builder *b, enum memcpy_plan_kind kind, uint32_t offs, uint32_t size, uint32_t arg)
+{
+  struct dds_cdrstream_memcpy_plan * const plan = b->plan;
+  if (plan->nsteps == b->steps_size)
+  {
+    b->steps_size = b->steps_size ? 2 * b->steps_size : 8;
+    plan->steps = b->allocator->realloc (plan->steps, b->steps_size * sizeof (*plan->steps));
+  }
+  struct memcpy_plan_step *step = &plan->steps[plan->nsteps++];
+  *step = (struct memcpy_plan_step) { .kind = kind, .offs = offs, .size = size, .arg = arg };
+  return step;
+}
+
+ddsrt_nonnull_all
+static void memcpy_plan_add_prim (struct memcpy_plan_builder *b, uint32_t offs, uint32_t size, uint32_t num)
+{
+  struct dds_cdrstream_memcpy_plan * const plan = b->plan;
+  const uint32_t align = ALIGN (dds_cdr_get_align (b->xcdr_version, size));
+  struct memcpy_plan_step *run = (plan->nsteps > 0 && plan->steps[plan->nsteps - 1].kind == PLAN_RUN) ? &plan->steps[plan->nsteps - 1] : NULL;
+
+  // Extend the current run if the CDR offset of this member relative to the start of
+  // the run (assuming the run starts at a multiple of the run's alignment) matches the
+  // offset in memory, otherwise start a new run
+  uint32_t run_offs = run ? (run->size + align - 1) & ~(align - 1) : 0;
+  if (run == NULL || run->offs + run_offs != offs)
+  {
+    run = memcpy_plan_add_step (b, PLAN_RUN, offs, 0, 0);
+    run->run_align = align;
+    run->elem0 = plan->nelems;
+    run_offs = 0;
+  }
+  run->size = run_offs + num * size;
+  if (align > run->run_align)
+    run->run_align = align;
+  run->nelems++;
+
+  if (plan->nelems == b->elems_size)
+  {
+    b->elems_size = b->elems_size ? 2 * b->elems_size : 8;
+    plan->elems = b->allocator->realloc (plan->elems, b->elems_size * sizeof (*plan->elems));
+  }
+  plan->elems[plan->nelems++] = (struct memcpy_plan_elem) { .offs = offs, .size = size, .num = num };
+}
+
+ddsrt_nonnull_all
+static bool memcpy_plan_build (struct memcpy_plan_builder *b, const uint32_t *ops, uint32_t member_offs)
+{
+  uint32_t insn;
+  while ((insn = *ops) != DDS_OP_RTS)
+  {
+    if (DDS_OP (insn) != DDS_OP_ADR || op_type_external (insn) || op_type_optional (insn))
+      return false;
+
+    const uint32_t offs = member_offs + ops[1];
+    switch (DDS_OP_TYPE (insn))
+    {
+      case DDS_OP_VAL_BLN:
+        (void) memcpy_plan_add_step (b, PLAN_BLN, offs, 1, 0);
+        ops += 2;
+        break;
+      case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY:
+        memcpy_plan_add_prim (b, offs, get_primitive_size (DDS_OP_TYPE (insn)), 1);
+        ops += 2;
+        break;
+      case DDS_OP_VAL_ENU:
+        (void) memcpy_plan_add_step (b, PLAN_ENU, offs, DDS_OP_TYPE_SZ (insn), ops[2]);
+        ops += 3;
+        break;
+      case DDS_OP_VAL_STR:
+        (void) memcpy_plan_add_step (b, PLAN_STR, offs, 0, 0);
+        ops += 2;
+        break;
+      case DDS_OP_VAL_BST:
+        (void) memcpy_plan_add_step (b, PLAN_BST, offs, ops[2], 0);
+        ops += 3;
+        break;
+      case DDS_OP_VAL_ARR:
+        switch (DDS_OP_SUBTYPE (insn))
+        {
+          case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY:
+            memcpy_plan_add_prim (b, offs, get_primitive_size (DDS_OP_SUBTYPE (insn)), ops[2]);
+            ops += 3;
+            break;
+          default:
+            return false;
+        }
+        break;
+      case DDS_OP_VAL_SEQ: case DDS_OP_VAL_BSQ: {
+        const uint32_t bound_op = seq_is_bounded (DDS_OP_TYPE (insn)) ? 1 : 0;
+        switch (DDS_OP_SUBTYPE (insn))
+        {
+          case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY:
+            (void) memcpy_plan_add_step (b, PLAN_SEQ, offs, get_primitive_size (DDS_OP_SUBTYPE (insn)), bound_op ? ops[2] : 0);
+            ops += 2 + bound_op;
+            break;
+          default:
+            return false;
+        }
+        break;
+      }
+      case DDS_OP_VAL_EXT: {
+        const uint32_t *jsr_ops = ops + DDS_OP_ADR_JSR (ops[2]);
+        const uint32_t jmp = DDS_OP_ADR_JMP (ops[2]);
+        if (op_type_base (insn) && jsr_ops[0] == DDS_OP_DLC)
+          jsr_ops++;
+        if (!memcpy_plan_build (b, jsr_ops, offs))
+          return false;
+        ops += jmp ? jmp : 3;
+        break;
+      }
+      case DDS_OP_VAL_BMK: // no memcpy: values must be checked when writing
+      case DDS_OP_VAL_WSTR: case DDS_OP_VAL_BWSTR: case DDS_OP_VAL_WCHAR:
+      case DDS_OP_VAL_UNI: case DDS_OP_VAL_STU:
+        return false;
+    }
+  }
+  return true;
+}
+
+ddsrt_nonnull_all
+static void memcpy_plan_free (struct dds_cdrstream_memcpy_plan *plan, const struct dds_cdrstream_allocator *allocator)
+{
+  allocator->free (plan->steps);
+  allocator->free (plan->elems);
+  allocator->free (plan);
+}
+
+struct dds_cdrstream_memcpy_plan *dds_stream_memcpy_plan (const struct dds_cdrstream_desc *desc, const struct dds_cdrstream_allocator *allocator, uint32_t xcdr_version)
+{
+  // Only for final types: appendable and mutable types start with a DLC or PLC instruction
+  struct dds_cdrstream_memcpy_plan *plan = allocator->malloc (sizeof (*plan));
+  *plan = (struct dds_cdrstream_memcpy_plan) { .nsteps = 0 };
+  struct memcpy_plan_builder b = { .plan = plan, .allocator = allocator, .xcdr_version = xcdr_version };
+  if (!memcpy_plan_build (&b, desc->ops.ops, 0))
+  {
+    memcpy_plan_free (plan, allocator);
+    return NULL;
+  }
+  return plan;
+}
+
+struct key_plan_builder {
+  struct dds_cdrstream_key_plan *plan;
+  const struct dds_cdrstream_allocator *allocator;
+  uint32_t steps_size;
+  uint32_t keys_remaining;
+};
+
+ddsrt_nonnull_all
+static struct key_plan_step *key_plan_add_step (struct key_plan_builder *b, enum key_plan_kind kind)
+{
+  struct dds_cdrstream_key_plan * const plan = b->plan;
+  if (plan->nsteps == b->steps_size)
+  {
+    b->steps_size = b->steps_size ? 2 * b->steps_size : 8;
+    plan->steps = b->allocator->realloc (plan->steps, b->steps_size * sizeof (*plan->steps));
+  }
+  struct key_plan_step *step = &plan->steps[plan->nsteps++];
+  *step = (struct key_plan_step) { .kind = kind };
+  return step;
+}
+
+ddsrt_nonnull_all
+static void key_plan_add_prim (struct key_plan_builder *b, enum key_plan_kind kind, uint32_t size, uint32_t num)
+{
+  struct dds_cdrstream_key_plan * const plan = b->plan;
+  struct key_plan_step *step = (plan->nsteps > 0 && plan->steps[plan->nsteps - 1].kind == kind) ? &plan->steps[plan->nsteps - 1] : NULL;
+
+  // Elements of a size not larger than that of the previous element in the step are
+  // aligned without padding, both in the data and in the key, once the first element
+  // is aligned
+  if (step != NULL && size <= step->last_size)
+    step->size += num * size;
+  else
+  {
+    step = key_plan_add_step (b, kind);
+    step->first_size = size;
+    step->size = num * size;
+  }
+  step->last_size = size;
+}
+
+ddsrt_nonnull_all
+static bool key_plan_build (struct key_plan_builder *b, const uint32_t *ops)
+{
+  uint32_t insn;
+  while ((insn = *ops) != DDS_OP_RTS && b->keys_remaining > 0)
+  {
+    if (DDS_OP (insn) != DDS_OP_ADR)
+      return false;
+
+    const enum dds_stream_typecode type = DDS_OP_TYPE (insn);
+    if (!(insn & DDS_OP_FLAG_KEY))
+    {
+      // Skip primitives by their size, anything else using the instructions
+      if (op_type_optional (insn))
+        key_plan_add_step (b, KEY_PLAN_MEMBER)->ops = ops;
+      else if (is_primitive_type (type))
+        key_plan_add_prim (b, KEY_PLAN_SKIP, get_primitive_size (type), 1);
+      else if (type == DDS_OP_VAL_ENU || type == DDS_OP_VAL_BMK)
+        key_plan_add_prim (b, KEY_PLAN_SKIP, DDS_OP_TYPE_SZ (insn), 1);
+      else if (type == DDS_OP_VAL_ARR && is_primitive_type (DDS_OP_SUBTYPE (insn)))
+        key_plan_add_prim (b, KEY_PLAN_SKIP, get_primitive_size (DDS_OP_SUBTYPE (insn)), ops[2]);
+      else
+        key_plan_add_step (b, KEY_PLAN_MEMBER)->ops = ops;
+      ops = dds_stream_skip_adr (insn, ops);
+      continue;
+    }
+
+    switch (type)
+    {
+      case DDS_OP_VAL_BLN: case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY: case DDS_OP_VAL_WCHAR:
+        key_plan_add_prim (b, KEY_PLAN_COPY, get_primitive_size (type), 1);
+        break;
+      case DDS_OP_VAL_ENU: case DDS_OP_VAL_BMK:
+        key_plan_add_prim (b, KEY_PLAN_COPY, DDS_OP_TYPE_SZ (insn), 1);
+        break;
+      case DDS_OP_VAL_STR: case DDS_OP_VAL_BST:
+        (void) key_plan_add_step (b, KEY_PLAN_STR);
+        break;
+      case DDS_OP_VAL_ARR:
+        // arrays of non-primitive types have a DHEADER in XCDR2
+        if (!is_primitive_type (DDS_OP_SUBTYPE (insn)))
+          return false;
+        key_plan_add_prim (b, KEY_PLAN_COPY, get_primitive_size (DDS_OP_SUBTYPE (insn)), ops[2]);
+        break;
+      case DDS_OP_VAL_EXT: {
+        const uint32_t *jsr_ops = ops + DDS_OP_ADR_JSR (ops[2]);
+        if (op_type_base (insn) && jsr_ops[0] == DDS_OP_DLC)
+          jsr_ops++;
+        if (!key_plan_build (b, jsr_ops))
+          return false;
+        ops = dds_stream_skip_adr (insn, ops);
+        continue;
+      }
+      case DDS_OP_VAL_WSTR: case DDS_OP_VAL_BWSTR:
+      case DDS_OP_VAL_SEQ: case DDS_OP_VAL_BSQ: case DDS_OP_VAL_UNI: case DDS_OP_VAL_STU:
+        return false;
+    }
+    b->keys_remaining--;
+    ops = dds_stream_skip_adr (insn, ops);
+  }
+  return true;
+}
+
+ddsrt_nonnull_all
+static void key_plan_free (struct dds_cdrstream_key_plan *plan, const struct dds_cdrstream_allocator *allocator)
+{
+  allocator->free (plan->steps);
+  allocator->free (plan);
+}
+
+struct dds_cdrstream_key_plan *dds_stream_key_plan (const struct dds_cdrstream_desc *desc, const struct dds_cdrstream_allocator *allocator)
+{
+  // Types with keys in appendable or mutable types, or in sequences or arrays of
+  // aggregated types are handled by reading the full sample (see dds_stream_extract_key_from_data)
+  if (desc->keys.nkeys == 0 || (desc->flagset & (DDS_TOPIC_KEY_APPENDABLE | DDS_TOPIC_KEY_MUTABLE | DDS_TOPIC_KEY_SEQUENCE | DDS_TOPIC_KEY_ARRAY_NONPRIM)))
+    return NULL;
+  struct dds_cdrstream_key_plan *plan = allocator->malloc (sizeof (*plan));
+  *plan = (struct dds_cdrstream_key_plan) { .nsteps = 0 };
+  struct key_plan_builder b = { .plan = plan, .allocator = allocator, .keys_remaining = desc->keys.nkeys };
+  if (!key_plan_build (&b, desc->ops.ops) || b.keys_remaining > 0)
+  {
+    key_plan_free (plan, allocator);
+    return NULL;
+  }
+  return plan;
+}
+
+/* Whether the size of the serialized representation of the type is independent of the
+   contents of the sample: this is conservative, it excludes mutable types and unions */
+ddsrt_nonnull_all
+static bool fixed_serialized_size_ops (const uint32_t *ops)
+{
+  uint32_t insn;
+  if (*ops == DDS_OP_DLC) // DHEADER is always 4 bytes
+    ops++;
+  while ((insn = *ops) != DDS_OP_RTS)
+  {
+    if (DDS_OP (insn) != DDS_OP_ADR || op_type_external (insn) || op_type_optional (insn))
+      return false;
+    switch (DDS_OP_TYPE (insn))
+    {
+      case DDS_OP_VAL_BLN: case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY: case DDS_OP_VAL_WCHAR:
+        ops += 2;
+        break;
+      case DDS_OP_VAL_ENU:
+        ops += 3;
+        break;
+      case DDS_OP_VAL_BMK:
+        ops += 4;
+        break;
+      case DDS_OP_VAL_ARR:
+        switch (DDS_OP_SUBTYPE (insn))
+        {
+          case DDS_OP_VAL_BLN: case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY: case DDS_OP_VAL_WCHAR:
+            ops += 3;
+            break;
+          case DDS_OP_VAL_ENU:
+            ops += 4;
+            break;
+          case DDS_OP_VAL_BMK:
+            ops += 5;
+            break;
+          case DDS_OP_VAL_STU: {
+            const uint32_t jmp = DDS_OP_ADR_JMP (ops[3]);
+            if (!fixed_serialized_size_ops (ops + DDS_OP_ADR_JSR (ops[3])))
+              return false;
+            ops += jmp ? jmp : 5;
+            break;
+          }
+          default:
+            return false;
+        }
+        break;
+      case DDS_OP_VAL_EXT: {
+        const uint32_t jmp = DDS_OP_ADR_JMP (ops[2]);
+        if (!fixed_serialized_size_ops (ops + DDS_OP_ADR_JSR (ops[2])))
+          return false;
+        ops += jmp ? jmp : 3;
+        break;
+      }
+      case DDS_OP_VAL_STR: case DDS_OP_VAL_BST: case DDS_OP_VAL_WSTR: case DDS_OP_VAL_BWSTR:
+      case DDS_OP_VAL_SEQ: case DDS_OP_VAL_BSQ: case DDS_OP_VAL_UNI: case DDS_OP_VAL_STU:
+        return false;
+    }
+  }
+  return true;
+}
+
+size_t dds_stream_fixed_serialized_size (const struct dds_cdrstream_desc *desc, const struct dds_cdrstream_allocator *allocator, uint32_t xcdr_version)
+{
+  if (!fixed_serialized_size_ops (desc->ops.ops))
+    return 0;
+  // the size doesn't depend on the contents, so any sample will do
+  char *sample = allocator->malloc (desc->size);
+  memset (sample, 0, desc->size);
+  const size_t size = dds_stream_getsize_sample (sample, desc, xcdr_version);
+  allocator->free (sample);
+  return (size == SIZE_MAX) ? 0 : size;
+}
+
 ddsrt_nonnull_all
 static void dds_stream_get_ops_info1 (const uint32_t *ops, uint32_t nestc, struct dds_cdrstream_ops_info *info, bool in_xcdr1_delimited_scope, bool in_recursive);
 
@@ -1750,6 +2311,7 @@ bool dds_stream_write_sampleLE (dds_ostreamLE_t *os, const struct dds_cdrstream_
 {
   STREAM_SIZE_CHECK_INIT (os->x);
   const size_t opt_size = os->x.m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_1 ? desc->opt_size_xcdr1 : desc->opt_size_xcdr2;
+  const struct dds_cdrstream_memcpy_plan *plan = os->x.m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_1 ? desc->plan_xcdr1 : desc->plan_xcdr2;
   bool res;
   if (opt_size && desc->align && (os->x.m_index % desc->align) == 0) {
     restrict_ostream_t ros;
@@ -1758,6 +2320,10 @@ bool dds_stream_write_sampleLE (dds_ostreamLE_t *os, const struct dds_cdrstream_
     dds_os_put_bytes_base (&ros.x, allocator, data, (uint32_t) opt_size);
     memcpy (os, &ros, sizeof (*os));
     res = true;
+  } else if (desc->specialized && desc->specialized->write) {
+    res = desc->specialized->write (&os->x, allocator, data);
+  } else if (plan) {
+    res = dds_stream_write_planLE (os, allocator, data, plan);
   } else {
     res = dds_stream_write_with_midLE (os, allocator, &desc->member_ids, data, desc->ops.ops) != NULL;
   }
@@ -1768,7 +2334,12 @@ bool dds_stream_write_sampleLE (dds_ostreamLE_t *os, const struct dds_cdrstream_
 bool dds_stream_write_sampleBE (dds_ostreamBE_t *os, const struct dds_cdrstream_allocator *allocator, const void *data, const struct dds_cdrstream_desc *desc)
 {
   STREAM_SIZE_CHECK_INIT (os->x);
-  const bool res = (dds_stream_write_with_midBE (os, allocator, &desc->member_ids, data, desc->ops.ops) != NULL);
+  const struct dds_cdrstream_memcpy_plan *plan = os->x.m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_1 ? desc->plan_xcdr1 : desc->plan_xcdr2;
+  bool res;
+  if (plan)
+    res = dds_stream_write_planBE (os, allocator, data, plan);
+  else
+    res = (dds_stream_write_with_midBE (os, allocator, &desc->member_ids, data, desc->ops.ops) != NULL);
   STREAM_SIZE_CHECK (os->x);
   return res;
 }
@@ -1786,7 +2357,12 @@ bool dds_stream_write_sample (dds_ostream_t *os, const struct dds_cdrstream_allo
 bool dds_stream_write_sampleLE (dds_ostreamLE_t *os, const struct dds_cdrstream_allocator *allocator, const void *data, const struct dds_cdrstream_desc *desc)
 {
   STREAM_SIZE_CHECK_INIT (os->x);
-  const bool res = (dds_stream_write_with_midLE (os, allocator, &desc->member_ids, data, desc->ops.ops) != NULL);
+  const struct dds_cdrstream_memcpy_plan *plan = os->x.m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_1 ? desc->plan_xcdr1 : desc->plan_xcdr2;
+  bool res;
+  if (plan)
+    res = dds_stream_write_planLE (os, allocator, data, plan);
+  else
+    res = (dds_stream_write_with_midLE (os, allocator, &desc->member_ids, data, desc->ops.ops) != NULL);
   STREAM_SIZE_CHECK (os->x);
   return res;
 }
@@ -1795,6 +2371,7 @@ bool dds_stream_write_sampleBE (dds_ostreamBE_t *os, const struct dds_cdrstream_
 {
   STREAM_SIZE_CHECK_INIT (os->x);
   const size_t opt_size = os->x.m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_1 ? desc->opt_size_xcdr1 : desc->opt_size_xcdr2;
+  const struct dds_cdrstream_memcpy_plan *plan = os->x.m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_1 ? desc->plan_xcdr1 : desc->plan_xcdr2;
   bool res;
   if (opt_size && desc->align && (os->x.m_index % desc->align) == 0) {
     restrict_ostream_t ros;
@@ -1803,6 +2380,10 @@ bool dds_stream_write_sampleBE (dds_ostreamBE_t *os, const struct dds_cdrstream_
     dds_os_put_bytes_base (&ros.x, allocator, data, (uint32_t) opt_size);
     memcpy (os, &ros, sizeof (*os));
     res = true;
+  } else if (desc->specialized && desc->specialized->write) {
+    res = desc->specialized->write (&os->x, allocator, data);
+  } else if (plan) {
+    res = dds_stream_write_planBE (os, allocator, data, plan);
   } else {
     res = dds_stream_write_with_midBE (os, allocator, &desc->member_ids, data, desc->ops.ops) != NULL;
   }
@@ -2444,6 +3025,11 @@ static size_t dds_stream_getsize_sample_impl (const char *data, const uint32_t *
 
 size_t dds_stream_getsize_sample (const char *data, const struct dds_cdrstream_desc *desc, uint32_t xcdr_version)
 {
+  const size_t fixed_size = (xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_1) ? desc->fixed_size_xcdr1 : desc->fixed_size_xcdr2;
+  if (fixed_size > 0)
+    return fixed_size;
+  if (desc->specialized && desc->specialized->getsize)
+    return desc->specialized->getsize (data, xcdr_version);
   return dds_stream_getsize_sample_impl (data, desc->ops.ops, xcdr_version);
 }
 
@@ -2663,6 +3249,21 @@ static void adjust_sequence_buffer (dds_sequence_t *seq, const struct dds_cdrstr
   }
 }
 
+void dds_stream_adjust_sequence_buffer (dds_sequence_t *seq, const struct dds_cdrstream_allocator *allocator, uint32_t num, uint32_t elem_size, bool initialize)
+{
+  enum sample_data_state sample_state = SAMPLE_DATA_INITIALIZED;
+  if (num == 0)
+    seq->_length = 0;
+  else
+  {
+    if (initialize)
+      adjust_sequence_buffer_initialize (seq, allocator, num, elem_size, &sample_state);
+    else
+      adjust_sequence_buffer (seq, allocator, num, elem_size, &sample_state);
+    seq->_length = (num <= seq->_maximum) ? num : seq->_maximum;
+  }
+}
+
 /**
  * @param[in,out] is                  input stream
  * @param[out]    param_mid  parameter id if return is true, else left unchanged
@@ -3859,9 +4460,16 @@ static bool normalize_boolarray (char * restrict data, uint32_t * restrict off,
   if ((*off = check_align_prim_many (*off, size, 0, 0, num)) == UINT32_MAX)
     return false;
   uint8_t * const xs = (uint8_t *) (data + *off);
+  // first check whether there is anything to do with a loop the compiler can vectorize,
+  // because values other than 0 and 1 are rare
+  uint8_t any = 0;
   for (uint32_t i = 0; i < num; i++)
-    if (xs[i] > 1)
-      xs[i] = 1;
+    any |= xs[i];
+  if (any > 1)
+  {
+    for (uint32_t i = 0; i < num; i++)
+      xs[i] = (xs[i] != 0);
+  }
   *off += num;
   return true;
 }
@@ -3907,35 +4515,47 @@ static bool normalize_primarray (char * restrict data, uint32_t * restrict off,
 ddsrt_attribute_warn_unused_result ddsrt_nonnull_all
 static bool normalize_enumarray (char * restrict data, uint32_t * restrict off, uint32_t size, bool bswap, uint32_t enum_sz, uint32_t num, uint32_t max)
 {
+  // swap all elements first and then check the maximum in a loop without early exit, so
+  // that both can be vectorized: invalid input is rare and gets rejected anyway
   switch (enum_sz)
   {
     case 1: {
       if ((*off = check_align_prim_many (*off, size, 0, 0, num)) == UINT32_MAX)
         return false;
-      uint8_t * const xs = (uint8_t *) (data + *off);
+      const uint8_t * const xs = (const uint8_t *) (data + *off);
+      uint8_t m = 0;
       for (uint32_t i = 0; i < num; i++)
-        if (xs[i] > max)
-          return normalize_error_bool ();
+        m = (xs[i] > m) ? xs[i] : m;
+      if (m > max)
+        return normalize_error_bool ();
       *off += num;
       break;
     }
     case 2: {
       if ((*off = check_align_prim_many (*off, size, 1, 1, num)) == UINT32_MAX)
         return false;
-      uint16_t * const xs = (uint16_t *) (data + *off);
+      if (bswap)
+        dds_stream_swap (data + *off, 2, num);
+      const uint16_t * const xs = (const uint16_t *) (data + *off);
+      uint16_t m = 0;
       for (uint32_t i = 0; i < num; i++)
-        if ((uint16_t) (bswap ? (xs[i] = ddsrt_bswap2u (xs[i])) : xs[i]) > max)
-          return normalize_error_bool ();
+        m = (xs[i] > m) ? xs[i] : m;
+      if (m > max)
+        return normalize_error_bool ();
       *off += 2 * num;
       break;
     }
     case 4: {
       if ((*off = check_align_prim_many (*off, size, 2, 2, num)) == UINT32_MAX)
         return false;
-      uint32_t * const xs = (uint32_t *) (data + *off);
+      if (bswap)
+        dds_stream_swap (data + *off, 4, num);
+      const uint32_t * const xs = (const uint32_t *) (data + *off);
+      uint32_t m = 0;
       for (uint32_t i = 0; i < num; i++)
-        if ((uint32_t) (bswap ? (xs[i] = ddsrt_bswap4u (xs[i])) : xs[i]) > max)
-          return normalize_error_bool ();
+        m = (xs[i] > m) ? xs[i] : m;
+      if (m > max)
+        return normalize_error_bool ();
       *off += 4 * num;
       break;
     }
@@ -4911,6 +5531,13 @@ bool dds_stream_normalize (void *data, uint32_t size, bool bswap, uint32_t xcdr_
     return normalize_error_bool ();
   else if (just_key)
     return stream_normalize_key (data, size, bswap, xcdr_version, desc, actual_size);
+  else if (desc->specialized && desc->specialized->normalize)
+  {
+    if (!desc->specialized->normalize (data, &off, size, bswap, xcdr_version))
+      return normalize_error_bool ();
+    *actual_size = off;
+    return true;
+  }
   else if (!stream_normalize_data_impl (data, &off, size, bswap, xcdr_version, &desc->member_ids, desc->ops.ops, false, CDR_KIND_DATA))
     return false;
   else
@@ -5297,10 +5924,18 @@ static void dds_stream_extract_key_from_key_prim_op (dds_istream_t *is, restrict
 static void dds_stream_swap_copy (void * restrict vdst, const void *vsrc, uint32_t size, uint32_t num)
 {
   assert (size == 1 || size == 2 || size == 4 || size == 8);
+  if (size == 1)
+  {
+    memcpy (vdst, vsrc, num);
+    return;
+  }
+  const uint32_t done = dds_stream_swap_copy_vec (vdst, vsrc, size, num);
+  vdst = (char *) vdst + done * size;
+  vsrc = (const char *) vsrc + done * size;
+  num -= done;
   switch (size)
   {
     case 1:
-      memcpy (vdst, vsrc, num);
       break;
     case 2: {
       const uint16_t *src = vsrc;
@@ -5581,15 +6216,116 @@ static const uint32_t *dds_stream_extract_key_from_data_skip_adr (dds_istream_t
   return ops;
 }
 
+ddsrt_nonnull_all
+static void dds_stream_extract_key_from_data_plan (dds_istream_t *is, restrict_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const struct dds_cdrstream_desc *desc, const struct dds_cdrstream_key_plan *plan)
+{
+  for (uint32_t s = 0; s < plan->nsteps; s++)
+  {
+    const struct key_plan_step *step = &plan->steps[s];
+    switch (step->kind)
+    {
+      case KEY_PLAN_SKIP: {
+        const uint32_t a = ALIGN (dds_cdr_get_align (is->m_xcdr_version, step->first_size));
+        is->m_index = ((is->m_index + a - 1) & ~(a - 1)) + step->size;
+        break;
+      }
+      case KEY_PLAN_COPY:
+        dds_cdr_alignto (is, dds_cdr_get_align (is->m_xcdr_version, step->first_size));
+        (void) dds_cdr_alignto_clear_and_resize_base (&os->x, allocator, dds_cdr_get_align (os->x.m_xcdr_version, step->first_size), step->size);
+        memcpy (os->x.m_buffer + os->x.m_index, is->m_buffer + is->m_index, step->size);
+        os->x.m_index += step->size;
+        is->m_index += step->size;
+        break;
+      case KEY_PLAN_STR: {
+        const uint32_t sz = dds_is_get4 (is);
+        dds_os_put4 (os, allocator, sz);
+        dds_os_put_bytes_base (&os->x, allocator, is->m_buffer + is->m_index, sz);
+        is->m_index += sz;
+        break;
+      }
+      case KEY_PLAN_MEMBER: {
+        uint32_t keys_remaining = 0;
+        const uint32_t *next_ops = dds_stream_extract_key_from_data_adr (*step->ops, is, NULL, allocator, &desc->member_ids, step->ops, false, 0, &keys_remaining);
+        assert (next_ops == dds_stream_skip_adr (*step->ops, step->ops));
+        (void) next_ops;
+        break;
+      }
+    }
+  }
+}
+
 /*******************************************************************************************
  **
  **  Read/write of samples and keys -- i.e., DDSI payloads.
  **
  *******************************************************************************************/
 
+ddsrt_nonnull_all
+static void dds_stream_read_plan (dds_istream_t *is, char * restrict data, const struct dds_cdrstream_allocator *allocator, const struct dds_cdrstream_memcpy_plan *plan)
+{
+  for (uint32_t s = 0; s < plan->nsteps; s++)
+  {
+    const struct memcpy_plan_step *step = &plan->steps[s];
+    char *addr = data + step->offs;
+    switch (step->kind)
+    {
+      case PLAN_RUN: {
+        const struct memcpy_plan_elem *elems = &plan->elems[step->elem0];
+        dds_cdr_alignto (is, dds_cdr_get_align (is->m_xcdr_version, elems[0].size));
+        if (is->m_index % step->run_align == 0)
+        {
+          memcpy (addr, is->m_buffer + is->m_index, step->size);
+          is->m_index += step->size;
+        }
+        else
+        {
+          for (uint32_t e = 0; e < step->nelems; e++)
+            dds_is_get_bytes (is, data + elems[e].offs, elems[e].num, elems[e].size);
+        }
+        break;
+      }
+      case PLAN_BLN:
+        *((uint8_t *) addr) = dds_is_get1 (is);
+        break;
+      case PLAN_ENU:
+        switch (step->size)
+        {
+          case 1: *((uint32_t *) addr) = dds_is_get1 (is); break;
+          case 2: *((uint32_t *) addr) = dds_is_get2 (is); break;
+          case 4: *((uint32_t *) addr) = dds_is_get4 (is); break;
+          default: abort ();
+        }
+        break;
+      case PLAN_STR:
+        *((char **) addr) = dds_stream_reuse_string (is, *((char **) addr), allocator, SAMPLE_DATA_INITIALIZED);
+        break;
+      case PLAN_BST:
+        (void) dds_stream_reuse_string_bound (is, addr, step->size);
+        break;
+      case PLAN_SEQ: {
+        dds_sequence_t * const seq = (dds_sequence_t *) addr;
+        const uint32_t num = dds_is_get4 (is);
+        if (num == 0)
+          seq->_length = 0;
+        else
+        {
+          enum sample_data_state sample_state = SAMPLE_DATA_INITIALIZED;
+          adjust_sequence_buffer (seq, allocator, num, step->size, &sample_state);
+          seq->_length = (num <= seq->_maximum) ? num : seq->_maximum;
+          dds_is_get_bytes (is, seq->_buffer, seq->_length, step->size);
+          if (seq->_length < num)
+            dds_stream_skip_forward (is, num - seq->_length, step->size);
+        }
+        break;
+      }
+    }
+  }
+}
+
 void dds_stream_read_sample (dds_istream_t *is, void *data, const struct dds_cdrstream_allocator *allocator, const struct dds_cdrstream_desc *desc)
 {
   size_t opt_size = is->m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_1 ? desc->opt_size_xcdr1 : desc->opt_size_xcdr2;
+  const struct dds_cdrstream_memcpy_plan *plan = is->m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_1 ? desc->plan_xcdr1 : desc->plan_xcdr2;
   if (opt_size)
   {
     /* Layout of struct & CDR is the same, but sizeof(struct) may include padding at
@@ -5597,6 +6333,14 @@ void dds_stream_read_sample (dds_istream_t *is, void *data, const struct dds_cdr
        potential out-of-bounds read */
     dds_is_get_bytes (is, data, (uint32_t) opt_size, 1);
   }
+  else if (desc->specialized && desc->specialized->read)
+  {
+    desc->specialized->read (is, data, allocator);
+  }
+  else if (plan)
+  {
+    dds_stream_read_plan (is, data, allocator, plan);
+  }
   else
   {
     (void) dds_stream_read_impl (is, data, allocator, desc->ops.ops, false, CDR_KIND_DATA, SAMPLE_DATA_INITIALIZED);
@@ -5728,14 +6472,18 @@ void dds_stream_read_key (dds_istream_t *is, char *sample, const struct dds_cdrs
 
 // Native endianness
 #define NAME_BYTE_ORDER_EXT
+#define BYTE_ORDER_IS_NATIVE 1
 #include "dds_cdrstream_keys.part.h"
+#undef BYTE_ORDER_IS_NATIVE
 #undef NAME_BYTE_ORDER_EXT
 
 #if DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN
 
 // Big-endian implementation
 #define NAME_BYTE_ORDER_EXT BE
+#define BYTE_ORDER_IS_NATIVE 0
 #include "dds_cdrstream_keys.part.h"
+#undef BYTE_ORDER_IS_NATIVE
 #undef NAME_BYTE_ORDER_EXT
 
 #else /* if DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN */
@@ -7100,9 +7848,16 @@ void dds_cdrstream_desc_init_with_nops (struct dds_cdrstream_desc *desc, const s
   }
 
   /* Get the flagset from the descriptor, except for the key related flags that are calculated
-     using the CDR stream serializer */
-  desc->flagset = flagset & ~DDS_CDR_CALCULATED_FLAGS;
+     using the CDR stream serializer and the flag for the presence of specialized functions:
+     those don't change the type and are set by the caller if it has them */
+  desc->flagset = flagset & ~(DDS_CDR_CALCULATED_FLAGS | DDS_TOPIC_SPECIALIZED_OPS);
   desc->flagset |= dds_stream_key_flags (desc, NULL, NULL);
+  desc->specialized = NULL;
+  desc->plan_xcdr1 = NULL;
+  desc->plan_xcdr2 = NULL;
+  desc->fixed_size_xcdr1 = 0;
+  desc->fixed_size_xcdr2 = 0;
+  desc->key_plan = NULL;
 }
 
 void dds_cdrstream_desc_init (struct dds_cdrstream_desc *desc, const struct dds_cdrstream_allocator *allocator,
@@ -7131,6 +7886,12 @@ void dds_cdrstream_desc_fini (struct dds_cdrstream_desc *desc, const struct dds_
     ddsrt_hh_enum (desc->member_ids.table, free_member_id, (void *) allocator);
     ddsrt_hh_free (desc->member_ids.table);
   }
+  if (desc->plan_xcdr1 != NULL)
+    memcpy_plan_free (desc->plan_xcdr1, allocator);
+  if (desc->plan_xcdr2 != NULL)
+    memcpy_plan_free (desc->plan_xcdr2, allocator);
+  if (desc->key_plan != NULL)
+    key_plan_free (desc->key_plan, allocator);
   allocator->free (desc->ops.ops);
 }
 
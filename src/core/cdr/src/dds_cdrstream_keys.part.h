@@ -297,6 +297,13 @@ static bool dds_stream_extract_keyBO_from_data_restrict (dds_istream_t *is, REST
     dds_stream_free_sample (sample, allocator, desc->ops.ops);
     allocator->free (sample);
   }
+#if BYTE_ORDER_IS_NATIVE
+  else if (desc->key_plan)
+  {
+    /* precomputed steps, stopping after the last key member */
+    dds_stream_extract_key_from_data_plan (is, os, allocator, desc, desc->key_plan);
+  }
+#endif
   else
   {
     /* optimized solution for keys in type with final extensibility */
@@ -312,6 +319,10 @@ static bool dds_stream_extract_keyBO_from_data_restrict (dds_istream_t *is, REST
 ddsrt_attribute_warn_unused_result ddsrt_nonnull_all
 bool dds_stream_extract_keyBO_from_data (dds_istream_t *is, DDS_OSTREAM_T *os, const struct dds_cdrstream_allocator *allocator, const struct dds_cdrstream_desc *desc)
 {
+#if BYTE_ORDER_IS_NATIVE
+  if (desc->specialized && desc->specialized->extract_key_from_data)
+    return desc->specialized->extract_key_from_data (is, (dds_ostream_t *) os, allocator);
+#endif
   RESTRICT_OSTREAM_T ros;
   memcpy (&ros, os, sizeof (*os));
   ros.x.m_align_off = 0;
@@ -925,6 +925,94 @@ static const uint32_t *dds_stream_write_implBO (RESTRICT_OSTREAM_T *os, const st
   return ops;
 }
 
+ddsrt_attribute_warn_unused_result ddsrt_nonnull_all
+static inline bool dds_stream_write_plan_implBO (RESTRICT_OSTREAM_T *os, const struct dds_cdrstream_allocator *allocator, const char *data, const struct dds_cdrstream_memcpy_plan *plan)
+{
+  const uint32_t xcdrv = os->x.m_xcdr_version;
+  for (uint32_t s = 0; s < plan->nsteps; s++)
+  {
+    const struct memcpy_plan_step *step = &plan->steps[s];
+    const char *addr = data + step->offs;
+    switch (step->kind)
+    {
+      case PLAN_RUN: {
+        const struct memcpy_plan_elem *elems = &plan->elems[step->elem0];
+        dds_cdr_alignto_clear_and_resize_base (&os->x, allocator, dds_cdr_get_align (xcdrv, elems[0].size), step->size);
+        if ((os->x.m_index - os->x.m_align_off) % step->run_align == 0)
+        {
+          unsigned char *dst = os->x.m_buffer + os->x.m_index;
+          memcpy (dst, addr, step->size);
+          os->x.m_index += step->size;
+          for (uint32_t e = 0; e < step->nelems; e++)
+            dds_stream_to_BO_insitu (dst + (elems[e].offs - step->offs), elems[e].size, elems[e].num);
+        }
+        else
+        {
+          // layout in CDR differs from the layout in memory, copy the elements one by one
+          for (uint32_t e = 0; e < step->nelems; e++)
+          {
+            void *dst;
+            dds_os_put_bytes_aligned_base (&os->x, allocator, data + elems[e].offs, elems[e].num, elems[e].size, dds_cdr_get_align (xcdrv, elems[e].size), &dst);
+            dds_stream_to_BO_insitu (dst, elems[e].size, elems[e].num);
+          }
+        }
+        break;
+      }
+      case PLAN_BLN:
+        dds_os_put1BO (os, allocator, *((const uint8_t *) addr) != 0);
+        break;
+      case PLAN_ENU: {
+        const uint32_t val = *((const uint32_t *) addr);
+        if (val > step->arg)
+          return write_error_bool ();
+        switch (step->size)
+        {
+          case 1: dds_os_put1BO (os, allocator, (uint8_t) val); break;
+          case 2: dds_os_put2BO (os, allocator, (uint16_t) val); break;
+          case 4: dds_os_put4BO (os, allocator, val); break;
+          default: abort ();
+        }
+        break;
+      }
+      case PLAN_STR:
+        if (!dds_stream_write_stringBO (os, allocator, *((const char **) addr)))
+          return false;
+        break;
+      case PLAN_BST:
+        if (!dds_stream_write_bstringBO (os, allocator, addr, step->size - 1))
+          return false;
+        break;
+      case PLAN_SEQ: {
+        const dds_sequence_t * const seq = (const dds_sequence_t *) addr;
+        const uint32_t num = seq->_length;
+        if (step->arg && num > step->arg)
+          return write_error_bool ();
+        if (num > 0 && seq->_buffer == NULL)
+          return write_error_bool ();
+        dds_os_put4BO (os, allocator, num);
+        if (num > 0)
+        {
+          void *dst;
+          dds_os_put_bytes_aligned_base (&os->x, allocator, seq->_buffer, num, step->size, dds_cdr_get_align (xcdrv, step->size), &dst);
+          dds_stream_to_BO_insitu (dst, step->size, num);
+        }
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+static inline bool dds_stream_write_planBO (DDS_OSTREAM_T *os, const struct dds_cdrstream_allocator *allocator, const char *data, const struct dds_cdrstream_memcpy_plan *plan)
+{
+  RESTRICT_OSTREAM_T ros;
+  memcpy (&ros, os, sizeof (*os));
+  ros.x.m_align_off = 0;
+  const bool ret = dds_stream_write_plan_implBO (&ros, allocator, data, plan);
+  memcpy (os, &ros, sizeof (*os));
+  return ret;
+}
+
 const uint32_t *dds_stream_write_with_midBO (DDS_OSTREAM_T *os, const struct dds_cdrstream_allocator *allocator, const struct dds_cdrstream_desc_mid_table *mid_table, const char *data, const uint32_t *ops)
 {
   const struct dds_cdrstream_desc_mid_table empty_mid_table = { .table = (struct ddsrt_hh *) &ddsrt_hh_empty, .op0 = ops };
@@ -2532,6 +2532,46 @@ dds_write_ts(
   const void *data,
   dds_time_t timestamp);
 
+/**
+ * @brief Write a sequence of samples with the same source timestamp
+ * @ingroup writing
+ * @component write_data
+ *
+ * Writes the samples in order as if by `dds_write_ts()`, but serializes all of them before
+ * handing them to the writer history cache in one go, and packs them in as few network
+ * messages as possible, followed by a single heartbeat.  The check whether the writer has
+ * to block because of too much unacknowledged data is done once for the whole sequence.
+ *
+ * If writing one of the samples fails, the samples preceding it have been written and
+ * the remaining samples are not.
+ *
+ * @param[in]  writer The writer entity.
+ * @param[in]  data Array of pointers to the n samples to be written.
+ * @param[in]  n Number of samples.
+ * @param[in]  timestamp Source timestamp (>= 0).
+ *
+ * @returns A dds_return_t indicating success or failure.
+ *
+ * @retval DDS_RETCODE_OK
+ *             The writer successfully wrote all samples.
+ * @retval DDS_RETCODE_ERROR
+ *             An internal error has occurred.
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             One of the given arguments is not valid.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The entity has already been deleted.
+ * @retval DDS_RETCODE_TIMEOUT
+ *             The writer failed to write the samples reliably within the specified max_blocking_time.
+ */
+DDS_EXPORT dds_return_t
+dds_write_batch(
+  dds_entity_t writer,
+  const void * const *data,
+  uint32_t n,
+  dds_time_t timestamp);
+
 /**
  * @defgroup readcondition (ReadCondition)
  * @ingroup condition
@@ -4103,6 +4143,106 @@ dds_take_next_wl(
   void **buf,
   dds_sample_info_t *si);
 
+/**
+ * @brief Memory block for taking samples without individual allocations
+ * @ingroup reading
+ * @component read_data
+ *
+ * @see dds_take_arena
+ */
+typedef struct dds_sample_arena dds_sample_arena_t;
+
+/**
+ * @brief Create a sample arena
+ * @ingroup reading
+ * @component read_data
+ *
+ * Allocates a single block of `size` bytes from which @ref dds_take_arena allocates samples
+ * and all memory they reference.
+ *
+ * @param[in] size Size of the arena in bytes, must be > 0.
+ *
+ * @returns A pointer to the new arena, or a null pointer if `size` is 0 or the memory could
+ *          not be allocated.
+ */
+DDS_EXPORT dds_sample_arena_t *
+dds_sample_arena_create(size_t size);
+
+/**
+ * @brief Release all samples taken into a sample arena
+ * @ingroup reading
+ * @component read_data
+ *
+ * Makes the full arena available again.  All samples previously taken into it become invalid
+ * and must no longer be accessed.
+ *
+ * @param[in] arena The arena to reset.
+ */
+DDS_EXPORT void
+dds_sample_arena_reset(dds_sample_arena_t *arena);
+
+/**
+ * @brief Free a sample arena
+ * @ingroup reading
+ * @component read_data
+ *
+ * Frees the arena, invalidating all samples taken into it.
+ *
+ * @param[in] arena The arena to free.
+ */
+DDS_EXPORT void
+dds_sample_arena_delete(dds_sample_arena_t *arena);
+
+/**
+ * @brief Take data from the data reader, read or query condition into a sample arena
+ * @ingroup reading
+ * @component read_data
+ *
+ * Takes samples like @ref dds_take, but deserializes them into the free space of `arena`
+ * instead of into application-provided samples: on return, `buf[0 .. n-1]` point to samples
+ * in the arena and all strings and sequences in those samples point into the arena as well.
+ * No memory is allocated on the heap, and the samples are released all at once by resetting
+ * or deleting the arena.  The samples must not be freed with @ref dds_sample_free or
+ * returned with @ref dds_return_loan.
+ *
+ * Taking stops early if the next sample doesn't fit in the remaining space of the arena; that
+ * sample and any following ones remain in the reader.  Subsequent calls continue to allocate
+ * from the space left in the arena.
+ *
+ * This is only supported for topics using the default (IDL-generated or dynamic type) sample
+ * representation.
+ *
+ * @param[in]  reader_or_condition Reader, readcondition or querycondition entity.
+ * @param[out] buf An array of `bufsz` pointers to be set to the samples in the arena.
+ * @param[out] si Pointer to an array of @ref dds_sample_info_t returned for each data value.
+ * @param[in]  bufsz The size of buffer provided.
+ * @param[in]  maxs Maximum number of samples to take.
+ * @param[in]  arena The arena to allocate the samples from.
+ *
+ * @returns A dds_return_t with the number of samples taken or an error code.
+ *
+ * @retval >=0
+ *             Number of samples taken.
+ * @retval DDS_RETCODE_OUT_OF_RESOURCES
+ *             The first sample did not fit in the arena.
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             One of the given arguments is not valid.
+ * @retval DDS_RETCODE_UNSUPPORTED
+ *             The topic does not use the default sample representation.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The entity has already been deleted.
+ */
+DDS_EXPORT dds_return_t
+dds_take_arena(
+  dds_entity_t reader_or_condition,
+  void **buf,
+  dds_sample_info_t *si,
+  size_t bufsz,
+  uint32_t maxs,
+  dds_sample_arena_t *arena);
+
 /**
  * @brief Function type for sample collector argument in read/take-with-collector
  * @ingroup reading
@@ -4824,6 +4964,43 @@ dds_get_matched_subscription_data (
   dds_entity_t writer,
   dds_instance_handle_t ih);
 
+/**
+ * @brief Get the round-trip time estimate for a reader matched with the provided writer
+ * @ingroup builtintopic
+ * @component writer
+ *
+ * This operation looks up the reader instance handle in the set of
+ * readers matched with the specified writer and returns the estimate
+ * of the round-trip time between a heartbeat requesting an
+ * acknowledgement and the reader's response.  Such estimates exist
+ * only for remote reliable readers and only once they have responded
+ * to a heartbeat.  They are used to pace heartbeats if so configured
+ * (Internal/AdaptiveHeartbeat).
+ *
+ * @param[in] writer   The writer.
+ * @param[in] ih       The instance handle of a reader.
+ * @param[out] srtt    The smoothed round-trip time.
+ * @param[out] rttvar  The mean deviation of the round-trip time.
+ *
+ * @returns A dds_return_t indicating success or failure.
+ *
+ * @retval DDS_RETCODE_OK
+ *             The estimate was returned.
+ * @retval DDS_RETCODE_NO_DATA
+ *             The reader is matched but there is no estimate for it.
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             The writer is not valid, srtt or rttvar is a null pointer,
+ *             or ih is not an instance handle of a matched reader.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ */
+DDS_EXPORT dds_return_t
+dds_get_matched_subscription_rtt (
+  dds_entity_t writer,
+  dds_instance_handle_t ih,
+  dds_duration_t *srtt,
+  dds_duration_t *rttvar);
+
 /**
  * @brief Get instance handles of the data writers matching a reader
  * @ingroup builtintopic
@@ -694,6 +694,14 @@ enum dds_stream_typecode_subtype {
  */
 #define DDS_TOPIC_KEY_ARRAY_NONPRIM             (1u << 12)
 
+/**
+ * @anchor DDS_TOPIC_SPECIALIZED_OPS
+ * @ingroup topic_flags
+ * @brief Set if the topic descriptor includes type-specific serialization
+ * functions generated by the IDL compiler (option "-f specialized-ops").
+ */
+#define DDS_TOPIC_SPECIALIZED_OPS               (1u << 13)
+
 /**
  * @anchor DDS_FIXED_KEY_MAX_SIZE
  * @ingroup topic_flags
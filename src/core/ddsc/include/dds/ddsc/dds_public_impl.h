@@ -145,6 +145,8 @@ struct dds_type_meta_ser
  */
 #define DDS_DATA_REPRESENTATION_RESTRICT_DEFAULT  (DDS_DATA_REPRESENTATION_FLAG_XCDR1 | DDS_DATA_REPRESENTATION_FLAG_XCDR2)
 
+struct dds_cdrstream_specialized_ops;
+
 /**
  * @brief Topic Descriptor
  * @ingroup topic_definition
@@ -168,6 +170,8 @@ typedef struct dds_topic_descriptor
                                                    only present if flag DDS_TOPIC_XTYPES_METADATA is set */
   const uint32_t restrict_data_representation; /**< restrictions on the data representations allowed for the top-level type for this topic,
                                            only present if flag DDS_TOPIC_RESTRICT_DATA_REPRESENTATION */
+  const struct dds_cdrstream_specialized_ops *specialized_ops; /**< type-specific serialization functions generated by the IDL compiler,
+                                           only present if flag DDS_TOPIC_SPECIALIZED_OPS is set */
 }
 dds_topic_descriptor_t;
 
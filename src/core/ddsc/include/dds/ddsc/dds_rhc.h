@@ -32,6 +32,16 @@ typedef int32_t (*dds_rhc_read_take_t) (struct dds_rhc *rhc, int32_t max_samples
 typedef bool (*dds_rhc_add_readcondition_t) (struct dds_rhc *rhc, struct dds_readcond *cond);
 typedef void (*dds_rhc_remove_readcondition_t) (struct dds_rhc *rhc, struct dds_readcond *cond);
 
+/* Occupancy of the storage for samples and instances of an RHC, for the reader statistics */
+struct dds_rhc_slab_stats {
+  uint32_t samples_used;
+  uint32_t samples_reserved;
+  uint32_t instances_used;
+  uint32_t instances_reserved;
+};
+
+typedef void (*dds_rhc_get_slab_stats_t) (struct dds_rhc *rhc, struct dds_rhc_slab_stats *stats);
+
 struct dds_rhc_ops {
   /* A copy of DDSI rhc ops comes first so we can use either interface without
      additional indirections */
@@ -42,6 +52,7 @@ struct dds_rhc_ops {
   dds_rhc_add_readcondition_t add_readcondition;
   dds_rhc_remove_readcondition_t remove_readcondition;
   dds_rhc_associate_t associate;
+  dds_rhc_get_slab_stats_t get_slab_stats; /* optional, may be a null pointer */
 };
 
 struct dds_rhc {
@@ -103,6 +114,14 @@ DDS_INLINE_EXPORT inline void dds_rhc_remove_readcondition (struct dds_rhc *rhc,
   rhc->common.ops->remove_readcondition (rhc, cond);
 }
 
+/** @component rhc */
+DDS_INLINE_EXPORT inline void dds_rhc_get_slab_stats (struct dds_rhc *rhc, struct dds_rhc_slab_stats *stats) {
+  if (rhc->common.ops->get_slab_stats)
+    rhc->common.ops->get_slab_stats (rhc, stats);
+  else
+    stats->samples_used = stats->samples_reserved = stats->instances_used = stats->instances_reserved = 0;
+}
+
 /** @component rhc */
 DDS_EXPORT void dds_reader_data_available_cb (struct dds_reader *rd);
 
@@ -18,6 +18,7 @@ extern "C" {
 #endif
 
 struct dds_rhc;
+struct dds_readcond;
 struct ddsi_sertype;
 struct ddsi_domaingv;
 
@@ -27,6 +28,47 @@ struct dds_rhc *dds_rhc_default_new_xchecks (struct ddsi_domaingv *gv, const str
 /** @component rhc */
 struct dds_rhc *dds_rhc_default_new (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos);
 
+/** @component rhc
+ *
+ * Creates a default RHC for use as a shard of a sharded RHC: the list of read conditions is
+ * shared with the other shards and the trigger counts of the conditions are the sum over all
+ * shards.
+ */
+struct dds_rhc *dds_rhc_default_new_shard (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos);
+
+/** @component rhc */
+void dds_rhc_default_lock (struct dds_rhc *rhc);
+
+/** @component rhc */
+void dds_rhc_default_unlock (struct dds_rhc *rhc);
+
+/** @component rhc
+ *
+ * Adds a read condition to an RHC that is locked by the caller.
+ *
+ * @param[in] rhc      the RHC, locked
+ * @param[in] cond     the condition
+ * @param[in] link     whether to link the condition into the list, false if another shard
+ *                     sharing the list has already done so
+ * @param[out] trigger number of instances/samples in the RHC that match the condition
+ * @return false if the query condition can't be added because all slots are in use
+ */
+bool dds_rhc_default_add_readcondition_locked (struct dds_rhc *rhc, struct dds_readcond *cond, bool link, uint32_t *trigger);
+
+/** @component rhc
+ *
+ * Removes a read condition from an RHC that is locked by the caller, without freeing the
+ * query condition slot.
+ */
+void dds_rhc_default_remove_readcondition_locked (struct dds_rhc *rhc, struct dds_readcond *cond);
+
+/** @component rhc
+ *
+ * Converts a read/take state mask to the set of sample, view and instance states that must not
+ * be present, using the same interpretation as the default RHC.
+ */
+uint32_t dds_rhc_default_qminv_from_mask (uint32_t mask);
+
 #ifdef DDS_HAS_LIFESPAN
 /** @component rhc */
 ddsrt_mtime_t dds_rhc_default_sample_expired_cb(void *hc, ddsrt_mtime_t tnow);
@@ -0,0 +1,44 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDS__RHC_LATEST_H
+#define DDS__RHC_LATEST_H
+
+#include "dds/features.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct dds_rhc;
+struct ddsi_sertype;
+struct ddsi_domaingv;
+
+/** @component rhc
+ *
+ * Whether a reader of the given type and with the given QoS can use the "latest value" RHC:
+ * this requires a keyless type, a KEEP_LAST history of depth 1 and no QoS settings that depend
+ * on per-writer state or timing (deadline, time-based filter, by-source ordering, exclusive
+ * ownership).
+ */
+bool dds_rhc_latest_applicable (const struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos);
+
+/** @component rhc
+ *
+ * Creates an RHC that keeps the single sample of a keyless KEEP_LAST(1) reader in a slot that
+ * can be read and taken without locking, falling back to a default RHC once the full instance
+ * state machine is needed.
+ */
+struct dds_rhc *dds_rhc_latest_new (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* DDS__RHC_LATEST_H */
@@ -0,0 +1,42 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDS__RHC_SHARDED_H
+#define DDS__RHC_SHARDED_H
+
+#include "dds/features.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct dds_rhc;
+struct ddsi_sertype;
+struct ddsi_domaingv;
+
+/** @component rhc
+ *
+ * Whether a reader of the given type and with the given QoS should use a sharded RHC: this
+ * requires the type to have a key, more than one shard to be configured and no limits on the
+ * number of instances or samples in the reader as a whole.
+ */
+bool dds_rhc_sharded_applicable (const struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos);
+
+/** @component rhc
+ *
+ * Creates an RHC that partitions the instances over a number of default RHCs, each with its own
+ * lock, so that updates to instances in different shards can proceed in parallel.
+ */
+struct dds_rhc *dds_rhc_sharded_new (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* DDS__RHC_SHARDED_H */
@@ -146,6 +146,31 @@ struct dds_serdatapool * dds_serdatapool_new (void);
 /** @component typesupport_c */
 void dds_serdatapool_free (struct dds_serdatapool * pool);
 
+/** @component typesupport_c
+ *
+ * Serializes a sample of a type using the default sample representation into a buffer
+ * local to the calling thread, which remains valid until the next call on that thread.
+ * The buffer is retained for subsequent calls, so that in steady state this serializes
+ * the sample in a single pass, without allocating memory or computing the size first.
+ *
+ * @returns false if the sample is invalid
+ */
+bool dds_sertype_default_serialize_scratch (const struct ddsi_sertype *tpcmn, enum ddsi_serdata_kind sdkind, const void *sample, const void **buf, size_t *size, uint16_t *enc_identifier);
+
+/** @component typesupport_c
+ *
+ * Signals that the caller is done with the result of `dds_sertype_default_serialize_scratch`,
+ * so that an exceptionally large buffer can be freed instead of retained by the thread.
+ */
+void dds_sertype_default_serialize_scratch_done (void);
+
+/** @component typesupport_c
+ *
+ * Whether the serialized size of samples of this kind is the same for all samples and
+ * therefore known without looking at the sample.
+ */
+bool dds_sertype_default_has_fixed_serialized_size (const struct ddsi_sertype *tpcmn, enum ddsi_serdata_kind sdkind);
+
 /** @component typesupport_c */
 dds_return_t dds_sertype_default_init (const struct dds_domain *domain, struct dds_sertype_default *st, const dds_topic_descriptor_t *desc, uint16_t min_xcdrv, dds_data_representation_id_t data_representation);
 
@@ -44,6 +44,8 @@ struct dds_readcond;
 struct dds_guardcond;
 struct dds_statuscond;
 struct dds_loan_pool;
+struct dds_write_pipeline;
+struct dds_write_async;
 
 struct ddsi_sertype;
 struct ddsi_rhc;
@@ -315,6 +317,9 @@ typedef struct dds_domain {
   /* Transmit side: pool for the serializer & transmit messages */
   struct dds_serdatapool *serpool;
 
+  /* Transmit workers for writers in asynchronous mode, NULL if not enabled */
+  struct dds_write_pipeline *write_pipeline;
+
   struct dds_psmx_set psmx_instances;
 } dds_domain;
 
@@ -423,6 +428,7 @@ typedef struct dds_writer {
   struct ddsi_whc *m_whc; /* FIXME: ownership still with underlying DDSI writer (cos of DDSI built-in writers )*/
   bool whc_batch; /* FIXME: channels + latency budget */
   struct dds_loan_pool *m_loans; /* administration of associated loans */
+  struct dds_write_async *m_async; /* queue for asynchronous writing, NULL if synchronous */
   ddsi_protocol_version_t protocol_version; /* copy of configured protocol version */
 
   /* Status metrics */
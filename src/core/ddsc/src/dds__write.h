@@ -48,6 +48,26 @@ dds_return_t dds_writecdr_local_orphan_impl (struct ddsi_local_orphan_writer *lo
 /** @component write_data */
 void dds_write_flush_impl (dds_writer *wr);
 
+/** @brief Writes a sequence of samples via DDSI and delivers them to local readers
+ * @component write_data
+ *
+ * The caller must be awake and retains its references to the samples; `tk` is scratch
+ * space for `n` instance pointers.  If writing fails, the samples preceding the failing
+ * one have been written and delivered and the remaining ones are dropped.
+ *
+ * @param[in] thrst     thread state
+ * @param[in] wr        writer
+ * @param[in] xp        xpack to use for packing the messages
+ * @param[in] flush     whether to send the contents of `xp` once written
+ * @param[in] max_blocking_time  maximum time to wait for space in the writer history cache
+ * @param[in] n         number of samples
+ * @param[in] serdata   samples
+ * @param[out] tk       scratch array
+ * @param[out] nwritten number of samples written
+ */
+dds_return_t dds_write_serdata_batch (struct ddsi_thread_state * const thrst, dds_writer *wr, struct ddsi_xpack *xp, bool flush, dds_duration_t max_blocking_time, uint32_t n, struct ddsi_serdata **serdata, struct ddsi_tkmap_instance **tk, uint32_t *nwritten)
+  ddsrt_nonnull_all;
+
 inline bool dds_source_timestamp_is_valid_ddsi_time (dds_time_t timestamp, ddsi_protocol_version_t protover) {
   // infinity as a source timestamp makes no sense so we disallow it
   // invalid is useful because of dds_forwardcdr i.c.w. inputs with invalid/missing source timestamps
@@ -0,0 +1,121 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDS__WRITE_ASYNC_H
+#define DDS__WRITE_ASYNC_H
+
+#include "dds__types.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct ddsi_thread_state;
+struct ddsi_serdata;
+struct dds_write_pipeline;
+struct dds_write_async;
+
+/** @brief Per-writer statistics of asynchronous writing
+ * @component write_data */
+struct dds_write_async_stats {
+  uint32_t queued;      /**< number of samples currently queued */
+  uint32_t max_queued;  /**< largest number of samples queued at any one time */
+  uint32_t blocked;     /**< number of writes that had to wait for space in the queue */
+  uint64_t samples;     /**< number of samples handled by the transmit workers */
+  uint64_t latency;     /**< total time from enqueueing to handing to DDSI (ns) */
+  uint64_t dropped;     /**< number of samples dropped because writing them failed */
+};
+
+/** @brief Creates the transmit workers of a domain
+ * @component write_data
+ *
+ * @param[in] gv         domain
+ * @param[in] nworkers   number of transmit worker threads
+ * @return pipeline, or NULL if the threads could not be started
+ */
+struct dds_write_pipeline *dds_write_pipeline_new (struct ddsi_domaingv *gv, uint32_t nworkers)
+  ddsrt_nonnull_all;
+
+/** @brief Stops the transmit workers and frees the pipeline
+ * @component write_data
+ *
+ * All asynchronous writers must have been deleted already.
+ */
+void dds_write_pipeline_free (struct dds_write_pipeline *pl)
+  ddsrt_nonnull_all;
+
+/** @brief Number of samples handled and number of batches written by transmit worker `i`
+ * @component write_data */
+void dds_write_pipeline_worker_stats (const struct dds_write_pipeline *pl, uint32_t i, uint64_t *samples, uint64_t *batches)
+  ddsrt_nonnull_all;
+
+/** @brief Number of transmit workers in the pipeline
+ * @component write_data */
+uint32_t dds_write_pipeline_nworkers (const struct dds_write_pipeline *pl)
+  ddsrt_nonnull_all;
+
+/** @brief Creates the queue of a writer in asynchronous mode
+ * @component write_data
+ *
+ * @param[in] pl     pipeline to which the writer's queue is handed when it has data
+ * @param[in] wr     writer
+ * @param[in] depth  queue depth, rounded up to a power of 2
+ * @return queue
+ */
+struct dds_write_async *dds_write_async_new (struct dds_write_pipeline *pl, struct dds_writer *wr, uint32_t depth)
+  ddsrt_nonnull_all;
+
+/** @brief Frees the queue of a writer, it must be empty
+ * @component write_data */
+void dds_write_async_free (struct dds_write_async *q)
+  ddsrt_nonnull_all;
+
+/** @brief Queues a sample for writing by a transmit worker
+ * @component write_data
+ *
+ * Consumes the reference to `sd`.  If the queue is full, it waits for space for at most the
+ * max_blocking_time of the writer's reliability QoS.
+ *
+ * @param[in] thrst  thread state if the calling thread is awake (so that it can go to
+ *                   sleep while waiting), else NULL
+ * @param[in] q      writer's queue
+ * @param[in] sd     sample to be written
+ *
+ * @retval DDS_RETCODE_OK       queued
+ * @retval DDS_RETCODE_TIMEOUT  queue remained full, sample dropped
+ */
+dds_return_t dds_write_async_enqueue (struct ddsi_thread_state *thrst, struct dds_write_async *q, struct ddsi_serdata *sd)
+  ddsrt_nonnull ((2, 3));
+
+/** @brief Waits until all samples queued so far have been handed to DDSI
+ * @component write_data */
+void dds_write_async_drain (struct dds_write_async *q)
+  ddsrt_nonnull_all;
+
+/** @brief Drains the queue of a writer that is being deleted
+ * @component write_data
+ *
+ * From then on, the transmit workers no longer wait for space in the writer history cache:
+ * whatever doesn't fit is dropped (and counted as such).  Waits until all samples queued so
+ * far have been handed to DDSI or dropped, which takes at most one turn of a worker.
+ */
+void dds_write_async_close (struct dds_write_async *q)
+  ddsrt_nonnull_all;
+
+/** @brief Statistics of a writer's queue
+ * @component write_data */
+void dds_write_async_get_stats (const struct dds_write_async *q, struct dds_write_async_stats *stats)
+  ddsrt_nonnull_all;
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDS__WRITE_ASYNC_H */
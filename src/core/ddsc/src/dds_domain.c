@@ -8,12 +8,14 @@
 //
 // SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
 
+#include <assert.h>
 #include <string.h>
 
 #include "dds/features.h"
 #include "dds/ddsrt/process.h"
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/hopscotch.h"
+#include "dds/ddsrt/static_assert.h"
 #include "dds/ddsi/ddsi_iid.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsi/ddsi_serdata.h"
@@ -23,6 +25,7 @@
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_typelib.h"
 #include "dds/ddsi/ddsi_init.h"
+#include "dds/ddsi/ddsi_statistics.h"
 #include "dds/ddsc/dds_rhc.h"
 #include "dds__init.h"
 #include "dds__domain.h"
@@ -31,17 +34,78 @@
 #include "dds__entity.h"
 #include "dds__serdata_default.h"
 #include "dds__psmx.h"
+#include "dds__statistics.h"
+#include "dds__write_async.h"
 
 static dds_return_t dds_domain_free (dds_entity *vdomain);
 
+static const struct dds_stat_keyvalue_descriptor dds_domain_statistics_kv[] = {
+  { "recv_reads", DDS_STAT_KIND_UINT64 },
+  { "recv_packets", DDS_STAT_KIND_UINT64 },
+  { "xmit_flushes", DDS_STAT_KIND_UINT64 },
+  { "xmit_packets", DDS_STAT_KIND_UINT64 },
+  { "xmit_syscalls", DDS_STAT_KIND_UINT64 },
+  { "dqueue_samples", DDS_STAT_KIND_UINT64 },
+  { "dqueue_max_samples", DDS_STAT_KIND_UINT64 },
+  { "dqueue_wakeups", DDS_STAT_KIND_UINT64 },
+  { "rbuf_bytes", DDS_STAT_KIND_UINT64 },
+  { "rbuf_pinned_bytes", DDS_STAT_KIND_UINT64 },
+  { "rbuf_allocs", DDS_STAT_KIND_UINT64 },
+  { "rbuf_reuses", DDS_STAT_KIND_UINT64 },
+  /* only present for the transmit workers that exist */
+  { "wrasync0_samples", DDS_STAT_KIND_UINT64 },
+  { "wrasync0_batches", DDS_STAT_KIND_UINT64 },
+  { "wrasync1_samples", DDS_STAT_KIND_UINT64 },
+  { "wrasync1_batches", DDS_STAT_KIND_UINT64 },
+  { "wrasync2_samples", DDS_STAT_KIND_UINT64 },
+  { "wrasync2_batches", DDS_STAT_KIND_UINT64 },
+  { "wrasync3_samples", DDS_STAT_KIND_UINT64 },
+  { "wrasync3_batches", DDS_STAT_KIND_UINT64 },
+  { "wrasync4_samples", DDS_STAT_KIND_UINT64 },
+  { "wrasync4_batches", DDS_STAT_KIND_UINT64 },
+  { "wrasync5_samples", DDS_STAT_KIND_UINT64 },
+  { "wrasync5_batches", DDS_STAT_KIND_UINT64 },
+  { "wrasync6_samples", DDS_STAT_KIND_UINT64 },
+  { "wrasync6_batches", DDS_STAT_KIND_UINT64 },
+  { "wrasync7_samples", DDS_STAT_KIND_UINT64 },
+  { "wrasync7_batches", DDS_STAT_KIND_UINT64 }
+};
+
+#define DDS_DOMAIN_STATISTICS_BASE_COUNT 12u
+#define DDS_DOMAIN_STATISTICS_MAX_WRASYNC 8u
+DDSRT_STATIC_ASSERT (sizeof (dds_domain_statistics_kv) / sizeof (dds_domain_statistics_kv[0]) == DDS_DOMAIN_STATISTICS_BASE_COUNT + 2 * DDS_DOMAIN_STATISTICS_MAX_WRASYNC);
+
+static struct dds_statistics *dds_domain_create_statistics (const struct dds_entity *entity)
+{
+  const struct dds_domain *dom = (const struct dds_domain *) entity;
+  const uint32_t nworkers = dom->write_pipeline ? dds_write_pipeline_nworkers (dom->write_pipeline) : 0;
+  assert (nworkers <= DDS_DOMAIN_STATISTICS_MAX_WRASYNC);
+  const struct dds_stat_descriptor desc = {
+    .count = DDS_DOMAIN_STATISTICS_BASE_COUNT + 2 * nworkers,
+    .kv = dds_domain_statistics_kv
+  };
+  return dds_alloc_statistics (entity, &desc);
+}
+
+static void dds_domain_refresh_statistics (const struct dds_entity *entity, struct dds_statistics *stat)
+{
+  const struct dds_domain *dom = (const struct dds_domain *) entity;
+  ddsi_get_recv_stats (&dom->gv, &stat->kv[0].u.u64, &stat->kv[1].u.u64);
+  ddsi_get_xmit_stats (&dom->gv, &stat->kv[2].u.u64, &stat->kv[3].u.u64, &stat->kv[4].u.u64);
+  ddsi_get_dqueue_stats (&dom->gv, &stat->kv[5].u.u64, &stat->kv[6].u.u64, &stat->kv[7].u.u64);
+  ddsi_get_rbuf_stats (&dom->gv, &stat->kv[8].u.u64, &stat->kv[9].u.u64, &stat->kv[10].u.u64, &stat->kv[11].u.u64);
+  for (uint32_t i = 0, k = DDS_DOMAIN_STATISTICS_BASE_COUNT; k < stat->count; i++, k += 2)
+    dds_write_pipeline_worker_stats (dom->write_pipeline, i, &stat->kv[k].u.u64, &stat->kv[k + 1].u.u64);
+}
+
 const struct dds_entity_deriver dds_entity_deriver_domain = {
   .interrupt = dds_entity_deriver_dummy_interrupt,
   .close = dds_entity_deriver_dummy_close,
   .delete = dds_domain_free,
   .set_qos = dds_entity_deriver_dummy_set_qos,
   .validate_status = dds_entity_deriver_dummy_validate_status,
-  .create_statistics = dds_entity_deriver_dummy_create_statistics,
-  .refresh_statistics = dds_entity_deriver_dummy_refresh_statistics,
+  .create_statistics = dds_domain_create_statistics,
+  .refresh_statistics = dds_domain_refresh_statistics,
   .invoke_cbs_for_pending_events = dds_entity_deriver_dummy_invoke_cbs_for_pending_events
 };
 
@@ -176,6 +240,17 @@ static dds_entity_t dds_domain_init (dds_domain *domain, dds_domainid_t domain_i
     }
   }
 
+  domain->write_pipeline = NULL;
+  if (domain->gv.config.async_write)
+  {
+    if ((domain->write_pipeline = dds_write_pipeline_new (&domain->gv, (uint32_t) domain->gv.config.async_write_threads)) == NULL)
+    {
+      DDS_ILOG (DDS_LC_ERROR, domain->m_id, "Failed to start the transmit workers for asynchronous writing\n");
+      ret = DDS_RETCODE_ERROR;
+      goto fail_write_pipeline;
+    }
+  }
+
   dds__builtin_init (domain);
 
   if (ddsi_start (&domain->gv) < 0)
@@ -192,6 +267,9 @@ static dds_entity_t dds_domain_init (dds_domain *domain, dds_domainid_t domain_i
 
 fail_ddsi_start:
   dds__builtin_fini (domain);
+  if (domain->write_pipeline)
+    dds_write_pipeline_free (domain->write_pipeline);
+fail_write_pipeline:
   if (domain->gv.config.liveliness_monitoring && dds_global.threadmon_count == 1)
     ddsi_threadmon_stop (dds_global.threadmon);
 fail_threadmon_start:
@@ -326,6 +404,8 @@ dds_entity_t dds_create_domain_with_rawconfig (const dds_domainid_t domain, cons
 static dds_return_t dds_domain_free (dds_entity *vdomain)
 {
   struct dds_domain *domain = (struct dds_domain *) vdomain;
+  if (domain->write_pipeline)
+    dds_write_pipeline_free (domain->write_pipeline);
   ddsi_stop (&domain->gv);
   dds__builtin_fini (domain);
 
@@ -102,6 +102,24 @@ dds_builtintopic_endpoint_t *dds_get_matched_subscription_data (dds_entity_t wri
   return ret;
 }
 
+dds_return_t dds_get_matched_subscription_rtt (dds_entity_t writer, dds_instance_handle_t ih, dds_duration_t *srtt, dds_duration_t *rttvar)
+{
+  dds_writer *wr;
+  dds_return_t rc;
+  if (srtt == NULL || rttvar == NULL)
+    return DDS_RETCODE_BAD_PARAMETER;
+  if ((rc = dds_writer_lock (writer, &wr)) != DDS_RETCODE_OK)
+    return rc;
+
+  struct ddsi_domaingv * const gv = &wr->m_entity.m_domain->gv;
+  ddsi_thread_state_awake (ddsi_lookup_thread_state (), gv);
+  rc = ddsi_writer_get_matched_reader_rtt (wr->m_wr, ih, srtt, rttvar);
+  ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+
+  dds_writer_unlock (wr);
+  return rc;
+}
+
 dds_builtintopic_endpoint_t *dds_get_matched_publication_data (dds_entity_t reader, dds_instance_handle_t ih)
 {
   dds_reader *rd;
@@ -10,6 +10,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include "dds/ddsrt/heap.h"
 #include "dds__entity.h"
 #include "dds__reader.h"
 #include "dds__read.h"
@@ -24,6 +25,7 @@
 #include "dds/ddsc/dds_psmx.h"
 #include "dds__loaned_sample.h"
 #include "dds__heap_loan.h"
+#include "dds__serdata_default.h"
 
 void dds_read_collect_sample_arg_init (struct dds_read_collect_sample_arg *arg, void **ptrs, dds_sample_info_t *infos, struct dds_loan_pool *loan_pool, struct dds_loan_pool *heap_loan_cache)
 {
@@ -408,6 +410,111 @@ dds_return_t dds_take_next_wl (dds_entity_t reader, void **buf, dds_sample_info_
   return dds_take_next (reader, buf, si);
 }
 
+/* A sample arena is a single block of memory from which dds_take_arena bump-allocates the
+   samples and everything they reference (strings, sequences, external members), leaving
+   the heap alone.  Nothing in it is ever freed individually: resetting the arena releases
+   all samples taken into it at once. */
+#define SAMPLE_ARENA_ALIGN 8u
+
+struct dds_sample_arena {
+  char *base;
+  char *pos;
+  char *lim;
+};
+
+struct dds_read_collect_sample_arena_arg {
+  struct dds_read_collect_sample_arg c;
+  struct dds_sample_arena *arena;
+};
+
+dds_sample_arena_t *dds_sample_arena_create (size_t size)
+{
+  if (size == 0)
+    return NULL;
+  struct dds_sample_arena *arena = ddsrt_malloc_s (sizeof (*arena));
+  if (arena == NULL)
+    return NULL;
+  if ((arena->base = ddsrt_malloc_s (size)) == NULL)
+  {
+    ddsrt_free (arena);
+    return NULL;
+  }
+  arena->pos = arena->base;
+  arena->lim = arena->base + size;
+  return arena;
+}
+
+void dds_sample_arena_reset (dds_sample_arena_t *arena)
+{
+  arena->pos = arena->base;
+}
+
+void dds_sample_arena_delete (dds_sample_arena_t *arena)
+{
+  ddsrt_free (arena->base);
+  ddsrt_free (arena);
+}
+
+static dds_return_t dds_read_collect_sample_arena (void *varg, const dds_sample_info_t *si, const struct ddsi_sertype *st, struct ddsi_serdata *sd)
+{
+  struct dds_read_collect_sample_arena_arg * const arg = varg;
+  struct dds_sample_arena * const arena = arg->arena;
+  const uintptr_t a = ((uintptr_t) arena->pos + SAMPLE_ARENA_ALIGN - 1) & ~(uintptr_t) (SAMPLE_ARENA_ALIGN - 1);
+  if (a > (uintptr_t) arena->lim || st->sizeof_type > (size_t) ((uintptr_t) arena->lim - a))
+    return DDS_RETCODE_OUT_OF_RESOURCES;
+
+  void * const sample = (void *) a;
+  void *bufptr = (char *) sample + st->sizeof_type;
+  bool ok;
+  memset (sample, 0, st->sizeof_type);
+  if (si->valid_data)
+    ok = ddsi_serdata_to_sample (sd, sample, &bufptr, arena->lim);
+  else
+    ok = ddsi_serdata_untyped_to_sample (st, sd, sample, &bufptr, arena->lim);
+  // the only way deserializing into the arena fails is running out of space, in which case
+  // the sample stays in the reader
+  if (!ok)
+    return DDS_RETCODE_OUT_OF_RESOURCES;
+  arena->pos = bufptr;
+  arg->c.ptrs[arg->c.next_idx] = sample;
+  arg->c.infos[arg->c.next_idx] = *si;
+  arg->c.next_idx++;
+  return DDS_RETCODE_OK;
+}
+
+dds_return_t dds_take_arena (dds_entity_t reader_or_condition, void **buf, dds_sample_info_t *si, size_t bufsz, uint32_t maxs, dds_sample_arena_t *arena)
+{
+  if (buf == NULL || si == NULL || arena == NULL || maxs == 0 || bufsz == 0 || bufsz < maxs || maxs > INT32_MAX)
+    return DDS_RETCODE_BAD_PARAMETER;
+
+  dds_return_t ret;
+  struct dds_entity *entity;
+  struct dds_reader *rd;
+  struct dds_readcond *cond;
+  uint32_t mask = 0;
+  if ((ret = dds_read_impl_setup (reader_or_condition, false, &entity, &rd, &cond, &mask)) < 0)
+    return ret;
+
+  // Deserializing into caller-provided memory is only implemented by the default sample
+  // representation
+  if (rd->m_topic->m_stype->ops != &dds_sertype_ops_default)
+  {
+    dds_entity_unpin (entity);
+    return DDS_RETCODE_UNSUPPORTED;
+  }
+
+  struct dds_read_collect_sample_arena_arg collect_arg;
+  dds_read_collect_sample_arg_init (&collect_arg.c, buf, si, NULL, NULL);
+  collect_arg.arena = arena;
+
+  struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  ddsi_thread_state_awake (thrst, &entity->m_domain->gv);
+  ret = dds_read_impl_common (READ_OPER_TAKE, rd, cond, maxs, mask, DDS_HANDLE_NIL, dds_read_collect_sample_arena, &collect_arg);
+  ddsi_thread_state_asleep (thrst);
+  dds_entity_unpin (entity);
+  return ret;
+}
+
 dds_return_t dds_peekcdr (dds_entity_t reader_or_condition, struct ddsi_serdata **buf, uint32_t maxs, dds_sample_info_t *si, uint32_t mask)
 {
   return dds_readcdr_impl (READ_OPER_PEEK, reader_or_condition, buf, maxs, si, mask, DDS_HANDLE_NIL);
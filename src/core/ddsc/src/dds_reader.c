@@ -34,6 +34,8 @@
 #include "dds__listener.h"
 #include "dds__init.h"
 #include "dds__rhc_default.h"
+#include "dds__rhc_sharded.h"
+#include "dds__rhc_latest.h"
 #include "dds__topic.h"
 #include "dds__get_status.h"
 #include "dds__qos.h"
@@ -446,7 +448,11 @@ void dds_reader_invoke_cbs_for_pending_events(struct dds_entity *e, uint32_t sta
 }
 
 static const struct dds_stat_keyvalue_descriptor dds_reader_statistics_kv[] = {
-  { "discarded_bytes", DDS_STAT_KIND_UINT64 }
+  { "discarded_bytes", DDS_STAT_KIND_UINT64 },
+  { "rhc_samples_used", DDS_STAT_KIND_UINT32 },
+  { "rhc_samples_reserved", DDS_STAT_KIND_UINT32 },
+  { "rhc_instances_used", DDS_STAT_KIND_UINT32 },
+  { "rhc_instances_reserved", DDS_STAT_KIND_UINT32 }
 };
 
 static const struct dds_stat_descriptor dds_reader_statistics_desc = {
@@ -464,6 +470,12 @@ static void dds_reader_refresh_statistics (const struct dds_entity *entity, stru
   const struct dds_reader *rd = (const struct dds_reader *) entity;
   if (rd->m_rd)
     ddsi_get_reader_stats (rd->m_rd, &stat->kv[0].u.u64);
+  struct dds_rhc_slab_stats slab;
+  dds_rhc_get_slab_stats (rd->m_rhc, &slab);
+  stat->kv[1].u.u32 = slab.samples_used;
+  stat->kv[2].u.u32 = slab.samples_reserved;
+  stat->kv[3].u.u32 = slab.instances_used;
+  stat->kv[4].u.u32 = slab.instances_reserved;
 }
 
 const struct dds_entity_deriver dds_entity_deriver_reader = {
@@ -618,7 +630,14 @@ static dds_entity_t dds_create_reader_int (dds_entity_t participant_or_subscribe
   ddsrt_atomic_or32 (&rd->m_entity.m_status.m_status_and_mask, DDS_DATA_ON_READERS_STATUS << SAM_ENABLED_SHIFT);
   rd->m_sample_rejected_status.last_reason = DDS_NOT_REJECTED;
   rd->m_topic = tp;
-  rd->m_rhc = rhc ? rhc : dds_rhc_default_new (gv, tp->m_stype, rd->m_entity.m_qos);
+  if (rhc != NULL)
+    rd->m_rhc = rhc;
+  else if (dds_rhc_sharded_applicable (gv, tp->m_stype, rd->m_entity.m_qos))
+    rd->m_rhc = dds_rhc_sharded_new (gv, tp->m_stype, rd->m_entity.m_qos);
+  else if (dds_rhc_latest_applicable (gv, tp->m_stype, rd->m_entity.m_qos))
+    rd->m_rhc = dds_rhc_latest_new (gv, tp->m_stype, rd->m_entity.m_qos);
+  else
+    rd->m_rhc = dds_rhc_default_new (gv, tp->m_stype, rd->m_entity.m_qos);
   rc = dds_loan_pool_create (&rd->m_loans, 0);
   assert (rc == DDS_RETCODE_OK); // FIXME: can be out of resources
   rc = dds_loan_pool_create (&rd->m_heap_loan_cache, 0);
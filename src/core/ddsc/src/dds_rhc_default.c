@@ -31,7 +31,6 @@
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsrt/hopscotch.h"
 #include "dds/ddsrt/avl.h"
-#include "dds/ddsrt/circlist.h"
 #include "dds/ddsi/ddsi_rhc.h"
 #include "dds/ddsi/ddsi_xqos.h"
 #include "dds/ddsi/ddsi_unused.h"
@@ -233,6 +232,195 @@ void lwregs_dump (struct lwregs *rt)
 }
 #endif
 
+/*************************
+ ******    SLABS    ******
+ *************************/
+
+/* Samples and instances are fixed-size objects that are allocated and freed at a high
+   rate, always while holding the RHC lock.  Each RHC therefore allocates them from its
+   own slabs: memory is obtained in chunks of increasing size, each with its own free
+   list, and every object is preceded by a pointer to its chunk.  Chunks that were
+   reserved up front based on the resource limits are kept until the RHC is freed; of the
+   others, one completely free chunk is kept to avoid allocating and freeing a chunk
+   repeatedly when the number of objects in use oscillates, and any other chunk is
+   returned to the heap as soon as it is completely free. */
+
+#define RHC_SLAB_MIN_CHUNK 16
+#define RHC_SLAB_MAX_CHUNK 4096
+
+struct rhc_slab_free {
+  struct rhc_slab_free *next;
+};
+
+struct rhc_slab_chunk {
+  struct rhc_slab_chunk *next, *prev; /* in slab's list of chunks with or without free objects */
+  struct rhc_slab_free *freelist;
+  uint32_t nobjs;
+  uint32_t nfree;
+  bool pinned;                /* reserved up front, never released */
+  uint64_t align;             /* objects follow, aligned to 8 bytes */
+};
+
+struct rhc_slab_chunklist {
+  struct rhc_slab_chunk *first, *last;
+};
+
+struct rhc_slab {
+  size_t objsize;             /* including the pointer to the chunk */
+  uint32_t nreserved;         /* # objects in all chunks */
+  uint32_t nused;             /* # objects handed out */
+  struct rhc_slab_chunklist avail; /* chunks with free objects, spare chunk (if any) last */
+  struct rhc_slab_chunklist full;  /* chunks without free objects */
+  struct rhc_slab_chunk *spare;    /* completely free chunk that is not pinned */
+};
+
+static void rhc_slab_chunklist_remove (struct rhc_slab_chunklist *l, struct rhc_slab_chunk *c)
+{
+  if (c->prev)
+    c->prev->next = c->next;
+  else
+    l->first = c->next;
+  if (c->next)
+    c->next->prev = c->prev;
+  else
+    l->last = c->prev;
+}
+
+static void rhc_slab_chunklist_push_front (struct rhc_slab_chunklist *l, struct rhc_slab_chunk *c)
+{
+  c->prev = NULL;
+  c->next = l->first;
+  if (l->first)
+    l->first->prev = c;
+  else
+    l->last = c;
+  l->first = c;
+}
+
+static void rhc_slab_chunklist_push_back (struct rhc_slab_chunklist *l, struct rhc_slab_chunk *c)
+{
+  c->next = NULL;
+  c->prev = l->last;
+  if (l->last)
+    l->last->next = c;
+  else
+    l->first = c;
+  l->last = c;
+}
+
+static void rhc_slab_chunklist_free (struct rhc_slab_chunklist *l)
+{
+  while (l->first)
+  {
+    struct rhc_slab_chunk *c = l->first;
+    l->first = c->next;
+    ddsrt_free (c);
+  }
+  l->last = NULL;
+}
+
+static void rhc_slab_init (struct rhc_slab *slab, size_t objsize)
+{
+  assert (objsize >= sizeof (struct rhc_slab_free));
+  slab->objsize = sizeof (uint64_t) + ((objsize + 7) & ~(size_t) 7);
+  slab->nreserved = 0;
+  slab->nused = 0;
+  slab->avail.first = slab->avail.last = NULL;
+  slab->full.first = slab->full.last = NULL;
+  slab->spare = NULL;
+}
+
+static void rhc_slab_fini (struct rhc_slab *slab)
+{
+  rhc_slab_chunklist_free (&slab->avail);
+  rhc_slab_chunklist_free (&slab->full);
+}
+
+static void rhc_slab_reserve (struct rhc_slab *slab, uint32_t n, bool pinned)
+{
+  if (n == 0)
+    return;
+  struct rhc_slab_chunk *c = ddsrt_malloc (offsetof (struct rhc_slab_chunk, align) + n * slab->objsize);
+  c->freelist = NULL;
+  c->nobjs = c->nfree = n;
+  c->pinned = pinned;
+  char *objs = (char *) &c->align;
+  for (uint32_t i = n; i > 0; i--)
+  {
+    char *p = objs + (i - 1) * slab->objsize;
+    *((struct rhc_slab_chunk **) p) = c;
+    struct rhc_slab_free *f = (struct rhc_slab_free *) (p + sizeof (uint64_t));
+    f->next = c->freelist;
+    c->freelist = f;
+  }
+  rhc_slab_chunklist_push_front (&slab->avail, c);
+  slab->nreserved += n;
+}
+
+static void *rhc_slab_alloc (struct rhc_slab *slab)
+{
+  if (slab->avail.first == NULL)
+  {
+    /* double the reserved number of objects, within limits */
+    uint32_t n = slab->nreserved;
+    if (n < RHC_SLAB_MIN_CHUNK)
+      n = RHC_SLAB_MIN_CHUNK;
+    else if (n > RHC_SLAB_MAX_CHUNK)
+      n = RHC_SLAB_MAX_CHUNK;
+    rhc_slab_reserve (slab, n, false);
+  }
+  struct rhc_slab_chunk *c = slab->avail.first;
+  if (c == slab->spare)
+    slab->spare = NULL;
+  struct rhc_slab_free *f = c->freelist;
+  c->freelist = f->next;
+  if (--c->nfree == 0)
+  {
+    rhc_slab_chunklist_remove (&slab->avail, c);
+    rhc_slab_chunklist_push_front (&slab->full, c);
+  }
+  slab->nused++;
+  return f;
+}
+
+static void rhc_slab_release (struct rhc_slab *slab, struct rhc_slab_chunk *c)
+{
+  rhc_slab_chunklist_remove (&slab->avail, c);
+  slab->nreserved -= c->nobjs;
+  ddsrt_free (c);
+}
+
+static void rhc_slab_free (struct rhc_slab *slab, void *obj)
+{
+  struct rhc_slab_free *f = obj;
+  struct rhc_slab_chunk *c = *((struct rhc_slab_chunk **) ((char *) obj - sizeof (uint64_t)));
+  assert (slab->nused > 0);
+  assert (c->nfree < c->nobjs);
+  f->next = c->freelist;
+  c->freelist = f;
+  slab->nused--;
+  if (c->nfree++ == 0)
+  {
+    rhc_slab_chunklist_remove (&slab->full, c);
+    rhc_slab_chunklist_push_front (&slab->avail, c);
+  }
+  if (c->nfree == c->nobjs && !c->pinned)
+  {
+    /* keep the largest completely free chunk, moving it to the end so that the
+       partially used ones are used first */
+    if (slab->spare != NULL && slab->spare->nobjs > c->nobjs)
+      rhc_slab_release (slab, c);
+    else
+    {
+      if (slab->spare != NULL)
+        rhc_slab_release (slab, slab->spare);
+      slab->spare = c;
+      rhc_slab_chunklist_remove (&slab->avail, c);
+      rhc_slab_chunklist_push_back (&slab->avail, c);
+    }
+  }
+}
+
 /*************************
  ******     RHC     ******
  *************************/
@@ -272,7 +460,7 @@ struct rhc_instance {
   int32_t strength;            /* "current" ownership strength */
   ddsi_guid_t wr_guid;         /* guid of last writer (if wr_iid != 0 then wr_guid is the corresponding guid, else undef) */
   ddsrt_wctime_t tstamp;          /* source time stamp of last update */
-  struct ddsrt_circlist_elem nonempty_list; /* links non-empty instances in arbitrary ordering */
+  uint32_t nonempty_idx;       /* index in rhc->nonempty if non-empty, else NONEMPTY_NOIDX */
 #ifdef DDS_HAS_DEADLINE_MISSED
   struct deadline_elem deadline; /* element in deadline missed administration */
 #endif
@@ -286,10 +474,26 @@ typedef enum rhc_store_result {
   RHC_REJECTED
 } rhc_store_result_t;
 
+/* Non-empty instances are kept in the order in which they became non-empty in a pair of
+   parallel arrays: one with pointers to the instances and one with a summary of their
+   instance, view and sample states.  Operations on all instances scan the summaries to
+   find the instances that may match without touching the (large) instances themselves.
+   Removing an instance leaves a hole with a summary that never matches, holes are
+   squeezed out when the arrays would otherwise have to grow. */
+#define NONEMPTY_NOIDX UINT32_MAX
+#define NONEMPTY_HOLE 0u
+
+struct rhc_nonempty {
+  uint32_t n;                        /* number of entries in use, including holes */
+  uint32_t size;                     /* allocated length of the arrays */
+  uint32_t *summary;                 /* instance & view state | sample states present */
+  struct rhc_instance **inst;        /* instance or NULL if a hole */
+};
+
 struct dds_rhc_default {
   struct dds_rhc common;
   struct ddsrt_hh *instances;
-  struct ddsrt_circlist nonempty_instances; /* circular, points to most recently added one, NULL if none */
+  struct rhc_nonempty nonempty;      /* non-empty instances, oldest first */
   struct lwregs registrations;       /* should be a global one (with lock-free lookups) */
 
   /* Instance/Sample maximums from resource limits QoS */
@@ -313,6 +517,7 @@ struct dds_rhc_default {
   bool exclusive_ownership;          /* true if EXCLUSIVE, false if SHARED */
   bool reliable;                     /* true if reliability RELIABLE */
   bool xchecks;                      /* whether to do expensive checking if checking at all */
+  bool shard;                        /* shard of a sharded RHC: conditions are shared, triggers summed over shards */
 
   dds_reader *reader;                /* reader -- may be NULL (used by rhc_torture) */
   struct ddsi_tkmap *tkmap;          /* back pointer to tkmap */
@@ -321,6 +526,8 @@ struct dds_rhc_default {
   uint32_t history_depth;            /* depth, 1 for KEEP_LAST_1, 2**32-1 for KEEP_ALL */
 
   ddsrt_mutex_t lock;
+  struct rhc_slab sample_slab;       /* Storage for samples other than the one embedded in an instance */
+  struct rhc_slab instance_slab;     /* Storage for instances */
   dds_readcond * conds;              /* List of associated read conditions */
   uint32_t nconds;                   /* Number of associated read conditions */
   uint32_t nqconds;                  /* Number of associated query conditions */
@@ -433,33 +640,108 @@ static bool instance_iid_eq (const void *va, const void *vb)
   return (a->iid == b->iid);
 }
 
+static uint32_t inst_summary (const struct rhc_instance *inst)
+{
+  uint32_t s = qmask_of_inst (inst);
+  if (inst_has_read (inst))
+    s |= DDS_READ_SAMPLE_STATE;
+  if (inst_has_unread (inst))
+    s |= DDS_NOT_READ_SAMPLE_STATE;
+  return s;
+}
+
+static bool summary_matches (uint32_t summary, uint32_t qminv)
+{
+  /* the instance and view states must not be excluded, and at least one of the sample
+     states present in the instance must be included; holes have no samples at all */
+  return (summary & qminv & ~(uint32_t) DDS_ANY_SAMPLE_STATE) == 0 && (summary & ~qminv & DDS_ANY_SAMPLE_STATE) != 0;
+}
+
+static void nonempty_compact (struct rhc_nonempty *ne)
+{
+  uint32_t j = 0;
+  for (uint32_t i = 0; i < ne->n; i++)
+  {
+    if (ne->inst[i] == NULL)
+      continue;
+    ne->inst[j] = ne->inst[i];
+    ne->summary[j] = ne->summary[i];
+    ne->inst[j]->nonempty_idx = j;
+    j++;
+  }
+  ne->n = j;
+}
+
 static void add_inst_to_nonempty_list (struct dds_rhc_default *rhc, struct rhc_instance *inst)
 {
-  ddsrt_circlist_append (&rhc->nonempty_instances, &inst->nonempty_list);
+  struct rhc_nonempty * const ne = &rhc->nonempty;
+  assert (inst->nonempty_idx == NONEMPTY_NOIDX);
+  if (ne->n == ne->size)
+  {
+    /* squeeze out the holes if that frees up a reasonable amount of space, else grow */
+    if (ne->n - rhc->n_nonempty_instances >= ne->size / 4 && ne->size > 0)
+      nonempty_compact (ne);
+    else
+    {
+      ne->size = (ne->size == 0) ? 8 : 2 * ne->size;
+      ne->summary = ddsrt_realloc (ne->summary, ne->size * sizeof (*ne->summary));
+      ne->inst = ddsrt_realloc (ne->inst, ne->size * sizeof (*ne->inst));
+    }
+  }
+  inst->nonempty_idx = ne->n++;
+  ne->inst[inst->nonempty_idx] = inst;
+  ne->summary[inst->nonempty_idx] = inst_summary (inst);
   rhc->n_nonempty_instances++;
 }
 
 static void remove_inst_from_nonempty_list (struct dds_rhc_default *rhc, struct rhc_instance *inst)
 {
+  struct rhc_nonempty * const ne = &rhc->nonempty;
   assert (inst_is_empty (inst));
-  ddsrt_circlist_remove (&rhc->nonempty_instances, &inst->nonempty_list);
+  assert (inst->nonempty_idx < ne->n && ne->inst[inst->nonempty_idx] == inst);
+  ne->inst[inst->nonempty_idx] = NULL;
+  ne->summary[inst->nonempty_idx] = NONEMPTY_HOLE;
+  inst->nonempty_idx = NONEMPTY_NOIDX;
+  /* trailing holes can simply be dropped, this also resets it when it becomes empty */
+  while (ne->n > 0 && ne->inst[ne->n - 1] == NULL)
+    ne->n--;
   assert (rhc->n_nonempty_instances > 0);
   rhc->n_nonempty_instances--;
 }
 
-static struct rhc_instance *oldest_nonempty_instance (const struct dds_rhc_default *rhc)
+static void update_nonempty_summary (struct dds_rhc_default *rhc, const struct rhc_instance *inst)
 {
-  return DDSRT_FROM_CIRCLIST (struct rhc_instance, nonempty_list, ddsrt_circlist_oldest (&rhc->nonempty_instances));
+  if (inst->nonempty_idx != NONEMPTY_NOIDX)
+    rhc->nonempty.summary[inst->nonempty_idx] = inst_summary (inst);
 }
 
-static struct rhc_instance *latest_nonempty_instance (const struct dds_rhc_default *rhc)
+static uint32_t next_matching_nonempty (const struct dds_rhc_default *rhc, uint32_t idx, uint32_t qminv)
 {
-  return DDSRT_FROM_CIRCLIST (struct rhc_instance, nonempty_list, ddsrt_circlist_latest (&rhc->nonempty_instances));
+  /* Checking blocks of summaries without an early exit allows the compiler to vectorize
+     it, which pays off when few instances match */
+  const uint32_t * const summary = rhc->nonempty.summary;
+  const uint32_t n = rhc->nonempty.n;
+  while (n - idx >= 8)
+  {
+    uint32_t m = 0;
+    for (uint32_t k = 0; k < 8; k++)
+      m |= (uint32_t) summary_matches (summary[idx + k], qminv);
+    if (m)
+      break;
+    idx += 8;
+  }
+  while (idx < n && !summary_matches (summary[idx], qminv))
+    idx++;
+  return idx;
 }
 
-static struct rhc_instance *next_nonempty_instance (const struct rhc_instance *inst)
+static uint32_t count_matching_nonempty (const struct dds_rhc_default *rhc, uint32_t qminv)
 {
-  return DDSRT_FROM_CIRCLIST (struct rhc_instance, nonempty_list, inst->nonempty_list.next);
+  const uint32_t * const summary = rhc->nonempty.summary;
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < rhc->nonempty.n; i++)
+    count += (uint32_t) summary_matches (summary[i], qminv);
+  return count;
 }
 
 #ifdef DDS_HAS_LIFESPAN
@@ -507,6 +789,7 @@ static void drop_expired_samples (struct dds_rhc_default *rhc, struct rhc_sample
   }
   trig_qc.dec_conds_sample = sample->conds;
   free_sample (rhc, inst, sample);
+  update_nonempty_summary (rhc, inst);
   get_trigger_info_cmn (&post.c, inst);
   update_conditions_locked (rhc, false, &pre, &post, &trig_qc, inst);
   if (inst_is_empty (inst))
@@ -579,7 +862,7 @@ static void dds_rhc_default_set_qos (struct ddsi_rhc *rhc_common, const dds_qos_
   rhc->deadline.dur = qos->deadline.deadline; */
 }
 
-struct dds_rhc *dds_rhc_default_new_xchecks (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos, bool xchecks)
+static struct dds_rhc *dds_rhc_default_new_impl (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos, bool xchecks, bool shard)
 {
   struct dds_rhc_default *rhc = ddsrt_malloc (sizeof (*rhc));
   memset (rhc, 0, sizeof (*rhc));
@@ -588,12 +871,14 @@ struct dds_rhc *dds_rhc_default_new_xchecks (struct ddsi_domaingv *gv, const str
   lwregs_init (&rhc->registrations);
   ddsrt_mutex_init (&rhc->lock);
   rhc->instances = ddsrt_hh_new (1, instance_iid_hash, instance_iid_eq);
-  ddsrt_circlist_init (&rhc->nonempty_instances);
   rhc->type = type;
   rhc->reader = NULL; // set by "associate"
   rhc->tkmap = gv->m_tkmap;
   rhc->gv = gv;
   rhc->xchecks = xchecks;
+  rhc->shard = shard;
+  rhc_slab_init (&rhc->sample_slab, sizeof (struct rhc_sample));
+  rhc_slab_init (&rhc->instance_slab, sizeof (struct rhc_instance));
 
 #ifdef DDS_HAS_LIFESPAN
   ddsi_lifespan_init (gv, &rhc->lifespan, offsetof(struct dds_rhc_default, lifespan), offsetof(struct rhc_sample, lifespan), dds_rhc_default_sample_expired_cb);
@@ -605,14 +890,47 @@ struct dds_rhc *dds_rhc_default_new_xchecks (struct ddsi_domaingv *gv, const str
 #endif
 
   dds_rhc_default_set_qos (&rhc->common.common.rhc, qos);
+
+  /* Reserve what the resource limits allow for up front, within limits: the first sample
+     of an instance is stored in the instance itself */
+  const uint32_t prealloc_max = gv->config.rhc_prealloc_max;
+  if (rhc->max_instances != DDS_LENGTH_UNLIMITED)
+    rhc_slab_reserve (&rhc->instance_slab, ((uint32_t) rhc->max_instances < prealloc_max) ? (uint32_t) rhc->max_instances : prealloc_max, true);
+  if (rhc->max_samples != DDS_LENGTH_UNLIMITED)
+  {
+    const uint32_t n = (uint32_t) rhc->max_samples - ((rhc->max_instances != DDS_LENGTH_UNLIMITED && rhc->max_instances < rhc->max_samples) ? (uint32_t) rhc->max_instances : 0);
+    rhc_slab_reserve (&rhc->sample_slab, (n < prealloc_max) ? n : prealloc_max, true);
+  }
   return &rhc->common;
 }
 
+struct dds_rhc *dds_rhc_default_new_xchecks (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos, bool xchecks)
+{
+  return dds_rhc_default_new_impl (gv, type, qos, xchecks, false);
+}
+
 struct dds_rhc *dds_rhc_default_new (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos)
 {
   return dds_rhc_default_new_xchecks (gv, type, qos, (gv->config.enabled_xchecks & DDSI_XCHECK_RHC) != 0);
 }
 
+struct dds_rhc *dds_rhc_default_new_shard (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos)
+{
+  return dds_rhc_default_new_impl (gv, type, qos, (gv->config.enabled_xchecks & DDSI_XCHECK_RHC) != 0, true);
+}
+
+void dds_rhc_default_lock (struct dds_rhc *rhc_common)
+{
+  struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
+  ddsrt_mutex_lock (&rhc->lock);
+}
+
+void dds_rhc_default_unlock (struct dds_rhc *rhc_common)
+{
+  struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
+  ddsrt_mutex_unlock (&rhc->lock);
+}
+
 static dds_return_t dds_rhc_default_associate (struct dds_rhc *rhc_common, dds_reader *reader)
 {
   struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
@@ -622,6 +940,17 @@ static dds_return_t dds_rhc_default_associate (struct dds_rhc *rhc_common, dds_r
   return DDS_RETCODE_OK;
 }
 
+static void dds_rhc_default_get_slab_stats (struct dds_rhc *rhc_common, struct dds_rhc_slab_stats *stats)
+{
+  struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
+  ddsrt_mutex_lock (&rhc->lock);
+  stats->samples_used = rhc->sample_slab.nused;
+  stats->samples_reserved = rhc->sample_slab.nreserved;
+  stats->instances_used = rhc->instance_slab.nused;
+  stats->instances_reserved = rhc->instance_slab.nreserved;
+  ddsrt_mutex_unlock (&rhc->lock);
+}
+
 static bool eval_predicate_sample (const struct dds_rhc_default *rhc, const struct ddsi_serdata *sample, bool (*pred) (const void *sample))
 {
   // What to do if deserialization fails? Consider it matching or not?
@@ -643,7 +972,7 @@ static bool eval_predicate_invsample (const struct dds_rhc_default *rhc, const s
   return ret;
 }
 
-static struct rhc_sample *alloc_sample (struct rhc_instance *inst)
+static struct rhc_sample *alloc_sample (struct dds_rhc_default *rhc, struct rhc_instance *inst)
 {
   if (inst->a_sample_free)
   {
@@ -655,10 +984,7 @@ static struct rhc_sample *alloc_sample (struct rhc_instance *inst)
   }
   else
   {
-    /* This instead of sizeof(rhc_sample) gets us type checking */
-    struct rhc_sample *s;
-    s = ddsrt_malloc (sizeof (*s));
-    return s;
+    return rhc_slab_alloc (&rhc->sample_slab);
   }
 }
 
@@ -681,7 +1007,7 @@ static void free_sample (struct dds_rhc_default *rhc, struct rhc_instance *inst,
   }
   else
   {
-    ddsrt_free (s);
+    rhc_slab_free (&rhc->sample_slab, s);
   }
 }
 
@@ -733,7 +1059,7 @@ static void free_empty_instance (struct rhc_instance *inst, struct dds_rhc_defau
   if (inst->deadline_reg)
     ddsi_deadline_unregister_instance_locked (&rhc->deadline, &inst->deadline);
 #endif
-  ddsrt_free (inst);
+  rhc_slab_free (&rhc->instance_slab, inst);
 }
 
 static void free_instance_rhc_free (struct rhc_instance *inst, struct dds_rhc_default *rhc)
@@ -781,12 +1107,16 @@ static void dds_rhc_default_free (struct ddsi_rhc *rhc_common)
   ddsi_deadline_stop (&rhc->deadline);
 #endif
   ddsrt_hh_enum (rhc->instances, free_instance_rhc_free_wrap, rhc);
-  assert (ddsrt_circlist_isempty (&rhc->nonempty_instances));
+  assert (rhc->nonempty.n == 0);
+  ddsrt_free (rhc->nonempty.summary);
+  ddsrt_free (rhc->nonempty.inst);
 #ifdef DDS_HAS_DEADLINE_MISSED
   ddsi_deadline_fini (&rhc->deadline);
 #endif
   ddsrt_hh_free (rhc->instances);
   lwregs_fini (&rhc->registrations);
+  rhc_slab_fini (&rhc->sample_slab);
+  rhc_slab_fini (&rhc->instance_slab);
   if (rhc->qcond_eval_samplebuf != NULL)
     ddsi_sertype_free_sample (rhc->type, rhc->qcond_eval_samplebuf, DDS_FREE_ALL);
   ddsrt_mutex_destroy (&rhc->lock);
@@ -897,7 +1227,7 @@ static bool add_sample (struct dds_rhc_default *rhc, struct rhc_instance *inst,
     }
 
     /* add new latest sample */
-    s = alloc_sample (inst);
+    s = alloc_sample (rhc, inst);
     inst_clear_invsample_if_exists (rhc, inst, trig_qc);
     if (inst->latest == NULL)
     {
@@ -1403,10 +1733,11 @@ static struct rhc_instance *alloc_new_instance (struct dds_rhc_default *rhc, con
   struct rhc_instance *inst;
 
   ddsi_tkmap_instance_ref (tk);
-  inst = ddsrt_malloc (sizeof (*inst));
+  inst = rhc_slab_alloc (&rhc->instance_slab);
   memset (inst, 0, sizeof (*inst));
   inst->iid = tk->m_iid;
   inst->tk = tk;
+  inst->nonempty_idx = NONEMPTY_NOIDX;
   inst->wrcount = 1;
   inst->isdisposed = (serdata->statusinfo & DDSI_STATUSINFO_DISPOSE) != 0;
   inst->autodispose = wrinfo->auto_dispose;
@@ -1498,6 +1829,7 @@ static void postprocess_instance_update (struct dds_rhc_default *rhc, struct rhc
 {
   {
     struct rhc_instance *inst = *instptr;
+    update_nonempty_summary (rhc, inst);
 
 #ifdef DDS_HAS_DEADLINE_MISSED
     if (inst->isdisposed)
@@ -1929,6 +2261,11 @@ static uint32_t qmask_from_mask_n_cond (uint32_t mask, dds_readcond* cond)
   return qminv;
 }
 
+uint32_t dds_rhc_default_qminv_from_mask (uint32_t mask)
+{
+  return qmask_from_mask_n_cond (mask, NULL);
+}
+
 static uint32_t get_absolute_generation_rank (const struct rhc_instance *inst, const struct rhc_sample *sample)
 {
   return (inst->disposed_gen + inst->no_writers_gen) - (sample->disposed_gen + sample->no_writers_gen);
@@ -2267,6 +2604,7 @@ abort_on_error: ;
   }
   if (nread != inst_nread (inst) || inst_became_old)
   {
+    update_nonempty_summary (state->rhc, inst);
     get_trigger_info_cmn (&post.c, inst);
     assert (trig_qc.dec_conds_invsample == 0);
     assert (trig_qc.dec_conds_sample == 0);
@@ -2322,6 +2660,7 @@ abort_on_error: ;
       state->rhc->n_new--;
     }
     /* if nsamples = 0, it won't match anything, so no need to do anything here for drop_instance_noupdate_no_writers */
+    update_nonempty_summary (state->rhc, inst);
     get_trigger_info_cmn (&post.c, inst);
     assert (trig_qc.dec_conds_invsample == 0);
     assert (trig_qc.dec_conds_sample == 0);
@@ -2355,14 +2694,11 @@ static dds_return_t read_w_qminv (const struct readtake_w_qminv_inst_state *stat
     else
       rc = DDS_RETCODE_PRECONDITION_NOT_MET;
   }
-  else if (!ddsrt_circlist_isempty (&rhc->nonempty_instances))
+  else
   {
-    struct rhc_instance * inst = oldest_nonempty_instance (rhc);
-    struct rhc_instance * const end = inst;
-    do {
-      rc = read_w_qminv_inst (state, mark_as_read, inst);
-      inst = next_nonempty_instance (inst);
-    } while (rc >= 0 && inst != end && *state->limit > 0);
+    uint32_t idx = 0;
+    while (rc >= 0 && *state->limit > 0 && (idx = next_matching_nonempty (rhc, idx, state->qminv)) < rhc->nonempty.n)
+      rc = read_w_qminv_inst (state, mark_as_read, rhc->nonempty.inst[idx++]);
   }
   TRACE ("read: returning %"PRId32" with remaining limit %"PRId32"\n", rc, *state->limit);
   assert (rhc_check_counts_locked (rhc, true, false));
@@ -2390,15 +2726,15 @@ static dds_return_t take_w_qminv (const struct readtake_w_qminv_inst_state *stat
     else
       rc = DDS_RETCODE_PRECONDITION_NOT_MET;
   }
-  else if (!ddsrt_circlist_isempty (&rhc->nonempty_instances))
+  else
   {
-    struct rhc_instance *inst = oldest_nonempty_instance (rhc);
-    uint32_t n_insts = rhc->n_nonempty_instances;
-    while (rc >= 0 && n_insts-- > 0 && *state->limit > 0)
+    /* taking all samples from an instance turns its entry into a hole, so indices
+       remain valid while iterating */
+    uint32_t idx = 0;
+    while (rc >= 0 && *state->limit > 0 && (idx = next_matching_nonempty (rhc, idx, state->qminv)) < rhc->nonempty.n)
     {
-      struct rhc_instance * const inst1 = next_nonempty_instance (inst);
+      struct rhc_instance *inst = rhc->nonempty.inst[idx++];
       rc = take_w_qminv_inst (state, &inst);
-      inst = inst1;
     }
   }
   TRACE ("take: returning %"PRId32" with remaining limit %"PRId32"\n", rc, *state->limit);
@@ -2450,27 +2786,33 @@ static bool cond_is_sample_state_dependent (const struct dds_readcond *cond)
   }
 }
 
-static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_readcond *cond)
+bool dds_rhc_default_add_readcondition_locked (struct dds_rhc *rhc_common, dds_readcond *cond, bool link, uint32_t *trigger_out)
 {
   /* On the assumption that a readcondition will be attached to a
      waitset for nearly all of its life, we keep track of all
      readconditions on a reader in one set, without distinguishing
-     between those attached to a waitset or not. */
+     between those attached to a waitset or not.
+
+     The shards of a sharded RHC share the list: only the first one
+     links it in, the others merely catch up with the new head. */
   struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
   struct ddsrt_hh_iter it;
 
   assert ((dds_entity_kind (&cond->m_entity) == DDS_KIND_COND_READ && cond->m_query.m_filter == 0) ||
           (dds_entity_kind (&cond->m_entity) == DDS_KIND_COND_QUERY && cond->m_query.m_filter != 0));
-  assert (ddsrt_atomic_ld32 (&cond->m_entity.m_status.m_trigger) == 0);
-  assert (cond->m_query.m_qcmask == 0);
+  assert (link || rhc->shard);
+  assert (!link || cond->m_query.m_qcmask == 0);
 
   cond->m_qminv = qmask_from_dcpsquery (cond->m_sample_states, cond->m_view_states, cond->m_instance_states);
 
-  ddsrt_mutex_lock (&rhc->lock);
-
-  /* Allocate a slot in the condition bitmasks; return an error no more slots are available */
-  if (cond->m_query.m_filter != NULL)
+  if (!link)
   {
+    assert (cond->m_next == rhc->conds);
+    assert ((cond->m_query.m_filter == NULL) == (cond->m_query.m_qcmask == 0));
+  }
+  else if (cond->m_query.m_filter != NULL)
+  {
+    /* Allocate a slot in the condition bitmasks; return an error no more slots are available */
     dds_querycond_mask_t avail_qcmask = ~(dds_querycond_mask_t)0;
     for (dds_readcond *rc = rhc->conds; rc != NULL; rc = rc->m_next)
     {
@@ -2480,7 +2822,6 @@ static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_r
     if (avail_qcmask == 0)
     {
       /* no available indices */
-      ddsrt_mutex_unlock (&rhc->lock);
       return false;
     }
 
@@ -2489,23 +2830,16 @@ static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_r
   }
 
   rhc->nconds++;
-  cond->m_next = rhc->conds;
+  if (link)
+    cond->m_next = rhc->conds;
   rhc->conds = cond;
 
   uint32_t trigger = 0;
   if (cond->m_query.m_filter == NULL)
   {
     /* Read condition is not cached inside the instances and samples, so it only needs
-       to be evaluated on the non-empty instances */
-    if (!ddsrt_circlist_isempty (&rhc->nonempty_instances))
-    {
-      struct rhc_instance *inst = latest_nonempty_instance (rhc);
-      struct rhc_instance const * const end = inst;
-      do {
-        trigger += rhc_get_cond_trigger (inst, cond);
-        inst = next_nonempty_instance (inst);
-      } while (inst != end);
-    }
+       to be evaluated on the non-empty instances, for which the summaries suffice */
+    trigger = count_matching_nonempty (rhc, cond->m_qminv);
   }
   else
   {
@@ -2542,35 +2876,47 @@ static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_r
     }
   }
 
-  if (trigger)
-  {
-    ddsrt_atomic_st32 (&cond->m_entity.m_status.m_trigger, trigger);
-    dds_entity_status_signal (&cond->m_entity);
-  }
-
   TRACE ("add_readcondition(%p, %"PRIx32", %"PRIx32", %"PRIx32") => %p qminv %"PRIx32" ; rhc %"PRIu32" conds\n",
     (void *) rhc, cond->m_sample_states, cond->m_view_states,
     cond->m_instance_states, (void *) cond, cond->m_qminv, rhc->nconds);
 
-  ddsrt_mutex_unlock (&rhc->lock);
+  *trigger_out = trigger;
   return true;
 }
 
-static void dds_rhc_default_remove_readcondition (struct dds_rhc *rhc_common, dds_readcond *cond)
+static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_readcond *cond)
 {
   struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
-  dds_readcond **ptr;
+  uint32_t trigger;
+  bool ok;
+
+  assert (ddsrt_atomic_ld32 (&cond->m_entity.m_status.m_trigger) == 0);
   ddsrt_mutex_lock (&rhc->lock);
-  ptr = &rhc->conds;
-  while (*ptr != cond)
+  if ((ok = dds_rhc_default_add_readcondition_locked (rhc_common, cond, true, &trigger)) && trigger)
+  {
+    ddsrt_atomic_st32 (&cond->m_entity.m_status.m_trigger, trigger);
+    dds_entity_status_signal (&cond->m_entity);
+  }
+  ddsrt_mutex_unlock (&rhc->lock);
+  return ok;
+}
+
+void dds_rhc_default_remove_readcondition_locked (struct dds_rhc *rhc_common, dds_readcond *cond)
+{
+  /* In a sharded RHC, the first shard unlinks it from the shared list, the
+     others only need to update their head if it was the first */
+  struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
+  dds_readcond **ptr = &rhc->conds;
+  while (*ptr != cond && *ptr != NULL)
     ptr = &(*ptr)->m_next;
-  *ptr = (*ptr)->m_next;
+  assert (*ptr == cond || rhc->shard);
+  if (*ptr == cond)
+    *ptr = cond->m_next;
   rhc->nconds--;
   if (cond->m_query.m_filter)
   {
     rhc->nqconds--;
     rhc->qconds_samplest &= ~cond->m_query.m_qcmask;
-    cond->m_query.m_qcmask = 0;
     if (rhc->nqconds == 0)
     {
       assert (rhc->qcond_eval_samplebuf != NULL);
@@ -2578,6 +2924,14 @@ static void dds_rhc_default_remove_readcondition (struct dds_rhc *rhc_common, dd
       rhc->qcond_eval_samplebuf = NULL;
     }
   }
+}
+
+static void dds_rhc_default_remove_readcondition (struct dds_rhc *rhc_common, dds_readcond *cond)
+{
+  struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
+  ddsrt_mutex_lock (&rhc->lock);
+  dds_rhc_default_remove_readcondition_locked (rhc_common, cond);
+  cond->m_query.m_qcmask = 0;
   ddsrt_mutex_unlock (&rhc->lock);
 }
 
@@ -2875,7 +3229,10 @@ static bool rhc_check_counts_locked (struct dds_rhc_default *rhc, bool check_con
     if (inst->isnew)
       n_new++;
     if (inst_is_empty (inst))
+    {
+      assert (inst->nonempty_idx == NONEMPTY_NOIDX);
       continue;
+    }
 
     n_nonempty_instances++;
     if (inst->isdisposed)
@@ -2973,33 +3330,29 @@ static bool rhc_check_counts_locked (struct dds_rhc_default *rhc, bool check_con
   assert (rhc->n_invsamples == n_invsamples);
   assert (rhc->n_invread == n_invread);
 
-  if (check_conds)
+  if (check_conds && !rhc->shard)
   {
     for (i = 0, rciter = rhc->conds; rciter && i < ncheck; i++, rciter = rciter->m_next)
       assert (cond_match_count[i] == ddsrt_atomic_ld32 (&rciter->m_entity.m_status.m_trigger));
   }
 
-  if (rhc->n_nonempty_instances == 0)
+  assert (rhc->nonempty.n <= rhc->nonempty.size);
+  assert (rhc->nonempty.n == 0 || rhc->nonempty.inst[rhc->nonempty.n - 1] != NULL);
+  n_nonempty_instances = 0;
+  for (i = 0; i < rhc->nonempty.n; i++)
   {
-    assert (ddsrt_circlist_isempty (&rhc->nonempty_instances));
-  }
-  else
-  {
-    assert (!ddsrt_circlist_isempty (&rhc->nonempty_instances));
-    struct ddsrt_circlist_elem const *prev = rhc->nonempty_instances.latest->prev;
-    inst = latest_nonempty_instance (rhc);
-    struct rhc_instance const * const end = inst;
-    n_nonempty_instances = 0;
-    do {
-      assert (!inst_is_empty (inst));
-      assert (prev->next == &inst->nonempty_list);
-      assert (inst->nonempty_list.prev == prev);
-      prev = &inst->nonempty_list;
-      inst = next_nonempty_instance (inst);
-      n_nonempty_instances++;
-    } while (inst != end);
-    assert (rhc->n_nonempty_instances == n_nonempty_instances);
+    if ((inst = rhc->nonempty.inst[i]) == NULL)
+    {
+      assert (rhc->nonempty.summary[i] == NONEMPTY_HOLE);
+      continue;
+    }
+    assert (!inst_is_empty (inst));
+    assert (inst->nonempty_idx == i);
+    /* summaries are updated together with the condition triggers */
+    assert (!check_conds || rhc->nonempty.summary[i] == inst_summary (inst));
+    n_nonempty_instances++;
   }
+  assert (rhc->n_nonempty_instances == n_nonempty_instances);
 
   return true;
 }
@@ -3018,5 +3371,6 @@ static const struct dds_rhc_ops dds_rhc_default_ops = {
   .take = dds_rhc_default_take,
   .add_readcondition = dds_rhc_default_add_readcondition,
   .remove_readcondition = dds_rhc_default_remove_readcondition,
-  .associate = dds_rhc_default_associate
+  .associate = dds_rhc_default_associate,
+  .get_slab_stats = dds_rhc_default_get_slab_stats
 };
@@ -0,0 +1,505 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <string.h>
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "dds/ddsi/ddsi_gc.h"
+#include "dds/ddsi/ddsi_rhc.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_sertype.h"
+#include "dds/ddsi/ddsi_thread.h"
+#include "dds/ddsi/ddsi_tkmap.h"
+#include "dds/ddsi/ddsi_xqos.h"
+#include "dds/ddsc/dds_rhc.h"
+#include "dds__entity.h"
+#include "dds__types.h"
+#include "dds__rhc_default.h"
+#include "dds__rhc_latest.h"
+
+/* The "latest value" RHC is for keyless KEEP_LAST(1) readers, where all the reader ever
+   holds is the most recent sample of a single instance.  As long as that instance is only
+   written by a single writer, and there are no read conditions, the instance state is
+   always ALIVE and all that needs to be tracked is the sample itself, whether it has been
+   read or taken and whether the instance is still NEW.
+
+   The sample lives in "slot", everything else in "state": a sequence number that is
+   incremented on every store, plus some flags.  Stores are serialised by "lock", but read
+   and take don't lock at all.  A store first sets WRITING, replaces the sample and then
+   clears WRITING and increments the sequence number; read loads the state, the sample and
+   the state again and retries if the sequence number changed in between; take claims the
+   sample by clearing PRESENT with a CAS on the state it observed.
+
+   A sample that has been replaced may still be in use by a concurrent read or take, so it
+   isn't released immediately.  Readers are always "awake" when accessing the RHC and the
+   replaced samples are batched and released via the garbage collector, which waits until
+   all threads that were awake at the time have gone to sleep.
+
+   Anything else -- a read condition, a second writer, a dispose or unregister, a sample
+   with a lifespan, or a topic filter -- needs the full instance state machine of the
+   default RHC.  In that case the contents of the slot are transferred to a default RHC and
+   all subsequent operations are forwarded to it.  This switch is one-way. */
+
+#define LV_WRITING   1u   /* slot being updated or transferred, try again */
+#define LV_PRESENT   2u   /* slot contains a sample that hasn't been taken */
+#define LV_READ      4u   /* sample in slot has been read */
+#define LV_NOT_NEW   8u   /* instance has been read from or taken from */
+#define LV_DELEGATED 16u  /* all operations forwarded to default RHC */
+#define LV_INSTANCE  32u  /* instance exists: iid, tk and wrinfo are set */
+#define LV_SEQ_UNIT  64u  /* sequence number in remaining bits */
+#define LV_SEQ_MASK  (~(LV_SEQ_UNIT - 1))
+
+/* Number of replaced samples released with a single garbage collector request */
+#define LV_RETIRE_BATCH 8
+
+struct lv_retired {
+  uint32_t n;
+  struct ddsi_serdata *samples[LV_RETIRE_BATCH];
+};
+
+struct dds_rhc_latest {
+  struct dds_rhc common;
+  ddsrt_atomic_uint32_t state;
+  ddsrt_atomic_voidp_t slot;
+  ddsrt_mutex_t lock; /* serialises store and the switch to the default RHC */
+  struct ddsi_domaingv *gv;
+  const struct ddsi_sertype *type;
+  struct dds_reader *reader;
+  struct dds_rhc *rhc; /* default RHC taking over once delegated */
+  struct lv_retired *retired;
+  /* iid, tk and wrinfo are set by the first store and constant afterward (for as long as
+     this RHC handles the data itself); readers only look at them if they observed
+     INSTANCE */
+  uint64_t iid;
+  struct ddsi_tkmap_instance *tk;
+  struct ddsi_writer_info wrinfo;
+};
+
+static const struct dds_rhc_ops dds_rhc_latest_ops;
+
+bool dds_rhc_latest_applicable (const struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos)
+{
+  if (!gv->config.rhc_latest || type->has_key)
+    return false;
+  return (qos->history.kind == DDS_HISTORY_KEEP_LAST && qos->history.depth == 1 &&
+          qos->deadline.deadline == DDS_INFINITY &&
+          qos->time_based_filter.minimum_separation == 0 &&
+          qos->destination_order.kind == DDS_DESTINATIONORDER_BY_RECEPTION_TIMESTAMP &&
+          qos->ownership.kind == DDS_OWNERSHIP_SHARED);
+}
+
+struct dds_rhc *dds_rhc_latest_new (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos)
+{
+  struct dds_rhc_latest *rhc = ddsrt_malloc (sizeof (*rhc));
+  memset (rhc, 0, sizeof (*rhc));
+  rhc->common.common.ops = &dds_rhc_latest_ops;
+  ddsrt_atomic_st32 (&rhc->state, 0);
+  ddsrt_atomic_stvoidp (&rhc->slot, NULL);
+  ddsrt_mutex_init (&rhc->lock);
+  rhc->gv = gv;
+  rhc->type = type;
+  rhc->rhc = dds_rhc_default_new (gv, type, qos);
+  return &rhc->common;
+}
+
+static void lv_free_retired (struct ddsi_gcreq *gcreq)
+{
+  struct lv_retired *retired = ddsi_gcreq_get_arg (gcreq);
+  ddsi_gcreq_free (gcreq);
+  for (uint32_t i = 0; i < retired->n; i++)
+    ddsi_serdata_unref (retired->samples[i]);
+  ddsrt_free (retired);
+}
+
+static void lv_flush_retired_locked (struct dds_rhc_latest *rhc)
+{
+  if (rhc->retired == NULL)
+    return;
+  struct ddsi_gcreq *gcreq = ddsi_gcreq_new (rhc->gv->gcreq_queue, lv_free_retired);
+  ddsi_gcreq_set_arg (gcreq, rhc->retired);
+  ddsi_gcreq_enqueue (gcreq);
+  rhc->retired = NULL;
+}
+
+static void lv_retire_locked (struct dds_rhc_latest *rhc, struct ddsi_serdata *sample)
+{
+  if (rhc->retired == NULL)
+  {
+    rhc->retired = ddsrt_malloc (sizeof (*rhc->retired));
+    rhc->retired->n = 0;
+  }
+  rhc->retired->samples[rhc->retired->n++] = sample;
+  if (rhc->retired->n == LV_RETIRE_BATCH)
+    lv_flush_retired_locked (rhc);
+}
+
+static dds_return_t collect_nothing (void *arg, const dds_sample_info_t *si, const struct ddsi_sertype *st, struct ddsi_serdata *sd)
+{
+  (void) arg; (void) si; (void) st; (void) sd;
+  return DDS_RETCODE_OK;
+}
+
+static void lv_delegate_locked (struct dds_rhc_latest *rhc)
+{
+  /* Setting WRITING without ever clearing it again freezes the slot: readers wait until
+     DELEGATED is set and then continue with the default RHC.  The default RHC isn't yet
+     associated with the reader, so transferring the state doesn't trigger listeners. */
+  const uint32_t st = ddsrt_atomic_or32_ov (&rhc->state, LV_WRITING);
+  assert (!(st & (LV_WRITING | LV_DELEGATED)));
+  struct ddsi_serdata * const sample = ddsrt_atomic_ldvoidp (&rhc->slot);
+  if (sample != NULL)
+  {
+    /* The default RHC can't be told the state directly, but the same effect can be
+       had by storing, reading and taking.  A read sample in an instance that is no
+       longer NEW needs a store followed by a read, an unread sample in an instance
+       that is no longer NEW needs that followed by another store. */
+    (void) dds_rhc_store (rhc->rhc, &rhc->wrinfo, sample, rhc->tk);
+    if (st & (LV_READ | LV_NOT_NEW))
+      (void) dds_rhc_read (rhc->rhc, 1, DDS_RHC_NO_STATE_MASK_SET, 0, NULL, collect_nothing, NULL);
+    if (!(st & LV_PRESENT))
+      (void) dds_rhc_take (rhc->rhc, 1, DDS_RHC_NO_STATE_MASK_SET, 0, NULL, collect_nothing, NULL);
+    else if ((st & (LV_READ | LV_NOT_NEW)) == LV_NOT_NEW)
+      (void) dds_rhc_store (rhc->rhc, &rhc->wrinfo, sample, rhc->tk);
+    ddsrt_atomic_stvoidp (&rhc->slot, NULL);
+    lv_retire_locked (rhc, sample);
+  }
+  lv_flush_retired_locked (rhc);
+  if (rhc->reader)
+    (void) dds_rhc_associate (rhc->rhc, rhc->reader);
+  ddsrt_atomic_or32 (&rhc->state, LV_DELEGATED);
+}
+
+static bool lv_is_delegated (const struct dds_rhc_latest *rhc)
+{
+  return (ddsrt_atomic_ld32 (&rhc->state) & LV_DELEGATED) != 0;
+}
+
+static void dds_rhc_latest_free (struct ddsi_rhc *rhc_common)
+{
+  /* no concurrent readers remain when the RHC is freed */
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  struct ddsi_serdata * const sample = ddsrt_atomic_ldvoidp (&rhc->slot);
+  if (sample)
+    ddsi_serdata_unref (sample);
+  if (rhc->retired)
+  {
+    for (uint32_t i = 0; i < rhc->retired->n; i++)
+      ddsi_serdata_unref (rhc->retired->samples[i]);
+    ddsrt_free (rhc->retired);
+  }
+  if (rhc->tk)
+    ddsi_tkmap_instance_unref (rhc->gv->m_tkmap, rhc->tk);
+  dds_rhc_free (rhc->rhc);
+  ddsrt_mutex_destroy (&rhc->lock);
+  ddsrt_free (rhc);
+}
+
+static dds_return_t dds_rhc_latest_associate (struct dds_rhc *rhc_common, dds_reader *reader)
+{
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  dds_return_t ret = DDS_RETCODE_OK;
+  ddsrt_mutex_lock (&rhc->lock);
+  rhc->reader = reader;
+  if (lv_is_delegated (rhc))
+    ret = dds_rhc_associate (rhc->rhc, reader);
+  ddsrt_mutex_unlock (&rhc->lock);
+  return ret;
+}
+
+static bool lv_handles_sample (const struct dds_rhc_latest *rhc, uint32_t st, const struct ddsi_writer_info *wrinfo, const struct ddsi_serdata *sample)
+{
+  if (sample->kind != SDK_DATA || sample->statusinfo != 0)
+    return false;
+  if ((st & LV_INSTANCE) && wrinfo->iid != rhc->wrinfo.iid)
+    return false;
+#ifdef DDS_HAS_LIFESPAN
+  if (wrinfo->lifespan_exp.v != DDS_NEVER)
+    return false;
+#endif
+  if (rhc->reader && rhc->reader->m_topic->m_filter.mode != DDS_TOPIC_FILTER_NONE)
+    return false;
+  return true;
+}
+
+static bool dds_rhc_latest_store (struct ddsi_rhc *rhc_common, const struct ddsi_writer_info *wrinfo, struct ddsi_serdata *sample, struct ddsi_tkmap_instance *tk)
+{
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  if (lv_is_delegated (rhc))
+    return dds_rhc_store (rhc->rhc, wrinfo, sample, tk);
+  if (sample->kind != SDK_DATA && sample->statusinfo == 0)
+  {
+    /* explicit register, ignored just like the default RHC does */
+    return true;
+  }
+
+  ddsrt_mutex_lock (&rhc->lock);
+  const uint32_t st = ddsrt_atomic_ld32 (&rhc->state);
+  if (st & LV_DELEGATED)
+    ; // raced with switch to default RHC
+  else if (!lv_handles_sample (rhc, st, wrinfo, sample))
+    lv_delegate_locked (rhc);
+  else
+  {
+    if (!(st & LV_INSTANCE))
+    {
+      rhc->iid = tk->m_iid;
+      ddsi_tkmap_instance_ref (tk);
+      rhc->tk = tk;
+      rhc->wrinfo = *wrinfo;
+    }
+    (void) ddsrt_atomic_or32_ov (&rhc->state, LV_WRITING);
+    struct ddsi_serdata * const old = ddsrt_atomic_ldvoidp (&rhc->slot);
+    ddsrt_atomic_stvoidp (&rhc->slot, ddsi_serdata_ref (sample));
+    ddsrt_atomic_fence_rel ();
+    /* readers may set NOT_NEW while WRITING is set, but nothing else changes */
+    uint32_t st1;
+    do {
+      st1 = ddsrt_atomic_ld32 (&rhc->state);
+    } while (!ddsrt_atomic_cas32 (&rhc->state, st1, ((st1 & ~(LV_WRITING | LV_READ)) | LV_PRESENT | LV_INSTANCE) + LV_SEQ_UNIT));
+    if (old)
+      lv_retire_locked (rhc, old);
+    ddsrt_mutex_unlock (&rhc->lock);
+    if (rhc->reader)
+      dds_reader_data_available_cb (rhc->reader);
+    return true;
+  }
+  ddsrt_mutex_unlock (&rhc->lock);
+  return dds_rhc_store (rhc->rhc, wrinfo, sample, tk);
+}
+
+static void dds_rhc_latest_unregister_wr (struct ddsi_rhc *rhc_common, const struct ddsi_writer_info *wrinfo)
+{
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  if (!lv_is_delegated (rhc))
+  {
+    ddsrt_mutex_lock (&rhc->lock);
+    const uint32_t st = ddsrt_atomic_ld32 (&rhc->state);
+    const bool registered = !(st & LV_DELEGATED) && (st & LV_INSTANCE) && rhc->wrinfo.iid == wrinfo->iid;
+    if (registered)
+      lv_delegate_locked (rhc);
+    ddsrt_mutex_unlock (&rhc->lock);
+    if (!registered && !lv_is_delegated (rhc))
+      return;
+  }
+  dds_rhc_unregister_wr (rhc->rhc, wrinfo);
+}
+
+static void dds_rhc_latest_relinquish_ownership (struct ddsi_rhc *rhc_common, const uint64_t wr_iid)
+{
+  /* only relevant for exclusive ownership, which this RHC doesn't handle itself */
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  if (lv_is_delegated (rhc))
+    dds_rhc_relinquish_ownership (rhc->rhc, wr_iid);
+}
+
+static void lv_make_sample_info (dds_sample_info_t *si, const struct dds_rhc_latest *rhc, uint32_t st, const struct ddsi_serdata *sample)
+{
+  si->sample_state = (st & LV_READ) ? DDS_READ_SAMPLE_STATE : DDS_NOT_READ_SAMPLE_STATE;
+  si->view_state = (st & LV_NOT_NEW) ? DDS_NOT_NEW_VIEW_STATE : DDS_NEW_VIEW_STATE;
+  si->instance_state = DDS_ALIVE_INSTANCE_STATE;
+  si->instance_handle = rhc->iid;
+  si->publication_handle = rhc->wrinfo.iid;
+  si->disposed_generation_count = 0;
+  si->no_writers_generation_count = 0;
+  si->sample_rank = 0;
+  si->generation_rank = 0;
+  si->absolute_generation_rank = 0;
+  si->valid_data = true;
+  si->source_timestamp = sample->timestamp.v;
+}
+
+static uint32_t lv_qmask (uint32_t st)
+{
+  return (((st & LV_READ) ? DDS_READ_SAMPLE_STATE : DDS_NOT_READ_SAMPLE_STATE) |
+          ((st & LV_NOT_NEW) ? DDS_NOT_NEW_VIEW_STATE : DDS_NEW_VIEW_STATE) |
+          DDS_ALIVE_INSTANCE_STATE);
+}
+
+/* Waits for a concurrent store to complete and checks whether the slot has a sample matching the
+   instance handle and mask: 0 if there is none, 1 if there is, or an error. */
+static int32_t lv_wait_and_check (const struct dds_rhc_latest *rhc, uint32_t *st, uint32_t qminv, dds_instance_handle_t handle)
+{
+  while ((*st = ddsrt_atomic_ld32 (&rhc->state)) & LV_WRITING)
+  {
+    if (*st & LV_DELEGATED)
+      return 1;
+    dds_sleepfor (DDS_USECS (1));
+  }
+  if (handle && (!(*st & LV_INSTANCE) || handle != rhc->iid))
+    return DDS_RETCODE_PRECONDITION_NOT_MET;
+  if (!(*st & LV_PRESENT) || (lv_qmask (*st) & qminv) != 0)
+    return 0;
+  ddsrt_atomic_fence_ldld ();
+  return 1;
+}
+
+static int32_t lv_read (struct dds_rhc_latest *rhc, bool mark_as_read, uint32_t mask, dds_instance_handle_t handle, dds_read_with_collector_fn_t collect_sample, void *collect_sample_arg, bool *delegated)
+{
+  const uint32_t qminv = dds_rhc_default_qminv_from_mask (mask);
+  uint32_t st;
+  struct ddsi_serdata *sample;
+  int32_t rc;
+  do {
+    if ((rc = lv_wait_and_check (rhc, &st, qminv, handle)) <= 0)
+      return rc;
+    else if (st & LV_DELEGATED)
+    {
+      *delegated = true;
+      return 0;
+    }
+    sample = ddsrt_atomic_ldvoidp (&rhc->slot);
+    ddsrt_atomic_fence_ldld ();
+    /* concurrent reads may set READ and NOT_NEW, that is of no consequence */
+  } while ((ddsrt_atomic_ld32 (&rhc->state) | LV_READ | LV_NOT_NEW) != (st | LV_READ | LV_NOT_NEW));
+
+  dds_sample_info_t si;
+  lv_make_sample_info (&si, rhc, st, sample);
+  if ((rc = collect_sample (collect_sample_arg, &si, rhc->type, sample)) < 0)
+    return rc;
+  if (mark_as_read && (st & (LV_READ | LV_NOT_NEW)) != (LV_READ | LV_NOT_NEW))
+  {
+    /* The sample can only be marked as read if it is still the same one, but the instance
+       has been read regardless; a concurrent store preserves NOT_NEW */
+    uint32_t st1;
+    do {
+      st1 = ddsrt_atomic_ld32 (&rhc->state);
+      if ((st1 & LV_SEQ_MASK) != (st & LV_SEQ_MASK) || (st1 & LV_WRITING))
+      {
+        ddsrt_atomic_or32 (&rhc->state, LV_NOT_NEW);
+        break;
+      }
+    } while (!ddsrt_atomic_cas32 (&rhc->state, st1, st1 | LV_READ | LV_NOT_NEW));
+  }
+  return 1;
+}
+
+static int32_t lv_take (struct dds_rhc_latest *rhc, uint32_t mask, dds_instance_handle_t handle, dds_read_with_collector_fn_t collect_sample, void *collect_sample_arg, bool *delegated)
+{
+  const uint32_t qminv = dds_rhc_default_qminv_from_mask (mask);
+  uint32_t st, st1;
+  struct ddsi_serdata *sample;
+  int32_t rc;
+  do {
+    if ((rc = lv_wait_and_check (rhc, &st, qminv, handle)) <= 0)
+      return rc;
+    else if (st & LV_DELEGATED)
+    {
+      *delegated = true;
+      return 0;
+    }
+    sample = ddsrt_atomic_ldvoidp (&rhc->slot);
+    st1 = (st & ~(LV_PRESENT | LV_READ)) | LV_NOT_NEW;
+  } while (!ddsrt_atomic_cas32 (&rhc->state, st, st1));
+
+  /* A successful CAS means no store intervened, so the sample is the one that was taken */
+  dds_sample_info_t si;
+  lv_make_sample_info (&si, rhc, st, sample);
+  if ((rc = collect_sample (collect_sample_arg, &si, rhc->type, sample)) < 0)
+  {
+    /* put it back unless it has been replaced in the meantime */
+    (void) ddsrt_atomic_cas32 (&rhc->state, st1, st);
+    return rc;
+  }
+  return 1;
+}
+
+static int32_t dds_rhc_latest_peek (struct dds_rhc *rhc_common, int32_t max_samples, uint32_t mask, dds_instance_handle_t handle, dds_readcond *cond, dds_read_with_collector_fn_t collect_sample, void *collect_sample_arg)
+{
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  bool delegated = (cond != NULL);
+  assert (max_samples > 0);
+  assert (ddsi_thread_is_awake ());
+  assert (cond == NULL || lv_is_delegated (rhc));
+  if (!delegated)
+  {
+    const int32_t rc = lv_read (rhc, false, mask, handle, collect_sample, collect_sample_arg, &delegated);
+    if (!delegated)
+      return rc;
+  }
+  return dds_rhc_peek (rhc->rhc, max_samples, mask, handle, cond, collect_sample, collect_sample_arg);
+}
+
+static int32_t dds_rhc_latest_read (struct dds_rhc *rhc_common, int32_t max_samples, uint32_t mask, dds_instance_handle_t handle, dds_readcond *cond, dds_read_with_collector_fn_t collect_sample, void *collect_sample_arg)
+{
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  bool delegated = (cond != NULL);
+  assert (max_samples > 0);
+  assert (ddsi_thread_is_awake ());
+  assert (cond == NULL || lv_is_delegated (rhc));
+  if (!delegated)
+  {
+    const int32_t rc = lv_read (rhc, true, mask, handle, collect_sample, collect_sample_arg, &delegated);
+    if (!delegated)
+      return rc;
+  }
+  return dds_rhc_read (rhc->rhc, max_samples, mask, handle, cond, collect_sample, collect_sample_arg);
+}
+
+static int32_t dds_rhc_latest_take (struct dds_rhc *rhc_common, int32_t max_samples, uint32_t mask, dds_instance_handle_t handle, dds_readcond *cond, dds_read_with_collector_fn_t collect_sample, void *collect_sample_arg)
+{
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  bool delegated = (cond != NULL);
+  assert (max_samples > 0);
+  assert (ddsi_thread_is_awake ());
+  assert (cond == NULL || lv_is_delegated (rhc));
+  if (!delegated)
+  {
+    const int32_t rc = lv_take (rhc, mask, handle, collect_sample, collect_sample_arg, &delegated);
+    if (!delegated)
+      return rc;
+  }
+  return dds_rhc_take (rhc->rhc, max_samples, mask, handle, cond, collect_sample, collect_sample_arg);
+}
+
+static bool dds_rhc_latest_add_readcondition (struct dds_rhc *rhc_common, dds_readcond *cond)
+{
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  if (!lv_is_delegated (rhc))
+  {
+    ddsrt_mutex_lock (&rhc->lock);
+    if (!lv_is_delegated (rhc))
+      lv_delegate_locked (rhc);
+    ddsrt_mutex_unlock (&rhc->lock);
+  }
+  return dds_rhc_add_readcondition (rhc->rhc, cond);
+}
+
+static void dds_rhc_latest_remove_readcondition (struct dds_rhc *rhc_common, dds_readcond *cond)
+{
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  assert (lv_is_delegated (rhc));
+  dds_rhc_remove_readcondition (rhc->rhc, cond);
+}
+
+static void dds_rhc_latest_get_slab_stats (struct dds_rhc *rhc_common, struct dds_rhc_slab_stats *stats)
+{
+  /* the slot doesn't use the slabs, the default RHC does once it has taken over */
+  struct dds_rhc_latest * const rhc = (struct dds_rhc_latest *) rhc_common;
+  dds_rhc_get_slab_stats (rhc->rhc, stats);
+}
+
+static const struct dds_rhc_ops dds_rhc_latest_ops = {
+  .rhc_ops = {
+    .store = dds_rhc_latest_store,
+    .unregister_wr = dds_rhc_latest_unregister_wr,
+    .relinquish_ownership = dds_rhc_latest_relinquish_ownership,
+    .free = dds_rhc_latest_free
+  },
+  .peek = dds_rhc_latest_peek,
+  .read = dds_rhc_latest_read,
+  .take = dds_rhc_latest_take,
+  .add_readcondition = dds_rhc_latest_add_readcondition,
+  .remove_readcondition = dds_rhc_latest_remove_readcondition,
+  .associate = dds_rhc_latest_associate,
+  .get_slab_stats = dds_rhc_latest_get_slab_stats
+};
@@ -0,0 +1,235 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <string.h>
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_sertype.h"
+#include "dds/ddsi/ddsi_tkmap.h"
+#include "dds/ddsi/ddsi_xqos.h"
+#include "dds/ddsc/dds_rhc.h"
+#include "dds__entity.h"
+#include "dds__rhc_default.h"
+#include "dds__rhc_sharded.h"
+
+/* The default RHC serialises all operations on a reader through a single lock. For
+   keyed topics with many instances, updated by multiple delivery threads and read by
+   multiple application threads, that lock becomes the point of contention.
+
+   The sharded RHC partitions the instances over a number of default RHCs based on the
+   instance id. Each shard has its own lock, its own counts and its own list of
+   non-empty instances, so that stores to instances in different shards proceed in
+   parallel. Operations on a single instance (store, read/take with an instance handle)
+   go to a single shard, operations on all instances visit the shards one by one.
+
+   The read conditions are shared: they are linked into a single list that all shards
+   refer to, and the trigger count of a condition is the sum of the matches in each of
+   the shards (the counts are updated atomically already). Adding or removing a
+   condition locks all shards, in order, so that the shared list is stable whenever one
+   of the shards is locked.
+
+   The reader-wide resource limits can't be enforced without a global count and a
+   sharded RHC is therefore only used if these are unlimited. The order in which samples
+   of different instances are returned by read/take differs from that of the default
+   RHC: it goes shard by shard instead of following the order in which instances became
+   non-empty. */
+
+struct dds_rhc_sharded {
+  struct dds_rhc common;
+  uint32_t nshards;
+  struct dds_rhc *shards[];
+};
+
+static const struct dds_rhc_ops dds_rhc_sharded_ops;
+
+static struct dds_rhc *shard_of_iid (const struct dds_rhc_sharded *rhc, uint64_t iid)
+{
+  /* instance ids are pseudo-random, but mix the high bits in anyway */
+  const uint32_t h = (uint32_t) ((iid * UINT64_C (0x9e3779b97f4a7c15)) >> 32);
+  return rhc->shards[h % rhc->nshards];
+}
+
+bool dds_rhc_sharded_applicable (const struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos)
+{
+  if (gv->config.rhc_shards <= 1 || !type->has_key)
+    return false;
+  return qos->resource_limits.max_samples == DDS_LENGTH_UNLIMITED && qos->resource_limits.max_instances == DDS_LENGTH_UNLIMITED;
+}
+
+struct dds_rhc *dds_rhc_sharded_new (struct ddsi_domaingv *gv, const struct ddsi_sertype *type, const dds_qos_t *qos)
+{
+  assert (gv->config.rhc_shards > 1);
+  const uint32_t nshards = (uint32_t) gv->config.rhc_shards;
+  struct dds_rhc_sharded *rhc = ddsrt_malloc (sizeof (*rhc) + nshards * sizeof (rhc->shards[0]));
+  rhc->common.common.ops = &dds_rhc_sharded_ops;
+  rhc->nshards = nshards;
+  for (uint32_t i = 0; i < nshards; i++)
+    rhc->shards[i] = dds_rhc_default_new_shard (gv, type, qos);
+  return &rhc->common;
+}
+
+static void dds_rhc_sharded_free (struct ddsi_rhc *rhc_common)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  for (uint32_t i = 0; i < rhc->nshards; i++)
+    dds_rhc_free (rhc->shards[i]);
+  ddsrt_free (rhc);
+}
+
+static dds_return_t dds_rhc_sharded_associate (struct dds_rhc *rhc_common, dds_reader *reader)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  for (uint32_t i = 0; i < rhc->nshards; i++)
+  {
+    dds_return_t ret;
+    if ((ret = dds_rhc_associate (rhc->shards[i], reader)) < 0)
+      return ret;
+  }
+  return DDS_RETCODE_OK;
+}
+
+static bool dds_rhc_sharded_store (struct ddsi_rhc *rhc_common, const struct ddsi_writer_info *wrinfo, struct ddsi_serdata *sample, struct ddsi_tkmap_instance *tk)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  return dds_rhc_store (shard_of_iid (rhc, tk->m_iid), wrinfo, sample, tk);
+}
+
+static void dds_rhc_sharded_unregister_wr (struct ddsi_rhc *rhc_common, const struct ddsi_writer_info *wrinfo)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  for (uint32_t i = 0; i < rhc->nshards; i++)
+    dds_rhc_unregister_wr (rhc->shards[i], wrinfo);
+}
+
+static void dds_rhc_sharded_relinquish_ownership (struct ddsi_rhc *rhc_common, const uint64_t wr_iid)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  for (uint32_t i = 0; i < rhc->nshards; i++)
+    dds_rhc_relinquish_ownership (rhc->shards[i], wr_iid);
+}
+
+static int32_t readtake_sharded (struct dds_rhc_sharded *rhc, dds_rhc_read_take_t op, int32_t max_samples, uint32_t mask, dds_instance_handle_t handle, dds_readcond *cond, dds_read_with_collector_fn_t collect_sample, void *collect_sample_arg)
+{
+  /* The collector keeps track of where the next sample goes, so the shards can simply
+     be visited in turn until the limit is reached.  Errors are returned only if nothing
+     has been collected yet, just like the default RHC does for a single instance. */
+  if (handle)
+    return op (shard_of_iid (rhc, handle), max_samples, mask, handle, cond, collect_sample, collect_sample_arg);
+  int32_t n = 0;
+  for (uint32_t i = 0; i < rhc->nshards && n < max_samples; i++)
+  {
+    const int32_t m = op (rhc->shards[i], max_samples - n, mask, 0, cond, collect_sample, collect_sample_arg);
+    if (m < 0)
+      return (n == 0) ? m : n;
+    n += m;
+  }
+  return n;
+}
+
+static int32_t dds_rhc_sharded_peek (struct dds_rhc *rhc_common, int32_t max_samples, uint32_t mask, dds_instance_handle_t handle, dds_readcond *cond, dds_read_with_collector_fn_t collect_sample, void *collect_sample_arg)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  return readtake_sharded (rhc, rhc->shards[0]->common.ops->peek, max_samples, mask, handle, cond, collect_sample, collect_sample_arg);
+}
+
+static int32_t dds_rhc_sharded_read (struct dds_rhc *rhc_common, int32_t max_samples, uint32_t mask, dds_instance_handle_t handle, dds_readcond *cond, dds_read_with_collector_fn_t collect_sample, void *collect_sample_arg)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  return readtake_sharded (rhc, rhc->shards[0]->common.ops->read, max_samples, mask, handle, cond, collect_sample, collect_sample_arg);
+}
+
+static int32_t dds_rhc_sharded_take (struct dds_rhc *rhc_common, int32_t max_samples, uint32_t mask, dds_instance_handle_t handle, dds_readcond *cond, dds_read_with_collector_fn_t collect_sample, void *collect_sample_arg)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  return readtake_sharded (rhc, rhc->shards[0]->common.ops->take, max_samples, mask, handle, cond, collect_sample, collect_sample_arg);
+}
+
+static void lock_all_shards (struct dds_rhc_sharded *rhc)
+{
+  for (uint32_t i = 0; i < rhc->nshards; i++)
+    dds_rhc_default_lock (rhc->shards[i]);
+}
+
+static void unlock_all_shards (struct dds_rhc_sharded *rhc)
+{
+  for (uint32_t i = rhc->nshards; i > 0; i--)
+    dds_rhc_default_unlock (rhc->shards[i - 1]);
+}
+
+static bool dds_rhc_sharded_add_readcondition (struct dds_rhc *rhc_common, dds_readcond *cond)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  uint32_t trigger = 0;
+  bool ok;
+  assert (ddsrt_atomic_ld32 (&cond->m_entity.m_status.m_trigger) == 0);
+  lock_all_shards (rhc);
+  if ((ok = dds_rhc_default_add_readcondition_locked (rhc->shards[0], cond, true, &trigger)))
+  {
+    for (uint32_t i = 1; i < rhc->nshards; i++)
+    {
+      uint32_t t;
+      bool ok1 = dds_rhc_default_add_readcondition_locked (rhc->shards[i], cond, false, &t);
+      assert (ok1);
+      (void) ok1;
+      trigger += t;
+    }
+    if (trigger)
+    {
+      ddsrt_atomic_st32 (&cond->m_entity.m_status.m_trigger, trigger);
+      dds_entity_status_signal (&cond->m_entity);
+    }
+  }
+  unlock_all_shards (rhc);
+  return ok;
+}
+
+static void dds_rhc_sharded_remove_readcondition (struct dds_rhc *rhc_common, dds_readcond *cond)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  lock_all_shards (rhc);
+  for (uint32_t i = 0; i < rhc->nshards; i++)
+    dds_rhc_default_remove_readcondition_locked (rhc->shards[i], cond);
+  cond->m_query.m_qcmask = 0;
+  unlock_all_shards (rhc);
+}
+
+static void dds_rhc_sharded_get_slab_stats (struct dds_rhc *rhc_common, struct dds_rhc_slab_stats *stats)
+{
+  struct dds_rhc_sharded * const rhc = (struct dds_rhc_sharded *) rhc_common;
+  memset (stats, 0, sizeof (*stats));
+  for (uint32_t i = 0; i < rhc->nshards; i++)
+  {
+    struct dds_rhc_slab_stats st;
+    dds_rhc_get_slab_stats (rhc->shards[i], &st);
+    stats->samples_used += st.samples_used;
+    stats->samples_reserved += st.samples_reserved;
+    stats->instances_used += st.instances_used;
+    stats->instances_reserved += st.instances_reserved;
+  }
+}
+
+static const struct dds_rhc_ops dds_rhc_sharded_ops = {
+  .rhc_ops = {
+    .store = dds_rhc_sharded_store,
+    .unregister_wr = dds_rhc_sharded_unregister_wr,
+    .relinquish_ownership = dds_rhc_sharded_relinquish_ownership,
+    .free = dds_rhc_sharded_free
+  },
+  .peek = dds_rhc_sharded_peek,
+  .read = dds_rhc_sharded_read,
+  .take = dds_rhc_sharded_take,
+  .add_readcondition = dds_rhc_sharded_add_readcondition,
+  .remove_readcondition = dds_rhc_sharded_remove_readcondition,
+  .associate = dds_rhc_sharded_associate,
+  .get_slab_stats = dds_rhc_sharded_get_slab_stats
+};
@@ -17,6 +17,7 @@
 #include "dds/ddsrt/log.h"
 #include "dds/ddsrt/md5.h"
 #include "dds/ddsrt/mh3.h"
+#include "dds/ddsrt/threads.h"
 #include "dds/ddsi/ddsi_freelist.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/cdr/dds_cdrstream.h"
@@ -210,6 +211,16 @@ static struct dds_serdata_default *serdata_default_allocnew (struct dds_serdatap
   return d;
 }
 
+static struct dds_serdata_default *serdata_default_allocnew_s (struct dds_serdatapool *serpool, uint32_t init_size)
+{
+  struct dds_serdata_default *d = ddsrt_malloc_s (offsetof (struct dds_serdata_default, data) + init_size);
+  if (d == NULL)
+    return NULL;
+  d->size = init_size;
+  d->serpool = serpool;
+  return d;
+}
+
 static struct dds_serdata_default *serdata_default_new_size (const struct dds_sertype_default *tp, enum ddsi_serdata_kind kind, uint32_t size, uint32_t xcdr_version)
 {
   struct dds_serdata_default *d;
@@ -344,6 +355,33 @@ static bool gen_serdata_key_from_cdr (dds_istream_t *is, struct dds_serdata_defa
   return gen_serdata_key (type, kh, just_key ? GSKIK_CDRKEY : GSKIK_CDRSAMPLE, is);
 }
 
+/* Validate, normalize and extract the key from the serialized data in d, which
+   has a valid encoding identifier; unrefs d on failure */
+static struct dds_serdata_default *serdata_default_from_ser_fixup (const struct dds_sertype_default *tp, enum ddsi_serdata_kind kind, struct dds_serdata_default *d)
+{
+  const bool needs_bswap = !DDSI_RTPS_CDR_ENC_IS_NATIVE (d->hdr.identifier);
+  d->hdr.identifier = DDSI_RTPS_CDR_ENC_TO_NATIVE (d->hdr.identifier);
+  const uint32_t pad = ddsrt_fromBE2u (d->hdr.options) & DDS_CDR_HDR_PADDING_MASK;
+  const uint32_t xcdr_version = ddsi_sertype_enc_id_xcdr_version (d->hdr.identifier);
+  const uint32_t encoding_format = ddsi_sertype_enc_id_enc_format (d->hdr.identifier);
+  if (ddsi_sertype_get_native_enc_identifier (xcdr_version, encoding_format) != ddsi_sertype_get_native_enc_identifier (xcdr_version, tp->encoding_format))
+    goto err;
+
+  uint32_t actual_size;
+  if (d->pos < pad || !dds_stream_normalize (d->data, d->pos - pad, needs_bswap, xcdr_version, &tp->type, kind == SDK_KEY, &actual_size))
+    goto err;
+
+  dds_istream_t is;
+  dds_istream_init (&is, actual_size, d->data, xcdr_version);
+  if (!gen_serdata_key_from_cdr (&is, &d->key, tp, kind == SDK_KEY))
+    goto err;
+  return d;
+
+err:
+  ddsi_serdata_unref (&d->c);
+  return NULL;
+}
+
 /* Construct a serdata from a fragchain received over the network */
 static struct dds_serdata_default *serdata_default_from_ser_common (const struct ddsi_sertype *tpcmn, enum ddsi_serdata_kind kind, const struct ddsi_rdata *fragchain, size_t size)
   ddsrt_nonnull_all;
@@ -384,23 +422,7 @@ static struct dds_serdata_default *serdata_default_from_ser_common (const struct
     }
   }
 
-  const bool needs_bswap = !DDSI_RTPS_CDR_ENC_IS_NATIVE (d->hdr.identifier);
-  d->hdr.identifier = DDSI_RTPS_CDR_ENC_TO_NATIVE (d->hdr.identifier);
-  const uint32_t pad = ddsrt_fromBE2u (d->hdr.options) & DDS_CDR_HDR_PADDING_MASK;
-  const uint32_t xcdr_version = ddsi_sertype_enc_id_xcdr_version (d->hdr.identifier);
-  const uint32_t encoding_format = ddsi_sertype_enc_id_enc_format (d->hdr.identifier);
-  if (ddsi_sertype_get_native_enc_identifier (xcdr_version, encoding_format) != ddsi_sertype_get_native_enc_identifier (xcdr_version, tp->encoding_format))
-    goto err;
-
-  uint32_t actual_size;
-  if (d->pos < pad || !dds_stream_normalize (d->data, d->pos - pad, needs_bswap, xcdr_version, &tp->type, kind == SDK_KEY, &actual_size))
-    goto err;
-
-  dds_istream_t is;
-  dds_istream_init (&is, actual_size, d->data, xcdr_version);
-  if (!gen_serdata_key_from_cdr (&is, &d->key, tp, kind == SDK_KEY))
-    goto err;
-  return d;
+  return serdata_default_from_ser_fixup (tp, kind, d);
 
 err:
   ddsi_serdata_unref (&d->c);
@@ -431,23 +453,7 @@ static struct dds_serdata_default *serdata_default_from_ser_iov_common (const st
   for (ddsrt_msg_iovlen_t i = 1; i < niov; i++)
     serdata_default_append_blob (&d, iov[i].iov_len, iov[i].iov_base);
 
-  const bool needs_bswap = !DDSI_RTPS_CDR_ENC_IS_NATIVE (d->hdr.identifier);
-  d->hdr.identifier = DDSI_RTPS_CDR_ENC_TO_NATIVE (d->hdr.identifier);
-  const uint32_t pad = ddsrt_fromBE2u (d->hdr.options) & DDS_CDR_HDR_PADDING_MASK;
-  const uint32_t xcdr_version = ddsi_sertype_enc_id_xcdr_version (d->hdr.identifier);
-  const uint32_t encoding_format = ddsi_sertype_enc_id_enc_format (d->hdr.identifier);
-  if (ddsi_sertype_get_native_enc_identifier (xcdr_version, encoding_format) != ddsi_sertype_get_native_enc_identifier (xcdr_version, tp->encoding_format))
-    goto err;
-
-  uint32_t actual_size;
-  if (d->pos < pad || !dds_stream_normalize (d->data, d->pos - pad, needs_bswap, xcdr_version, &tp->type, kind == SDK_KEY, &actual_size))
-    goto err;
-
-  dds_istream_t is;
-  dds_istream_init (&is, actual_size, d->data, xcdr_version);
-  if (!gen_serdata_key_from_cdr (&is, &d->key, tp, kind == SDK_KEY))
-    goto err;
-  return d;
+  return serdata_default_from_ser_fixup (tp, kind, d);
 
 err:
   ddsi_serdata_unref (&d->c);
@@ -486,6 +492,56 @@ static struct ddsi_serdata *serdata_default_from_ser_iov_nokey (const struct dds
   return fix_serdata_default_nokey (d, tpcmn->serdata_basehash);
 }
 
+static struct ddsi_serdata *serdata_default_from_ser_prealloc (const struct ddsi_sertype *tpcmn, enum ddsi_serdata_kind kind, size_t size, void **buf)
+{
+  const struct dds_sertype_default *tp = (const struct dds_sertype_default *)tpcmn;
+  if (size < sizeof (struct dds_cdr_header) || size > UINT32_MAX - offsetof (struct dds_serdata_default, hdr))
+    return NULL;
+  struct dds_serdata_default *d;
+  if (size <= MAX_SIZE_FOR_POOL)
+    d = serdata_default_new_size (tp, kind, (uint32_t) size, DDSI_RTPS_CDR_ENC_VERSION_UNDEF);
+  else
+  {
+    /* the size is whatever the sender claims, so failing to allocate it must not be fatal */
+    if ((d = serdata_default_allocnew_s (tp->serpool, (uint32_t) size)) != NULL)
+      serdata_default_init (d, tp, kind, DDSI_RTPS_CDR_ENC_VERSION_UNDEF);
+  }
+  if (d == NULL)
+    return NULL;
+  /* the header is immediately followed by the data, so the caller gets to see one
+     contiguous buffer; appending also grows a recycled serdata if it is too small */
+  (void) serdata_default_append (&d, size - sizeof (struct dds_cdr_header));
+  *buf = &d->hdr;
+  return &d->c;
+}
+
+static struct dds_serdata_default *serdata_default_from_ser_finish_common (struct ddsi_serdata *dcmn)
+{
+  struct dds_serdata_default *d = (struct dds_serdata_default *) dcmn;
+  if (!is_valid_xcdr_id (d->hdr.identifier))
+  {
+    ddsi_serdata_unref (&d->c);
+    return NULL;
+  }
+  return serdata_default_from_ser_fixup ((const struct dds_sertype_default *) d->c.type, d->c.kind, d);
+}
+
+static struct ddsi_serdata *serdata_default_from_ser_finish (struct ddsi_serdata *dcmn)
+{
+  struct dds_serdata_default *d;
+  if ((d = serdata_default_from_ser_finish_common (dcmn)) == NULL)
+    return NULL;
+  return fix_serdata_default (d, d->c.type->serdata_basehash);
+}
+
+static struct ddsi_serdata *serdata_default_from_ser_finish_nokey (struct ddsi_serdata *dcmn)
+{
+  struct dds_serdata_default *d;
+  if ((d = serdata_default_from_ser_finish_common (dcmn)) == NULL)
+    return NULL;
+  return fix_serdata_default_nokey (d, d->c.type->serdata_basehash);
+}
+
 static struct ddsi_serdata *serdata_default_from_keyhash_cdr (const struct ddsi_sertype *tpcmn, const ddsi_keyhash_t *keyhash)
 {
   const struct dds_sertype_default *tp = (const struct dds_sertype_default *)tpcmn;
@@ -569,7 +625,10 @@ static void ostream_add_to_serdata_default (dds_ostream_t *s, struct dds_serdata
 static struct dds_serdata_default *serdata_default_from_sample_cdr_common (const struct ddsi_sertype *tpcmn, enum ddsi_serdata_kind kind, uint32_t xcdr_version, const void *sample)
 {
   const struct dds_sertype_default *tp = (const struct dds_sertype_default *)tpcmn;
-  struct dds_serdata_default *d = serdata_default_new(tp, kind, xcdr_version);
+  // size the serdata so that it needn't grow while serializing if the size is known
+  const size_t fixed_size = (kind != SDK_DATA) ? 0 : (xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_1) ? tp->type.fixed_size_xcdr1 : tp->type.fixed_size_xcdr2;
+  const uint32_t init_size = (fixed_size > DEFAULT_NEW_SIZE) ? (uint32_t) alignup_size (fixed_size, 4) : DEFAULT_NEW_SIZE;
+  struct dds_serdata_default *d = serdata_default_new_size (tp, kind, init_size, xcdr_version);
   if (d == NULL)
     return NULL;
 
@@ -716,12 +775,92 @@ static void serdata_default_to_ser_unref (struct ddsi_serdata *serdata_common, c
   ddsi_serdata_unref(serdata_common);
 }
 
+/* Deserializing into memory provided by the caller (bufptr != NULL) bump-allocates the
+   strings, sequences and external members of the sample from [*bufptr, buflim).  The
+   cdrstream allocator interface has no context argument, so the bump allocator state is
+   passed via a thread-local variable.  Deserialization can't stop half-way, so if the
+   space runs out the remaining allocations go to the heap; these are freed again once
+   the sample is complete and the conversion fails without consuming any space. */
+struct bump_alloc {
+  char *start;
+  char *pos;
+  char *lim;
+  bool overflow;
+};
+
+#define BUMP_ALLOC_ALIGN 8u
+
+static ddsrt_thread_local struct bump_alloc *bump_alloc_state;
+
+static bool in_bump_region (const struct bump_alloc *ba, const void *ptr)
+{
+  return (const char *) ptr >= ba->start && (const char *) ptr <= ba->lim;
+}
+
+static void *bump_malloc (size_t size)
+{
+  struct bump_alloc * const ba = bump_alloc_state;
+  const uintptr_t a = ((uintptr_t) ba->pos + BUMP_ALLOC_ALIGN - 1) & ~(uintptr_t) (BUMP_ALLOC_ALIGN - 1);
+  if (a <= (uintptr_t) ba->lim && size <= (size_t) ((uintptr_t) ba->lim - a))
+  {
+    ba->pos = (char *) a + size;
+    return (char *) a;
+  }
+  ba->overflow = true;
+  return ddsrt_malloc (size);
+}
+
+static void *bump_realloc (void *ptr, size_t size)
+{
+  struct bump_alloc * const ba = bump_alloc_state;
+  if (ptr == NULL)
+    return bump_malloc (size);
+  else if (!in_bump_region (ba, ptr))
+    return ddsrt_realloc (ptr, size);
+  else
+  {
+    // the old block ends at or before pos, so copying up to pos copies all of it
+    const size_t avail = (size_t) (ba->pos - (char *) ptr);
+    void *nptr = bump_malloc (size);
+    memcpy (nptr, ptr, size < avail ? size : avail);
+    return nptr;
+  }
+}
+
+static void bump_free (void *ptr)
+{
+  if (ptr != NULL && !in_bump_region (bump_alloc_state, ptr))
+    ddsrt_free (ptr);
+}
+
+static const struct dds_cdrstream_allocator bump_allocator = { bump_malloc, bump_realloc, bump_free };
+
+static bool read_sample_into_buffer (dds_istream_t *is, bool just_key, void *sample, void **bufptr, void *buflim, const struct dds_sertype_default *tp)
+{
+  struct bump_alloc ba = { .start = *bufptr, .pos = *bufptr, .lim = buflim, .overflow = false };
+  assert (bump_alloc_state == NULL);
+  bump_alloc_state = &ba;
+  if (just_key)
+    dds_stream_read_key (is, sample, &bump_allocator, &tp->type);
+  else
+    dds_stream_read_sample (is, sample, &bump_allocator, &tp->type);
+  if (ba.overflow)
+  {
+    dds_stream_free_sample (sample, &bump_allocator, tp->type.ops.ops);
+    ddsi_sertype_zero_sample (&tp->c, sample);
+  }
+  bump_alloc_state = NULL;
+  if (ba.overflow)
+    return false;
+  *bufptr = ba.pos;
+  return true;
+}
+
 static bool serdata_default_to_sample_cdr (const struct ddsi_serdata *serdata_common, void *sample, void **bufptr, void *buflim)
 {
   const struct dds_serdata_default *d = (const struct dds_serdata_default *)serdata_common;
   const struct dds_sertype_default *tp = (const struct dds_sertype_default *) d->c.type;
   dds_istream_t is;
-  if (bufptr) abort(); else { (void)buflim; } /* FIXME: haven't implemented that bit yet! */
   if (d->c.loan != NULL &&
       tp->c.is_memcpy_safe &&
       (d->c.loan->metadata->sample_state == DDS_LOANED_SAMPLE_STATE_RAW_DATA ||
@@ -734,7 +873,9 @@ static bool serdata_default_to_sample_cdr (const struct ddsi_serdata *serdata_co
   {
     assert (DDSI_RTPS_CDR_ENC_IS_NATIVE (d->hdr.identifier));
     istream_from_serdata_default (&is, d);
-    if (d->c.kind == SDK_KEY)
+    if (bufptr)
+      return read_sample_into_buffer (&is, d->c.kind == SDK_KEY, sample, bufptr, buflim, tp);
+    else if (d->c.kind == SDK_KEY)
       dds_stream_read_key (&is, sample, &dds_cdrstream_default_allocator, &tp->type);
     else
       dds_stream_read_sample (&is, sample, &dds_cdrstream_default_allocator, &tp->type);
@@ -751,8 +892,9 @@ static bool serdata_default_untyped_to_sample_cdr (const struct ddsi_sertype *se
   assert (d->c.kind == SDK_KEY);
   assert (d->c.ops == sertype_common->serdata_ops);
   assert (DDSI_RTPS_CDR_ENC_IS_NATIVE (d->hdr.identifier));
-  if (bufptr) abort(); else { (void)buflim; } /* FIXME: haven't implemented that bit yet! */
   dds_istream_init (&is, d->key.keysize, serdata_default_keybuf (d), DDSI_RTPS_CDR_ENC_VERSION_2);
+  if (bufptr)
+    return read_sample_into_buffer (&is, true, sample, bufptr, buflim, tp);
   dds_stream_read_key (&is, sample, &dds_cdrstream_default_allocator, &tp->type);
   return true; /* FIXME: can't conversion to sample fail? */
 }
@@ -989,7 +1131,9 @@ const struct ddsi_serdata_ops dds_serdata_ops_cdr = {
   .print = serdata_default_print_cdr,
   .get_keyhash = serdata_default_get_keyhash,
   .from_loaned_sample = serdata_default_from_loaned_sample,
-  .from_psmx = serdata_default_from_psmx
+  .from_psmx = serdata_default_from_psmx,
+  .from_ser_prealloc = serdata_default_from_ser_prealloc,
+  .from_ser_finish = serdata_default_from_ser_finish
 };
 
 const struct ddsi_serdata_ops dds_serdata_ops_xcdr2 = {
@@ -1009,7 +1153,9 @@ const struct ddsi_serdata_ops dds_serdata_ops_xcdr2 = {
   .print = serdata_default_print_cdr,
   .get_keyhash = serdata_default_get_keyhash,
   .from_loaned_sample = serdata_default_from_loaned_sample,
-  .from_psmx = serdata_default_from_psmx
+  .from_psmx = serdata_default_from_psmx,
+  .from_ser_prealloc = serdata_default_from_ser_prealloc,
+  .from_ser_finish = serdata_default_from_ser_finish
 };
 
 const struct ddsi_serdata_ops dds_serdata_ops_cdr_nokey = {
@@ -1029,7 +1175,9 @@ const struct ddsi_serdata_ops dds_serdata_ops_cdr_nokey = {
   .print = serdata_default_print_cdr,
   .get_keyhash = serdata_default_get_keyhash,
   .from_loaned_sample = serdata_default_from_loaned_sample,
-  .from_psmx = serdata_default_from_psmx
+  .from_psmx = serdata_default_from_psmx,
+  .from_ser_prealloc = serdata_default_from_ser_prealloc,
+  .from_ser_finish = serdata_default_from_ser_finish_nokey
 };
 
 const struct ddsi_serdata_ops dds_serdata_ops_xcdr2_nokey = {
@@ -1049,5 +1197,7 @@ const struct ddsi_serdata_ops dds_serdata_ops_xcdr2_nokey = {
   .print = serdata_default_print_cdr,
   .get_keyhash = serdata_default_get_keyhash,
   .from_loaned_sample = serdata_default_from_loaned_sample,
-  .from_psmx = serdata_default_from_psmx
+  .from_psmx = serdata_default_from_psmx,
+  .from_ser_prealloc = serdata_default_from_ser_prealloc,
+  .from_ser_finish = serdata_default_from_ser_finish_nokey
 };
@@ -18,6 +18,7 @@
 #include "dds/ddsrt/mh3.h"
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/string.h"
+#include "dds/ddsrt/threads.h"
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_freelist.h"
 #include "dds/ddsi/ddsi_xqos.h"
@@ -273,6 +274,108 @@ static bool sertype_default_serialize_into (const struct ddsi_sertype *tpcmn, en
     return dds_stream_write_sample (&os, &no_allocator, sample, &tp->type);
 }
 
+/* Thread-local buffer for serializing samples of which the size isn't known in advance.
+   It is kept for the next sample written by the same thread and grows geometrically,
+   so that in steady state a sample gets serialized in a single pass without computing
+   its size first and without any allocations. It is freed when the thread terminates,
+   or after use if it grew beyond SERIALIZE_SCRATCH_RETAIN_MAX, so that a thread that
+   once wrote a very large sample doesn't hold on to that memory forever. */
+#define SERIALIZE_SCRATCH_RETAIN_MAX (1u << 20)
+
+struct serialize_scratch {
+  unsigned char *buf;
+  uint32_t size;
+  bool cleanup_registered;
+};
+
+static ddsrt_thread_local struct serialize_scratch serialize_scratch;
+
+static void serialize_scratch_fini (void *arg)
+{
+  (void) arg;
+  ddsrt_free (serialize_scratch.buf);
+  serialize_scratch.buf = NULL;
+  serialize_scratch.size = 0;
+}
+
+static void *serialize_scratch_realloc (void *ptr, size_t size)
+{
+  // the output stream is the only user, and it only ever grows the scratch buffer
+  assert (ptr == serialize_scratch.buf);
+  (void) ptr;
+  if (size > serialize_scratch.size)
+  {
+    size_t new_size = 2 * (size_t) serialize_scratch.size;
+    if (new_size < size)
+      new_size = size;
+    if (new_size > UINT32_MAX)
+      new_size = UINT32_MAX;
+    if (!serialize_scratch.cleanup_registered)
+    {
+      ddsrt_thread_cleanup_push (serialize_scratch_fini, NULL);
+      serialize_scratch.cleanup_registered = true;
+    }
+    serialize_scratch.buf = ddsrt_realloc (serialize_scratch.buf, new_size);
+    serialize_scratch.size = (uint32_t) new_size;
+  }
+  return serialize_scratch.buf;
+}
+
+static void *serialize_scratch_malloc (size_t size)
+{
+  return serialize_scratch_realloc (serialize_scratch.buf, size);
+}
+
+static void serialize_scratch_free (void *ptr)
+{
+  // retained for the next sample
+  (void) ptr;
+}
+
+static const struct dds_cdrstream_allocator serialize_scratch_allocator = { serialize_scratch_malloc, serialize_scratch_realloc, serialize_scratch_free };
+
+bool dds_sertype_default_serialize_scratch (const struct ddsi_sertype *tpcmn, enum ddsi_serdata_kind sdkind, const void *sample, const void **buf, size_t *size, uint16_t *enc_identifier)
+{
+  const struct dds_sertype_default *tp = (const struct dds_sertype_default *) tpcmn;
+  assert (tpcmn->ops == &dds_sertype_ops_default);
+  dds_ostream_t os = {
+    .m_buffer = serialize_scratch.buf,
+    .m_size = serialize_scratch.size,
+    .m_index = 0,
+    .m_xcdr_version = tp->write_encoding_version
+  };
+  bool ok;
+  if (sdkind == SDK_KEY)
+    ok = dds_stream_write_key (&os, DDS_CDR_KEY_SERIALIZATION_SAMPLE, &serialize_scratch_allocator, sample, &tp->type);
+  else
+    ok = dds_stream_write_sample (&os, &serialize_scratch_allocator, sample, &tp->type);
+  if (!ok)
+    return false;
+  *buf = os.m_buffer;
+  *size = os.m_index;
+  *enc_identifier = ddsi_sertype_get_native_enc_identifier (tp->write_encoding_version, tp->encoding_format);
+  return true;
+}
+
+void dds_sertype_default_serialize_scratch_done (void)
+{
+  if (serialize_scratch.size > SERIALIZE_SCRATCH_RETAIN_MAX)
+  {
+    ddsrt_free (serialize_scratch.buf);
+    serialize_scratch.buf = NULL;
+    serialize_scratch.size = 0;
+  }
+}
+
+bool dds_sertype_default_has_fixed_serialized_size (const struct ddsi_sertype *tpcmn, enum ddsi_serdata_kind sdkind)
+{
+  const struct dds_sertype_default *tp = (const struct dds_sertype_default *) tpcmn;
+  assert (tpcmn->ops == &dds_sertype_ops_default);
+  if (sdkind == SDK_KEY)
+    return false;
+  return ((tp->write_encoding_version == DDSI_RTPS_CDR_ENC_VERSION_1) ? tp->type.fixed_size_xcdr1 : tp->type.fixed_size_xcdr2) > 0;
+}
+
 const struct ddsi_sertype_ops dds_sertype_ops_default = {
   .version = ddsi_sertype_v0,
   .arg = 0,
@@ -333,6 +436,8 @@ dds_return_t dds_sertype_default_init (const struct dds_domain *domain, struct d
   st->serpool = domain->serpool;
 
   dds_cdrstream_desc_init_with_nops (&st->type, &dds_cdrstream_default_allocator, desc->m_size, desc->m_align, desc->m_flagset, desc->m_ops, desc->m_nops, desc->m_keys, desc->m_nkeys);
+  if (desc->m_flagset & DDS_TOPIC_SPECIALIZED_OPS)
+    st->type.specialized = desc->specialized_ops;
 
   if (min_xcdrv == DDSI_RTPS_CDR_ENC_VERSION_2 && dds_stream_type_nesting_depth (desc->m_ops) > DDS_CDRSTREAM_MAX_NESTING_DEPTH)
   {
@@ -371,5 +476,29 @@ dds_return_t dds_sertype_default_init (const struct dds_domain *domain, struct d
   if (st->type.opt_size_xcdr2 > 0)
     GVTRACE ("Marshalling XCDR2 for type: %s is %soptimised\n", st->c.type_name, st->type.opt_size_xcdr2 ? "" : "not ");
 
+  /* Types that can't be copied as a whole may still consist of contiguous blocks that
+     can be copied, separated by strings and sequences */
+  if (st->type.opt_size_xcdr1 == 0 && (st->c.allowed_data_representation & DDS_DATA_REPRESENTATION_FLAG_XCDR1))
+    st->type.plan_xcdr1 = dds_stream_memcpy_plan (&st->type, &dds_cdrstream_default_allocator, DDSI_RTPS_CDR_ENC_VERSION_1);
+  if (st->type.opt_size_xcdr2 == 0 && (st->c.allowed_data_representation & DDS_DATA_REPRESENTATION_FLAG_XCDR2))
+    st->type.plan_xcdr2 = dds_stream_memcpy_plan (&st->type, &dds_cdrstream_default_allocator, DDSI_RTPS_CDR_ENC_VERSION_2);
+  if (st->type.plan_xcdr1 || st->type.plan_xcdr2)
+    GVTRACE ("Marshalling for type: %s uses a memcpy plan\n", st->c.type_name);
+
+  /* Extracting the key from received data needn't look at anything following the last
+     key member, and adjacent key members can be copied at once */
+  st->type.key_plan = dds_stream_key_plan (&st->type, &dds_cdrstream_default_allocator);
+  if (st->type.key_plan)
+    GVTRACE ("Key extraction for type: %s uses a plan\n", st->c.type_name);
+
+  /* The serialized size of types without strings, sequences, unions, optionals and mutable
+     types doesn't depend on the sample, so there is no need to compute it for each sample */
+  if (st->c.allowed_data_representation & DDS_DATA_REPRESENTATION_FLAG_XCDR1)
+    st->type.fixed_size_xcdr1 = dds_stream_fixed_serialized_size (&st->type, &dds_cdrstream_default_allocator, DDSI_RTPS_CDR_ENC_VERSION_1);
+  if (st->c.allowed_data_representation & DDS_DATA_REPRESENTATION_FLAG_XCDR2)
+    st->type.fixed_size_xcdr2 = dds_stream_fixed_serialized_size (&st->type, &dds_cdrstream_default_allocator, DDSI_RTPS_CDR_ENC_VERSION_2);
+  if (st->type.fixed_size_xcdr1 || st->type.fixed_size_xcdr2)
+    GVTRACE ("Serialized size for type: %s is fixed (XCDR1 %"PRIuSIZE", XCDR2 %"PRIuSIZE")\n", st->c.type_name, st->type.fixed_size_xcdr1, st->type.fixed_size_xcdr2);
+
   return DDS_RETCODE_OK;
 }
@@ -1176,4 +1176,6 @@ void dds_cdrstream_desc_from_topic_desc (struct dds_cdrstream_desc *desc, const
   memset (desc, 0, sizeof (*desc));
   dds_cdrstream_desc_init_with_nops (desc, &dds_cdrstream_default_allocator, topic_desc->m_size, topic_desc->m_align, topic_desc->m_flagset,
       topic_desc->m_ops, topic_desc->m_nops, topic_desc->m_keys, topic_desc->m_nkeys);
+  if (topic_desc->m_flagset & DDS_TOPIC_SPECIALIZED_OPS)
+    desc->specialized = topic_desc->specialized_ops;
 }
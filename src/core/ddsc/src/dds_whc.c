@@ -32,6 +32,7 @@
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_entity.h"
 #include "dds__whc.h"
+#include "dds__whc_ring.h"
 #include "dds__entity.h"
 #include "dds__writer.h"
 
@@ -442,6 +443,25 @@ void dds_whc_free_wrinfo (struct whc_writer_info *info)
   ddsrt_free (info);
 }
 
+static bool whc_ring_applicable (const struct ddsi_domaingv *gv, const struct whc_writer_info *wrinfo)
+{
+  /* A keyless topic has a single instance, and if there is no need to keep data for late
+     joiners nor track deadlines or lifespans, all that is needed is the samples in order
+     of sequence number.  Both QoS can be changed later: the ring then expires samples
+     in order of sequence number, and a deadline is only ever tracked by the WHC if it
+     was set when the writer was created. */
+  if (!gv->config.whc_ring || wrinfo->writer == NULL)
+    return false;
+  if (wrinfo->is_transient_local || wrinfo->has_deadline || wrinfo->writer->m_topic->m_stype->has_key)
+    return false;
+#ifdef DDS_HAS_LIFESPAN
+  const dds_qos_t *qos = wrinfo->writer->m_entity.m_qos;
+  if ((qos->present & DDSI_QP_LIFESPAN) && qos->lifespan.duration != DDS_INFINITY)
+    return false;
+#endif
+  return true;
+}
+
 struct ddsi_whc *dds_whc_new (struct ddsi_domaingv *gv, const struct whc_writer_info *wrinfo)
 {
   size_t sample_overhead = 80; /* INFO_TS, DATA (estimate), inline QoS */
@@ -450,6 +470,9 @@ struct ddsi_whc *dds_whc_new (struct ddsi_domaingv *gv, const struct whc_writer_
 
   assert ((wrinfo->hdepth == 0 || wrinfo->tldepth <= wrinfo->hdepth) || wrinfo->is_transient_local);
 
+  if (whc_ring_applicable (gv, wrinfo))
+    return dds_whc_ring_new (gv, wrinfo->hdepth);
+
   whc = ddsrt_malloc (sizeof (*whc));
   whc->common.ops = &whc_ops;
   ddsrt_mutex_init (&whc->lock);
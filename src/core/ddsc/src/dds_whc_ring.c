@@ -0,0 +1,661 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/misc.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_unused.h"
+#include "dds/ddsi/ddsi_tkmap.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "dds/ddsi/ddsi_xevent.h"
+#include "dds__whc_ring.h"
+
+/* WHC for writers of keyless topics that are volatile and have neither a deadline nor a
+   lifespan.  There is only a single instance and no need for retaining any data for late
+   joining readers, so the instance index of the default WHC degenerates to the sequence
+   numbers of the last "hdepth" samples and the samples can be stored by value in a
+   power-of-two sized array indexed by "seq & mask".  Looking up a sequence number, finding
+   the next one and dropping acknowledged samples then require neither a hash table nor an
+   interval tree, and there are no allocations per sample.
+
+   The sequence numbers need not be consecutive: there may be gaps in the sequence and
+   KEEP_LAST pruning and unregisters can delete samples in the middle.  Such "holes" are
+   slots without a serdata.  The array covers [free_seq,maxp1_seq):
+
+   - [free_seq,min_seq) are acknowledged samples that have been handed out as the deferred
+     free list by remove_acked_messages and that are released when free_deferred_free_list
+     is called, i.e., outside the writer lock, just like in the default WHC;
+   - [min_seq,maxp1_seq) are the samples in the WHC, neither min_seq nor maxp1_seq-1 is a
+     hole (unless the WHC is empty, i.e., min_seq = maxp1_seq).
+
+   All slots outside [free_seq,maxp1_seq) are empty and the array grows by doubling when
+   (maxp1_seq - free_seq) would exceed its size.
+
+   The lifespan QoS can be changed after creating the writer, and so samples may still
+   come with an expiry time.  These are expired from the tail: a single timed event
+   removes the oldest samples for as long as they have expired.  If the lifespan remains
+   the same, the expiry times increase with the sequence numbers (barring source
+   timestamps going back in time); if it is shortened, a sample may be retained until
+   the older samples have expired as well. */
+
+#define WHC_RING_INIT_SIZE 64u
+#define WHC_RING_SHRINK_SIZE 4096u
+#define WHC_RING_FREE_BATCH 32u
+
+struct whc_ring_slot {
+  struct ddsi_serdata *serdata; /* NULL if hole */
+  size_t size;
+  unsigned unacked: 1; /* counted in whc::unacked_bytes iff 1 */
+  unsigned borrowed: 1; /* at most one can borrow it at any time */
+  uint32_t rexmit_count;
+  ddsrt_mtime_t last_rexmit_ts;
+#ifdef DDS_HAS_LIFESPAN
+  ddsrt_mtime_t t_expire;
+#endif
+};
+
+struct whc_ring {
+  struct ddsi_whc common;
+  ddsrt_mutex_t lock;
+  struct ddsi_domaingv *gv;
+  struct ddsi_tkmap *tkmap;
+  size_t sample_overhead;
+  uint32_t fragment_size;
+  uint32_t hdepth; /* 0 = unlimited */
+  uint32_t seq_size; /* number of samples in [min_seq,maxp1_seq) */
+  size_t unacked_bytes;
+  ddsi_seqno_t max_drop_seq;
+  ddsi_seqno_t free_seq;
+  ddsi_seqno_t min_seq;
+  ddsi_seqno_t maxp1_seq;
+  uint32_t mask;
+  struct whc_ring_slot *slots;
+  struct ddsi_tkmap_instance *tk; /* non-NULL iff the instance is registered */
+  uint32_t headidx;
+  ddsi_seqno_t *hist; /* circular array of hdepth seqs of the latest samples, 0 if none */
+  struct ddsi_whc_node deferred_free_marker; /* returned as deferred free list */
+#ifdef DDS_HAS_LIFESPAN
+  struct ddsi_xevent *lifespan_xev; /* created on inserting the first sample that can expire */
+#endif
+};
+
+struct ddsi_whc_sample_iter_impl {
+  struct ddsi_whc_sample_iter_base c;
+  bool first;
+};
+
+/* check that our definition of whc_sample_iter fits in the type that callers allocate */
+DDSRT_STATIC_ASSERT (sizeof (struct ddsi_whc_sample_iter_impl) <= sizeof (struct ddsi_whc_sample_iter));
+
+#define TRACE(...) DDS_CLOG (DDS_LC_WHC, &whc->gv->logconfig, __VA_ARGS__)
+
+static struct whc_ring_slot *whc_ring_slot (const struct whc_ring *whc, ddsi_seqno_t seq)
+{
+  return &whc->slots[seq & whc->mask];
+}
+
+static struct whc_ring_slot *whc_ring_lookup (const struct whc_ring *whc, ddsi_seqno_t seq)
+{
+  if (seq < whc->min_seq || seq >= whc->maxp1_seq)
+    return NULL;
+  struct whc_ring_slot * const s = whc_ring_slot (whc, seq);
+  return (s->serdata != NULL) ? s : NULL;
+}
+
+static void whc_ring_check (const struct whc_ring *whc)
+{
+  assert (whc->free_seq <= whc->min_seq && whc->min_seq <= whc->maxp1_seq);
+  assert (whc->maxp1_seq - whc->free_seq <= (ddsi_seqno_t) whc->mask + 1);
+  assert ((whc->seq_size == 0) == (whc->min_seq == whc->maxp1_seq));
+  assert (whc->seq_size == 0 || whc_ring_slot (whc, whc->min_seq)->serdata != NULL);
+  assert (whc->seq_size == 0 || whc_ring_slot (whc, whc->maxp1_seq - 1)->serdata != NULL);
+  assert (whc->seq_size == 0 || whc->unacked_bytes == 0 || whc->max_drop_seq < whc->maxp1_seq - 1);
+  (void) whc;
+}
+
+static size_t whc_ring_sample_size (const struct whc_ring *whc, const struct ddsi_serdata *serdata)
+{
+  size_t sz = ddsi_serdata_size (serdata);
+  return sz + ((sz + whc->fragment_size - 1) / whc->fragment_size) * whc->sample_overhead;
+}
+
+static const struct ddsi_whc_ops whc_ring_ops;
+
+struct ddsi_whc *dds_whc_ring_new (struct ddsi_domaingv *gv, uint32_t hdepth)
+{
+  struct whc_ring *whc = ddsrt_malloc (sizeof (*whc));
+  whc->common.ops = &whc_ring_ops;
+  ddsrt_mutex_init (&whc->lock);
+  whc->gv = gv;
+  whc->tkmap = gv->m_tkmap;
+  whc->sample_overhead = 80; /* INFO_TS, DATA (estimate), inline QoS */
+  whc->fragment_size = gv->config.fragment_size;
+  whc->hdepth = hdepth;
+  whc->seq_size = 0;
+  whc->unacked_bytes = 0;
+  whc->max_drop_seq = 0;
+  whc->free_seq = whc->min_seq = whc->maxp1_seq = 1;
+  whc->mask = WHC_RING_INIT_SIZE - 1;
+  whc->slots = ddsrt_calloc (WHC_RING_INIT_SIZE, sizeof (*whc->slots));
+  whc->tk = NULL;
+  whc->headidx = 0;
+  whc->hist = (hdepth > 0) ? ddsrt_malloc (hdepth * sizeof (*whc->hist)) : NULL;
+  whc->deferred_free_marker.seq = 0;
+#ifdef DDS_HAS_LIFESPAN
+  whc->lifespan_xev = NULL;
+#endif
+  return &whc->common;
+}
+
+static void whc_ring_free (struct ddsi_whc *whc_generic)
+{
+  struct whc_ring * const whc = (struct whc_ring *) whc_generic;
+#ifdef DDS_HAS_LIFESPAN
+  if (whc->lifespan_xev)
+    ddsi_delete_xevent (whc->lifespan_xev);
+#endif
+  whc_ring_check (whc);
+  for (ddsi_seqno_t seq = whc->free_seq; seq < whc->maxp1_seq; seq++)
+  {
+    struct whc_ring_slot * const s = whc_ring_slot (whc, seq);
+    /* a borrowed sample that has been acknowledged is released by whoever borrowed it */
+    if (s->serdata && (seq >= whc->min_seq || !s->borrowed))
+      ddsi_serdata_unref (s->serdata);
+  }
+  if (whc->tk)
+    ddsi_tkmap_instance_unref (whc->tkmap, whc->tk);
+  ddsrt_free (whc->hist);
+  ddsrt_free (whc->slots);
+  ddsrt_mutex_destroy (&whc->lock);
+  ddsrt_free (whc);
+}
+
+static void get_state_locked (const struct whc_ring *whc, struct ddsi_whc_state *st)
+{
+  if (whc->seq_size == 0)
+  {
+    st->min_seq = st->max_seq = 0;
+    st->unacked_bytes = 0;
+  }
+  else
+  {
+    st->min_seq = whc->min_seq;
+    st->max_seq = whc->maxp1_seq - 1;
+    st->unacked_bytes = whc->unacked_bytes;
+  }
+}
+
+static void whc_ring_get_state (const struct ddsi_whc *whc_generic, struct ddsi_whc_state *st)
+{
+  const struct whc_ring * const whc = (const struct whc_ring *) whc_generic;
+  ddsrt_mutex_lock ((ddsrt_mutex_t *) &whc->lock);
+  whc_ring_check (whc);
+  get_state_locked (whc, st);
+  ddsrt_mutex_unlock ((ddsrt_mutex_t *) &whc->lock);
+}
+
+static ddsi_seqno_t next_seq_locked (const struct whc_ring *whc, ddsi_seqno_t seq)
+{
+  ddsi_seqno_t nseq = (seq < whc->min_seq) ? whc->min_seq : seq + 1;
+  while (nseq < whc->maxp1_seq && whc_ring_slot (whc, nseq)->serdata == NULL)
+    nseq++;
+  return (nseq < whc->maxp1_seq) ? nseq : DDSI_MAX_SEQ_NUMBER;
+}
+
+static ddsi_seqno_t whc_ring_next_seq (const struct ddsi_whc *whc_generic, ddsi_seqno_t seq)
+{
+  const struct whc_ring * const whc = (const struct whc_ring *) whc_generic;
+  ddsi_seqno_t nseq;
+  ddsrt_mutex_lock ((ddsrt_mutex_t *) &whc->lock);
+  whc_ring_check (whc);
+  nseq = next_seq_locked (whc, seq);
+  ddsrt_mutex_unlock ((ddsrt_mutex_t *) &whc->lock);
+  return nseq;
+}
+
+static void whc_ring_trim (struct whc_ring *whc)
+{
+  /* Restores the invariant that the first and last samples are not holes, if the deferred
+     free range is empty, it remains empty */
+  const bool no_deferred = (whc->free_seq == whc->min_seq);
+  while (whc->min_seq < whc->maxp1_seq && whc_ring_slot (whc, whc->min_seq)->serdata == NULL)
+    whc->min_seq++;
+  while (whc->maxp1_seq > whc->min_seq && whc_ring_slot (whc, whc->maxp1_seq - 1)->serdata == NULL)
+    whc->maxp1_seq--;
+  if (no_deferred)
+    whc->free_seq = whc->min_seq;
+}
+
+static void whc_ring_delete_one (struct whc_ring *whc, ddsi_seqno_t seq)
+{
+  struct whc_ring_slot * const s = whc_ring_slot (whc, seq);
+  assert (whc_ring_lookup (whc, seq) == s);
+  TRACE (" delete %"PRIu64, seq);
+  if (s->unacked)
+  {
+    assert (whc->unacked_bytes >= s->size);
+    whc->unacked_bytes -= s->size;
+  }
+  /* a borrowed sample gets released on returning it because it no longer exists */
+  if (!s->borrowed)
+    ddsi_serdata_unref (s->serdata);
+  s->serdata = NULL;
+  s->unacked = 0;
+  s->borrowed = 0;
+  whc->seq_size--;
+  whc_ring_trim (whc);
+}
+
+static void whc_ring_release_deferred_locked (struct whc_ring *whc)
+{
+  for (; whc->free_seq < whc->min_seq; whc->free_seq++)
+  {
+    struct whc_ring_slot * const s = whc_ring_slot (whc, whc->free_seq);
+    if (s->serdata)
+    {
+      if (!s->borrowed)
+        ddsi_serdata_unref (s->serdata);
+      s->serdata = NULL;
+      s->borrowed = 0;
+    }
+  }
+}
+
+static void whc_ring_resize (struct whc_ring *whc, uint32_t size)
+{
+  struct whc_ring_slot * const slots = ddsrt_calloc (size, sizeof (*slots));
+  const uint32_t mask = size - 1;
+  assert ((size & mask) == 0);
+  assert (whc->maxp1_seq - whc->free_seq <= size);
+  for (ddsi_seqno_t seq = whc->free_seq; seq < whc->maxp1_seq; seq++)
+    slots[seq & mask] = *whc_ring_slot (whc, seq);
+  ddsrt_free (whc->slots);
+  whc->slots = slots;
+  whc->mask = mask;
+}
+
+static void whc_ring_make_room (struct whc_ring *whc, ddsi_seqno_t seq)
+{
+  /* Slots [free_seq,seq] are needed, which may mean growing the ring, but it is better to
+     first release any acknowledged samples that are still waiting for it */
+  if (seq - whc->free_seq <= whc->mask)
+    return;
+  whc_ring_release_deferred_locked (whc);
+  if (seq - whc->free_seq <= whc->mask)
+    return;
+  uint32_t size = whc->mask + 1;
+  while (seq - whc->free_seq >= size)
+  {
+    assert (size < UINT32_MAX / 2);
+    size *= 2;
+  }
+  TRACE (" grow %"PRIu32, size);
+  whc_ring_resize (whc, size);
+}
+
+static void whc_ring_unregister (struct whc_ring *whc, ddsi_seqno_t max_drop_seq)
+{
+  /* Samples no longer in the instance's history are only retained until acknowledged */
+  for (uint32_t i = 0; i < whc->hdepth; i++)
+  {
+    if (whc->hist[i] != 0 && whc->hist[i] <= max_drop_seq && whc_ring_lookup (whc, whc->hist[i]))
+      whc_ring_delete_one (whc, whc->hist[i]);
+  }
+  ddsi_tkmap_instance_unref (whc->tkmap, whc->tk);
+  whc->tk = NULL;
+}
+
+#ifdef DDS_HAS_LIFESPAN
+struct whc_ring_lifespan_arg {
+  struct whc_ring *whc;
+};
+
+static void whc_ring_lifespan_cb (struct ddsi_domaingv *gv, struct ddsi_xevent *xev, struct ddsi_xpack *xp, void *varg, ddsrt_mtime_t tnow)
+{
+  struct whc_ring_lifespan_arg * const arg = varg;
+  struct whc_ring * const whc = arg->whc;
+  ddsrt_mtime_t tnext = DDSRT_MTIME_NEVER;
+  (void) gv;
+  (void) xp;
+  ddsrt_mutex_lock (&whc->lock);
+  whc_ring_check (whc);
+  TRACE ("whc_ring_lifespan_cb(%p):", (void *) whc);
+  while (whc->seq_size > 0)
+  {
+    const struct whc_ring_slot * const s = whc_ring_slot (whc, whc->min_seq);
+    if (s->t_expire.v > tnow.v)
+    {
+      tnext = s->t_expire;
+      break;
+    }
+    whc_ring_delete_one (whc, whc->min_seq);
+  }
+  TRACE ("\n");
+  ddsrt_mutex_unlock (&whc->lock);
+  ddsi_resched_xevent_if_earlier (xev, tnext);
+}
+#endif
+
+static void whc_ring_lifespan_update (struct whc_ring *whc)
+{
+  /* the oldest sample may have changed, so expiring it may be due earlier */
+#ifdef DDS_HAS_LIFESPAN
+  if (whc->lifespan_xev && whc->seq_size > 0)
+    ddsi_resched_xevent_if_earlier (whc->lifespan_xev, whc_ring_slot (whc, whc->min_seq)->t_expire);
+#else
+  (void) whc;
+#endif
+}
+
+static int whc_ring_insert (struct ddsi_whc *whc_generic, ddsi_seqno_t max_drop_seq, ddsi_seqno_t seq, ddsrt_mtime_t exp, struct ddsi_serdata *serdata, struct ddsi_tkmap_instance *tk)
+{
+  struct whc_ring * const whc = (struct whc_ring *) whc_generic;
+#ifndef DDS_HAS_LIFESPAN
+  DDSRT_UNUSED_ARG (exp);
+#endif
+
+  ddsrt_mutex_lock (&whc->lock);
+  whc_ring_check (whc);
+  TRACE ("whc_ring_insert(%p max_drop_seq %"PRIu64" seq %"PRIu64" serdata %p:%"PRIx32")\n",
+         (void *) whc, max_drop_seq, seq, (void *) serdata, serdata->hash);
+  TRACE ("  whc: [%"PRIu64",%"PRIu64") free %"PRIu64" max_drop_seq %"PRIu64" h %"PRIu32":",
+         whc->min_seq, whc->maxp1_seq, whc->free_seq, whc->max_drop_seq, whc->hdepth);
+
+  assert (max_drop_seq < DDSI_MAX_SEQ_NUMBER);
+  assert (max_drop_seq >= whc->max_drop_seq);
+  assert (seq >= whc->maxp1_seq);
+
+  if (whc->seq_size == 0)
+  {
+    /* nothing to keep in between: skip over any gap in sequence numbers */
+    if (whc->free_seq == whc->min_seq)
+      whc->free_seq = seq;
+    whc->min_seq = whc->maxp1_seq = seq;
+  }
+  whc_ring_make_room (whc, seq);
+
+  struct whc_ring_slot * const s = whc_ring_slot (whc, seq);
+  assert (s->serdata == NULL && !s->borrowed);
+  s->serdata = ddsi_serdata_ref (serdata);
+  s->size = whc_ring_sample_size (whc, serdata);
+  s->unacked = (seq > max_drop_seq);
+  s->rexmit_count = 0;
+  s->last_rexmit_ts.v = 0;
+  if (s->unacked)
+    whc->unacked_bytes += s->size;
+  whc->maxp1_seq = seq + 1;
+  whc->seq_size++;
+#ifdef DDS_HAS_LIFESPAN
+  s->t_expire = exp;
+  if (exp.v != DDS_NEVER && whc->lifespan_xev == NULL)
+  {
+    const struct whc_ring_lifespan_arg arg = { .whc = whc };
+    whc->lifespan_xev = ddsi_qxev_callback (whc->gv->xevents, DDSRT_MTIME_NEVER, whc_ring_lifespan_cb, &arg, sizeof (arg), true);
+  }
+#endif
+
+  /* Special case of empty data (such as commit messages) can't go into index */
+  if (serdata->kind == SDK_EMPTY)
+  {
+    TRACE (" empty\n");
+    whc_ring_lifespan_update (whc);
+    ddsrt_mutex_unlock (&whc->lock);
+    return 0;
+  }
+
+  assert (whc->tk == NULL || whc->tk->m_iid == tk->m_iid);
+  if (serdata->statusinfo & DDSI_STATUSINFO_UNREGISTER)
+  {
+    TRACE (" unreg");
+    if (whc->tk)
+      whc_ring_unregister (whc, max_drop_seq);
+    if (seq <= max_drop_seq)
+      whc_ring_delete_one (whc, seq);
+  }
+  else if (whc->tk == NULL)
+  {
+    TRACE (" register");
+    ddsi_tkmap_instance_ref (tk);
+    whc->tk = tk;
+    whc->headidx = 0;
+    if (whc->hdepth > 0)
+    {
+      whc->hist[0] = seq;
+      for (uint32_t i = 1; i < whc->hdepth; i++)
+        whc->hist[i] = 0;
+    }
+  }
+  else if (whc->hdepth > 0)
+  {
+    if (++whc->headidx == whc->hdepth)
+      whc->headidx = 0;
+    const ddsi_seqno_t oldseq = whc->hist[whc->headidx];
+    whc->hist[whc->headidx] = seq;
+    if (oldseq != 0 && whc_ring_lookup (whc, oldseq))
+    {
+      TRACE (" prune");
+      whc_ring_delete_one (whc, oldseq);
+    }
+  }
+  TRACE ("\n");
+  whc_ring_lifespan_update (whc);
+  ddsrt_mutex_unlock (&whc->lock);
+  return 0;
+}
+
+static uint32_t whc_ring_remove_acked_messages (struct ddsi_whc *whc_generic, ddsi_seqno_t max_drop_seq, struct ddsi_whc_state *whcst, struct ddsi_whc_node **deferred_free_list)
+{
+  struct whc_ring * const whc = (struct whc_ring *) whc_generic;
+  uint32_t ndropped = 0;
+
+  ddsrt_mutex_lock (&whc->lock);
+  whc_ring_check (whc);
+  assert (max_drop_seq < DDSI_MAX_SEQ_NUMBER);
+  assert (max_drop_seq >= whc->max_drop_seq);
+  TRACE ("whc_ring_remove_acked_messages(%p max_drop_seq %"PRIu64")\n", (void *) whc, max_drop_seq);
+  TRACE ("  whc: [%"PRIu64",%"PRIu64") free %"PRIu64" max_drop_seq %"PRIu64"\n",
+         whc->min_seq, whc->maxp1_seq, whc->free_seq, whc->max_drop_seq);
+
+  const ddsi_seqno_t end = (max_drop_seq < whc->maxp1_seq) ? max_drop_seq + 1 : whc->maxp1_seq;
+  for (ddsi_seqno_t seq = whc->min_seq; seq < end; seq++)
+  {
+    struct whc_ring_slot * const s = whc_ring_slot (whc, seq);
+    if (s->serdata == NULL)
+      continue;
+    ndropped++;
+    if (s->unacked)
+    {
+      assert (whc->unacked_bytes >= s->size);
+      whc->unacked_bytes -= s->size;
+      s->unacked = 0;
+    }
+  }
+  if (end > whc->min_seq)
+  {
+    /* no need to keep a range of nothing but holes for deferred freeing */
+    if (ndropped == 0 && whc->free_seq == whc->min_seq)
+      whc->free_seq = end;
+    whc->min_seq = end;
+    assert (ndropped <= whc->seq_size);
+    whc->seq_size -= ndropped;
+    whc_ring_trim (whc);
+  }
+  whc->max_drop_seq = max_drop_seq;
+  whc_ring_lifespan_update (whc);
+  *deferred_free_list = (whc->free_seq < whc->min_seq) ? &whc->deferred_free_marker : NULL;
+  get_state_locked (whc, whcst);
+  ddsrt_mutex_unlock (&whc->lock);
+  return ndropped;
+}
+
+static void whc_ring_free_deferred_free_list (struct ddsi_whc *whc_generic, struct ddsi_whc_node *deferred_free_list)
+{
+  struct whc_ring * const whc = (struct whc_ring *) whc_generic;
+  struct ddsi_serdata *batch[WHC_RING_FREE_BATCH];
+  uint32_t n;
+  if (deferred_free_list == NULL)
+    return;
+  assert (deferred_free_list == &whc->deferred_free_marker);
+  /* Releasing the samples is done outside the lock, but in batches to avoid having to
+     allocate memory for a list */
+  do {
+    n = 0;
+    ddsrt_mutex_lock (&whc->lock);
+    for (; whc->free_seq < whc->min_seq && n < WHC_RING_FREE_BATCH; whc->free_seq++)
+    {
+      struct whc_ring_slot * const s = whc_ring_slot (whc, whc->free_seq);
+      if (s->serdata)
+      {
+        if (!s->borrowed)
+          batch[n++] = s->serdata;
+        s->serdata = NULL;
+        s->borrowed = 0;
+      }
+    }
+    if (whc->seq_size == 0 && whc->free_seq == whc->min_seq && whc->mask + 1 > WHC_RING_SHRINK_SIZE)
+    {
+      /* give back the memory after a burst */
+      whc_ring_resize (whc, WHC_RING_INIT_SIZE);
+    }
+    ddsrt_mutex_unlock (&whc->lock);
+    for (uint32_t i = 0; i < n; i++)
+      ddsi_serdata_unref (batch[i]);
+  } while (n == WHC_RING_FREE_BATCH);
+}
+
+static void make_borrowed_sample (struct ddsi_whc_borrowed_sample *sample, ddsi_seqno_t seq, struct whc_ring_slot *s)
+{
+  assert (!s->borrowed);
+  s->borrowed = 1;
+  sample->seq = seq;
+  sample->serdata = s->serdata;
+  sample->unacked = s->unacked;
+  sample->rexmit_count = s->rexmit_count;
+  sample->last_rexmit_ts = s->last_rexmit_ts;
+}
+
+static bool whc_ring_borrow_sample (const struct ddsi_whc *whc_generic, ddsi_seqno_t seq, struct ddsi_whc_borrowed_sample *sample)
+{
+  const struct whc_ring * const whc = (const struct whc_ring *) whc_generic;
+  struct whc_ring_slot *s;
+  bool found;
+  ddsrt_mutex_lock ((ddsrt_mutex_t *) &whc->lock);
+  if ((s = whc_ring_lookup (whc, seq)) == NULL)
+    found = false;
+  else
+  {
+    make_borrowed_sample (sample, seq, s);
+    found = true;
+  }
+  ddsrt_mutex_unlock ((ddsrt_mutex_t *) &whc->lock);
+  return found;
+}
+
+static bool whc_ring_borrow_sample_key (const struct ddsi_whc *whc_generic, const struct ddsi_serdata *serdata_key, struct ddsi_whc_borrowed_sample *sample)
+{
+  const struct whc_ring * const whc = (const struct whc_ring *) whc_generic;
+  struct whc_ring_slot *s;
+  bool found = false;
+  ddsrt_mutex_lock ((ddsrt_mutex_t *) &whc->lock);
+  if (whc->tk != NULL && whc->hdepth > 0 && ddsi_tkmap_lookup (whc->tkmap, serdata_key) == whc->tk->m_iid)
+  {
+    const ddsi_seqno_t seq = whc->hist[whc->headidx];
+    if ((s = whc_ring_lookup (whc, seq)) != NULL)
+    {
+      make_borrowed_sample (sample, seq, s);
+      found = true;
+    }
+  }
+  ddsrt_mutex_unlock ((ddsrt_mutex_t *) &whc->lock);
+  return found;
+}
+
+static void return_sample_locked (struct whc_ring *whc, struct ddsi_whc_borrowed_sample *sample, bool update_retransmit_info)
+{
+  struct whc_ring_slot *s;
+  if ((s = whc_ring_lookup (whc, sample->seq)) == NULL)
+  {
+    /* data no longer present in WHC */
+    ddsi_serdata_unref (sample->serdata);
+  }
+  else
+  {
+    assert (s->borrowed);
+    assert (s->serdata == sample->serdata);
+    s->borrowed = 0;
+    if (update_retransmit_info)
+    {
+      s->rexmit_count = sample->rexmit_count;
+      s->last_rexmit_ts = sample->last_rexmit_ts;
+    }
+  }
+}
+
+static void whc_ring_return_sample (struct ddsi_whc *whc_generic, struct ddsi_whc_borrowed_sample *sample, bool update_retransmit_info)
+{
+  struct whc_ring * const whc = (struct whc_ring *) whc_generic;
+  ddsrt_mutex_lock (&whc->lock);
+  return_sample_locked (whc, sample, update_retransmit_info);
+  ddsrt_mutex_unlock (&whc->lock);
+}
+
+static void whc_ring_sample_iter_init (const struct ddsi_whc *whc_generic, struct ddsi_whc_sample_iter *opaque_it)
+{
+  struct ddsi_whc_sample_iter_impl *it = (struct ddsi_whc_sample_iter_impl *) opaque_it;
+  it->c.whc = (struct ddsi_whc *) whc_generic;
+  it->first = true;
+}
+
+static bool whc_ring_sample_iter_borrow_next (struct ddsi_whc_sample_iter *opaque_it, struct ddsi_whc_borrowed_sample *sample)
+{
+  struct ddsi_whc_sample_iter_impl * const it = (struct ddsi_whc_sample_iter_impl *) opaque_it;
+  struct whc_ring * const whc = (struct whc_ring *) it->c.whc;
+  ddsi_seqno_t seq;
+  bool valid;
+  ddsrt_mutex_lock (&whc->lock);
+  whc_ring_check (whc);
+  if (!it->first)
+  {
+    seq = sample->seq;
+    return_sample_locked (whc, sample, false);
+  }
+  else
+  {
+    it->first = false;
+    seq = 0;
+  }
+  if ((seq = next_seq_locked (whc, seq)) == DDSI_MAX_SEQ_NUMBER)
+    valid = false;
+  else
+  {
+    make_borrowed_sample (sample, seq, whc_ring_slot (whc, seq));
+    valid = true;
+  }
+  ddsrt_mutex_unlock (&whc->lock);
+  return valid;
+}
+
+static const struct ddsi_whc_ops whc_ring_ops = {
+  .insert = whc_ring_insert,
+  .remove_acked_messages = whc_ring_remove_acked_messages,
+  .free_deferred_free_list = whc_ring_free_deferred_free_list,
+  .get_state = whc_ring_get_state,
+  .next_seq = whc_ring_next_seq,
+  .borrow_sample = whc_ring_borrow_sample,
+  .borrow_sample_key = whc_ring_borrow_sample_key,
+  .return_sample = whc_ring_return_sample,
+  .sample_iter_init = whc_ring_sample_iter_init,
+  .sample_iter_borrow_next = whc_ring_sample_iter_borrow_next,
+  .free = whc_ring_free
+};
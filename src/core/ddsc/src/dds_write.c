@@ -10,6 +10,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include "dds/ddsrt/heap.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsi/ddsi_thread.h"
 #include "dds/ddsi/ddsi_xmsg.h"
@@ -28,9 +29,11 @@
 #include "dds__heap_loan.h"
 #include "dds__writer.h"
 #include "dds__write.h"
+#include "dds__write_async.h"
 #include "dds__loaned_sample.h"
 #include "dds__psmx.h"
 #include "dds__guid.h"
+#include "dds__serdata_default.h"
 
 extern inline bool dds_source_timestamp_is_valid_ddsi_time (dds_time_t timestamp, ddsi_protocol_version_t protover);
 
@@ -170,6 +173,27 @@ dds_return_t dds_write_ts (dds_entity_t writer, const void *data, dds_time_t tim
   return ret;
 }
 
+static dds_return_t dds_write_batch_impl (dds_writer *wr, const void * const *data, uint32_t n, dds_time_t timestamp)
+  ddsrt_nonnull_all ddsrt_attribute_warn_unused_result;
+
+dds_return_t dds_write_batch (dds_entity_t writer, const void * const *data, uint32_t n, dds_time_t timestamp)
+{
+  dds_return_t ret;
+  dds_writer *wr;
+
+  if (data == NULL)
+    return DDS_RETCODE_BAD_PARAMETER;
+  for (uint32_t i = 0; i < n; i++)
+    if (data[i] == NULL)
+      return DDS_RETCODE_BAD_PARAMETER;
+
+  if ((ret = dds_writer_lock (writer, &wr)) != DDS_RETCODE_OK)
+    return ret;
+  ret = dds_write_batch_impl (wr, data, n, timestamp);
+  dds_writer_unlock (wr);
+  return ret;
+}
+
 struct local_sourceinfo {
   const struct ddsi_sertype *src_type;
   struct ddsi_serdata *src_payload;
@@ -524,6 +548,8 @@ static dds_return_t dds_writecdr_impl_common (struct dds_writer *wr, struct ddsi
   }
 
   // d = din: refc(d) = r, otherwise refc(d) = 1
+  if (wr->m_async && !uses_psmx)
+    return dds_write_async_enqueue (NULL, wr->m_async, &d->a);
   ddsi_thread_state_awake (thrst, ddsi_wr->e.gv);
   ret = deliver_data_any (thrst, wr, ddsi_wr, d, xp, flush);
   ddsi_thread_state_asleep (thrst);
@@ -640,18 +666,40 @@ static struct dds_loaned_sample *dds_write_impl_serialize_into_loan (const struc
 {
   size_t loan_size_unpadded;
   uint16_t enc_identifier;
-  if (ddsi_sertype_get_serialized_size (sertype, sdkind, data, &loan_size_unpadded, &enc_identifier) != 0)
+  const void *ser = NULL;
+  if (sertype->ops == &dds_sertype_ops_default && !dds_sertype_default_has_fixed_serialized_size (sertype, sdkind))
+  {
+    // Serializing once into a scratch buffer and copying the result into the loan is
+    // cheaper than traversing the sample twice, first to compute the size and then to
+    // serialize it
+    if (!dds_sertype_default_serialize_scratch (sertype, sdkind, data, &ser, &loan_size_unpadded, &enc_identifier))
+      return NULL;
+  }
+  else if (ddsi_sertype_get_serialized_size (sertype, sdkind, data, &loan_size_unpadded, &enc_identifier) != 0)
     return NULL;
   const uint32_t pad_mask = 3u;
   const uint32_t loan_size_padded = ((uint32_t) loan_size_unpadded + pad_mask) & ~pad_mask;
   struct dds_loaned_sample * const loan = dds_writer_request_psmx_loan (wr, loan_size_padded);
   if (loan == NULL)
+  {
+    if (ser != NULL)
+      dds_sertype_default_serialize_scratch_done ();
     return NULL;
+  }
   struct dds_psmx_metadata * const md = loan->metadata;
   md->sample_state = (sdkind == SDK_KEY) ? DDS_LOANED_SAMPLE_STATE_SERIALIZED_KEY : DDS_LOANED_SAMPLE_STATE_SERIALIZED_DATA;
   md->cdr_identifier = enc_identifier;
   md->cdr_options = ddsrt_toBE2u ((uint16_t) (loan_size_padded - loan_size_unpadded));
-  ddsi_sertype_serialize_into (sertype, sdkind, data, loan->sample_ptr, loan_size_unpadded);
+  if (ser != NULL)
+  {
+    memcpy (loan->sample_ptr, ser, loan_size_unpadded);
+    dds_sertype_default_serialize_scratch_done ();
+  }
+  else if (!ddsi_sertype_serialize_into (sertype, sdkind, data, loan->sample_ptr, loan_size_unpadded))
+  {
+    dds_loaned_sample_unref (loan);
+    return NULL;
+  }
   dds_psmx_set_loan_writeinfo (loan, &wr->m_entity.m_guid, timestamp, statusinfo);
   return loan;
 }
@@ -931,9 +979,14 @@ dds_return_t dds_write_impl (dds_writer *wr, const void *data, dds_time_t timest
 
     if (serdata != NULL)
     {
-      if (ret == DDS_RETCODE_OK)
-        ret = dds_write_impl_deliver_via_ddsi (thrst, wr, serdata);
-      ddsi_serdata_unref (serdata);
+      if (ret == DDS_RETCODE_OK && wr->m_async)
+        ret = dds_write_async_enqueue (thrst, wr->m_async, serdata);
+      else
+      {
+        if (ret == DDS_RETCODE_OK)
+          ret = dds_write_impl_deliver_via_ddsi (thrst, wr, serdata);
+        ddsi_serdata_unref (serdata);
+      }
     }
 
     if (loan_to_be_freed)
@@ -943,6 +996,97 @@ dds_return_t dds_write_impl (dds_writer *wr, const void *data, dds_time_t timest
   return ret;
 }
 
+static dds_return_t dds_write_batch_impl (dds_writer *wr, const void * const *data, uint32_t n, dds_time_t timestamp)
+{
+  if (!dds_source_timestamp_is_valid_ddsi_time (timestamp, wr->protocol_version))
+    return DDS_RETCODE_BAD_PARAMETER;
+  if (n == 0)
+    return DDS_RETCODE_OK;
+
+  // Delivery via PSMX is per sample anyway, so there's little to gain from doing anything
+  // special for it; in asynchronous mode the transmit worker does the batching
+  if (wr->m_endpoint.psmx_endpoints.length > 0 || wr->m_async)
+  {
+    dds_return_t ret = DDS_RETCODE_OK;
+    for (uint32_t i = 0; i < n && ret == DDS_RETCODE_OK; i++)
+      ret = dds_write_impl (wr, data[i], timestamp, DDS_WR_ACTION_WRITE);
+    return ret;
+  }
+
+  struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  struct ddsi_domaingv * const gv = &wr->m_entity.m_domain->gv;
+  struct ddsi_serdata **serdata = ddsrt_malloc (n * sizeof (*serdata));
+  struct ddsi_tkmap_instance **tk = ddsrt_malloc (n * sizeof (*tk));
+  dds_return_t ret = DDS_RETCODE_OK;
+  uint32_t m = 0;
+
+  // Serialize everything first, stopping at the first failure: the samples preceding it
+  // still get written
+  ddsi_thread_state_awake (thrst, gv);
+  for (uint32_t i = 0; i < n && ret == DDS_RETCODE_OK; i++)
+  {
+    if (!evaluate_topic_filter (wr, data[i], SDK_DATA))
+      continue;
+    struct dds_loaned_sample *psmx_loan, *loan_to_be_freed;
+    if ((ret = dds_write_impl_psmxloan_serdata (wr, data[i], SDK_DATA, timestamp, 0, &psmx_loan, &serdata[m], &loan_to_be_freed)) == DDS_RETCODE_OK)
+    {
+      assert (psmx_loan == NULL && loan_to_be_freed == NULL && serdata[m] != NULL);
+      m++;
+    }
+  }
+
+  uint32_t nwritten;
+  dds_return_t ret2 = dds_write_serdata_batch (thrst, wr, wr->m_xp, !wr->whc_batch, wr->m_wr->xqos->reliability.max_blocking_time, m, serdata, tk, &nwritten);
+  // an error in writing precedes any serialization error
+  if (ret2 != DDS_RETCODE_OK && (ret == DDS_RETCODE_OK || nwritten < m))
+    ret = ret2;
+  for (uint32_t i = 0; i < m; i++)
+    ddsi_serdata_unref (serdata[i]);
+  ddsi_thread_state_asleep (thrst);
+  ddsrt_free (tk);
+  ddsrt_free (serdata);
+  return ret;
+}
+
+dds_return_t dds_write_serdata_batch (struct ddsi_thread_state * const thrst, dds_writer *wr, struct ddsi_xpack *xp, bool flush, dds_duration_t max_blocking_time, uint32_t n, struct ddsi_serdata **serdata, struct ddsi_tkmap_instance **tk, uint32_t *nwritten)
+{
+  struct ddsi_domaingv * const gv = &wr->m_entity.m_domain->gv;
+  dds_return_t ret = DDS_RETCODE_OK;
+
+  for (uint32_t i = 0; i < n; i++)
+  {
+    tk[i] = ddsi_tkmap_lookup_instance_ref (gv->m_tkmap, serdata[i]);
+    // ddsi_write_sample_batch_gc consumes a reference, keep one for local delivery
+    (void) ddsi_serdata_ref (serdata[i]);
+  }
+
+  const int ret1 = ddsi_write_sample_batch_gc (thrst, xp, wr->m_wr, max_blocking_time, n, serdata, tk, nwritten);
+  if (ret1 >= 0)
+  {
+    if (flush)
+      ddsi_xpack_send (xp, false);
+  }
+  else
+  {
+    ret = (ret1 == DDS_RETCODE_TIMEOUT) ? ret1 : DDS_RETCODE_ERROR;
+  }
+
+  for (uint32_t i = 0; i < *nwritten; i++)
+  {
+    dds_return_t ret2;
+    if ((ret2 = deliver_locally (wr->m_wr, serdata[i], tk[i])) != DDS_RETCODE_OK)
+    {
+      if (ret == DDS_RETCODE_OK)
+        ret = ret2;
+      break;
+    }
+  }
+
+  for (uint32_t i = 0; i < n; i++)
+    ddsi_tkmap_instance_unref (gv->m_tkmap, tk[i]);
+  return ret;
+}
+
 dds_return_t dds_writecdr_impl (dds_writer *wr, struct ddsi_xpack *xp, struct ddsi_serdata *d, bool flush)
 {
   dds_return_t ret = dds_writecdr_impl_common (wr, wr->m_wr, xp, (struct ddsi_serdata_any *) d, flush);
@@ -952,6 +1096,8 @@ dds_return_t dds_writecdr_impl (dds_writer *wr, struct ddsi_xpack *xp, struct dd
 void dds_write_flush_impl (dds_writer *wr)
 {
   ddsrt_mutex_lock (&wr->m_entity.m_mutex);
+  if (wr->m_async)
+    dds_write_async_drain (wr->m_async);
   ddsi_xpack_send (wr->m_xp, true);
   ddsrt_mutex_unlock (&wr->m_entity.m_mutex);
 }
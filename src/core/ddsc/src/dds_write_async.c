@@ -0,0 +1,438 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "dds/ddsi/ddsi_thread.h"
+#include "dds/ddsi/ddsi_xmsg.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_tkmap.h"
+#include "dds/ddsi/ddsi_entity.h"
+#include "dds/ddsi/ddsi_endpoint.h"
+#include "dds__write.h"
+#include "dds__write_async.h"
+
+/* In asynchronous mode, a write serializes the sample on the application thread and then
+   appends it to a queue owned by the writer, leaving the insertion in the WHC, the packing
+   into messages, the sending and the delivery to local readers to a transmit worker.
+
+   The queue is a bounded array of cells with sequence numbers (Vyukov's queue): an
+   application thread claims a slot by incrementing the enqueue position with a CAS and
+   publishes the sample by updating the sequence number of the cell; the consumer releases
+   the cell by setting its sequence number to the position it will have in the next round.
+   There is at most one consumer at any one time, because a writer is handed to the workers
+   via a shared run queue and the "scheduled" flag ensures it is in there (or being worked
+   on) at most once.  An application thread sets the flag after publishing a sample if it
+   wasn't set yet; a worker clears it when done and then checks once more whether anything
+   was published in the meantime.  The worker does that while holding the lock of the
+   writer queue, because draining the queue (and thus freeing it) completes once the flag
+   is cleared.
+
+   A worker releases cells only after it handed the samples in them to the writer.  A
+   writer waiting for space in its history cache that times out hasn't accepted any of
+   them, so the samples stay in the queue and the writer goes to the back of the run
+   queue.  Nothing is lost that way.  A worker waits for space for at most the writer's
+   max_blocking_time and never longer than WRITE_ASYNC_MAX_BLOCK, so that a writer that
+   is throttled by a reader that doesn't acknowledge anything doesn't stop the worker
+   from serving other writers.  Once the writer is being deleted (the queue is "closing"),
+   the worker no longer waits at all and drops what the writer doesn't accept.
+
+   The lock and condition variable of the writer queue are otherwise only used for
+   waiting, either for space in the queue or for the queue to drain. */
+
+#define WRITE_ASYNC_BATCH 32u
+#define WRITE_ASYNC_MAX_PER_TURN (8 * WRITE_ASYNC_BATCH)
+#define WRITE_ASYNC_MAX_BLOCK DDS_MSECS (10)
+
+struct dds_write_async_cell {
+  ddsrt_atomic_uint32_t seq;
+  struct ddsi_serdata *sd;
+  int64_t tenqueue;
+};
+
+struct dds_write_async {
+  struct dds_write_async *runq_next; /* protected by pipeline lock */
+  struct dds_write_pipeline *pl;
+  struct dds_writer *wr;
+  uint32_t mask;
+  ddsrt_atomic_uint32_t enqpos;
+  ddsrt_atomic_uint32_t deqpos; /* only updated by the worker that has it scheduled */
+  ddsrt_atomic_uint32_t scheduled;
+  ddsrt_atomic_uint32_t nwaiters;
+  ddsrt_atomic_uint32_t closing;
+  ddsrt_mutex_t lock;
+  ddsrt_cond_mtime_t cond;
+
+  ddsrt_atomic_uint32_t max_queued;
+  ddsrt_atomic_uint32_t blocked;
+  ddsrt_atomic_uint64_t samples;
+  ddsrt_atomic_uint64_t latency;
+  ddsrt_atomic_uint64_t dropped;
+
+  struct dds_write_async_cell cells[];
+};
+
+struct dds_write_pipeline_worker {
+  struct dds_write_pipeline *pl;
+  struct ddsi_thread_state *thrst;
+  struct ddsi_xpack *xp;
+  ddsrt_atomic_uint64_t samples;
+  ddsrt_atomic_uint64_t batches;
+};
+
+struct dds_write_pipeline {
+  struct ddsi_domaingv *gv;
+  ddsrt_mutex_t lock;
+  ddsrt_cond_t cond;
+  bool stop;
+  struct dds_write_async *runq_head, *runq_tail;
+  uint32_t nworkers;
+  struct dds_write_pipeline_worker workers[];
+};
+
+static bool has_published (const struct dds_write_async *q)
+{
+  const uint32_t pos = ddsrt_atomic_ld32 (&q->deqpos);
+  return ddsrt_atomic_ld32 (&q->cells[pos & q->mask].seq) == pos + 1;
+}
+
+static void update_max_queued (struct dds_write_async *q, uint32_t enqpos)
+{
+  const uint32_t count = enqpos - ddsrt_atomic_ld32 (&q->deqpos);
+  uint32_t max;
+  while (count > (max = ddsrt_atomic_ld32 (&q->max_queued)) && !ddsrt_atomic_cas32 (&q->max_queued, max, count))
+    ;
+}
+
+static bool try_enqueue (struct dds_write_async *q, struct ddsi_serdata *sd, int64_t tnow)
+{
+  uint32_t pos = ddsrt_atomic_ld32 (&q->enqpos);
+  while (true)
+  {
+    struct dds_write_async_cell * const c = &q->cells[pos & q->mask];
+    const uint32_t seq = ddsrt_atomic_ld32 (&c->seq);
+    ddsrt_atomic_fence_acq ();
+    const int32_t diff = (int32_t) (seq - pos);
+    if (diff < 0)
+      return false;
+    else if (diff == 0 && ddsrt_atomic_cas32 (&q->enqpos, pos, pos + 1))
+    {
+      c->sd = sd;
+      c->tenqueue = tnow;
+      ddsrt_atomic_fence_rel ();
+      ddsrt_atomic_st32 (&c->seq, pos + 1);
+      update_max_queued (q, pos + 1);
+      return true;
+    }
+    pos = ddsrt_atomic_ld32 (&q->enqpos);
+  }
+}
+
+static uint32_t peek_batch (const struct dds_write_async *q, struct ddsi_serdata **sds, int64_t *tenqueue, uint32_t max)
+{
+  uint32_t pos = ddsrt_atomic_ld32 (&q->deqpos), n = 0;
+  while (n < max)
+  {
+    const struct dds_write_async_cell * const c = &q->cells[pos & q->mask];
+    if (ddsrt_atomic_ld32 (&c->seq) != pos + 1)
+      break;
+    ddsrt_atomic_fence_acq ();
+    sds[n] = c->sd;
+    tenqueue[n] = c->tenqueue;
+    n++;
+    pos++;
+  }
+  return n;
+}
+
+static void release_batch (struct dds_write_async *q, uint32_t n)
+{
+  uint32_t pos = ddsrt_atomic_ld32 (&q->deqpos);
+  ddsrt_atomic_fence_rel ();
+  for (uint32_t i = 0; i < n; i++, pos++)
+    ddsrt_atomic_st32 (&q->cells[pos & q->mask].seq, pos + q->mask + 1);
+  ddsrt_atomic_st32 (&q->deqpos, pos);
+}
+
+static void wake_waiters (struct dds_write_async *q)
+{
+  ddsrt_atomic_fence ();
+  if (ddsrt_atomic_ld32 (&q->nwaiters) > 0)
+  {
+    ddsrt_mutex_lock (&q->lock);
+    ddsrt_cond_mtime_broadcast (&q->cond);
+    ddsrt_mutex_unlock (&q->lock);
+  }
+}
+
+static void schedule (struct dds_write_async *q)
+{
+  struct dds_write_pipeline * const pl = q->pl;
+  /* Pairs with the fence following clearing "scheduled" in the worker: either we see it
+     cleared, or the worker sees the sample we published */
+  ddsrt_atomic_fence ();
+  if (ddsrt_atomic_ld32 (&q->scheduled) || !ddsrt_atomic_cas32 (&q->scheduled, 0, 1))
+    return;
+  ddsrt_mutex_lock (&pl->lock);
+  q->runq_next = NULL;
+  if (pl->runq_head == NULL)
+    pl->runq_head = q;
+  else
+    pl->runq_tail->runq_next = q;
+  pl->runq_tail = q;
+  ddsrt_cond_signal (&pl->cond);
+  ddsrt_mutex_unlock (&pl->lock);
+}
+
+static void process_queue (struct dds_write_pipeline_worker *w, struct ddsi_thread_state *thrst, struct dds_write_async *q)
+{
+  struct ddsi_serdata *sds[WRITE_ASYNC_BATCH];
+  struct ddsi_tkmap_instance *tks[WRITE_ASYNC_BATCH];
+  int64_t tenqueue[WRITE_ASYNC_BATCH];
+  uint32_t n, total = 0;
+  dds_duration_t max_block = q->wr->m_wr->xqos->reliability.max_blocking_time;
+  if (max_block > WRITE_ASYNC_MAX_BLOCK)
+    max_block = WRITE_ASYNC_MAX_BLOCK;
+
+  ddsi_thread_state_awake (thrst, w->pl->gv);
+  while (total < WRITE_ASYNC_MAX_PER_TURN && (n = peek_batch (q, sds, tenqueue, WRITE_ASYNC_BATCH)) > 0)
+  {
+    uint32_t nwritten;
+    const bool closing = ddsrt_atomic_ld32 (&q->closing);
+    const dds_return_t ret = dds_write_serdata_batch (thrst, q->wr, w->xp, false, closing ? 0 : max_block, n, sds, tks, &nwritten);
+    ddsi_xpack_send (w->xp, false);
+    if (ret == DDS_RETCODE_TIMEOUT && nwritten == 0 && !closing)
+    {
+      // no space in the WHC: leave them queued and give other writers a chance
+      break;
+    }
+    release_batch (q, n);
+    wake_waiters (q);
+    const int64_t tnow = ddsrt_time_monotonic ().v;
+    uint64_t latency = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+      latency += (uint64_t) (tnow - tenqueue[i]);
+      ddsi_serdata_unref (sds[i]);
+    }
+    ddsrt_atomic_add64 (&q->samples, n);
+    ddsrt_atomic_add64 (&q->latency, latency);
+    if (nwritten < n)
+      ddsrt_atomic_add64 (&q->dropped, n - nwritten);
+    ddsrt_atomic_add64 (&w->samples, n);
+    ddsrt_atomic_inc64 (&w->batches);
+    total += n;
+  }
+  ddsi_thread_state_asleep (thrst);
+
+  // q may be freed as soon as "scheduled" is cleared and the lock is released
+  ddsrt_mutex_lock (&q->lock);
+  ddsrt_atomic_st32 (&q->scheduled, 0);
+  ddsrt_atomic_fence ();
+  if (has_published (q))
+    schedule (q);
+  ddsrt_cond_mtime_broadcast (&q->cond);
+  ddsrt_mutex_unlock (&q->lock);
+}
+
+static uint32_t dds_write_pipeline_worker_thread (void *varg)
+{
+  struct dds_write_pipeline_worker * const w = varg;
+  struct dds_write_pipeline * const pl = w->pl;
+  struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  ddsrt_mutex_lock (&pl->lock);
+  while (true)
+  {
+    struct dds_write_async *q;
+    while (!pl->stop && pl->runq_head == NULL)
+      ddsrt_cond_wait (&pl->cond, &pl->lock);
+    if ((q = pl->runq_head) == NULL)
+      break;
+    if ((pl->runq_head = q->runq_next) == NULL)
+      pl->runq_tail = NULL;
+    ddsrt_mutex_unlock (&pl->lock);
+    process_queue (w, thrst, q);
+    ddsrt_mutex_lock (&pl->lock);
+  }
+  ddsrt_mutex_unlock (&pl->lock);
+  return 0;
+}
+
+struct dds_write_pipeline *dds_write_pipeline_new (struct ddsi_domaingv *gv, uint32_t nworkers)
+{
+  struct dds_write_pipeline *pl = ddsrt_malloc (sizeof (*pl) + nworkers * sizeof (pl->workers[0]));
+  pl->gv = gv;
+  ddsrt_mutex_init (&pl->lock);
+  ddsrt_cond_init (&pl->cond);
+  pl->stop = false;
+  pl->runq_head = pl->runq_tail = NULL;
+  pl->nworkers = 0;
+  for (uint32_t i = 0; i < nworkers; i++)
+  {
+    struct dds_write_pipeline_worker * const w = &pl->workers[i];
+    char name[24];
+    w->pl = pl;
+    w->xp = ddsi_xpack_new (gv, false);
+    ddsrt_atomic_st64 (&w->samples, 0);
+    ddsrt_atomic_st64 (&w->batches, 0);
+    (void) snprintf (name, sizeof (name), "wrasync%"PRIu32, i);
+    if (ddsi_create_thread (&w->thrst, gv, name, dds_write_pipeline_worker_thread, w) != DDS_RETCODE_OK)
+    {
+      GVERROR ("dds_write_pipeline_new: can't create transmit worker thread %s\n", name);
+      ddsi_xpack_free (w->xp);
+      dds_write_pipeline_free (pl);
+      return NULL;
+    }
+    pl->nworkers++;
+  }
+  return pl;
+}
+
+void dds_write_pipeline_free (struct dds_write_pipeline *pl)
+{
+  ddsrt_mutex_lock (&pl->lock);
+  assert (pl->runq_head == NULL);
+  pl->stop = true;
+  ddsrt_cond_broadcast (&pl->cond);
+  ddsrt_mutex_unlock (&pl->lock);
+  struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  for (uint32_t i = 0; i < pl->nworkers; i++)
+  {
+    ddsi_join_thread (pl->workers[i].thrst);
+    ddsi_thread_state_awake (thrst, pl->gv);
+    ddsi_xpack_free (pl->workers[i].xp);
+    ddsi_thread_state_asleep (thrst);
+  }
+  ddsrt_cond_destroy (&pl->cond);
+  ddsrt_mutex_destroy (&pl->lock);
+  ddsrt_free (pl);
+}
+
+uint32_t dds_write_pipeline_nworkers (const struct dds_write_pipeline *pl)
+{
+  return pl->nworkers;
+}
+
+void dds_write_pipeline_worker_stats (const struct dds_write_pipeline *pl, uint32_t i, uint64_t *samples, uint64_t *batches)
+{
+  assert (i < pl->nworkers);
+  *samples = ddsrt_atomic_ld64 (&pl->workers[i].samples);
+  *batches = ddsrt_atomic_ld64 (&pl->workers[i].batches);
+}
+
+struct dds_write_async *dds_write_async_new (struct dds_write_pipeline *pl, struct dds_writer *wr, uint32_t depth)
+{
+  uint32_t size = 1;
+  while (size < depth)
+    size *= 2;
+  struct dds_write_async *q = ddsrt_malloc (sizeof (*q) + size * sizeof (q->cells[0]));
+  q->runq_next = NULL;
+  q->pl = pl;
+  q->wr = wr;
+  q->mask = size - 1;
+  ddsrt_atomic_st32 (&q->enqpos, 0);
+  ddsrt_atomic_st32 (&q->deqpos, 0);
+  ddsrt_atomic_st32 (&q->scheduled, 0);
+  ddsrt_atomic_st32 (&q->nwaiters, 0);
+  ddsrt_atomic_st32 (&q->closing, 0);
+  ddsrt_mutex_init (&q->lock);
+  ddsrt_cond_mtime_init (&q->cond);
+  ddsrt_atomic_st32 (&q->max_queued, 0);
+  ddsrt_atomic_st32 (&q->blocked, 0);
+  ddsrt_atomic_st64 (&q->samples, 0);
+  ddsrt_atomic_st64 (&q->latency, 0);
+  ddsrt_atomic_st64 (&q->dropped, 0);
+  for (uint32_t i = 0; i < size; i++)
+  {
+    ddsrt_atomic_st32 (&q->cells[i].seq, i);
+    q->cells[i].sd = NULL;
+    q->cells[i].tenqueue = 0;
+  }
+  return q;
+}
+
+void dds_write_async_free (struct dds_write_async *q)
+{
+  assert (ddsrt_atomic_ld32 (&q->enqpos) == ddsrt_atomic_ld32 (&q->deqpos));
+  assert (ddsrt_atomic_ld32 (&q->scheduled) == 0);
+  ddsrt_cond_mtime_destroy (&q->cond);
+  ddsrt_mutex_destroy (&q->lock);
+  ddsrt_free (q);
+}
+
+dds_return_t dds_write_async_enqueue (struct ddsi_thread_state *thrst, struct dds_write_async *q, struct ddsi_serdata *sd)
+{
+  const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+  if (!try_enqueue (q, sd, tnow.v))
+  {
+    // Queue is full, so a worker is busy with this writer (or about to be), wait for it to
+    // make some space, but no longer than a reliable writer would wait for space in its WHC
+    const ddsrt_mtime_t abstimeout = ddsrt_mtime_add_duration (tnow, q->wr->m_wr->xqos->reliability.max_blocking_time);
+    bool ok;
+    ddsrt_atomic_inc32 (&q->blocked);
+    if (thrst)
+      ddsi_thread_state_asleep (thrst);
+    ddsrt_mutex_lock (&q->lock);
+    ddsrt_atomic_inc32 (&q->nwaiters);
+    while (!(ok = try_enqueue (q, sd, ddsrt_time_monotonic ().v)))
+    {
+      if (!ddsrt_cond_mtime_waituntil (&q->cond, &q->lock, abstimeout))
+      {
+        ok = try_enqueue (q, sd, ddsrt_time_monotonic ().v);
+        break;
+      }
+    }
+    ddsrt_atomic_dec32 (&q->nwaiters);
+    ddsrt_mutex_unlock (&q->lock);
+    if (thrst)
+      ddsi_thread_state_awake (thrst, q->pl->gv);
+    if (!ok)
+    {
+      ddsi_serdata_unref (sd);
+      return DDS_RETCODE_TIMEOUT;
+    }
+  }
+  schedule (q);
+  return DDS_RETCODE_OK;
+}
+
+void dds_write_async_drain (struct dds_write_async *q)
+{
+  ddsrt_mutex_lock (&q->lock);
+  ddsrt_atomic_inc32 (&q->nwaiters);
+  while (ddsrt_atomic_ld32 (&q->enqpos) != ddsrt_atomic_ld32 (&q->deqpos) || ddsrt_atomic_ld32 (&q->scheduled))
+    ddsrt_cond_mtime_wait (&q->cond, &q->lock);
+  ddsrt_atomic_dec32 (&q->nwaiters);
+  ddsrt_mutex_unlock (&q->lock);
+}
+
+void dds_write_async_close (struct dds_write_async *q)
+{
+  // a worker currently waiting for space for a batch from this queue stops doing so
+  // within WRITE_ASYNC_MAX_BLOCK, after which it drops the samples it couldn't write
+  ddsrt_atomic_st32 (&q->closing, 1);
+  dds_write_async_drain (q);
+}
+
+void dds_write_async_get_stats (const struct dds_write_async *q, struct dds_write_async_stats *stats)
+{
+  const uint32_t deqpos = ddsrt_atomic_ld32 (&q->deqpos);
+  stats->queued = ddsrt_atomic_ld32 (&q->enqpos) - deqpos;
+  stats->max_queued = ddsrt_atomic_ld32 (&q->max_queued);
+  stats->blocked = ddsrt_atomic_ld32 (&q->blocked);
+  stats->samples = ddsrt_atomic_ld64 (&q->samples);
+  stats->latency = ddsrt_atomic_ld64 (&q->latency);
+  stats->dropped = ddsrt_atomic_ld64 (&q->dropped);
+}
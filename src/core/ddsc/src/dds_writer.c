@@ -40,6 +40,7 @@
 #include "dds__psmx.h"
 #include "dds__heap_loan.h"
 #include "dds__guid.h"
+#include "dds__write_async.h"
 
 DECL_ENTITY_LOCK_UNLOCK (dds_writer)
 
@@ -185,7 +186,14 @@ static void dds_writer_interrupt (dds_entity *e) ddsrt_nonnull_all;
 
 static void dds_writer_interrupt (dds_entity *e)
 {
+  struct dds_writer * const wr = (struct dds_writer *) e;
   struct ddsi_domaingv * const gv = &e->m_domain->gv;
+  // Samples queued for asynchronous writing have been accepted already, so they are
+  // written before unblocking causes any further writes to fail, but only as far as
+  // the WHC accepts them without waiting: otherwise a reader that doesn't acknowledge
+  // anything would hold up the deletion indefinitely.  The remainder is dropped.
+  if (wr->m_async)
+    dds_write_async_close (wr->m_async);
   ddsi_thread_state_awake (ddsi_lookup_thread_state (), gv);
   ddsi_unblock_throttled_writer (gv, &e->m_guid);
   ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
@@ -198,6 +206,9 @@ static void dds_writer_close (dds_entity *e)
   struct dds_writer * const wr = (struct dds_writer *) e;
   struct ddsi_domaingv * const gv = &e->m_domain->gv;
   struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  // Writes racing with the deletion may have queued more samples after the interrupt
+  if (wr->m_async)
+    dds_write_async_drain (wr->m_async);
   ddsi_thread_state_awake (thrst, gv);
   ddsi_xpack_send (wr->m_xp, false);
   (void) ddsi_delete_writer (gv, &e->m_guid);
@@ -225,6 +236,8 @@ static dds_return_t dds_writer_delete (dds_entity *e)
   ddsi_thread_state_awake (ddsi_lookup_thread_state (), &e->m_domain->gv);
   ddsi_xpack_free (wr->m_xp);
   ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+  if (wr->m_async)
+    dds_write_async_free (wr->m_async);
   dds_entity_drop_ref (&wr->m_topic->m_entity);
   return ret;
 }
@@ -266,24 +279,51 @@ static const struct dds_stat_keyvalue_descriptor dds_writer_statistics_kv[] = {
   { "rexmit_bytes", DDS_STAT_KIND_UINT64 },
   { "throttle_count", DDS_STAT_KIND_UINT32 },
   { "time_throttle", DDS_STAT_KIND_UINT64 },
-  { "time_rexmit", DDS_STAT_KIND_UINT64 }
+  { "time_rexmit", DDS_STAT_KIND_UINT64 },
+  /* congestion control, 0 unless enabled (Internal/CongestionControl) and applicable */
+  { "cc_window", DDS_STAT_KIND_UINT32 },
+  { "cc_rate", DDS_STAT_KIND_UINT64 },
+  { "cc_loss_events", DDS_STAT_KIND_UINT32 },
+  /* only present for writers in asynchronous mode */
+  { "async_queued", DDS_STAT_KIND_UINT32 },
+  { "async_max_queued", DDS_STAT_KIND_UINT32 },
+  { "async_blocked", DDS_STAT_KIND_UINT32 },
+  { "async_samples", DDS_STAT_KIND_UINT64 },
+  { "async_latency", DDS_STAT_KIND_UINT64 },
+  { "async_dropped", DDS_STAT_KIND_UINT64 }
 };
 
-static const struct dds_stat_descriptor dds_writer_statistics_desc = {
-  .count = sizeof (dds_writer_statistics_kv) / sizeof (dds_writer_statistics_kv[0]),
-  .kv = dds_writer_statistics_kv
-};
+#define DDS_WRITER_STATISTICS_SYNC_COUNT 7u
 
 static struct dds_statistics *dds_writer_create_statistics (const struct dds_entity *entity)
 {
-  return dds_alloc_statistics (entity, &dds_writer_statistics_desc);
+  const struct dds_writer *wr = (const struct dds_writer *) entity;
+  const struct dds_stat_descriptor desc = {
+    .count = wr->m_async ? sizeof (dds_writer_statistics_kv) / sizeof (dds_writer_statistics_kv[0]) : DDS_WRITER_STATISTICS_SYNC_COUNT,
+    .kv = dds_writer_statistics_kv
+  };
+  return dds_alloc_statistics (entity, &desc);
 }
 
 static void dds_writer_refresh_statistics (const struct dds_entity *entity, struct dds_statistics *stat)
 {
   const struct dds_writer *wr = (const struct dds_writer *) entity;
   if (wr->m_wr)
+  {
     ddsi_get_writer_stats (wr->m_wr, &stat->kv[0].u.u64, &stat->kv[1].u.u32, &stat->kv[2].u.u64, &stat->kv[3].u.u64);
+    ddsi_get_writer_congestion_stats (wr->m_wr, &stat->kv[4].u.u32, &stat->kv[5].u.u64, &stat->kv[6].u.u32);
+  }
+  if (wr->m_async)
+  {
+    struct dds_write_async_stats as;
+    dds_write_async_get_stats (wr->m_async, &as);
+    stat->kv[7].u.u32 = as.queued;
+    stat->kv[8].u.u32 = as.max_queued;
+    stat->kv[9].u.u32 = as.blocked;
+    stat->kv[10].u.u64 = as.samples;
+    stat->kv[11].u.u64 = as.latency;
+    stat->kv[12].u.u64 = as.dropped;
+  }
 }
 
 const struct dds_entity_deriver dds_entity_deriver_writer = {
@@ -446,6 +486,11 @@ static dds_entity_t dds_create_writer_int (dds_entity_t participant_or_publisher
   dds_psmx_locators_set_free (vl_set);
   ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
 
+  // Asynchronous writing hands the serialized samples to a transmit worker, which doesn't
+  // fit with PSMX, where the sample is handed over to the PSMX directly by the application
+  if (gv->config.async_write && pub->m_entity.m_domain->write_pipeline && wr->m_endpoint.psmx_endpoints.length == 0)
+    wr->m_async = dds_write_async_new (pub->m_entity.m_domain->write_pipeline, wr, (uint32_t) gv->config.async_write_queue_depth);
+
   wr->m_entity.m_iid = ddsi_get_entity_instanceid (&wr->m_entity.m_domain->gv, &wr->m_entity.m_guid);
   dds_entity_register_child (&pub->m_entity, &wr->m_entity);
 
@@ -521,6 +566,8 @@ dds_return_t dds__ddsi_writer_wait_for_acks (struct dds_writer *wr, ddsi_guid_t
 {
   /* during lifetime of the writer m_wr is constant, it is only during deletion that it
      gets erased at some point */
+  if (wr->m_async)
+    dds_write_async_drain (wr->m_async);
   if (wr->m_wr == NULL)
     return DDS_RETCODE_OK;
   else
@@ -37,6 +37,9 @@
 #include "CdrStreamParamHeader.h"
 #include "CdrStreamSerDes.h"
 #include "CdrStreamXcdr1Opt.h"
+#include "CdrStreamSpecialized.h"
+#include "CdrStreamMemcpyPlan.h"
+#include "CdrStreamKeyPlan.h"
 #include "mem_ser.h"
 
 #define DDS_DOMAINID1 0
@@ -2629,3 +2632,789 @@ CU_Test (ddsc_cdrstream, check_xcdr1_appendable_normalize)
   }
 }
 #undef D
+
+static void specialized_descs (struct dds_cdrstream_desc *spec, struct dds_cdrstream_desc *interp, const dds_topic_descriptor_t *tdesc)
+{
+  dds_cdrstream_desc_from_topic_desc (spec, tdesc);
+  CU_ASSERT_FATAL (spec->specialized != NULL);
+  dds_cdrstream_desc_from_topic_desc (interp, tdesc);
+  interp->specialized = NULL;
+}
+
+static void check_specialized_normalize (const struct dds_cdrstream_desc *spec, const struct dds_cdrstream_desc *interp, const unsigned char *cdr, uint32_t size, bool bswap, uint32_t xcdr_version)
+{
+  void *cdr_spec = ddsrt_memdup (cdr, size), *cdr_interp = ddsrt_memdup (cdr, size);
+  uint32_t act_size_spec = 0, act_size_interp = 0;
+  const bool ok_spec = dds_stream_normalize (cdr_spec, size, bswap, xcdr_version, spec, false, &act_size_spec);
+  const bool ok_interp = dds_stream_normalize (cdr_interp, size, bswap, xcdr_version, interp, false, &act_size_interp);
+  CU_ASSERT_EQ_FATAL (ok_spec, ok_interp);
+  if (ok_interp)
+  {
+    CU_ASSERT_EQ_FATAL (act_size_spec, act_size_interp);
+    CU_ASSERT_MEMEQ_FATAL (cdr_spec, size, cdr_interp, size);
+  }
+  ddsrt_free (cdr_spec);
+  ddsrt_free (cdr_interp);
+}
+
+static void check_specialized_read (const struct dds_cdrstream_desc *spec, const struct dds_cdrstream_desc *interp, const dds_ostream_t *os, void *sample)
+{
+  // read with the generated functions and check that it serializes to the same data
+  dds_istream_t is;
+  dds_istream_init (&is, os->m_index, os->m_buffer, os->m_xcdr_version);
+  dds_stream_read_sample (&is, sample, &dds_cdrstream_default_allocator, spec);
+  CU_ASSERT_EQ (is.m_index, os->m_index);
+  dds_ostream_t os_check;
+  dds_ostream_init (&os_check, &dds_cdrstream_default_allocator, 0, os->m_xcdr_version);
+  CU_ASSERT_FATAL (dds_stream_write_sample (&os_check, &dds_cdrstream_default_allocator, sample, interp));
+  CU_ASSERT_MEMEQ_FATAL (os_check.m_buffer, os_check.m_index, os->m_buffer, os->m_index);
+  dds_ostream_fini (&os_check, &dds_cdrstream_default_allocator);
+}
+
+static void check_specialized (const dds_topic_descriptor_t *tdesc, const void *sample, const void *other_sample)
+{
+  struct dds_cdrstream_desc spec, interp;
+  specialized_descs (&spec, &interp, tdesc);
+  const uint32_t xcdr_versions[] = { XCDR1, XCDR2 };
+  for (uint32_t v = 0; v < sizeof (xcdr_versions) / sizeof (xcdr_versions[0]); v++)
+  {
+    const uint32_t xcdrv = xcdr_versions[v];
+    tprintf ("type %s xcdr version %"PRIu32"\n", tdesc->m_typename, xcdrv);
+
+    // serialization and serialized size must be identical to the interpreter's
+    dds_ostream_t os_spec, os_interp, os_other;
+    dds_ostream_init (&os_spec, &dds_cdrstream_default_allocator, 0, xcdrv);
+    dds_ostream_init (&os_interp, &dds_cdrstream_default_allocator, 0, xcdrv);
+    dds_ostream_init (&os_other, &dds_cdrstream_default_allocator, 0, xcdrv);
+    CU_ASSERT_FATAL (dds_stream_write_sample (&os_spec, &dds_cdrstream_default_allocator, sample, &spec));
+    CU_ASSERT_FATAL (dds_stream_write_sample (&os_interp, &dds_cdrstream_default_allocator, sample, &interp));
+    CU_ASSERT_FATAL (dds_stream_write_sample (&os_other, &dds_cdrstream_default_allocator, other_sample, &interp));
+    CU_ASSERT_MEMEQ_FATAL (os_spec.m_buffer, os_spec.m_index, os_interp.m_buffer, os_interp.m_index);
+    CU_ASSERT_EQ (dds_stream_getsize_sample (sample, &spec, xcdrv), (size_t) os_interp.m_index);
+    CU_ASSERT_EQ (dds_stream_getsize_sample (sample, &interp, xcdrv), (size_t) os_interp.m_index);
+
+    // normalizing valid data, in native and swapped byte order
+    check_specialized_normalize (&spec, &interp, os_interp.m_buffer, os_interp.m_index, false, xcdrv);
+    dds_ostreamBE_t os_be;
+    dds_ostreamBE_init (&os_be, &dds_cdrstream_default_allocator, 0, xcdrv);
+    CU_ASSERT_FATAL (dds_stream_write_sampleBE (&os_be, &dds_cdrstream_default_allocator, sample, &interp));
+    check_specialized_normalize (&spec, &interp, os_be.x.m_buffer, os_be.x.m_index, DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN, xcdrv);
+    dds_ostreamBE_fini (&os_be, &dds_cdrstream_default_allocator);
+
+    // normalizing truncated and corrupted data must give the same result
+    for (uint32_t n = 0; n < os_interp.m_index; n++)
+      check_specialized_normalize (&spec, &interp, os_interp.m_buffer, n, false, xcdrv);
+    const unsigned char corrupt_values[] = { 0x02, 0x07, 0x80, 0xff };
+    for (uint32_t n = 0; n < os_interp.m_index; n++)
+    {
+      for (uint32_t c = 0; c < sizeof (corrupt_values); c++)
+      {
+        unsigned char *cdr = ddsrt_memdup (os_interp.m_buffer, os_interp.m_index);
+        cdr[n] = corrupt_values[c];
+        check_specialized_normalize (&spec, &interp, cdr, os_interp.m_index, false, xcdrv);
+        ddsrt_free (cdr);
+      }
+    }
+
+    // reading into an empty sample and into a sample that has data that must be replaced
+    void *rd_sample = ddsrt_calloc (1, tdesc->m_size);
+    check_specialized_read (&spec, &interp, &os_interp, rd_sample);
+    check_specialized_read (&spec, &interp, &os_other, rd_sample);
+    check_specialized_read (&spec, &interp, &os_interp, rd_sample);
+    dds_stream_free_sample (rd_sample, &dds_cdrstream_default_allocator, tdesc->m_ops);
+    ddsrt_free (rd_sample);
+
+    // extracting the key from the data
+    dds_istream_t is;
+    dds_ostream_t osk_spec, osk_interp;
+    dds_ostream_init (&osk_spec, &dds_cdrstream_default_allocator, 0, xcdrv);
+    dds_ostream_init (&osk_interp, &dds_cdrstream_default_allocator, 0, xcdrv);
+    dds_istream_init (&is, os_interp.m_index, os_interp.m_buffer, xcdrv);
+    CU_ASSERT_FATAL (dds_stream_extract_key_from_data (&is, &osk_spec, &dds_cdrstream_default_allocator, &spec));
+    dds_istream_init (&is, os_interp.m_index, os_interp.m_buffer, xcdrv);
+    CU_ASSERT_FATAL (dds_stream_extract_key_from_data (&is, &osk_interp, &dds_cdrstream_default_allocator, &interp));
+    CU_ASSERT_MEMEQ_FATAL (osk_spec.m_buffer, osk_spec.m_index, osk_interp.m_buffer, osk_interp.m_index);
+    dds_ostream_fini (&osk_spec, &dds_cdrstream_default_allocator);
+    dds_ostream_fini (&osk_interp, &dds_cdrstream_default_allocator);
+
+    dds_ostream_fini (&os_spec, &dds_cdrstream_default_allocator);
+    dds_ostream_fini (&os_interp, &dds_cdrstream_default_allocator);
+    dds_ostream_fini (&os_other, &dds_cdrstream_default_allocator);
+  }
+  dds_cdrstream_desc_fini (&spec, &dds_cdrstream_default_allocator);
+  dds_cdrstream_desc_fini (&interp, &dds_cdrstream_default_allocator);
+}
+
+#define SEQ(type, ...) { ._length = sizeof ((type[]) { __VA_ARGS__ }) / sizeof (type), ._maximum = sizeof ((type[]) { __VA_ARGS__ }) / sizeof (type), ._buffer = (type[]) { __VA_ARGS__ } }
+
+CU_Test (ddsc_cdrstream, specialized_ops)
+{
+  CdrStreamSpecialized_Point points[] = { { 1.5, -2.5, 3 }, { 4.0, 5.0, -6 } };
+  CdrStreamSpecialized_Inner inners[] = {
+    { .name = "first", .tag = "t1", .points = SEQ (CdrStreamSpecialized_Point, { 7.0, 8.0, 9 }), .color = CdrStreamSpecialized_GREEN },
+    { .name = "", .tag = "", .points = { 0, 0, NULL, false }, .color = CdrStreamSpecialized_RED },
+    { .name = "third", .tag = "t3tttttt", .points = { 2, 2, points, false }, .color = CdrStreamSpecialized_BLUE }
+  };
+  const CdrStreamSpecialized_Nested nested = {
+    .id = 123, .sid = "key string", .flag = true, .o = 0xab,
+    .se = CdrStreamSpecialized_S2, .me = CdrStreamSpecialized_M3,
+    .ll = { INT64_MIN, 0, INT64_MAX }, .c = 'x',
+    .inner = { .name = "inner", .tag = "tag", .points = { 2, 2, points, false }, .color = CdrStreamSpecialized_BLUE },
+    .inners = { 3, 3, inners, false },
+    .longs = SEQ (int32_t, 1, -2, 3),
+    .doubles = SEQ (double, 0.5, 1.5),
+    .strs = SEQ (char *, "a", "", "abc"),
+    .bstrs = { 3, 3, (char[][5]) { "abcd", "", "x" }, false },
+    .colors = SEQ (CdrStreamSpecialized_Color, CdrStreamSpecialized_BLUE, CdrStreamSpecialized_RED),
+    .bools = SEQ (bool, true, false, true),
+    .pts = { { { 1, 2, 3 }, { 4, 5, 6 } }, { { 7, 8, 9 }, { 10, 11, 12 } } },
+    .names = { "name1", "name2" },
+    .flags = { true, false, true },
+    .f = 3.25f
+  };
+  const CdrStreamSpecialized_Nested nested_other = {
+    .id = 1, .sid = "", .inner = { .name = "other", .tag = "o", .points = { 1, 1, points, false } },
+    .inners = { 1, 1, inners, false },
+    .longs = SEQ (int32_t, 1, 2, 3, 4, 5, 6),
+    .strs = SEQ (char *, "other 1", "other 2", "other 3", "other 4"),
+    .bstrs = { 1, 1, (char[][5]) { "z" }, false },
+    .bools = SEQ (bool, false),
+    .names = { "other1", "other2" }
+  };
+  check_specialized (&CdrStreamSpecialized_Nested_desc, &nested, &nested_other);
+
+  const CdrStreamSpecialized_KeyAfter key_after = {
+    .inner = { .name = "inner", .tag = "tag", .points = { 2, 2, points, false }, .color = CdrStreamSpecialized_GREEN },
+    .inners = { 3, 3, inners, false },
+    .s = { "s1", "s2" },
+    .k = -5,
+    .l = SEQ (int64_t, 1, 2),
+    .ks = "key",
+    .u = UINT64_MAX
+  };
+  const CdrStreamSpecialized_KeyAfter key_after_other = {
+    .inner = { .name = "", .tag = "", .points = { 0, 0, NULL, false } },
+    .inners = { 0, 0, NULL, false },
+    .s = { "", "" },
+    .k = 7,
+    .l = { 0, 0, NULL, false },
+    .ks = "other key"
+  };
+  check_specialized (&CdrStreamSpecialized_KeyAfter_desc, &key_after, &key_after_other);
+}
+
+CU_Test (ddsc_cdrstream, specialized_ops_throughput)
+{
+  // not so much a test as a rough comparison of the time it takes to serialize, normalize
+  // and deserialize a sample using the generated functions and using the interpreter
+  const uint32_t npoints = 1000, nlongs = 1000, iters = 200;
+  CdrStreamSpecialized_Point *points = ddsrt_malloc (npoints * sizeof (*points));
+  for (uint32_t i = 0; i < npoints; i++)
+    points[i] = (CdrStreamSpecialized_Point) { (double) i, -(double) i, (int16_t) i };
+  int32_t *longs = ddsrt_malloc (nlongs * sizeof (*longs));
+  for (uint32_t i = 0; i < nlongs; i++)
+    longs[i] = (int32_t) i;
+  CdrStreamSpecialized_Inner inners[] = {
+    { .name = "first", .tag = "t1", .points = { npoints, npoints, points, false }, .color = CdrStreamSpecialized_GREEN },
+    { .name = "second", .tag = "t2", .points = { npoints, npoints, points, false }, .color = CdrStreamSpecialized_RED }
+  };
+  const CdrStreamSpecialized_Nested sample = {
+    .id = 123, .sid = "key string",
+    .inner = { .name = "inner", .tag = "tag", .points = { npoints, npoints, points, false }, .color = CdrStreamSpecialized_BLUE },
+    .inners = { 2, 2, inners, false },
+    .longs = { nlongs, nlongs, longs, false },
+    .strs = SEQ (char *, "a", "", "abc"),
+    .names = { "name1", "name2" }
+  };
+
+  struct dds_cdrstream_desc descs[2];
+  specialized_descs (&descs[0], &descs[1], &CdrStreamSpecialized_Nested_desc);
+  const char *names[2] = { "specialized", "interpreted" };
+  for (uint32_t d = 0; d < 2; d++)
+  {
+    dds_duration_t t_write = 0, t_normalize = 0, t_read = 0;
+    void *rd_sample = ddsrt_calloc (1, CdrStreamSpecialized_Nested_desc.m_size);
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < iters; i++)
+    {
+      dds_ostream_t os;
+      dds_ostream_init (&os, &dds_cdrstream_default_allocator, 0, XCDR2);
+      dds_time_t t0 = dds_time ();
+      const bool ok = dds_stream_write_sample (&os, &dds_cdrstream_default_allocator, &sample, &descs[d]);
+      t_write += dds_time () - t0;
+      CU_ASSERT_FATAL (ok);
+      size = os.m_index;
+
+      uint32_t act_size;
+      t0 = dds_time ();
+      const bool norm_ok = dds_stream_normalize (os.m_buffer, os.m_index, false, XCDR2, &descs[d], false, &act_size);
+      t_normalize += dds_time () - t0;
+      CU_ASSERT_FATAL (norm_ok);
+
+      dds_istream_t is;
+      dds_istream_init (&is, os.m_index, os.m_buffer, XCDR2);
+      t0 = dds_time ();
+      dds_stream_read_sample (&is, rd_sample, &dds_cdrstream_default_allocator, &descs[d]);
+      t_read += dds_time () - t0;
+      CU_ASSERT_EQ_FATAL (is.m_index, os.m_index);
+      dds_ostream_fini (&os, &dds_cdrstream_default_allocator);
+    }
+    tprintf ("%s (%"PRIu32" bytes): write %.1f MB/s normalize %.1f MB/s read %.1f MB/s\n", names[d], size,
+             (double) size * iters / ((double) (t_write + 1) / 1e3),
+             (double) size * iters / ((double) (t_normalize + 1) / 1e3),
+             (double) size * iters / ((double) (t_read + 1) / 1e3));
+    dds_stream_free_sample (rd_sample, &dds_cdrstream_default_allocator, CdrStreamSpecialized_Nested_desc.m_ops);
+    ddsrt_free (rd_sample);
+  }
+  dds_cdrstream_desc_fini (&descs[0], &dds_cdrstream_default_allocator);
+  dds_cdrstream_desc_fini (&descs[1], &dds_cdrstream_default_allocator);
+  ddsrt_free (longs);
+  ddsrt_free (points);
+}
+
+CU_Test (ddsc_cdrstream, specialized_ops_write_invalid)
+{
+  CdrStreamSpecialized_Inner inners[5] = {
+    { .name = "", .tag = "" }, { .name = "", .tag = "" }, { .name = "", .tag = "" }, { .name = "", .tag = "" }, { .name = "", .tag = "" }
+  };
+  const CdrStreamSpecialized_Nested valid = {
+    .sid = "", .inner = { .name = "", .tag = "" }, .names = { "", "" }
+  };
+  CdrStreamSpecialized_Nested tests[5];
+  for (uint32_t i = 0; i < sizeof (tests) / sizeof (tests[0]); i++)
+    tests[i] = valid;
+  tests[0].se = (CdrStreamSpecialized_SmallEnum) 3; // enum value out of range
+  tests[1].inner.color = (CdrStreamSpecialized_Color) 10; // enum value out of range in nested type
+  tests[2].inners = (dds_sequence_CdrStreamSpecialized_Inner) { 5, 5, inners, false }; // bounded sequence too long
+  memset (tests[3].inner.tag, 'x', sizeof (tests[3].inner.tag)); // bounded string not terminated
+  tests[4].bstrs = (dds_sequence_string4) { 1, 1, (char[][5]) { { 'a', 'b', 'c', 'd', 'e' } }, false }; // bounded string in sequence not terminated
+
+  struct dds_cdrstream_desc spec, interp;
+  specialized_descs (&spec, &interp, &CdrStreamSpecialized_Nested_desc);
+  for (uint32_t i = 0; i < sizeof (tests) / sizeof (tests[0]); i++)
+  {
+    tprintf ("running test %"PRIu32"\n", i);
+    dds_ostream_t os;
+    dds_ostream_init (&os, &dds_cdrstream_default_allocator, 0, XCDR2);
+    CU_ASSERT (!dds_stream_write_sample (&os, &dds_cdrstream_default_allocator, &tests[i], &interp));
+    dds_ostream_fini (&os, &dds_cdrstream_default_allocator);
+    dds_ostream_init (&os, &dds_cdrstream_default_allocator, 0, XCDR2);
+    CU_ASSERT (!dds_stream_write_sample (&os, &dds_cdrstream_default_allocator, &tests[i], &spec));
+    dds_ostream_fini (&os, &dds_cdrstream_default_allocator);
+  }
+  dds_cdrstream_desc_fini (&spec, &dds_cdrstream_default_allocator);
+  dds_cdrstream_desc_fini (&interp, &dds_cdrstream_default_allocator);
+}
+
+CU_Test (ddsc_cdrstream, specialized_ops_not_supported)
+{
+  CU_ASSERT (!(CdrStreamSpecialized_NotFinal_desc.m_flagset & DDS_TOPIC_SPECIALIZED_OPS));
+  CU_ASSERT (CdrStreamSpecialized_NotFinal_desc.specialized_ops == NULL);
+  struct dds_cdrstream_desc desc;
+  dds_cdrstream_desc_from_topic_desc (&desc, &CdrStreamSpecialized_NotFinal_desc);
+  CU_ASSERT (desc.specialized == NULL);
+  dds_cdrstream_desc_fini (&desc, &dds_cdrstream_default_allocator);
+}
+
+CU_Test (ddsc_cdrstream, specialized_ops_write_take)
+{
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  const dds_entity_t tp = dds_create_topic (pp, &CdrStreamSpecialized_KeyAfter_desc, "specialized_ops_write_take", NULL, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t rd = dds_create_reader (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+
+  CdrStreamSpecialized_Point points[] = { { 1.5, -2.5, 3 } };
+  CdrStreamSpecialized_Inner inners[] = { { .name = "n", .tag = "t", .points = { 1, 1, points, false } } };
+  const CdrStreamSpecialized_KeyAfter wrdata = {
+    .inner = { .name = "inner", .tag = "tag", .points = { 1, 1, points, false } },
+    .inners = { 1, 1, inners, false },
+    .s = { "s1", "s2" },
+    .k = 3,
+    .l = SEQ (int64_t, 4, 5),
+    .ks = "key",
+    .u = 6
+  };
+  dds_return_t ret = dds_write (wr, &wrdata);
+  CU_ASSERT_EQ_FATAL (ret, 0);
+  void *rddata = NULL;
+  dds_sample_info_t si;
+  ret = dds_take (rd, &rddata, &si, 1, 1);
+  CU_ASSERT_EQ_FATAL (ret, 1);
+  const CdrStreamSpecialized_KeyAfter *s = rddata;
+  CU_ASSERT_STREQ (s->inner.name, "inner");
+  CU_ASSERT_STREQ (s->inner.tag, "tag");
+  CU_ASSERT_EQ_FATAL (s->inner.points._length, 1);
+  CU_ASSERT_EQ (s->inner.points._buffer[0].z, 3);
+  CU_ASSERT_EQ_FATAL (s->inners._length, 1);
+  CU_ASSERT_STREQ (s->inners._buffer[0].name, "n");
+  CU_ASSERT_STREQ (s->s[1], "s2");
+  CU_ASSERT_EQ (s->k, 3);
+  CU_ASSERT_EQ_FATAL (s->l._length, 2);
+  CU_ASSERT_EQ (s->l._buffer[1], 5);
+  CU_ASSERT_STREQ (s->ks, "key");
+  CU_ASSERT_EQ (s->u, 6);
+  dds_return_loan (rd, &rddata, 1);
+  dds_delete (pp);
+}
+#undef SEQ
+
+static void memcpy_plan_descs (struct dds_cdrstream_desc *plan, struct dds_cdrstream_desc *interp, const dds_topic_descriptor_t *tdesc)
+{
+  dds_cdrstream_desc_from_topic_desc (plan, tdesc);
+  plan->plan_xcdr1 = dds_stream_memcpy_plan (plan, &dds_cdrstream_default_allocator, XCDR1);
+  plan->plan_xcdr2 = dds_stream_memcpy_plan (plan, &dds_cdrstream_default_allocator, XCDR2);
+  CU_ASSERT_FATAL (plan->plan_xcdr1 != NULL && plan->plan_xcdr2 != NULL);
+  dds_cdrstream_desc_from_topic_desc (interp, tdesc);
+}
+
+static void check_memcpy_plan (const dds_topic_descriptor_t *tdesc, const void *sample, const void *other_sample)
+{
+  struct dds_cdrstream_desc plan, interp;
+  memcpy_plan_descs (&plan, &interp, tdesc);
+  const uint32_t xcdr_versions[] = { XCDR1, XCDR2 };
+  for (uint32_t v = 0; v < sizeof (xcdr_versions) / sizeof (xcdr_versions[0]); v++)
+  {
+    const uint32_t xcdrv = xcdr_versions[v];
+    tprintf ("type %s xcdr version %"PRIu32"\n", tdesc->m_typename, xcdrv);
+    dds_ostream_t os_plan, os_interp, os_other;
+    dds_ostreamBE_t osbe_plan, osbe_interp;
+    dds_ostream_init (&os_plan, &dds_cdrstream_default_allocator, 0, xcdrv);
+    dds_ostream_init (&os_interp, &dds_cdrstream_default_allocator, 0, xcdrv);
+    dds_ostream_init (&os_other, &dds_cdrstream_default_allocator, 0, xcdrv);
+    dds_ostreamBE_init (&osbe_plan, &dds_cdrstream_default_allocator, 0, xcdrv);
+    dds_ostreamBE_init (&osbe_interp, &dds_cdrstream_default_allocator, 0, xcdrv);
+
+    // serialization in native and big-endian byte order must be identical to the interpreter's
+    CU_ASSERT_FATAL (dds_stream_write_sample (&os_plan, &dds_cdrstream_default_allocator, sample, &plan));
+    CU_ASSERT_FATAL (dds_stream_write_sample (&os_interp, &dds_cdrstream_default_allocator, sample, &interp));
+    CU_ASSERT_FATAL (dds_stream_write_sample (&os_other, &dds_cdrstream_default_allocator, other_sample, &interp));
+    CU_ASSERT_MEMEQ_FATAL (os_plan.m_buffer, os_plan.m_index, os_interp.m_buffer, os_interp.m_index);
+    CU_ASSERT_FATAL (dds_stream_write_sampleBE (&osbe_plan, &dds_cdrstream_default_allocator, sample, &plan));
+    CU_ASSERT_FATAL (dds_stream_write_sampleBE (&osbe_interp, &dds_cdrstream_default_allocator, sample, &interp));
+    CU_ASSERT_MEMEQ_FATAL (osbe_plan.x.m_buffer, osbe_plan.x.m_index, osbe_interp.x.m_buffer, osbe_interp.x.m_index);
+
+    // reading into an empty sample and into a sample that has data that must be replaced,
+    // re-serializing it must give the original data
+    void *rd_sample = ddsrt_calloc (1, tdesc->m_size);
+    const dds_ostream_t *inputs[] = { &os_interp, &os_other, &os_interp };
+    for (uint32_t i = 0; i < sizeof (inputs) / sizeof (inputs[0]); i++)
+    {
+      dds_istream_t is;
+      dds_istream_init (&is, inputs[i]->m_index, inputs[i]->m_buffer, xcdrv);
+      dds_stream_read_sample (&is, rd_sample, &dds_cdrstream_default_allocator, &plan);
+      CU_ASSERT_EQ (is.m_index, inputs[i]->m_index);
+      dds_ostream_t os_check;
+      dds_ostream_init (&os_check, &dds_cdrstream_default_allocator, 0, xcdrv);
+      CU_ASSERT_FATAL (dds_stream_write_sample (&os_check, &dds_cdrstream_default_allocator, rd_sample, &interp));
+      CU_ASSERT_MEMEQ_FATAL (os_check.m_buffer, os_check.m_index, inputs[i]->m_buffer, inputs[i]->m_index);
+      dds_ostream_fini (&os_check, &dds_cdrstream_default_allocator);
+    }
+    dds_stream_free_sample (rd_sample, &dds_cdrstream_default_allocator, tdesc->m_ops);
+    ddsrt_free (rd_sample);
+
+    dds_ostream_fini (&os_plan, &dds_cdrstream_default_allocator);
+    dds_ostream_fini (&os_interp, &dds_cdrstream_default_allocator);
+    dds_ostream_fini (&os_other, &dds_cdrstream_default_allocator);
+    dds_ostreamBE_fini (&osbe_plan, &dds_cdrstream_default_allocator);
+    dds_ostreamBE_fini (&osbe_interp, &dds_cdrstream_default_allocator);
+  }
+  dds_cdrstream_desc_fini (&plan, &dds_cdrstream_default_allocator);
+  dds_cdrstream_desc_fini (&interp, &dds_cdrstream_default_allocator);
+}
+
+#define SEQ(type, ...) { ._length = sizeof ((type[]) { __VA_ARGS__ }) / sizeof (type), ._maximum = sizeof ((type[]) { __VA_ARGS__ }) / sizeof (type), ._buffer = (type[]) { __VA_ARGS__ } }
+
+CU_Test (ddsc_cdrstream, memcpy_plan)
+{
+  CdrStreamMemcpyPlan_t1 t1 = {
+    .id = 1, .o = 2, .s = "string", .sh = -3, .l = 4, .ll = INT64_MIN, .d = { 0.5, 1.5, 2.5 },
+    .b = true, .c = CdrStreamMemcpyPlan_BLUE, .sm = CdrStreamMemcpyPlan_S2, .md = CdrStreamMemcpyPlan_M1,
+    .bs = "abcde", .seq_s = SEQ (int16_t, 1, 2, 3), .seq_ll = SEQ (int64_t, 4, 5),
+    .inner = { .s = 6, .l = 7, .ll = 8 }, .ch = 'x', .seq_o = SEQ (uint8_t, 9), .f = 10.5f
+  };
+  const CdrStreamMemcpyPlan_t1 t1_other = {
+    .s = "", .bs = "", .seq_s = SEQ (int16_t, 1, 2, 3, 4, 5, 6, 7, 8), .seq_ll = { 0, 0, NULL, false },
+    .seq_o = SEQ (uint8_t, 1, 2, 3, 4, 5, 6, 7, 8, 9)
+  };
+  // strings of different lengths so that the members following them are not
+  // always aligned the same way as in memory
+  const char *strs[] = { "", "a", "ab", "abc", "abcd", "abcde", "abcdef", "abcdefg" };
+  for (uint32_t i = 0; i < sizeof (strs) / sizeof (strs[0]); i++)
+  {
+    t1.s = (char *) strs[i];
+    memcpy (t1.bs, strs[i % 6], strlen (strs[i % 6]) + 1);
+    check_memcpy_plan (&CdrStreamMemcpyPlan_t1_desc, &t1, &t1_other);
+  }
+
+  CdrStreamMemcpyPlan_t2 t2 = { .parent = { .a = 1 }, .c = 2, .d = { 3, 4 }, .e = SEQ (double, 5.0, 6.0) };
+  const CdrStreamMemcpyPlan_t2 t2_other = { .parent = { .a = 2, .b = "other" }, .e = { 0, 0, NULL, false } };
+  for (uint32_t i = 0; i < sizeof (strs) / sizeof (strs[0]); i++)
+  {
+    t2.parent.b = (char *) strs[i];
+    check_memcpy_plan (&CdrStreamMemcpyPlan_t2_desc, &t2, &t2_other);
+  }
+}
+
+CU_Test (ddsc_cdrstream, memcpy_plan_write_invalid)
+{
+  const CdrStreamMemcpyPlan_t1 valid = { .s = "", .bs = "" };
+  CdrStreamMemcpyPlan_t1 tests[4];
+  for (uint32_t i = 0; i < sizeof (tests) / sizeof (tests[0]); i++)
+    tests[i] = valid;
+  tests[0].c = (CdrStreamMemcpyPlan_Color) 3; // enum value out of range
+  tests[1].sm = (CdrStreamMemcpyPlan_Small) 3; // enum value out of range
+  memset (tests[2].bs, 'x', sizeof (tests[2].bs)); // bounded string not terminated
+  tests[3].seq_ll = (dds_sequence_long_long) SEQ (int64_t, 1, 2, 3, 4); // bounded sequence too long
+
+  struct dds_cdrstream_desc plan, interp;
+  memcpy_plan_descs (&plan, &interp, &CdrStreamMemcpyPlan_t1_desc);
+  for (uint32_t i = 0; i < sizeof (tests) / sizeof (tests[0]); i++)
+  {
+    tprintf ("running test %"PRIu32"\n", i);
+    dds_ostream_t os;
+    dds_ostream_init (&os, &dds_cdrstream_default_allocator, 0, XCDR2);
+    CU_ASSERT (!dds_stream_write_sample (&os, &dds_cdrstream_default_allocator, &tests[i], &interp));
+    dds_ostream_fini (&os, &dds_cdrstream_default_allocator);
+    dds_ostream_init (&os, &dds_cdrstream_default_allocator, 0, XCDR2);
+    CU_ASSERT (!dds_stream_write_sample (&os, &dds_cdrstream_default_allocator, &tests[i], &plan));
+    dds_ostream_fini (&os, &dds_cdrstream_default_allocator);
+  }
+  dds_cdrstream_desc_fini (&plan, &dds_cdrstream_default_allocator);
+  dds_cdrstream_desc_fini (&interp, &dds_cdrstream_default_allocator);
+}
+
+CU_Test (ddsc_cdrstream, memcpy_plan_not_supported)
+{
+  const dds_topic_descriptor_t *descs[] = {
+    &CdrStreamMemcpyPlan_not_final_desc,
+    &CdrStreamMemcpyPlan_unsupported_bitmask_desc,
+    &CdrStreamMemcpyPlan_unsupported_seq_desc
+  };
+  for (uint32_t i = 0; i < sizeof (descs) / sizeof (descs[0]); i++)
+  {
+    struct dds_cdrstream_desc desc;
+    dds_cdrstream_desc_from_topic_desc (&desc, descs[i]);
+    CU_ASSERT (dds_stream_memcpy_plan (&desc, &dds_cdrstream_default_allocator, XCDR1) == NULL);
+    CU_ASSERT (dds_stream_memcpy_plan (&desc, &dds_cdrstream_default_allocator, XCDR2) == NULL);
+    dds_cdrstream_desc_fini (&desc, &dds_cdrstream_default_allocator);
+  }
+}
+#undef SEQ
+
+static void check_key_plan (const dds_topic_descriptor_t *tdesc, const void *sample)
+{
+  struct dds_cdrstream_desc plan, interp;
+  dds_cdrstream_desc_from_topic_desc (&plan, tdesc);
+  plan.key_plan = dds_stream_key_plan (&plan, &dds_cdrstream_default_allocator);
+  CU_ASSERT_FATAL (plan.key_plan != NULL);
+  dds_cdrstream_desc_from_topic_desc (&interp, tdesc);
+  const uint32_t xcdr_versions[] = { XCDR1, XCDR2 };
+  for (uint32_t v = 0; v < sizeof (xcdr_versions) / sizeof (xcdr_versions[0]); v++)
+  {
+    dds_ostream_t os;
+    dds_ostream_init (&os, &dds_cdrstream_default_allocator, 0, xcdr_versions[v]);
+    CU_ASSERT_FATAL (dds_stream_write_sample (&os, &dds_cdrstream_default_allocator, sample, &interp));
+    uint32_t actual_size;
+    CU_ASSERT_FATAL (dds_stream_normalize (os.m_buffer, os.m_index, false, xcdr_versions[v], &interp, false, &actual_size));
+
+    // the key extracted using the plan must be identical to the one extracted by the
+    // interpreter and to the one serialized from the sample, for all combinations of
+    // XCDR versions of the data and the key
+    for (uint32_t kv = 0; kv < sizeof (xcdr_versions) / sizeof (xcdr_versions[0]); kv++)
+    {
+      tprintf ("type %s data xcdr version %"PRIu32" key xcdr version %"PRIu32"\n", tdesc->m_typename, xcdr_versions[v], xcdr_versions[kv]);
+      dds_istream_t is;
+      dds_ostream_t osk_plan, osk_interp, osk_sample;
+      dds_ostream_init (&osk_plan, &dds_cdrstream_default_allocator, 0, xcdr_versions[kv]);
+      dds_ostream_init (&osk_interp, &dds_cdrstream_default_allocator, 0, xcdr_versions[kv]);
+      dds_ostream_init (&osk_sample, &dds_cdrstream_default_allocator, 0, xcdr_versions[kv]);
+      dds_istream_init (&is, actual_size, os.m_buffer, xcdr_versions[v]);
+      CU_ASSERT_FATAL (dds_stream_extract_key_from_data (&is, &osk_plan, &dds_cdrstream_default_allocator, &plan));
+      dds_istream_init (&is, actual_size, os.m_buffer, xcdr_versions[v]);
+      CU_ASSERT_FATAL (dds_stream_extract_key_from_data (&is, &osk_interp, &dds_cdrstream_default_allocator, &interp));
+      CU_ASSERT_FATAL (dds_stream_write_key (&osk_sample, DDS_CDR_KEY_SERIALIZATION_SAMPLE, &dds_cdrstream_default_allocator, sample, &interp));
+      CU_ASSERT_MEMEQ (osk_plan.m_buffer, osk_plan.m_index, osk_interp.m_buffer, osk_interp.m_index);
+      CU_ASSERT_MEMEQ (osk_plan.m_buffer, osk_plan.m_index, osk_sample.m_buffer, osk_sample.m_index);
+      dds_ostream_fini (&osk_plan, &dds_cdrstream_default_allocator);
+      dds_ostream_fini (&osk_interp, &dds_cdrstream_default_allocator);
+      dds_ostream_fini (&osk_sample, &dds_cdrstream_default_allocator);
+    }
+    dds_ostream_fini (&os, &dds_cdrstream_default_allocator);
+  }
+  dds_cdrstream_desc_fini (&plan, &dds_cdrstream_default_allocator);
+  dds_cdrstream_desc_fini (&interp, &dds_cdrstream_default_allocator);
+}
+
+CU_Test (ddsc_cdrstream, key_plan)
+{
+  // strings of different lengths so that the members following them are not
+  // always aligned the same way
+  const char *strs[] = { "", "a", "ab", "abc", "abcd", "abcde", "abcdef", "abcdefg" };
+  const uint32_t nstrs = sizeof (strs) / sizeof (strs[0]);
+  int32_t seq[] = { 5, 6, 7 };
+  for (uint32_t i = 0; i < nstrs; i++)
+  {
+    const CdrStreamKeyPlan_t1 t1 = {
+      .a = 1, .s = (char *) strs[i], .b = 2, .c = -3, .d = INT64_MIN,
+      .seq = { ._length = i % 4, ._maximum = 3, ._buffer = seq }, .name = (char *) strs[(i + 3) % nstrs],
+      .after = 8, .after_s = "after"
+    };
+    check_key_plan (&CdrStreamKeyPlan_t1_desc, &t1);
+
+    CdrStreamKeyPlan_t2 t2 = {
+      .o = 1, .k = { .x = 2, .y = 3, .z = 4 }, .ll = 5, .arr = { 6, 7, 8 }, .sm = CdrStreamKeyPlan_S1,
+      .bl = true, .c = CdrStreamKeyPlan_BLUE, .d = 9.5
+    };
+    memcpy (t2.bs, strs[i], strlen (strs[i]) + 1);
+    check_key_plan (&CdrStreamKeyPlan_t2_desc, &t2);
+
+    const CdrStreamKeyPlan_t3 t3 = {
+      .parent = { .id = 1, .s = (char *) strs[i], .inner = { .x = 2, .y = 3, .z = 4 }, .name = (char *) strs[(i + 5) % nstrs], .ch = 'x' },
+      .l = 5, .after_s = "after"
+    };
+    check_key_plan (&CdrStreamKeyPlan_t3_desc, &t3);
+  }
+}
+
+CU_Test (ddsc_cdrstream, key_plan_not_supported)
+{
+  const dds_topic_descriptor_t *descs[] = {
+    &CdrStreamKeyPlan_not_final_desc,
+    &CdrStreamKeyPlan_key_seq_desc,
+    &CdrStreamMemcpyPlan_t2_desc // no key
+  };
+  for (uint32_t i = 0; i < sizeof (descs) / sizeof (descs[0]); i++)
+  {
+    struct dds_cdrstream_desc desc;
+    dds_cdrstream_desc_from_topic_desc (&desc, descs[i]);
+    CU_ASSERT (dds_stream_key_plan (&desc, &dds_cdrstream_default_allocator) == NULL);
+    dds_cdrstream_desc_fini (&desc, &dds_cdrstream_default_allocator);
+  }
+}
+
+struct swap_test { dds_sequence_t s2, s4, s8, e2, e4, b; bool ba[40]; };
+
+static const uint32_t swap_test_ops[] = {
+  DDS_OP_ADR | DDS_OP_TYPE_SEQ | DDS_OP_SUBTYPE_2BY, offsetof (struct swap_test, s2),
+  DDS_OP_ADR | DDS_OP_TYPE_SEQ | DDS_OP_SUBTYPE_4BY, offsetof (struct swap_test, s4),
+  DDS_OP_ADR | DDS_OP_TYPE_SEQ | DDS_OP_SUBTYPE_8BY, offsetof (struct swap_test, s8),
+  DDS_OP_ADR | DDS_OP_TYPE_SEQ | DDS_OP_SUBTYPE_ENU | (1 << DDS_OP_FLAG_SZ_SHIFT), offsetof (struct swap_test, e2), 300u,
+  DDS_OP_ADR | DDS_OP_TYPE_SEQ | DDS_OP_SUBTYPE_ENU | (2 << DDS_OP_FLAG_SZ_SHIFT), offsetof (struct swap_test, e4), 300u,
+  DDS_OP_ADR | DDS_OP_TYPE_SEQ | DDS_OP_SUBTYPE_BLN, offsetof (struct swap_test, b),
+  DDS_OP_ADR | DDS_OP_TYPE_ARR | DDS_OP_SUBTYPE_BLN, offsetof (struct swap_test, ba), 40u,
+  DDS_OP_RTS
+};
+
+static void swap_test_put (unsigned char *cdr, uint32_t *off, uint64_t v, uint32_t sz, uint32_t align, bool be)
+{
+  while (*off % align)
+    cdr[(*off)++] = 0;
+  for (uint32_t i = 0; i < sz; i++)
+    cdr[*off + i] = (unsigned char) (v >> (8 * (be ? sz - 1 - i : i)));
+  *off += sz;
+}
+
+static uint64_t swap_test_value (uint32_t i)
+{
+  // different value for each of the bytes in an element, so that a wrong permutation shows up
+  return (uint64_t) (i + 1) * UINT64_C (0x0101010101010101) + UINT64_C (0x0011223344556677);
+}
+
+// Builds the CDR for a swap_test sample with all sequences of length n in the requested
+// byte order, with values in the bool array that are not 0 or 1 if "odd_bools" is set; the
+// offsets of the elements of the two enum sequences are stored in enum_offs if not null
+static uint32_t swap_test_cdr (unsigned char *cdr, uint32_t n, uint32_t xcdrv, bool be, bool odd_bools, uint32_t *enum_offs)
+{
+  const uint32_t sz[] = { 2, 4, 8 };
+  uint32_t off = 0;
+  for (uint32_t k = 0; k < 3; k++)
+  {
+    swap_test_put (cdr, &off, n, 4, 4, be);
+    for (uint32_t i = 0; i < n; i++)
+      swap_test_put (cdr, &off, swap_test_value (i), sz[k], (sz[k] == 8 && xcdrv == XCDR2) ? 4 : sz[k], be);
+  }
+  for (uint32_t k = 1; k < 3; k++)
+  {
+    if (xcdrv == XCDR2)
+      swap_test_put (cdr, &off, 4 + n * sz[k - 1], 4, 4, be); // DHEADER
+    swap_test_put (cdr, &off, n, 4, 4, be);
+    if (enum_offs)
+      enum_offs[k - 1] = off;
+    for (uint32_t i = 0; i < n; i++)
+      swap_test_put (cdr, &off, i % 300, sz[k - 1], sz[k - 1], be);
+  }
+  swap_test_put (cdr, &off, n, 4, 4, be);
+  for (uint32_t i = 0; i < n; i++)
+    swap_test_put (cdr, &off, (i % 3) != 0, 1, 1, be);
+  for (uint32_t i = 0; i < 40; i++)
+    swap_test_put (cdr, &off, odd_bools ? (i % 3) * (i % 5) : (i % 3) != 0, 1, 1, be);
+  return off;
+}
+
+CU_Test (ddsc_cdrstream, normalize_swap_arrays)
+{
+  const bool native_be = (DDSRT_ENDIAN == DDSRT_BIG_ENDIAN);
+  struct dds_cdrstream_desc desc;
+  memset (&desc, 0, sizeof (desc));
+  dds_cdrstream_desc_init_with_nops (&desc, &dds_cdrstream_default_allocator, sizeof (struct swap_test), dds_alignof (struct swap_test), 0, swap_test_ops, sizeof (swap_test_ops) / sizeof (swap_test_ops[0]), NULL, 0);
+  // up to 3 KiB of sequence data, 16 bytes of slack to vary the position of the data
+  // relative to the vector width used for swapping
+  const uint32_t maxn = 96, bufsz = 16 + 6 * (8 + 8 * maxn + 4) + 40;
+  uint64_t *bufs[3];
+  for (uint32_t k = 0; k < 3; k++)
+    bufs[k] = ddsrt_malloc (bufsz);
+  for (uint32_t xcdrv = XCDR1; xcdrv <= XCDR2; xcdrv++)
+  {
+    for (uint32_t n = 0; n <= maxn; n++)
+    {
+      for (uint32_t start = 0; start < 16; start += 4)
+      {
+        unsigned char * const swapped = (unsigned char *) bufs[0] + start;
+        unsigned char * const native = (unsigned char *) bufs[1];
+        const uint32_t size = swap_test_cdr (swapped, n, xcdrv, !native_be, false, NULL);
+        CU_ASSERT_EQ_FATAL (swap_test_cdr (native, n, xcdrv, native_be, false, NULL), size);
+
+        uint32_t act_size;
+        CU_ASSERT_FATAL (dds_stream_normalize (swapped, size, true, xcdrv, &desc, false, &act_size));
+        CU_ASSERT_EQ_FATAL (act_size, size);
+        CU_ASSERT_MEMEQ_FATAL (swapped, size, native, size);
+
+        // bools other than 0/1 in an array get mapped to 1
+        unsigned char * const odd = (unsigned char *) bufs[2] + start;
+        CU_ASSERT_EQ_FATAL (swap_test_cdr (odd, n, xcdrv, !native_be, true, NULL), size);
+        CU_ASSERT_FATAL (dds_stream_normalize (odd, size, true, xcdrv, &desc, false, &act_size));
+        swap_test_cdr (native, n, xcdrv, native_be, false, NULL);
+        for (uint32_t i = 0; i < 40; i++)
+          native[size - 40 + i] = ((i % 3) * (i % 5)) != 0;
+        CU_ASSERT_MEMEQ_FATAL (odd, size, native, size);
+
+        // an out-of-range enum value anywhere in the array must be rejected (for the
+        // 16-bit enum, the value would be in range if it weren't swapped)
+        for (uint32_t i = 0; i < n; i += 7)
+        {
+          for (uint32_t k = 0; k < 2; k++)
+          {
+            unsigned char * const inv = (unsigned char *) bufs[2] + start;
+            uint32_t enum_offs[2];
+            swap_test_cdr (inv, n, xcdrv, !native_be, false, enum_offs);
+            const uint32_t esz = (k == 0) ? 2 : 4, off = enum_offs[k] + i * esz;
+            memset (inv + off, 0, esz);
+            inv[off + (native_be ? 1 : esz - 2)] = 2; // 512
+            CU_ASSERT_FATAL (!dds_stream_normalize (inv, size, true, xcdrv, &desc, false, &act_size));
+          }
+        }
+      }
+    }
+
+    // writing in the non-native byte order uses the same swapping code
+    struct swap_test sample;
+    memset (&sample, 0, sizeof (sample));
+    dds_sequence_t *seqs[] = { &sample.s2, &sample.s4, &sample.s8, &sample.e2, &sample.e4, &sample.b };
+    unsigned char * const ref = (unsigned char *) bufs[0];
+    for (uint32_t n = 0; n <= maxn; n += 5)
+    {
+      const uint32_t size = swap_test_cdr (ref, n, xcdrv, native_be, false, NULL);
+      dds_istream_t is;
+      dds_istream_init (&is, size, ref, xcdrv);
+      dds_stream_read_sample (&is, &sample, &dds_cdrstream_default_allocator, &desc);
+      for (uint32_t k = 0; k < sizeof (seqs) / sizeof (seqs[0]); k++)
+        CU_ASSERT_EQ_FATAL (seqs[k]->_length, n);
+
+      dds_ostreamBE_t os;
+      dds_ostreamBE_init (&os, &dds_cdrstream_default_allocator, 0, xcdrv);
+      CU_ASSERT_FATAL (dds_stream_write_sampleBE (&os, &dds_cdrstream_default_allocator, &sample, &desc));
+      const uint32_t size_be = swap_test_cdr ((unsigned char *) bufs[1], n, xcdrv, true, false, NULL);
+      CU_ASSERT_MEMEQ_FATAL (os.x.m_buffer, os.x.m_index, bufs[1], size_be);
+      dds_ostreamBE_fini (&os, &dds_cdrstream_default_allocator);
+    }
+    dds_stream_free_sample (&sample, &dds_cdrstream_default_allocator, desc.ops.ops);
+  }
+  for (uint32_t k = 0; k < 3; k++)
+    ddsrt_free (bufs[k]);
+  dds_cdrstream_desc_fini (&desc, &dds_cdrstream_default_allocator);
+}
+
+CU_Test (ddsc_cdrstream, normalize_swap_throughput)
+{
+  // not so much a test as a rough measurement of the throughput of byte-swapping large
+  // sequences of 2, 4 and 8-byte elements while normalizing
+  struct dds_cdrstream_desc desc;
+  memset (&desc, 0, sizeof (desc));
+  dds_cdrstream_desc_init_with_nops (&desc, &dds_cdrstream_default_allocator, sizeof (struct swap_test), dds_alignof (struct swap_test), 0, swap_test_ops, sizeof (swap_test_ops) / sizeof (swap_test_ops[0]), NULL, 0);
+  const uint32_t nbytes = 256 * 1024, iters = 200;
+  void *data = ddsrt_calloc (1, nbytes);
+  for (uint32_t k = 0; k < 3; k++)
+  {
+    struct swap_test sample;
+    memset (&sample, 0, sizeof (sample));
+    dds_sequence_t *seq = (k == 0) ? &sample.s2 : (k == 1) ? &sample.s4 : &sample.s8;
+    const uint32_t elem_sz = 2u << k;
+    seq->_length = seq->_maximum = nbytes / elem_sz;
+    seq->_buffer = data;
+    dds_ostreamBE_t os;
+    dds_ostreamBE_init (&os, &dds_cdrstream_default_allocator, 0, XCDR2);
+    CU_ASSERT_FATAL (dds_stream_write_sampleBE (&os, &dds_cdrstream_default_allocator, &sample, &desc));
+    void *cdr = ddsrt_malloc (os.x.m_index);
+    dds_duration_t t = 0;
+    for (uint32_t i = 0; i < iters; i++)
+    {
+      memcpy (cdr, os.x.m_buffer, os.x.m_index);
+      uint32_t act_size;
+      const dds_time_t t0 = dds_time ();
+      const bool ok = dds_stream_normalize (cdr, os.x.m_index, true, XCDR2, &desc, false, &act_size);
+      t += dds_time () - t0;
+      CU_ASSERT_FATAL (ok);
+    }
+    tprintf ("%"PRIu32"-byte elements: %.1f MB/s\n", elem_sz, (double) nbytes * iters / ((double) (t + 1) / 1e3));
+    ddsrt_free (cdr);
+    dds_ostreamBE_fini (&os, &dds_cdrstream_default_allocator);
+  }
+  ddsrt_free (data);
+  dds_cdrstream_desc_fini (&desc, &dds_cdrstream_default_allocator);
+}
+
+CU_Test (ddsc_cdrstream, fixed_serialized_size)
+{
+  static const struct {
+    const dds_topic_descriptor_t *desc;
+    bool fixed;
+  } tests[] = {
+#define F(n) { &CdrStreamOptimize_ ## n ## _desc, true }
+#define V(n) { &CdrStreamOptimize_ ## n ## _desc, false }
+    F(t1), F(t1_a), V(t1_m), F(t2), V(t3), F(t4b), F(t5a), F(t6a), F(t8), F(t9), F(t10), F(t11a),
+    F(t12), F(t14), F(t15), V(t16), V(t17), V(t18), V(t19), V(t20), F(t21), F(t22), V(t23), V(t24),
+    V(t25), V(t26), F(t27), F(t28), F(t29), F(t30)
+#undef V
+#undef F
+  };
+  for (uint32_t i = 0; i < sizeof (tests) / sizeof (tests[0]); i++)
+  {
+    struct dds_cdrstream_desc desc;
+    dds_cdrstream_desc_from_topic_desc (&desc, tests[i].desc);
+    void *sample = ddsrt_calloc (1, desc.size);
+    for (uint32_t xcdrv = XCDR1; xcdrv <= XCDR2; xcdrv++)
+    {
+      const size_t fixed_size = dds_stream_fixed_serialized_size (&desc, &dds_cdrstream_default_allocator, xcdrv);
+      tprintf ("%s XCDR%"PRIu32": %"PRIuSIZE"\n", tests[i].desc->m_typename, xcdrv, fixed_size);
+      CU_ASSERT_EQ_FATAL (fixed_size > 0, tests[i].fixed);
+      if (fixed_size > 0)
+      {
+        dds_ostream_t os;
+        dds_ostream_init (&os, &dds_cdrstream_default_allocator, 0, xcdrv);
+        CU_ASSERT_FATAL (dds_stream_write_sample (&os, &dds_cdrstream_default_allocator, sample, &desc));
+        CU_ASSERT_EQ (os.m_index, fixed_size);
+        dds_ostream_fini (&os, &dds_cdrstream_default_allocator);
+      }
+    }
+    ddsrt_free (sample);
+    dds_cdrstream_desc_fini (&desc, &dds_cdrstream_default_allocator);
+  }
+}
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 
 #include "dds/dds.h"
+#include "dds/ddsc/dds_statistics.h"
 #include "config_env.h"
 
 #include "dds/version.h"
@@ -18,6 +19,7 @@
 #include "dds/ddsrt/cdtors.h"
 #include "dds/ddsrt/environ.h"
 #include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/threads.h"
 #include "ddsi__misc.h"
 #include "dds/ddsi/ddsi_xqos.h"
 
@@ -400,6 +402,530 @@ CU_Test(ddsc_config, too_deep_nesting, .init = ddsrt_init, .fini = ddsrt_fini)
   dds_set_trace_sink (NULL, NULL);
 }
 
+CU_Test (ddsc_config, receive_shards, .init = ddsrt_init, .fini = ddsrt_fini)
+{
+  char tpname[100];
+  create_unique_topic_name ("ddsc_config_receive_shards", tpname, sizeof (tpname));
+
+  const char *cyclonedds_uri;
+  if (ddsrt_getenv ("CYCLONEDDS_URI", &cyclonedds_uri) != DDS_RETCODE_OK)
+    cyclonedds_uri = "";
+  char *config;
+  (void) ddsrt_asprintf (&config, "%s,"
+                         "<Discovery>"
+                         "  <ExternalDomainId>0</ExternalDomainId>"
+                         "  <ParticipantIndex>auto</ParticipantIndex>"
+                         "</Discovery>"
+                         "<Internal>"
+                         "  <MultipleReceiveThreads>true</MultipleReceiveThreads>"
+                         "  <ReceiveShards>4</ReceiveShards>"
+                         "</Internal>",
+                         cyclonedds_uri);
+  dds_entity_t domw = dds_create_domain (0, config);
+  CU_ASSERT_GT_FATAL (domw, 0);
+  dds_entity_t domr = dds_create_domain (1, config);
+  CU_ASSERT_GT_FATAL (domr, 0);
+  ddsrt_free (config);
+
+  dds_entity_t dpw = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_GT_FATAL (dpw, 0);
+  dds_entity_t dpr = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_GT_FATAL (dpr, 0);
+  dds_entity_t tpw = dds_create_topic (dpw, &Space_Type1_desc, tpname, NULL, NULL);
+  CU_ASSERT_GT_FATAL (tpw, 0);
+  dds_entity_t tpr = dds_create_topic (dpr, &Space_Type1_desc, tpname, NULL, NULL);
+  CU_ASSERT_GT_FATAL (tpr, 0);
+
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  dds_entity_t wr = dds_create_writer (dpw, tpw, qos, NULL);
+  CU_ASSERT_GT_FATAL (wr, 0);
+  dds_entity_t rd = dds_create_reader (dpr, tpr, qos, NULL);
+  CU_ASSERT_GT_FATAL (rd, 0);
+  dds_delete_qos (qos);
+  sync_reader_writer (dpr, rd, dpw, wr);
+
+  const int32_t nsamples = 100;
+  for (int32_t i = 0; i < nsamples; i++)
+  {
+    const Space_Type1 s = { i, 0, 0 };
+    dds_return_t rc = dds_write (wr, &s);
+    CU_ASSERT_EQ_FATAL (rc, 0);
+  }
+
+  // All data comes from a single writer and so arrives on a single socket, in order
+  int32_t next = 0;
+  const dds_time_t tend = dds_time () + DDS_SECS (10);
+  while (next < nsamples && dds_time () < tend)
+  {
+    Space_Type1 s;
+    void *raw = &s;
+    dds_sample_info_t si;
+    if (dds_take (rd, &raw, &si, 1, 1) <= 0)
+      dds_sleepfor (DDS_MSECS (10));
+    else if (si.valid_data)
+    {
+      CU_ASSERT_EQ_FATAL (s.long_1, next);
+      next++;
+    }
+  }
+  CU_ASSERT_EQ (next, nsamples);
+
+  dds_return_t rc;
+  rc = dds_delete (domw);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  rc = dds_delete (domr);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+}
+
+#define RHC_SHARDS_NINST 50
+#define RHC_SHARDS_NSAMPLES 4
+
+struct rhc_shards_writer_arg {
+  dds_entity_t wr;
+  int32_t keybase;
+};
+
+static uint32_t rhc_shards_writer (void *varg)
+{
+  const struct rhc_shards_writer_arg *arg = varg;
+  for (int32_t j = 0; j < RHC_SHARDS_NSAMPLES; j++)
+    for (int32_t k = 0; k < RHC_SHARDS_NINST; k++)
+    {
+      const Space_Type1 s = { arg->keybase + k, j, 0 };
+      if (dds_write (arg->wr, &s) != 0)
+        return 1;
+    }
+  return 0;
+}
+
+static bool rhc_shards_even_key (const void *vs)
+{
+  const Space_Type1 *s = vs;
+  return (s->long_1 % 2) == 0;
+}
+
+static int32_t rhc_shards_readtake (dds_entity_t rd, bool take)
+{
+  void *raw[2 * RHC_SHARDS_NINST * RHC_SHARDS_NSAMPLES + 1] = { NULL };
+  dds_sample_info_t si[sizeof (raw) / sizeof (raw[0])];
+  const int32_t n = take ? dds_take (rd, raw, si, sizeof (raw) / sizeof (raw[0]), sizeof (raw) / sizeof (raw[0]))
+                         : dds_read (rd, raw, si, sizeof (raw) / sizeof (raw[0]), sizeof (raw) / sizeof (raw[0]));
+  if (n > 0)
+  {
+    dds_return_t rc = dds_return_loan (rd, raw, n);
+    CU_ASSERT_EQ_FATAL (rc, 0);
+  }
+  return n;
+}
+
+CU_Test (ddsc_config, reader_cache_shards, .init = ddsrt_init, .fini = ddsrt_fini)
+{
+  char tpname[100];
+  create_unique_topic_name ("ddsc_config_reader_cache_shards", tpname, sizeof (tpname));
+
+  const char *cyclonedds_uri;
+  if (ddsrt_getenv ("CYCLONEDDS_URI", &cyclonedds_uri) != DDS_RETCODE_OK)
+    cyclonedds_uri = "";
+  char *config;
+  (void) ddsrt_asprintf (&config, "%s,<Internal><ReaderCacheShards>4</ReaderCacheShards></Internal>", cyclonedds_uri);
+  dds_entity_t dom = dds_create_domain (0, config);
+  CU_ASSERT_GT_FATAL (dom, 0);
+  ddsrt_free (config);
+
+  dds_entity_t dp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_GT_FATAL (dp, 0);
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  dds_entity_t tp = dds_create_topic (dp, &Space_Type1_desc, tpname, qos, NULL);
+  CU_ASSERT_GT_FATAL (tp, 0);
+  dds_entity_t rd = dds_create_reader (dp, tp, qos, NULL);
+  CU_ASSERT_GT_FATAL (rd, 0);
+  dds_entity_t wrs[2];
+  for (int i = 0; i < 2; i++)
+  {
+    wrs[i] = dds_create_writer (dp, tp, qos, NULL);
+    CU_ASSERT_GT_FATAL (wrs[i], 0);
+  }
+  dds_delete_qos (qos);
+
+  // conditions on the reader are shared by the shards
+  dds_entity_t rdcond = dds_create_readcondition (rd, DDS_NOT_READ_SAMPLE_STATE);
+  CU_ASSERT_GT_FATAL (rdcond, 0);
+  dds_entity_t qcond = dds_create_querycondition (rd, DDS_ANY_STATE, rhc_shards_even_key);
+  CU_ASSERT_GT_FATAL (qcond, 0);
+
+  // local delivery stores the data in the writing threads, so these run in parallel
+  struct rhc_shards_writer_arg wrargs[2];
+  ddsrt_thread_t tids[2];
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  for (int i = 0; i < 2; i++)
+  {
+    wrargs[i] = (struct rhc_shards_writer_arg) { .wr = wrs[i], .keybase = 1000 * i };
+    dds_return_t rc = ddsrt_thread_create (&tids[i], "rhcwr", &tattr, rhc_shards_writer, &wrargs[i]);
+    CU_ASSERT_EQ_FATAL (rc, 0);
+  }
+  for (int i = 0; i < 2; i++)
+  {
+    uint32_t res;
+    dds_return_t rc = ddsrt_thread_join (tids[i], &res);
+    CU_ASSERT_EQ_FATAL (rc, 0);
+    CU_ASSERT_EQ_FATAL (res, 0);
+  }
+
+  const int32_t ntotal = 2 * RHC_SHARDS_NINST * RHC_SHARDS_NSAMPLES;
+  CU_ASSERT_EQ (dds_triggered (rdcond), 1);
+  CU_ASSERT_EQ (dds_triggered (qcond), 1);
+  CU_ASSERT_EQ (rhc_shards_readtake (qcond, false), ntotal / 2);
+  // reading through the query condition marked half the samples read
+  CU_ASSERT_EQ (rhc_shards_readtake (rdcond, false), ntotal / 2);
+  CU_ASSERT_EQ (dds_triggered (rdcond), 0);
+  CU_ASSERT_EQ (dds_triggered (qcond), 1);
+
+  // an instance lives in a single shard
+  const Space_Type1 key = { 1007, 0, 0 };
+  const dds_instance_handle_t ih = dds_lookup_instance (rd, &key);
+  CU_ASSERT_NEQ_FATAL (ih, 0);
+  void *raw[RHC_SHARDS_NSAMPLES + 1] = { NULL };
+  dds_sample_info_t si[RHC_SHARDS_NSAMPLES + 1];
+  int32_t n = dds_take_instance (rd, raw, si, RHC_SHARDS_NSAMPLES + 1, RHC_SHARDS_NSAMPLES + 1, ih);
+  CU_ASSERT_EQ_FATAL (n, RHC_SHARDS_NSAMPLES);
+  for (int32_t j = 0; j < n; j++)
+  {
+    const Space_Type1 *s = raw[j];
+    CU_ASSERT_EQ (s->long_1, 1007);
+    CU_ASSERT_EQ (s->long_2, j);
+  }
+  dds_return_t rc = dds_return_loan (rd, raw, n);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+
+  CU_ASSERT_EQ (rhc_shards_readtake (rd, true), ntotal - RHC_SHARDS_NSAMPLES);
+  CU_ASSERT_EQ (dds_triggered (qcond), 0);
+  CU_ASSERT_EQ (rhc_shards_readtake (rd, true), 0);
+
+  rc = dds_delete (dom);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+}
+
+#undef RHC_SHARDS_NINST
+#undef RHC_SHARDS_NSAMPLES
+
+static uint32_t rhc_stat_u32 (struct dds_statistics *stat, const char *name)
+{
+  const struct dds_stat_keyvalue *kv = dds_lookup_statistic (stat, name);
+  CU_ASSERT_FATAL (kv != NULL);
+  CU_ASSERT_EQ_FATAL (kv->kind, DDS_STAT_KIND_UINT32);
+  return kv->u.u32;
+}
+
+CU_Test (ddsc_config, reader_cache_prealloc, .init = ddsrt_init, .fini = ddsrt_fini)
+{
+  char tpname[100];
+  create_unique_topic_name ("ddsc_config_reader_cache_prealloc", tpname, sizeof (tpname));
+
+  const char *cyclonedds_uri;
+  if (ddsrt_getenv ("CYCLONEDDS_URI", &cyclonedds_uri) != DDS_RETCODE_OK)
+    cyclonedds_uri = "";
+  char *config;
+  (void) ddsrt_asprintf (&config, "%s,<Internal><ReaderCacheMaxPrealloc>50</ReaderCacheMaxPrealloc></Internal>", cyclonedds_uri);
+  dds_entity_t dom = dds_create_domain (0, config);
+  CU_ASSERT_GT_FATAL (dom, 0);
+  ddsrt_free (config);
+
+  dds_entity_t dp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_GT_FATAL (dp, 0);
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  dds_entity_t tp = dds_create_topic (dp, &Space_Type1_desc, tpname, qos, NULL);
+  CU_ASSERT_GT_FATAL (tp, 0);
+  dds_entity_t wr = dds_create_writer (dp, tp, qos, NULL);
+  CU_ASSERT_GT_FATAL (wr, 0);
+  dds_qset_resource_limits (qos, 100, 10, 10);
+  dds_entity_t rd = dds_create_reader (dp, tp, qos, NULL);
+  CU_ASSERT_GT_FATAL (rd, 0);
+  dds_delete_qos (qos);
+
+  // all instances, but only 50 of the remaining 90 samples are reserved up front
+  struct dds_statistics *stat = dds_create_statistics (rd);
+  CU_ASSERT_FATAL (stat != NULL);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_instances_reserved"), 10);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_reserved"), 50);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_instances_used"), 0);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_used"), 0);
+
+  // the first sample of an instance is stored in the instance
+  dds_return_t rc;
+  for (int32_t k = 0; k < 5; k++)
+  {
+    for (int32_t j = 0; j < 4; j++)
+    {
+      rc = dds_write (wr, &(Space_Type1){ k, j, 0 });
+      CU_ASSERT_EQ_FATAL (rc, 0);
+    }
+  }
+  rc = dds_refresh_statistics (stat);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_instances_used"), 5);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_used"), 15);
+
+  void *raw[20] = { NULL };
+  dds_sample_info_t si[20];
+  rc = dds_take (rd, raw, si, 20, 20);
+  CU_ASSERT_EQ_FATAL (rc, 20);
+  rc = dds_return_loan (rd, raw, rc);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  rc = dds_refresh_statistics (stat);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_instances_used"), 5);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_used"), 0);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_reserved"), 50);
+
+  dds_delete_statistics (stat);
+  rc = dds_delete (dom);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+}
+
+CU_Test (ddsc_config, reader_cache_release, .init = ddsrt_init, .fini = ddsrt_fini)
+{
+  char tpname[100];
+  create_unique_topic_name ("ddsc_config_reader_cache_release", tpname, sizeof (tpname));
+
+  dds_entity_t dp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_GT_FATAL (dp, 0);
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  dds_entity_t tp = dds_create_topic (dp, &Space_Type1_desc, tpname, qos, NULL);
+  CU_ASSERT_GT_FATAL (tp, 0);
+  dds_entity_t wr = dds_create_writer (dp, tp, qos, NULL);
+  CU_ASSERT_GT_FATAL (wr, 0);
+  dds_entity_t rd = dds_create_reader (dp, tp, qos, NULL);
+  CU_ASSERT_GT_FATAL (rd, 0);
+  dds_delete_qos (qos);
+
+  // no resource limits: nothing reserved up front, the slab grows in chunks of 16, 16, 32,
+  // 64, ... objects for storing all but the first sample of the instance
+  dds_return_t rc;
+  for (int32_t j = 0; j < 1000; j++)
+  {
+    rc = dds_write (wr, &(Space_Type1){ 0, j, 0 });
+    CU_ASSERT_EQ_FATAL (rc, 0);
+  }
+  struct dds_statistics *stat = dds_create_statistics (rd);
+  CU_ASSERT_FATAL (stat != NULL);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_used"), 999);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_reserved"), 1024);
+
+  // taking all but the last few frees all chunks but the largest, which still has some
+  // samples in it; taking the rest leaves it as the one spare chunk
+  void *raw[1] = { NULL };
+  dds_sample_info_t si[1];
+  for (int32_t j = 0; j < 990; j++)
+  {
+    rc = dds_take (rd, raw, si, 1, 1);
+    CU_ASSERT_EQ_FATAL (rc, 1);
+    rc = dds_return_loan (rd, raw, rc);
+    CU_ASSERT_EQ_FATAL (rc, 0);
+  }
+  rc = dds_refresh_statistics (stat);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_used"), 10);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_reserved"), 512 + 256);
+  for (int32_t j = 0; j < 10; j++)
+  {
+    rc = dds_take (rd, raw, si, 1, 1);
+    CU_ASSERT_EQ_FATAL (rc, 1);
+    rc = dds_return_loan (rd, raw, rc);
+    CU_ASSERT_EQ_FATAL (rc, 0);
+  }
+  rc = dds_refresh_statistics (stat);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_used"), 0);
+  CU_ASSERT_EQ (rhc_stat_u32 (stat, "rhc_samples_reserved"), 512);
+
+  dds_delete_statistics (stat);
+  rc = dds_delete (DDS_CYCLONEDDS_HANDLE);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+}
+
+static void rhc_latest_check (dds_entity_t rd_or_cond, bool take, int32_t value, dds_sample_state_t sst, dds_view_state_t vst, dds_instance_state_t ist)
+{
+  void *raw[1] = { NULL };
+  dds_sample_info_t si[1];
+  const int32_t n = take ? dds_take (rd_or_cond, raw, si, 1, 1) : dds_read (rd_or_cond, raw, si, 1, 1);
+  CU_ASSERT_EQ_FATAL (n, (value < 0) ? 0 : 1);
+  if (n == 0)
+    return;
+  const Space_Type3 *s = raw[0];
+  CU_ASSERT_EQ (s->long_1, value);
+  CU_ASSERT_EQ (si[0].sample_state, sst);
+  CU_ASSERT_EQ (si[0].view_state, vst);
+  CU_ASSERT_EQ (si[0].instance_state, ist);
+  dds_return_t rc = dds_return_loan (rd_or_cond, raw, n);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+}
+
+CU_Test (ddsc_config, latest_value_reader_cache, .init = ddsrt_init, .fini = ddsrt_fini)
+{
+  char tpname[100];
+  create_unique_topic_name ("ddsc_config_latest_value_reader_cache", tpname, sizeof (tpname));
+
+  const char *cyclonedds_uri;
+  if (ddsrt_getenv ("CYCLONEDDS_URI", &cyclonedds_uri) != DDS_RETCODE_OK)
+    cyclonedds_uri = "";
+  char *config;
+  (void) ddsrt_asprintf (&config, "%s,<Internal><LatestValueReaderCache>true</LatestValueReaderCache></Internal>", cyclonedds_uri);
+  dds_entity_t dom = dds_create_domain (0, config);
+  CU_ASSERT_GT_FATAL (dom, 0);
+  ddsrt_free (config);
+
+  // keyless topic, KEEP_LAST(1) reader
+  dds_entity_t dp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_GT_FATAL (dp, 0);
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_LAST, 1);
+  dds_entity_t tp = dds_create_topic (dp, &Space_Type3_desc, tpname, qos, NULL);
+  CU_ASSERT_GT_FATAL (tp, 0);
+  dds_entity_t rd = dds_create_reader (dp, tp, qos, NULL);
+  CU_ASSERT_GT_FATAL (rd, 0);
+  dds_entity_t wr = dds_create_writer (dp, tp, qos, NULL);
+  CU_ASSERT_GT_FATAL (wr, 0);
+  dds_delete_qos (qos);
+
+  dds_return_t rc;
+  for (int32_t v = 1; v <= 2; v++)
+  {
+    rc = dds_write (wr, &(Space_Type3){ v, 0, 0 });
+    CU_ASSERT_EQ_FATAL (rc, 0);
+  }
+  rhc_latest_check (rd, false, 2, DDS_SST_NOT_READ, DDS_VST_NEW, DDS_IST_ALIVE);
+  rhc_latest_check (rd, false, 2, DDS_SST_READ, DDS_VST_OLD, DDS_IST_ALIVE);
+  rc = dds_write (wr, &(Space_Type3){ 3, 0, 0 });
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  rhc_latest_check (rd, true, 3, DDS_SST_NOT_READ, DDS_VST_OLD, DDS_IST_ALIVE);
+  rhc_latest_check (rd, true, -1, 0, 0, 0);
+
+  // attaching a read condition switches to the default RHC, preserving the state
+  rc = dds_write (wr, &(Space_Type3){ 4, 0, 0 });
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  dds_entity_t rdcond = dds_create_readcondition (rd, DDS_NOT_READ_SAMPLE_STATE);
+  CU_ASSERT_GT_FATAL (rdcond, 0);
+  CU_ASSERT_EQ (dds_triggered (rdcond), 1);
+  rhc_latest_check (rdcond, false, 4, DDS_SST_NOT_READ, DDS_VST_OLD, DDS_IST_ALIVE);
+  CU_ASSERT_EQ (dds_triggered (rdcond), 0);
+  rc = dds_dispose (wr, &(Space_Type3){ 4, 0, 0 });
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  // the valid sample precedes the invalid one that signals the dispose
+  rhc_latest_check (rd, true, 4, DDS_SST_READ, DDS_VST_OLD, DDS_IST_NOT_ALIVE_DISPOSED);
+
+  rc = dds_delete (dom);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+}
+
+CU_Test (ddsc_config, coalescing, .init = ddsrt_init, .fini = ddsrt_fini)
+{
+  char tpname[100];
+  create_unique_topic_name ("ddsc_config_coalescing", tpname, sizeof (tpname));
+
+  const char *cyclonedds_uri;
+  if (ddsrt_getenv ("CYCLONEDDS_URI", &cyclonedds_uri) != DDS_RETCODE_OK)
+    cyclonedds_uri = "";
+  char *config;
+  (void) ddsrt_asprintf (&config, "%s,"
+                         "<Discovery>"
+                         "  <ExternalDomainId>0</ExternalDomainId>"
+                         "  <ParticipantIndex>auto</ParticipantIndex>"
+                         "</Discovery>"
+                         "<Internal>"
+                         "  <CoalescingMaxDelay>50ms</CoalescingMaxDelay>"
+                         "</Internal>",
+                         cyclonedds_uri);
+  dds_entity_t domw = dds_create_domain (0, config);
+  CU_ASSERT_GT_FATAL (domw, 0);
+  dds_entity_t domr = dds_create_domain (1, config);
+  CU_ASSERT_GT_FATAL (domr, 0);
+  ddsrt_free (config);
+
+  dds_entity_t dpw = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_GT_FATAL (dpw, 0);
+  dds_entity_t dpr = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_GT_FATAL (dpr, 0);
+  dds_entity_t tpw = dds_create_topic (dpw, &Space_Type1_desc, tpname, NULL, NULL);
+  CU_ASSERT_GT_FATAL (tpw, 0);
+  dds_entity_t tpr = dds_create_topic (dpr, &Space_Type1_desc, tpname, NULL, NULL);
+  CU_ASSERT_GT_FATAL (tpr, 0);
+
+  // Writers with a latency budget get their data coalesced, the budget is larger than
+  // the configured maximum so the latter determines the delay
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  dds_qset_latency_budget (qos, DDS_SECS (1));
+  dds_entity_t rd = dds_create_reader (dpr, tpr, qos, NULL);
+  CU_ASSERT_GT_FATAL (rd, 0);
+  enum { NWRITERS = 8, NSAMPLES = 10 };
+  dds_entity_t wrs[NWRITERS];
+  for (int i = 0; i < NWRITERS; i++)
+  {
+    wrs[i] = dds_create_writer (dpw, tpw, qos, NULL);
+    CU_ASSERT_GT_FATAL (wrs[i], 0);
+    sync_reader_writer (dpr, rd, dpw, wrs[i]);
+  }
+  dds_delete_qos (qos);
+
+  struct dds_statistics *stat = dds_create_statistics (domw);
+  CU_ASSERT_FATAL (stat != NULL);
+  const struct dds_stat_keyvalue *flushes = dds_lookup_statistic (stat, "xmit_flushes");
+  CU_ASSERT_FATAL (flushes != NULL);
+  const uint64_t flushes0 = flushes->u.u64;
+
+  for (int32_t j = 0; j < NSAMPLES; j++)
+  {
+    for (int32_t i = 0; i < NWRITERS; i++)
+    {
+      const Space_Type1 s = { i, j, 0 };
+      dds_return_t rc = dds_write (wrs[i], &s);
+      CU_ASSERT_EQ_FATAL (rc, 0);
+    }
+  }
+
+  // Per writer, the data must arrive in order
+  int32_t next[NWRITERS] = { 0 }, nrecv = 0;
+  const dds_time_t tend = dds_time () + DDS_SECS (10);
+  while (nrecv < NWRITERS * NSAMPLES && dds_time () < tend)
+  {
+    Space_Type1 s;
+    void *raw = &s;
+    dds_sample_info_t si;
+    if (dds_take (rd, &raw, &si, 1, 1) <= 0)
+      dds_sleepfor (DDS_MSECS (10));
+    else if (si.valid_data)
+    {
+      CU_ASSERT_FATAL (s.long_1 >= 0 && s.long_1 < NWRITERS);
+      CU_ASSERT_EQ_FATAL (s.long_2, next[s.long_1]);
+      next[s.long_1]++;
+      nrecv++;
+    }
+  }
+  CU_ASSERT_EQ (nrecv, NWRITERS * NSAMPLES);
+
+  // Without coalescing, each sample would be sent in a packet of its own
+  dds_return_t rc = dds_refresh_statistics (stat);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  CU_ASSERT_LT (flushes->u.u64 - flushes0, (uint64_t) (NWRITERS * NSAMPLES / 2));
+  dds_delete_statistics (stat);
+
+  rc = dds_delete (domw);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  rc = dds_delete (domr);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+}
+
 CU_Test(ddsc_config, multiple_domains, .init = ddsrt_init, .fini = ddsrt_fini)
 {
   static const char *config = "\
@@ -0,0 +1,144 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <string.h>
+
+#include "dds/dds.h"
+#include "dds/ddsrt/environ.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/io.h"
+#include "test_common.h"
+
+#define DDS_DOMAINID_PUB 0
+#define DDS_DOMAINID_SUB 1
+#define DDS_CONFIG_NO_PORT_GAIN "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>"
+#define DDS_CONFIG_SUB DDS_CONFIG_NO_PORT_GAIN "<Internal><DirectDefragMinSize>%s</DirectDefragMinSize></Internal>"
+
+#define N_READERS 2
+
+static const uint32_t sizes[] = { 1, 5000, 300000, 1000000 };
+
+static unsigned char payload_byte (uint32_t k, uint32_t i)
+{
+  return (unsigned char) ((k * 131 + i * 7 + (i >> 8)) & 0xff);
+}
+
+static void do_defrag (const char *direct_defrag_min_size)
+{
+  char topicname[100], *conf_pub, *conf_sub, *conf_sub_fmt;
+  dds_return_t rc;
+
+  conf_pub = ddsrt_expand_envvars (DDS_CONFIG_NO_PORT_GAIN, DDS_DOMAINID_PUB);
+  (void) ddsrt_asprintf (&conf_sub_fmt, DDS_CONFIG_SUB, direct_defrag_min_size);
+  conf_sub = ddsrt_expand_envvars (conf_sub_fmt, DDS_DOMAINID_SUB);
+  const dds_entity_t dom_pub = dds_create_domain (DDS_DOMAINID_PUB, conf_pub);
+  CU_ASSERT_GT_FATAL (dom_pub, 0);
+  const dds_entity_t dom_sub = dds_create_domain (DDS_DOMAINID_SUB, conf_sub);
+  CU_ASSERT_GT_FATAL (dom_sub, 0);
+  ddsrt_free (conf_pub);
+  ddsrt_free (conf_sub);
+  ddsrt_free (conf_sub_fmt);
+
+  const dds_entity_t pp_pub = dds_create_participant (DDS_DOMAINID_PUB, NULL, NULL);
+  CU_ASSERT_GT_FATAL (pp_pub, 0);
+  const dds_entity_t pp_sub = dds_create_participant (DDS_DOMAINID_SUB, NULL, NULL);
+  CU_ASSERT_GT_FATAL (pp_sub, 0);
+
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  create_unique_topic_name ("ddsc_defrag", topicname, sizeof (topicname));
+  const dds_entity_t tp_pub = dds_create_topic (pp_pub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_GT_FATAL (tp_pub, 0);
+  const dds_entity_t tp_sub = dds_create_topic (pp_sub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_GT_FATAL (tp_sub, 0);
+  const dds_entity_t wr = dds_create_writer (pp_pub, tp_pub, qos, NULL);
+  CU_ASSERT_GT_FATAL (wr, 0);
+  /* multiple readers of the same type share the directly defragmented sample */
+  dds_entity_t rds[N_READERS];
+  for (int i = 0; i < N_READERS; i++)
+  {
+    rds[i] = dds_create_reader (pp_sub, tp_sub, qos, NULL);
+    CU_ASSERT_GT_FATAL (rds[i], 0);
+    sync_reader_writer (pp_sub, rds[i], pp_pub, wr);
+  }
+  dds_delete_qos (qos);
+  /* the publication matched status remains set after the first reader matched, so
+     wait for the writer to have matched all readers before writing: a volatile reader
+     that isn't matched yet would (correctly) not get the first samples */
+  dds_publication_matched_status_t pm;
+  const dds_time_t tmatch = dds_time () + DDS_SECS (5);
+  while ((rc = dds_get_publication_matched_status (wr, &pm)) == DDS_RETCODE_OK && pm.current_count < N_READERS && dds_time () < tmatch)
+    dds_sleepfor (DDS_MSECS (10));
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  CU_ASSERT_EQ_FATAL (pm.current_count, N_READERS);
+
+  const uint32_t nsizes = (uint32_t) (sizeof (sizes) / sizeof (sizes[0]));
+  unsigned char *buf = ddsrt_malloc (sizes[nsizes - 1]);
+  for (uint32_t k = 0; k < nsizes; k++)
+  {
+    for (uint32_t i = 0; i < sizes[k]; i++)
+      buf[i] = payload_byte (k, i);
+    RoundTripModule_DataType s = { .payload = { ._length = sizes[k], ._maximum = sizes[k], ._buffer = buf } };
+    rc = dds_write (wr, &s);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  }
+  ddsrt_free (buf);
+
+  for (int r = 0; r < N_READERS; r++)
+  {
+    const dds_time_t tend = dds_time () + DDS_SECS (10);
+    uint32_t k = 0;
+    while (k < nsizes && dds_time () < tend)
+    {
+      void *raw = NULL;
+      dds_sample_info_t si;
+      if ((rc = dds_take (rds[r], &raw, &si, 1, 1)) <= 0)
+      {
+        CU_ASSERT_EQ_FATAL (rc, 0);
+        dds_sleepfor (DDS_MSECS (10));
+        continue;
+      }
+      const RoundTripModule_DataType *s = raw;
+      CU_ASSERT_FATAL (si.valid_data);
+      CU_ASSERT_EQ_FATAL (s->payload._length, sizes[k]);
+      uint32_t i;
+      for (i = 0; i < sizes[k]; i++)
+        if (s->payload._buffer[i] != payload_byte (k, i))
+          break;
+      CU_ASSERT_EQ_FATAL (i, sizes[k]);
+      rc = dds_return_loan (rds[r], &raw, rc);
+      CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+      k++;
+    }
+    CU_ASSERT_EQ_FATAL (k, nsizes);
+  }
+
+  rc = dds_delete (dom_pub);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  rc = dds_delete (dom_sub);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+}
+
+CU_Test (ddsc_defrag, direct)
+{
+  /* all fragmented samples are defragmented directly into the serdata */
+  do_defrag ("0 B");
+}
+
+CU_Test (ddsc_defrag, copy)
+{
+  do_defrag ("1 GB");
+}
+
+CU_Test (ddsc_defrag, mixed)
+{
+  do_defrag ("100 kB");
+}
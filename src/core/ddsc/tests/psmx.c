@@ -1649,6 +1649,71 @@ CU_Test (ddsc_psmx, reader_loan_on_delete)
   dds_delete (dds_get_parent (dpw));
 }
 
+CU_Test (ddsc_psmx, write_dynsize_serialized_into_loan, .timeout = 240)
+{
+  // A type that isn't memcpy-safe and that has no fixed serialized size gets serialized
+  // in a scratch buffer and copied into the PSMX loan. Alternate small and large samples
+  // so that the scratch buffer gets freed and reallocated in between.
+  dds_return_t rc;
+  const dds_entity_t dpw = create_participant (0);
+  const dds_entity_t dpr = create_participant (1); // different "process" same "host"
+  char topicname[100];
+  create_unique_topic_name ("write_dynsize_serialized_into_loan", topicname, sizeof (topicname));
+  dds_qos_t * const qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t tpw = dds_create_topic (dpw, &DynamicData_Msg_desc, topicname, qos, NULL);
+  CU_ASSERT_GT_FATAL (tpw, 0);
+  const dds_entity_t tpr = dds_create_topic (dpr, &DynamicData_Msg_desc, topicname, qos, NULL);
+  CU_ASSERT_GT_FATAL (tpr, 0);
+  dds_delete_qos (qos);
+  const dds_entity_t wr = dds_create_writer (dpw, tpw, NULL, NULL);
+  CU_ASSERT_GT_FATAL (wr, 0);
+  CU_ASSERT_FATAL (endpoint_has_psmx_enabled (wr));
+  const dds_entity_t rd = dds_create_reader (dpr, tpr, NULL, NULL);
+  CU_ASSERT_GT_FATAL (rd, 0);
+  CU_ASSERT_FATAL (endpoint_has_psmx_enabled (rd));
+  sync_reader_writer (dpr, rd, dpw, wr);
+
+  const size_t sizes[] = { 13, 3 << 20, 29, 3 << 20, 5 };
+  const uint32_t nsizes = (uint32_t) (sizeof (sizes) / sizeof (sizes[0]));
+  const dds_entity_t ws = dds_create_waitset (DDS_CYCLONEDDS_HANDLE);
+  rc = dds_set_status_mask (rd, DDS_DATA_AVAILABLE_STATUS);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  rc = dds_waitset_attach (ws, rd, 0);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  for (uint32_t i = 0; i < nsizes; i++)
+  {
+    char *message = ddsrt_malloc (sizes[i] + 1);
+    for (size_t j = 0; j < sizes[i]; j++)
+      message[j] = (char) ('a' + (i + j) % 26);
+    message[sizes[i]] = 0;
+    int32_t values[] = { (int32_t) i, 2, 3 };
+    const DynamicData_Msg wrdata = {
+      .message = message,
+      .scalar = (int32_t) i,
+      .values = { ._length = 3, ._maximum = 3, ._release = false, ._buffer = values }
+    };
+    rc = dds_write (wr, &wrdata);
+    CU_ASSERT_EQ_FATAL (rc, 0);
+
+    void *rddata = NULL;
+    dds_sample_info_t si;
+    while ((rc = dds_take (rd, &rddata, &si, 1, 1)) == 0)
+      (void) dds_waitset_wait (ws, NULL, 0, DDS_SECS (1));
+    CU_ASSERT_EQ_FATAL (rc, 1);
+    CU_ASSERT_FATAL (si.valid_data);
+    CU_ASSERT_FATAL (eq_DynamicData_Msg (&wrdata, rddata, true));
+    rc = dds_return_loan (rd, &rddata, rc);
+    CU_ASSERT_EQ_FATAL (rc, 0);
+    ddsrt_free (message);
+  }
+
+  dds_delete (ws);
+  dds_delete (dds_get_parent (dpr));
+  dds_delete (dds_get_parent (dpw));
+}
+
 CU_Test (ddsc_psmx, configstr)
 {
   typedef struct kv { const char *k; const char *v; } kv_t;
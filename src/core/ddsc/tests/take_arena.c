@@ -0,0 +1,221 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dds/dds.h"
+#include "dds/ddsrt/heap.h"
+
+#include "test_common.h"
+#include "CdrStreamString.h"
+
+#define ARENA_SIZE 65536
+#define NSAMPLES 10
+
+static dds_entity_t g_participant, g_topic, g_writer, g_reader;
+
+static void take_arena_init (void)
+{
+  char name[100];
+  g_participant = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (g_participant > 0);
+  g_topic = dds_create_topic (g_participant, &CdrStreamString_t4_desc, create_unique_topic_name ("ddsc_take_arena", name, sizeof (name)), NULL, NULL);
+  CU_ASSERT_FATAL (g_topic > 0);
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  dds_qset_writer_data_lifecycle (qos, false);
+  g_writer = dds_create_writer (g_participant, g_topic, qos, NULL);
+  CU_ASSERT_FATAL (g_writer > 0);
+  g_reader = dds_create_reader (g_participant, g_topic, qos, NULL);
+  CU_ASSERT_FATAL (g_reader > 0);
+  dds_delete_qos (qos);
+}
+
+static void take_arena_fini (void)
+{
+  dds_return_t rc = dds_delete (DDS_CYCLONEDDS_HANDLE);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+}
+
+static void write_samples (uint32_t first, uint32_t n)
+{
+  for (uint32_t i = first; i < first + n; i++)
+  {
+    char str0[20], str1[20];
+    char *strs[2] = { str0, str1 };
+    CdrStreamString_string1 chars[2] = { "a", "b" };
+    (void) snprintf (str0, sizeof (str0), "sample %"PRIu32, i);
+    (void) snprintf (str1, sizeof (str1), "%"PRIu32, i * 7);
+    CdrStreamString_t4 s = {
+      .ws1s = { ._length = 2, ._maximum = 2, ._buffer = strs, ._release = false },
+      .ws1bs = { ._length = i % 3, ._maximum = 2, ._buffer = chars, ._release = false },
+      .k = i
+    };
+    dds_return_t rc = dds_write (g_writer, &s);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  }
+}
+
+static bool in_range (const void *p, const void *lo, const void *hi)
+{
+  return (const char *) p >= (const char *) lo && (const char *) p < (const char *) hi;
+}
+
+static void check_sample (const CdrStreamString_t4 *s, uint32_t k, const void *lo, const void *hi)
+{
+  char exp0[20], exp1[20];
+  (void) snprintf (exp0, sizeof (exp0), "sample %"PRIu32, k);
+  (void) snprintf (exp1, sizeof (exp1), "%"PRIu32, k * 7);
+  CU_ASSERT_EQ_FATAL (s->k, k);
+  CU_ASSERT_EQ_FATAL (s->ws1s._length, 2);
+  CU_ASSERT_FATAL (in_range (s->ws1s._buffer, lo, hi));
+  CU_ASSERT_FATAL (in_range (s->ws1s._buffer[0], lo, hi));
+  CU_ASSERT_FATAL (in_range (s->ws1s._buffer[1], lo, hi));
+  CU_ASSERT_STREQ_FATAL (s->ws1s._buffer[0], exp0);
+  CU_ASSERT_STREQ_FATAL (s->ws1s._buffer[1], exp1);
+  CU_ASSERT_EQ_FATAL (s->ws1bs._length, k % 3);
+  if (s->ws1bs._length > 0)
+  {
+    CU_ASSERT_FATAL (in_range (s->ws1bs._buffer, lo, hi));
+    CU_ASSERT_STREQ_FATAL (s->ws1bs._buffer[0], "a");
+  }
+}
+
+CU_Test (ddsc_take_arena, bad_params, .init = take_arena_init, .fini = take_arena_fini)
+{
+  void *buf[NSAMPLES];
+  dds_sample_info_t si[NSAMPLES];
+  dds_return_t rc;
+
+  CU_ASSERT_FATAL (dds_sample_arena_create (0) == NULL);
+  dds_sample_arena_t *arena = dds_sample_arena_create (ARENA_SIZE);
+  CU_ASSERT_FATAL (arena != NULL);
+
+  rc = dds_take_arena (g_reader, buf, si, NSAMPLES, NSAMPLES, NULL);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_BAD_PARAMETER);
+  rc = dds_take_arena (g_reader, NULL, si, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_BAD_PARAMETER);
+  rc = dds_take_arena (g_reader, buf, NULL, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_BAD_PARAMETER);
+  rc = dds_take_arena (g_reader, buf, si, NSAMPLES, 0, arena);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_BAD_PARAMETER);
+  rc = dds_take_arena (g_reader, buf, si, 1, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_BAD_PARAMETER);
+  rc = dds_take_arena (g_writer, buf, si, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_ILLEGAL_OPERATION);
+
+  // built-in topics don't use the default sample representation
+  const dds_entity_t bird = dds_create_reader (g_participant, DDS_BUILTIN_TOPIC_DCPSPARTICIPANT, NULL, NULL);
+  CU_ASSERT_FATAL (bird > 0);
+  rc = dds_take_arena (bird, buf, si, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_UNSUPPORTED);
+
+  dds_sample_arena_delete (arena);
+}
+
+CU_Test (ddsc_take_arena, take, .init = take_arena_init, .fini = take_arena_fini)
+{
+  void *buf[NSAMPLES];
+  dds_sample_info_t si[NSAMPLES];
+  dds_sample_arena_t *arena = dds_sample_arena_create (ARENA_SIZE);
+  CU_ASSERT_FATAL (arena != NULL);
+
+  write_samples (0, NSAMPLES);
+  dds_return_t rc = dds_take_arena (g_reader, buf, si, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, NSAMPLES);
+  // everything must be in the arena: the first sample is allocated at its start
+  const char *lo = buf[0], *hi = lo + ARENA_SIZE;
+  for (uint32_t i = 0; i < NSAMPLES; i++)
+  {
+    CU_ASSERT_FATAL (si[i].valid_data);
+    CU_ASSERT_FATAL (in_range (buf[i], lo, hi));
+    check_sample (buf[i], ((CdrStreamString_t4 *) buf[i])->k, lo, hi);
+  }
+
+  // they were taken, so nothing left; dispose results in an invalid sample with only the key
+  rc = dds_take_arena (g_reader, buf, si, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  rc = dds_dispose (g_writer, &(CdrStreamString_t4){ .k = 3 });
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  rc = dds_take_arena (g_reader, buf, si, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, 1);
+  CU_ASSERT_FATAL (!si[0].valid_data);
+  CU_ASSERT_EQ_FATAL (si[0].instance_state, DDS_NOT_ALIVE_DISPOSED_INSTANCE_STATE);
+  CU_ASSERT_FATAL (in_range (buf[0], lo, hi));
+  CU_ASSERT_EQ_FATAL (((CdrStreamString_t4 *) buf[0])->k, 3);
+  CU_ASSERT_EQ_FATAL (((CdrStreamString_t4 *) buf[0])->ws1s._length, 0);
+
+  // after a reset the arena is reused from the start
+  dds_sample_arena_reset (arena);
+  write_samples (NSAMPLES, 1);
+  rc = dds_take_arena (g_reader, buf, si, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, 1);
+  CU_ASSERT_FATAL (buf[0] == (void *) lo);
+  check_sample (buf[0], NSAMPLES, lo, hi);
+
+  dds_sample_arena_delete (arena);
+}
+
+CU_Test (ddsc_take_arena, out_of_space, .init = take_arena_init, .fini = take_arena_fini)
+{
+  void *buf[NSAMPLES];
+  dds_sample_info_t si[NSAMPLES];
+  dds_return_t rc;
+
+  // too small for even the top-level sample
+  dds_sample_arena_t *arena = dds_sample_arena_create (sizeof (CdrStreamString_t4) - 1);
+  CU_ASSERT_FATAL (arena != NULL);
+  write_samples (0, NSAMPLES);
+  rc = dds_take_arena (g_reader, buf, si, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OUT_OF_RESOURCES);
+  dds_sample_arena_delete (arena);
+
+  // room for the top-level sample, but not for the strings
+  arena = dds_sample_arena_create (sizeof (CdrStreamString_t4) + 8);
+  CU_ASSERT_FATAL (arena != NULL);
+  rc = dds_take_arena (g_reader, buf, si, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OUT_OF_RESOURCES);
+  dds_sample_arena_delete (arena);
+
+  // room for a few samples: these are taken and the remainder stays in the reader, the
+  // strings for a sample that doesn't fit go to the heap temporarily and mustn't leak
+  const size_t size = 3 * (sizeof (CdrStreamString_t4) + 80);
+  arena = dds_sample_arena_create (size);
+  CU_ASSERT_FATAL (arena != NULL);
+  uint32_t ntaken = 0;
+  bool seen[NSAMPLES] = { false };
+  while (ntaken < NSAMPLES)
+  {
+    rc = dds_take_arena (g_reader, buf, si, NSAMPLES, NSAMPLES, arena);
+    CU_ASSERT_FATAL (rc > 0 && rc < NSAMPLES);
+    for (int32_t i = 0; i < rc; i++)
+    {
+      const CdrStreamString_t4 *s = buf[i];
+      CU_ASSERT_FATAL (s->k < NSAMPLES && !seen[s->k]);
+      seen[s->k] = true;
+      check_sample (s, s->k, buf[0], (const char *) buf[0] + size);
+    }
+    ntaken += (uint32_t) rc;
+    // no space left: an error, not 0 samples
+    if (ntaken < NSAMPLES)
+    {
+      rc = dds_take_arena (g_reader, buf, si, NSAMPLES, NSAMPLES, arena);
+      CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OUT_OF_RESOURCES);
+    }
+    dds_sample_arena_reset (arena);
+  }
+  rc = dds_take_arena (g_reader, buf, si, NSAMPLES, NSAMPLES, arena);
+  CU_ASSERT_EQ_FATAL (rc, 0);
+  dds_sample_arena_delete (arena);
+}
@@ -202,6 +202,8 @@ CU_Test (ddsc_uninitialized, various)
   check (dds_get_topic (1));
   check (dds_get_matched_subscriptions (1, &ih, 1));
   check_0 (dds_get_matched_subscription_data (1, ih));
+  dds_duration_t srtt, rttvar;
+  check (dds_get_matched_subscription_rtt (1, ih, &srtt, &rttvar));
   check (dds_get_matched_publications (1, &ih, 1));
   check_0 (dds_get_matched_publication_data (1, ih));
 
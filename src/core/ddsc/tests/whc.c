@@ -17,8 +17,14 @@
 #include "dds/ddsrt/environ.h"
 #include "dds/ddsi/ddsi_entity_index.h"
 #include "dds/ddsi/ddsi_entity.h"
+#include "dds/ddsi/ddsi_protocol.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_tkmap.h"
 #include "ddsi__whc.h"
+#include "ddsi__thread.h"
 #include "dds__entity.h"
+#include "dds__topic.h"
+#include "dds__whc_ring.h"
 
 #include "test_common.h"
 
@@ -294,6 +300,200 @@ CU_Test(ddsc_whc, check_end_state, .init=whc_init, .fini=whc_fini, .timeout=30)
 }
 
 #undef ARRAY_LEN
+
+static void ring_insert (struct ddsi_whc *whc, struct ddsi_sertype *st, struct ddsi_tkmap *tkmap, ddsi_seqno_t max_drop_seq, ddsi_seqno_t seq, bool unregister)
+{
+  Space_Type3 sample = { (int32_t) seq, 0, 0 };
+  struct ddsi_serdata *sd = ddsi_serdata_from_sample (st, SDK_DATA, &sample);
+  CU_ASSERT_NEQ_FATAL (sd, NULL);
+  if (unregister)
+    sd->statusinfo = DDSI_STATUSINFO_UNREGISTER;
+  struct ddsi_tkmap_instance *tk = ddsi_tkmap_lookup_instance_ref (tkmap, sd);
+  CU_ASSERT_EQ_FATAL (ddsi_whc_insert (whc, max_drop_seq, seq, DDSRT_MTIME_NEVER, sd, tk), 0);
+  ddsi_tkmap_instance_unref (tkmap, tk);
+  ddsi_serdata_unref (sd);
+}
+
+static void ring_insert_exp (struct ddsi_whc *whc, struct ddsi_sertype *st, struct ddsi_tkmap *tkmap, ddsi_seqno_t max_drop_seq, ddsi_seqno_t seq, ddsrt_mtime_t exp)
+{
+  Space_Type3 sample = { (int32_t) seq, 0, 0 };
+  struct ddsi_serdata *sd = ddsi_serdata_from_sample (st, SDK_DATA, &sample);
+  CU_ASSERT_NEQ_FATAL (sd, NULL);
+  struct ddsi_tkmap_instance *tk = ddsi_tkmap_lookup_instance_ref (tkmap, sd);
+  CU_ASSERT_EQ_FATAL (ddsi_whc_insert (whc, max_drop_seq, seq, exp, sd, tk), 0);
+  ddsi_tkmap_instance_unref (tkmap, tk);
+  ddsi_serdata_unref (sd);
+}
+
+static void ring_check_state (const struct ddsi_whc *whc, ddsi_seqno_t exp_min, ddsi_seqno_t exp_max)
+{
+  struct ddsi_whc_state whcst;
+  ddsi_whc_get_state (whc, &whcst);
+  CU_ASSERT_EQ_FATAL (whcst.min_seq, exp_min);
+  CU_ASSERT_EQ_FATAL (whcst.max_seq, exp_max);
+  CU_ASSERT_FATAL ((whcst.unacked_bytes == 0) == (exp_max == 0));
+}
+
+static uint32_t ring_remove_acked (struct ddsi_whc *whc, ddsi_seqno_t max_drop_seq)
+{
+  struct ddsi_whc_state whcst;
+  struct ddsi_whc_node *deferred_free_list;
+  uint32_t n = ddsi_whc_remove_acked_messages (whc, max_drop_seq, &whcst, &deferred_free_list);
+  ddsi_whc_free_deferred_free_list (whc, deferred_free_list);
+  return n;
+}
+
+CU_Test(ddsc_whc, ring, .init=whc_init, .fini=whc_fini)
+{
+  char name[100];
+  struct ddsi_whc_borrowed_sample sample;
+  struct ddsi_whc_state whcst;
+  struct ddsi_whc_node *deferred_free_list;
+  struct ddsi_whc *whc;
+  struct dds_entity *x;
+  struct dds_topic *tp;
+
+  create_unique_topic_name ("ddsc_whc_ring", name, sizeof name);
+  const dds_entity_t topic = dds_create_topic (g_participant, &Space_Type3_desc, name, NULL, NULL);
+  CU_ASSERT_GT_FATAL (topic, 0);
+  CU_ASSERT_EQ_FATAL (dds_entity_pin (g_participant, &x), 0);
+  struct ddsi_domaingv * const gv = &x->m_domain->gv;
+  dds_entity_unpin (x);
+  CU_ASSERT_EQ_FATAL (dds_topic_pin (topic, &tp), 0);
+  struct ddsi_sertype * const st = tp->m_stype;
+  ddsi_thread_state_awake (ddsi_lookup_thread_state (), gv);
+
+  /* keep-all: more samples than the initial size of the ring, with a gap at 100 */
+  whc = dds_whc_ring_new (gv, 0);
+  for (ddsi_seqno_t seq = 1; seq <= 200; seq++)
+    if (seq != 100)
+      ring_insert (whc, st, gv->m_tkmap, 0, seq, false);
+  ring_check_state (whc, 1, 200);
+  CU_ASSERT_EQ (ddsi_whc_next_seq (whc, 0), 1);
+  CU_ASSERT_EQ (ddsi_whc_next_seq (whc, 99), 101);
+  CU_ASSERT_EQ (ddsi_whc_next_seq (whc, 200), DDSI_MAX_SEQ_NUMBER);
+  CU_ASSERT_FATAL (!ddsi_whc_borrow_sample (whc, 100, &sample));
+
+  /* a sample borrowed while it gets acknowledged must survive until it is returned */
+  CU_ASSERT_FATAL (ddsi_whc_borrow_sample (whc, 50, &sample));
+  CU_ASSERT_EQ_FATAL (sample.seq, 50);
+  CU_ASSERT_FATAL (sample.unacked);
+  CU_ASSERT_EQ_FATAL (ddsi_whc_remove_acked_messages (whc, 150, &whcst, &deferred_free_list), 149);
+  CU_ASSERT_EQ_FATAL (whcst.min_seq, 151);
+  CU_ASSERT_EQ_FATAL (whcst.max_seq, 200);
+  CU_ASSERT_FATAL (!ddsi_whc_borrow_sample (whc, 51, &sample));
+  ddsi_whc_free_deferred_free_list (whc, deferred_free_list);
+  ddsi_whc_return_sample (whc, &sample, false);
+  CU_ASSERT_EQ (ddsi_whc_next_seq (whc, 50), 151);
+
+  CU_ASSERT_FATAL (ddsi_whc_borrow_sample (whc, 160, &sample));
+  sample.rexmit_count = 3;
+  ddsi_whc_return_sample (whc, &sample, true);
+  CU_ASSERT_FATAL (ddsi_whc_borrow_sample (whc, 160, &sample));
+  CU_ASSERT_EQ (sample.rexmit_count, 3);
+  ddsi_whc_return_sample (whc, &sample, false);
+
+  CU_ASSERT_EQ_FATAL (ring_remove_acked (whc, 300), 50);
+  ring_check_state (whc, 0, 0);
+  ring_insert (whc, st, gv->m_tkmap, 300, 1000, false);
+  ring_insert (whc, st, gv->m_tkmap, 300, 1001, false);
+  ring_check_state (whc, 1000, 1001);
+
+  uint32_t n = 0;
+  struct ddsi_whc_sample_iter it;
+  ddsi_whc_sample_iter_init (whc, &it);
+  while (ddsi_whc_sample_iter_borrow_next (&it, &sample))
+    CU_ASSERT_EQ_FATAL (sample.seq, 1000 + n++);
+  CU_ASSERT_EQ (n, 2);
+  ddsi_whc_free (whc);
+
+  /* keep-last 2: history depth applies regardless of acknowledgements, unregistering
+     drops the samples from the history but they remain until acknowledged */
+  whc = dds_whc_ring_new (gv, 2);
+  for (ddsi_seqno_t seq = 1; seq <= 5; seq++)
+    ring_insert (whc, st, gv->m_tkmap, 0, seq, false);
+  ring_check_state (whc, 4, 5);
+  CU_ASSERT_EQ (ddsi_whc_next_seq (whc, 1), 4);
+  ring_insert (whc, st, gv->m_tkmap, 0, 6, true);
+  ring_check_state (whc, 4, 6);
+  ring_insert (whc, st, gv->m_tkmap, 0, 7, false);
+  ring_insert (whc, st, gv->m_tkmap, 0, 8, false);
+  ring_insert (whc, st, gv->m_tkmap, 0, 9, false);
+  ring_check_state (whc, 4, 9);
+  CU_ASSERT_EQ (ddsi_whc_next_seq (whc, 6), 8);
+  CU_ASSERT_EQ_FATAL (ring_remove_acked (whc, 8), 4);
+  ring_check_state (whc, 9, 9);
+  /* unregister when everything is acknowledged (as if there are no readers) removes the
+     instance's samples immediately */
+  ring_insert (whc, st, gv->m_tkmap, 10, 10, true);
+  ring_check_state (whc, 0, 0);
+  ddsi_whc_free (whc);
+
+  ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+  dds_topic_unpin (tp);
+  dds_delete (topic);
+}
+
+#ifdef DDS_HAS_LIFESPAN
+static bool ring_wait_for_state (const struct ddsi_whc *whc, ddsi_seqno_t exp_min, ddsi_seqno_t exp_max)
+{
+  const dds_time_t tend = dds_time () + DDS_SECS (5);
+  struct ddsi_whc_state whcst;
+  ddsi_whc_get_state (whc, &whcst);
+  while ((whcst.min_seq != exp_min || whcst.max_seq != exp_max) && dds_time () < tend)
+  {
+    dds_sleepfor (DDS_MSECS (10));
+    ddsi_whc_get_state (whc, &whcst);
+  }
+  return whcst.min_seq == exp_min && whcst.max_seq == exp_max;
+}
+
+CU_Test(ddsc_whc, ring_lifespan, .init=whc_init, .fini=whc_fini)
+{
+  char name[100];
+  struct dds_entity *x;
+  struct dds_topic *tp;
+
+  create_unique_topic_name ("ddsc_whc_ring_lifespan", name, sizeof name);
+  const dds_entity_t topic = dds_create_topic (g_participant, &Space_Type3_desc, name, NULL, NULL);
+  CU_ASSERT_GT_FATAL (topic, 0);
+  CU_ASSERT_EQ_FATAL (dds_entity_pin (g_participant, &x), 0);
+  struct ddsi_domaingv * const gv = &x->m_domain->gv;
+  dds_entity_unpin (x);
+  CU_ASSERT_EQ_FATAL (dds_topic_pin (topic, &tp), 0);
+  struct ddsi_sertype * const st = tp->m_stype;
+  ddsi_thread_state_awake (ddsi_lookup_thread_state (), gv);
+
+  /* a lifespan may be set after the writer was created, samples then expire from the
+     tail, even if nothing has been acknowledged; a sample without a lifespan holds back
+     the expiry of the later ones until it is acknowledged */
+  struct ddsi_whc *whc = dds_whc_ring_new (gv, 0);
+  const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+  const ddsrt_mtime_t texp = ddsrt_mtime_add_duration (tnow, DDS_MSECS (100));
+  ring_insert_exp (whc, st, gv->m_tkmap, 0, 1, DDSRT_MTIME_NEVER);
+  ring_insert_exp (whc, st, gv->m_tkmap, 0, 2, texp);
+  ring_insert_exp (whc, st, gv->m_tkmap, 0, 3, texp);
+  ring_insert_exp (whc, st, gv->m_tkmap, 0, 4, DDSRT_MTIME_NEVER);
+  ring_insert_exp (whc, st, gv->m_tkmap, 0, 5, texp);
+  ring_check_state (whc, 1, 5);
+  dds_sleepfor (DDS_MSECS (200));
+  ring_check_state (whc, 1, 5);
+  CU_ASSERT_EQ_FATAL (ring_remove_acked (whc, 1), 1);
+  CU_ASSERT_FATAL (ring_wait_for_state (whc, 4, 5));
+  CU_ASSERT_EQ_FATAL (ring_remove_acked (whc, 4), 1);
+  CU_ASSERT_FATAL (ring_wait_for_state (whc, 0, 0));
+
+  /* samples that haven't expired yet remain */
+  ring_insert_exp (whc, st, gv->m_tkmap, 4, 6, ddsrt_mtime_add_duration (ddsrt_time_monotonic (), DDS_SECS (3600)));
+  ring_check_state (whc, 6, 6);
+  ddsi_whc_free (whc);
+
+  ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+  dds_topic_unpin (tp);
+  dds_delete (topic);
+}
+#endif
+
 #undef V
 #undef TL
 #undef R
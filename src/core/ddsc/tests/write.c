@@ -17,12 +17,22 @@
 #include "test_util.h"
 
 #include "dds/dds.h"
+#include "dds/ddsc/dds_statistics.h"
 #include "dds/ddsrt/io.h"
 #include "dds/ddsrt/misc.h"
 #include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/environ.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsi/ddsi_endpoint.h"
+#include "dds/ddsi/ddsi_whc.h"
+#include "ddsi__endpoint_match.h"
+#include "ddsi__hbcontrol.h"
+#include "ddsi__lat_estim.h"
+#include "dds__entity.h"
+#include "dds__types.h"
 
 /* Tests in this file only concern themselves with very basic api tests of
-   dds_write and dds_write_ts */
+   dds_write, dds_write_ts and dds_write_batch, synchronous and asynchronous */
 
 static const uint32_t payloadSize = 32;
 static RoundTripModule_DataType data;
@@ -132,6 +142,602 @@ CU_Test(ddsc_write_ts, bad_timestamp, .init = setup, .fini = teardown)
     CU_ASSERT_EQ_FATAL (status, DDS_RETCODE_BAD_PARAMETER);
 }
 
+CU_Test(ddsc_write_batch, bad_params, .init = setup, .fini = teardown)
+{
+    const void *samples[2] = { &data, &data };
+    const void *with_null[2] = { &data, NULL };
+    dds_return_t status;
+
+    status = dds_write_batch(writer, NULL, 1, dds_time());
+    CU_ASSERT_EQ_FATAL (status, DDS_RETCODE_BAD_PARAMETER);
+    status = dds_write_batch(writer, with_null, 2, dds_time());
+    CU_ASSERT_EQ_FATAL (status, DDS_RETCODE_BAD_PARAMETER);
+    status = dds_write_batch(writer, samples, 2, -1);
+    CU_ASSERT_EQ_FATAL (status, DDS_RETCODE_BAD_PARAMETER);
+    status = dds_write_batch(topic, samples, 2, dds_time());
+    CU_ASSERT_EQ_FATAL (status, DDS_RETCODE_ILLEGAL_OPERATION);
+    status = dds_write_batch(writer, samples, 0, dds_time());
+    CU_ASSERT_EQ_FATAL (status, DDS_RETCODE_OK);
+    status = dds_write_batch(writer, samples, 2, dds_time());
+    CU_ASSERT_EQ_FATAL (status, DDS_RETCODE_OK);
+}
+
+static void write_batch_check (dds_entity_t rd, uint32_t nsamples, dds_time_t ts, dds_duration_t timeout)
+{
+    // samples are taken per instance, but the values within an instance must be in order
+    const dds_time_t tend = dds_time () + timeout;
+    int32_t next[5] = { 0, 1, 2, 3, 4 };
+    uint32_t n = 0;
+    while (n < nsamples)
+    {
+        Space_Type1 buf[10];
+        void *raw[10];
+        dds_sample_info_t si[10];
+        for (int i = 0; i < 10; i++)
+            raw[i] = &buf[i];
+        dds_return_t rc = dds_take (rd, raw, si, 10, 10);
+        CU_ASSERT_FATAL (rc >= 0);
+        if (rc == 0)
+        {
+            CU_ASSERT_FATAL (dds_time () < tend);
+            dds_sleepfor (DDS_MSECS (10));
+            continue;
+        }
+        for (int i = 0; i < rc; i++)
+        {
+            CU_ASSERT_FATAL (si[i].valid_data);
+            CU_ASSERT_EQ_FATAL (si[i].source_timestamp, ts);
+            CU_ASSERT_FATAL (buf[i].long_1 >= 0 && buf[i].long_1 < 5);
+            CU_ASSERT_EQ_FATAL (buf[i].long_2, next[buf[i].long_1]);
+            next[buf[i].long_1] += 5;
+        }
+        n += (uint32_t) rc;
+    }
+    CU_ASSERT_EQ_FATAL (n, nsamples);
+}
+
+struct two_domains {
+    dds_entity_t pub_dom, sub_dom;
+    dds_entity_t pub_pp, sub_pp;
+    dds_entity_t pub_tp, sub_tp;
+    dds_entity_t wr, rrd;
+};
+
+static void two_domains_setup (struct two_domains *td, const char *topicprefix, const char *pub_config, const char *sub_config, const dds_qos_t *qos)
+{
+    // Two domains with a different domain id, but the same external domain id so that
+    // they can communicate, that way a reader in the publishing domain is local and the
+    // one in the subscribing domain is remote.  The configuration snippets (if any) are
+    // appended to the configuration of the respective domain, the QoS (if any) is used
+    // for the topics, the writer and the remote reader, the default is reliable with
+    // unlimited blocking and keep-all history
+    const char *config = "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>";
+    const char *extra[2] = { pub_config, sub_config };
+    dds_entity_t *doms[2] = { &td->pub_dom, &td->sub_dom };
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        char *conf = ddsrt_expand_envvars (config, i);
+        if (extra[i])
+        {
+            char *conf_tmp = conf;
+            (void) ddsrt_asprintf (&conf, "%s,%s", conf_tmp, extra[i]);
+            ddsrt_free (conf_tmp);
+        }
+        *doms[i] = dds_create_domain (i, conf);
+        CU_ASSERT_GT_FATAL (*doms[i], 0);
+        ddsrt_free (conf);
+    }
+
+    char topicname[100];
+    create_unique_topic_name (topicprefix, topicname, sizeof (topicname));
+    dds_qos_t *defqos = NULL;
+    if (qos == NULL)
+    {
+        qos = defqos = dds_create_qos ();
+        dds_qset_reliability (defqos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+        dds_qset_history (defqos, DDS_HISTORY_KEEP_ALL, 0);
+    }
+    td->pub_pp = dds_create_participant (0, NULL, NULL);
+    CU_ASSERT_GT_FATAL (td->pub_pp, 0);
+    td->sub_pp = dds_create_participant (1, NULL, NULL);
+    CU_ASSERT_GT_FATAL (td->sub_pp, 0);
+    td->pub_tp = dds_create_topic (td->pub_pp, &Space_Type1_desc, topicname, qos, NULL);
+    CU_ASSERT_GT_FATAL (td->pub_tp, 0);
+    td->sub_tp = dds_create_topic (td->sub_pp, &Space_Type1_desc, topicname, qos, NULL);
+    CU_ASSERT_GT_FATAL (td->sub_tp, 0);
+    td->wr = dds_create_writer (td->pub_pp, td->pub_tp, qos, NULL);
+    CU_ASSERT_GT_FATAL (td->wr, 0);
+    td->rrd = dds_create_reader (td->sub_pp, td->sub_tp, qos, NULL);
+    CU_ASSERT_GT_FATAL (td->rrd, 0);
+    sync_reader_writer (td->sub_pp, td->rrd, td->pub_pp, td->wr);
+    dds_delete_qos (defqos);
+}
+
+static void two_domains_fini (const struct two_domains *td)
+{
+    dds_return_t rc;
+    rc = dds_delete (td->pub_dom);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    rc = dds_delete (td->sub_dom);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+}
+
+CU_Test(ddsc_write_batch, local_and_remote)
+{
+    struct two_domains td;
+    two_domains_setup (&td, "ddsc_write_batch", NULL, NULL, NULL);
+    // local reader only after the remote one has been matched, or it would trigger the
+    // publication matched status of the writer
+    const dds_entity_t lrd = dds_create_reader (td.pub_pp, td.pub_tp, NULL, NULL);
+    CU_ASSERT_GT_FATAL (lrd, 0);
+
+    Space_Type1 samples[100];
+    const void *ptrs[100];
+    for (int32_t i = 0; i < 100; i++)
+    {
+        samples[i] = (Space_Type1){ i % 5, i, 0 };
+        ptrs[i] = &samples[i];
+    }
+    const dds_time_t ts = dds_time ();
+    dds_return_t rc = dds_write_batch (td.wr, ptrs, 100, ts);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    write_batch_check (lrd, 100, ts, 0);
+    write_batch_check (td.rrd, 100, ts, DDS_SECS (10));
+    rc = dds_wait_for_acks (td.wr, DDS_SECS (10));
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+
+    two_domains_fini (&td);
+}
+
+CU_Test(ddsc_write_async, local_and_remote)
+{
+    // Small queue so that the writes have to wait for the transmit workers every now and then
+    struct two_domains td;
+    two_domains_setup (&td, "ddsc_write_async", "<Internal><AsyncWrite>true</AsyncWrite><AsyncWriteQueueDepth>5</AsyncWriteQueueDepth><AsyncWriteThreads>2</AsyncWriteThreads></Internal>", NULL, NULL);
+    // local reader only after the remote one has been matched, or it would trigger the
+    // publication matched status of the writer
+    const dds_entity_t lrd = dds_create_reader (td.pub_pp, td.pub_tp, NULL, NULL);
+    CU_ASSERT_GT_FATAL (lrd, 0);
+
+    // first half with dds_write, second half with dds_write_batch
+    Space_Type1 samples[100];
+    const void *ptrs[100];
+    for (int32_t i = 0; i < 100; i++)
+    {
+        samples[i] = (Space_Type1){ i % 5, i, 0 };
+        ptrs[i] = &samples[i];
+    }
+    const dds_time_t ts = dds_time ();
+    dds_return_t rc;
+    for (int32_t i = 0; i < 50; i++)
+    {
+        rc = dds_write_ts (td.wr, &samples[i], ts);
+        CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    }
+    rc = dds_write_batch (td.wr, ptrs + 50, 50, ts);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    // local delivery happens in the transmit worker, so the local reader has to wait, too
+    write_batch_check (lrd, 100, ts, DDS_SECS (10));
+    write_batch_check (td.rrd, 100, ts, DDS_SECS (10));
+    rc = dds_wait_for_acks (td.wr, DDS_SECS (10));
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+
+    struct dds_statistics *stats = dds_create_statistics (td.wr);
+    CU_ASSERT_FATAL (stats != NULL);
+    const struct dds_stat_keyvalue *kv;
+    kv = dds_lookup_statistic (stats, "async_samples");
+    CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT64);
+    CU_ASSERT_EQ_FATAL (kv->u.u64, 100);
+    kv = dds_lookup_statistic (stats, "async_queued");
+    CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT32);
+    CU_ASSERT_EQ_FATAL (kv->u.u32, 0);
+    kv = dds_lookup_statistic (stats, "async_max_queued");
+    CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT32);
+    CU_ASSERT_FATAL (kv->u.u32 >= 1 && kv->u.u32 <= 8);
+    kv = dds_lookup_statistic (stats, "async_dropped");
+    CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT64);
+    CU_ASSERT_EQ_FATAL (kv->u.u64, 0);
+    dds_delete_statistics (stats);
+
+    stats = dds_create_statistics (td.pub_dom);
+    CU_ASSERT_FATAL (stats != NULL);
+    const struct dds_stat_keyvalue *w0 = dds_lookup_statistic (stats, "wrasync0_samples");
+    const struct dds_stat_keyvalue *w1 = dds_lookup_statistic (stats, "wrasync1_samples");
+    CU_ASSERT_FATAL (w0 != NULL && w1 != NULL);
+    CU_ASSERT_FATAL (dds_lookup_statistic (stats, "wrasync2_samples") == NULL);
+    CU_ASSERT_EQ_FATAL (w0->u.u64 + w1->u.u64, 100);
+    dds_delete_statistics (stats);
+
+    // the synchronous domain has no asynchronous writer statistics
+    const dds_entity_t rwr = dds_create_writer (td.sub_pp, td.sub_tp, NULL, NULL);
+    CU_ASSERT_GT_FATAL (rwr, 0);
+    stats = dds_create_statistics (rwr);
+    CU_ASSERT_FATAL (stats != NULL);
+    CU_ASSERT_FATAL (dds_lookup_statistic (stats, "async_samples") == NULL);
+    dds_delete_statistics (stats);
+
+    // deleting the writer must first hand all queued samples to DDSI
+    for (int32_t i = 0; i < 100; i++)
+    {
+        rc = dds_write_ts (td.wr, &samples[i], ts);
+        CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    }
+    rc = dds_delete (td.wr);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    write_batch_check (lrd, 100, ts, 0);
+
+    two_domains_fini (&td);
+}
+
+CU_Test(ddsc_write_async, throttled)
+{
+    // A tiny WHC, a short max_blocking_time and a subscriber that temporarily doesn't
+    // send acks so that the transmit worker times out waiting for acks: samples accepted
+    // in the queue must then stay queued rather than get dropped
+    struct two_domains td;
+    dds_qos_t *qos = dds_create_qos ();
+    dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_MSECS (1));
+    dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+    two_domains_setup (&td, "ddsc_write_async", "<Internal><AsyncWrite>true</AsyncWrite><AsyncWriteQueueDepth>16</AsyncWriteQueueDepth><Watermarks><WhcLow>0 B</WhcLow><WhcHighInit>64 B</WhcHighInit><WhcHigh>64 B</WhcHigh><WhcAdaptive>false</WhcAdaptive></Watermarks></Internal>", NULL, qos);
+    dds_delete_qos (qos);
+    dds_return_t rc = dds_domain_set_deafmute (td.sub_dom, false, true, DDS_MSECS (200));
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+
+    // a write may time out on a full queue, in which case the sample was not accepted
+    // and gets written again
+    const dds_time_t ts = dds_time ();
+    const dds_time_t tend = ts + DDS_SECS (10);
+    for (int32_t i = 0; i < 500; i++)
+    {
+        while ((rc = dds_write_ts (td.wr, &(Space_Type1){ i % 5, i, 0 }, ts)) == DDS_RETCODE_TIMEOUT)
+            CU_ASSERT_FATAL (dds_time () < tend);
+        CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    }
+    write_batch_check (td.rrd, 500, ts, DDS_SECS (10));
+
+    struct dds_statistics *stats = dds_create_statistics (td.wr);
+    CU_ASSERT_FATAL (stats != NULL);
+    const struct dds_stat_keyvalue *kv = dds_lookup_statistic (stats, "async_dropped");
+    CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT64);
+    CU_ASSERT_EQ_FATAL (kv->u.u64, 0);
+    dds_delete_statistics (stats);
+
+    two_domains_fini (&td);
+}
+
+CU_Test(ddsc_write_async, delete_throttled)
+{
+    // A single worker, a tiny WHC, unlimited blocking and a subscriber that doesn't hear
+    // anything: the writer stays throttled, but that must neither keep the worker from
+    // serving another writer nor prevent deleting the writer
+    struct two_domains td;
+    two_domains_setup (&td, "ddsc_write_async", "<Internal><AsyncWrite>true</AsyncWrite><AsyncWriteQueueDepth>16</AsyncWriteQueueDepth><AsyncWriteThreads>1</AsyncWriteThreads><Watermarks><WhcLow>0 B</WhcLow><WhcHighInit>64 B</WhcHighInit><WhcHigh>64 B</WhcHigh><WhcAdaptive>false</WhcAdaptive></Watermarks></Internal>", NULL, NULL);
+
+    // a reader that never responded to a heartbeat doesn't hold up the writer, so make
+    // sure it has acknowledged something before it goes deaf
+    dds_return_t rc = dds_write (td.wr, &(Space_Type1){ 0, 0, 0 });
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    rc = dds_wait_for_acks (td.wr, DDS_SECS (10));
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    rc = dds_domain_set_deafmute (td.sub_dom, true, false, DDS_INFINITY);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+
+    // write until samples stay in the queue because the WHC is full, the limit on the WHC
+    // is applied per batch, hence one at a time; that takes fewer samples than fit in the
+    // queue, so none of the writes has to block
+    struct dds_statistics *stats = dds_create_statistics (td.wr);
+    CU_ASSERT_FATAL (stats != NULL);
+    const struct dds_stat_keyvalue *kv = dds_lookup_statistic (stats, "async_queued");
+    CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT32);
+    int32_t i = 1;
+    do {
+        CU_ASSERT_FATAL (i < 16);
+        rc = dds_write (td.wr, &(Space_Type1){ i % 5, i, 0 });
+        CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+        i++;
+        dds_sleepfor (DDS_MSECS (10));
+        rc = dds_refresh_statistics (stats);
+        CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    } while (kv->u.u32 == 0);
+    kv = dds_lookup_statistic (stats, "async_dropped");
+    CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT64);
+    CU_ASSERT_EQ_FATAL (kv->u.u64, 0);
+    dds_delete_statistics (stats);
+
+    // another writer must still get its data delivered, the worker being blocked on the
+    // throttled writer would prevent that
+    char topicname[100];
+    create_unique_topic_name ("ddsc_write_async", topicname, sizeof (topicname));
+    const dds_entity_t tp2 = dds_create_topic (td.pub_pp, &Space_Type1_desc, topicname, NULL, NULL);
+    CU_ASSERT_GT_FATAL (tp2, 0);
+    const dds_entity_t wr2 = dds_create_writer (td.pub_pp, tp2, NULL, NULL);
+    CU_ASSERT_GT_FATAL (wr2, 0);
+    const dds_entity_t rd2 = dds_create_reader (td.pub_pp, tp2, NULL, NULL);
+    CU_ASSERT_GT_FATAL (rd2, 0);
+    rc = dds_write (wr2, &(Space_Type1){ 1, 2, 3 });
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    const dds_time_t tend = dds_time () + DDS_SECS (5);
+    Space_Type1 s;
+    void *raw[1] = { &s };
+    dds_sample_info_t si;
+    while ((rc = dds_take (rd2, raw, &si, 1, 1)) == 0)
+    {
+        CU_ASSERT_FATAL (dds_time () < tend);
+        dds_sleepfor (DDS_MSECS (10));
+    }
+    CU_ASSERT_EQ_FATAL (rc, 1);
+    CU_ASSERT_FATAL (s.long_1 == 1 && s.long_2 == 2 && s.long_3 == 3);
+
+    // deleting the writer discards what is still queued instead of waiting for acks
+    // that never come
+    const dds_time_t tdel = dds_time ();
+    rc = dds_delete (td.wr);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    CU_ASSERT_LT_FATAL (dds_time () - tdel, DDS_SECS (5));
+
+    two_domains_fini (&td);
+}
+
+CU_Test(ddsc_write_adaptive_hb, matched_rtt)
+{
+    struct two_domains td;
+    two_domains_setup (&td, "ddsc_write_adaptive_hb", "<Internal><AdaptiveHeartbeat>true</AdaptiveHeartbeat></Internal>", NULL, NULL);
+    const dds_entity_t lrd = dds_create_reader (td.pub_pp, td.pub_tp, NULL, NULL);
+    CU_ASSERT_GT_FATAL (lrd, 0);
+
+    dds_duration_t srtt, rttvar;
+    dds_instance_handle_t wr_ih, lrd_ih;
+    dds_return_t rc;
+    rc = dds_get_instance_handle (td.wr, &wr_ih);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    rc = dds_get_instance_handle (lrd, &lrd_ih);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    rc = dds_get_matched_subscription_rtt (td.wr, lrd_ih, NULL, &rttvar);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_BAD_PARAMETER);
+    rc = dds_get_matched_subscription_rtt (td.wr, wr_ih, &srtt, &rttvar);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_BAD_PARAMETER);
+    rc = dds_get_matched_subscription_rtt (lrd, lrd_ih, &srtt, &rttvar);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_ILLEGAL_OPERATION);
+
+    // writing results in heartbeats requesting acks, the first ack after such a heartbeat
+    // gives a round-trip time sample for the remote reader; there are none for local readers
+    for (int32_t i = 0; i < 100; i++)
+    {
+        rc = dds_write (td.wr, &(Space_Type1){ i % 5, i, 0 });
+        CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    }
+    rc = dds_wait_for_acks (td.wr, DDS_SECS (10));
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+
+    dds_instance_handle_t ihs[3];
+    rc = dds_get_matched_subscriptions (td.wr, ihs, 3);
+    CU_ASSERT_EQ_FATAL (rc, 2);
+    bool remote_ok = false;
+    for (int32_t i = 0; i < 2; i++)
+    {
+        rc = dds_get_matched_subscription_rtt (td.wr, ihs[i], &srtt, &rttvar);
+        if (ihs[i] == lrd_ih)
+            CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_NO_DATA);
+        else
+        {
+            // several heartbeats going out before the reader acknowledged one gives no
+            // sample, which happens easily on a loaded machine, so keep writing
+            const dds_time_t tend = dds_time () + DDS_SECS (10);
+            int32_t seq = 100;
+            while (rc == DDS_RETCODE_NO_DATA && dds_time () < tend)
+            {
+                rc = dds_write (td.wr, &(Space_Type1){ seq % 5, seq, 0 });
+                CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+                seq++;
+                (void) dds_wait_for_acks (td.wr, DDS_SECS (1));
+                rc = dds_get_matched_subscription_rtt (td.wr, ihs[i], &srtt, &rttvar);
+            }
+            CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+            CU_ASSERT_FATAL (srtt > 0 && srtt < DDS_SECS (10));
+            CU_ASSERT_FATAL (rttvar >= 0);
+            remote_ok = true;
+        }
+    }
+    CU_ASSERT_FATAL (remote_ok);
+
+    two_domains_fini (&td);
+}
+
+static void set_rtt_estimate (struct ddsi_wr_prd_match *m, int64_t sample)
+{
+    // a single sample gives srtt = sample, rttvar = sample/2, so rto = 3 * sample
+    ddsi_rtt_estim_init (&m->rtt);
+    ddsi_rtt_estim_update (&m->rtt, sample);
+    ddsrt_avl_augment_update (&ddsi_wr_readers_treedef, m);
+}
+
+CU_Test(ddsc_write_adaptive_hb, interval_from_rtt)
+{
+    struct two_domains td;
+    two_domains_setup (&td, "ddsc_write_adaptive_hb", "<Internal><AdaptiveHeartbeat>true</AdaptiveHeartbeat></Internal>", NULL, NULL);
+
+    struct dds_entity *x;
+    dds_return_t rc = dds_entity_pin (td.wr, &x);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    struct ddsi_writer * const wr = ((struct dds_writer *) x)->m_wr;
+    ddsrt_mutex_lock (&wr->e.lock);
+    struct ddsi_wr_prd_match * const m = ddsrt_avl_find_min (&ddsi_wr_readers_treedef, &wr->readers);
+    CU_ASSERT_FATAL (m != NULL && ddsrt_avl_find_succ (&ddsi_wr_readers_treedef, &wr->readers, m) == NULL);
+    const struct ddsi_rtt_estim rtt_orig = m->rtt;
+    const struct ddsi_hbcontrol hbc_orig = wr->hbcontrol;
+    const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+    struct ddsi_whc_state whcst = { .min_seq = 0, .max_seq = 0, .unacked_bytes = 0 };
+
+    // heartbeat interval: the configured one without an estimate, else the rto bounded
+    // below by the configured minimum of 20ms
+    wr->hbcontrol.hbs_since_last_write = 0;
+    ddsi_rtt_estim_init (&m->rtt);
+    ddsrt_avl_augment_update (&ddsi_wr_readers_treedef, m);
+    CU_ASSERT_EQ (ddsi_writer_hbcontrol_intv (wr, &whcst, tnow), DDS_MSECS (100));
+    set_rtt_estimate (m, DDS_MSECS (50));
+    CU_ASSERT_EQ (ddsi_writer_hbcontrol_intv (wr, &whcst, tnow), DDS_MSECS (150));
+    set_rtt_estimate (m, DDS_MSECS (1));
+    CU_ASSERT_EQ (ddsi_writer_hbcontrol_intv (wr, &whcst, tnow), DDS_MSECS (20));
+
+    // with a WHC that is filling up, an ack is requested if the previous request is longer
+    // ago than the configured minimum of 20ms, but not before srtt has passed and not
+    // flushed before rto has passed
+    whcst = (struct ddsi_whc_state) { .min_seq = 1, .max_seq = 1, .unacked_bytes = wr->whc_high };
+    wr->hbcontrol.t_of_last_write = tnow;
+    wr->hbcontrol.t_of_last_ackhb.v = tnow.v - DDS_MSECS (30);
+    ddsi_rtt_estim_init (&m->rtt);
+    ddsrt_avl_augment_update (&ddsi_wr_readers_treedef, m);
+    CU_ASSERT_EQ (ddsi_writer_hbcontrol_ack_required (wr, &whcst, tnow), DDSI_HBC_ACK_REQ_YES_AND_FLUSH);
+    set_rtt_estimate (m, DDS_MSECS (50));
+    CU_ASSERT_EQ (ddsi_writer_hbcontrol_ack_required (wr, &whcst, tnow), DDSI_HBC_ACK_REQ_NO);
+    wr->hbcontrol.t_of_last_ackhb.v = tnow.v - DDS_MSECS (60);
+    CU_ASSERT_EQ (ddsi_writer_hbcontrol_ack_required (wr, &whcst, tnow), DDSI_HBC_ACK_REQ_YES);
+    wr->hbcontrol.t_of_last_ackhb.v = tnow.v - DDS_MSECS (160);
+    CU_ASSERT_EQ (ddsi_writer_hbcontrol_ack_required (wr, &whcst, tnow), DDSI_HBC_ACK_REQ_YES_AND_FLUSH);
+
+    m->rtt = rtt_orig;
+    ddsrt_avl_augment_update (&ddsi_wr_readers_treedef, m);
+    wr->hbcontrol = hbc_orig;
+    ddsrt_mutex_unlock (&wr->e.lock);
+    dds_entity_unpin (x);
+    two_domains_fini (&td);
+}
+
+CU_Test(ddsc_write_congestion, lossy)
+{
+    // 20% of the packets sent by the writer's domain get lost, so the congestion
+    // window must have been reduced at least once by the time everything arrived
+    dds_qos_t *qos = dds_create_qos ();
+    dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_SECS (10));
+    dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+    struct two_domains td;
+    two_domains_setup (&td, "ddsc_write_congestion",
+                       "<Internal><CongestionControl>true</CongestionControl><Test><XmitLossiness>200</XmitLossiness></Test></Internal>",
+                       "<Internal><CongestionControl>false</CongestionControl></Internal>", qos);
+
+    const dds_time_t ts = dds_time ();
+    dds_return_t rc;
+    for (int32_t i = 0; i < 500; i++)
+    {
+        rc = dds_write_ts (td.wr, &(Space_Type1){ i % 5, i, 0 }, ts);
+        CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    }
+    write_batch_check (td.rrd, 500, ts, DDS_SECS (30));
+    rc = dds_wait_for_acks (td.wr, DDS_SECS (30));
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+
+    struct dds_statistics *stats = dds_create_statistics (td.wr);
+    CU_ASSERT_FATAL (stats != NULL);
+    const struct dds_stat_keyvalue *kv;
+    kv = dds_lookup_statistic (stats, "cc_window");
+    CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT32);
+    CU_ASSERT_GT_FATAL (kv->u.u32, 0);
+    kv = dds_lookup_statistic (stats, "cc_rate");
+    CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT64);
+    CU_ASSERT_GT_FATAL (kv->u.u64, 0);
+    kv = dds_lookup_statistic (stats, "cc_loss_events");
+    CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT32);
+    CU_ASSERT_GT_FATAL (kv->u.u32, 0);
+    dds_delete_statistics (stats);
+
+    // no congestion control in the subscriber's domain
+    const dds_entity_t rwr = dds_create_writer (td.sub_pp, td.sub_tp, qos, NULL);
+    CU_ASSERT_GT_FATAL (rwr, 0);
+    dds_delete_qos (qos);
+    stats = dds_create_statistics (rwr);
+    CU_ASSERT_FATAL (stats != NULL);
+    kv = dds_lookup_statistic (stats, "cc_window");
+    CU_ASSERT_FATAL (kv != NULL && kv->u.u32 == 0);
+    dds_delete_statistics (stats);
+
+    two_domains_fini (&td);
+}
+
+struct pacing_write_arg {
+    dds_entity_t wr;
+    ddsrt_atomic_uint32_t done;
+    dds_return_t ret;
+};
+
+static uint32_t pacing_write_thread (void *varg)
+{
+    struct pacing_write_arg * const arg = varg;
+    arg->ret = dds_write (arg->wr, &(Space_Type1){ 0, 0, 0 });
+    ddsrt_atomic_st32 (&arg->done, 1);
+    return 0;
+}
+
+CU_Test(ddsc_write_congestion, interrupt_while_pacing)
+{
+    // a write waiting for its turn because of pacing must return when the writer is
+    // interrupted, as happens when it gets deleted
+    struct two_domains td;
+    two_domains_setup (&td, "ddsc_write_congestion", "<Internal><CongestionControl>true</CongestionControl></Internal>", NULL, NULL);
+
+    // pacing needs a round-trip time estimate
+    dds_return_t rc;
+    for (int32_t i = 0; i < 10; i++)
+    {
+        rc = dds_write (td.wr, &(Space_Type1){ i % 5, i, 0 });
+        CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    }
+    rc = dds_wait_for_acks (td.wr, DDS_SECS (10));
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    dds_instance_handle_t rrd_ih;
+    rc = dds_get_matched_subscriptions (td.wr, &rrd_ih, 1);
+    CU_ASSERT_EQ_FATAL (rc, 1);
+    // there is no sample if several heartbeats went out before the reader acknowledged
+    // one, which happens easily on a loaded machine, so keep writing until there is one
+    dds_duration_t srtt, rttvar;
+    const dds_time_t tend = dds_time () + DDS_SECS (10);
+    int32_t seq = 10;
+    while ((rc = dds_get_matched_subscription_rtt (td.wr, rrd_ih, &srtt, &rttvar)) == DDS_RETCODE_NO_DATA && dds_time () < tend)
+    {
+        rc = dds_write (td.wr, &(Space_Type1){ seq % 5, seq, 0 });
+        CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+        seq++;
+        (void) dds_wait_for_acks (td.wr, DDS_SECS (1));
+    }
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+
+    // pretend a lot of data went out just now, so that the next write has to wait
+    struct dds_entity *x;
+    rc = dds_entity_pin (td.wr, &x);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    struct ddsi_writer * const wr = ((struct dds_writer *) x)->m_wr;
+    ddsrt_mutex_lock (&wr->e.lock);
+    wr->cc.t_pace = ddsrt_mtime_add_duration (ddsrt_time_monotonic (), DDS_SECS (30));
+    ddsrt_mutex_unlock (&wr->e.lock);
+
+    struct pacing_write_arg arg = { .wr = td.wr, .done = DDSRT_ATOMIC_UINT32_INIT (0), .ret = 0 };
+    ddsrt_threadattr_t tattr;
+    ddsrt_threadattr_init (&tattr);
+    ddsrt_thread_t tid;
+    rc = ddsrt_thread_create (&tid, "pacedwr", &tattr, pacing_write_thread, &arg);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    dds_sleepfor (DDS_MSECS (200));
+    CU_ASSERT_EQ_FATAL (ddsrt_atomic_ld32 (&arg.done), 0);
+
+    const dds_time_t tinterrupt = dds_time ();
+    struct ddsi_domaingv * const gv = &x->m_domain->gv;
+    ddsi_thread_state_awake (ddsi_lookup_thread_state (), gv);
+    rc = ddsi_unblock_throttled_writer (gv, &x->m_guid);
+    ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    rc = ddsrt_thread_join (tid, NULL);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    CU_ASSERT_LT (dds_time () - tinterrupt, DDS_SECS (5));
+    CU_ASSERT_NEQ (arg.ret, DDS_RETCODE_OK);
+
+    // deleting the writer interrupts it again, which is only allowed once
+    ddsrt_mutex_lock (&wr->e.lock);
+    wr->state = WRST_OPERATIONAL;
+    ddsrt_mutex_unlock (&wr->e.lock);
+    dds_entity_unpin (x);
+
+    two_domains_fini (&td);
+}
+
 CU_Test(ddsc_write, simpletypes)
 {
     dds_return_t status;
@@ -59,6 +59,8 @@ void ddsi_config_init_default (struct ddsi_config *cfg)
   cfg->secondary_reorder_maxsamples = UINT32_C (128);
   cfg->defrag_unreliable_maxsamples = UINT32_C (4);
   cfg->defrag_reliable_maxsamples = UINT32_C (16);
+  cfg->direct_defrag_min_size = UINT32_C (131072);
+  cfg->direct_defrag_max_size = UINT32_C (16777216);
   cfg->besmode = INT32_C (1);
   cfg->synchronous_delivery_latency_bound = INT64_C (9223372036854775807);
   cfg->retransmit_merging_period = INT64_C (5000000);
@@ -79,11 +81,20 @@ void ddsi_config_init_default (struct ddsi_config *cfg)
   cfg->auto_resched_nack_delay = INT64_C (3000000000);
   cfg->preemptive_ack_delay = INT64_C (10000000);
   cfg->max_sample_size = UINT32_C (2147483647);
+  cfg->whc_ring = INT32_C (1);
+  cfg->async_write_queue_depth = INT32_C (256);
+  cfg->async_write_threads = INT32_C (1);
+  cfg->rhc_shards = INT32_C (1);
+  cfg->rhc_prealloc_max = UINT32_C (1024);
+  cfg->rhc_latest = INT32_C (1);
   cfg->noprogress_log_stacktraces = INT32_C (1);
   cfg->liveliness_monitoring_interval = INT64_C (1000000000);
   cfg->monitor_port = INT32_C (-1);
   cfg->prioritize_retransmit = INT32_C (1);
   cfg->recv_thread_stop_maxretries = UINT32_C (4294967295);
+  cfg->recv_shards = INT32_C (1);
+  cfg->recv_batch_size = INT32_C (1);
+  cfg->xmit_batch_size = INT32_C (1);
   cfg->whc_lowwater_mark = UINT32_C (1024);
   cfg->whc_highwater_mark = UINT32_C (512000);
   cfg->whc_init_highwater_mark.isdefault = 0;
@@ -108,14 +119,14 @@ void ddsi_config_init_default (struct ddsi_config *cfg)
   cfg->ssl_min_version.minor = 3;
 #endif /* DDS_HAS_TCP_TLS */
 }
-/* generated from ddsi_config.h[a96f2afb055d694037710e101e4431ceee2c7c94] */
-/* generated from ddsi_config.c[9fb9ace4394a1b7d50f4e0fa3905bbba2a183e36] */
-/* generated from ddsi__cfgelems.h[5137766e3f48f57c05c3745cc2a2380bf7af82cc] */
+/* generated from ddsi_config.h[00c9e31a5f7bfe3e1aa793def2e0c89d3a68411a] */
+/* generated from ddsi_config.c[c96ce7c295c7a5bd7c7efd7bf56de543fe494059] */
+/* generated from ddsi__cfgelems.h[fd629dd99eea2ee57c250f12e74923eb7e029366] */
 /* generated from cfgunits.h[05f093223fce107d24dd157ebaafa351dc9df752] */
-/* generated from _confgen.h[bb9a0fc6ef1f7f7c46790ee00132e340e5fff36d] */
+/* generated from _confgen.h[6e4404ac61479440a47bcf133349d47980805d58] */
 /* generated from _confgen.c[0d833a6f2c98902f1249e63aed03a6164f0791d6] */
 /* generated from generate_rnc.c[b50e4b7ab1d04b2bc1d361a0811247c337b74934] */
 /* generated from generate_md.c[789b92e422631684352909cfb8bf43f6ceb16a01] */
 /* generated from generate_rst.c[3c4b523fbb57c8e4a7e247379d06a8021ccc21c4] */
 /* generated from generate_xsd.c[9bb91084fff7495aee9c025db3108549a0141957] */
-/* generated from generate_defconfig.c[02afff6935d72b7f04dc64c8a649b09f9f6143ac] */
+/* generated from generate_defconfig.c[f7028345e2e24673875a4cad488bedc61d26196c] */
@@ -176,6 +176,11 @@ enum ddsi_many_sockets_mode {
   DDSI_MSM_MANY_UNICAST
 };
 
+enum ddsi_sock_waitset_mode {
+  DDSI_SOCK_WAITSET_DEFAULT,
+  DDSI_SOCK_WAITSET_IO_URING
+};
+
 #ifdef DDS_HAS_SECURITY
 struct ddsi_plugin_library_properties {
   char *library_path;
@@ -333,6 +338,14 @@ struct ddsi_config
   int prioritize_retransmit;
   enum ddsi_boolean_default multiple_recv_threads;
   unsigned recv_thread_stop_maxretries;
+  int recv_batch_size;
+  int recv_shards;
+  int rhc_shards;
+  int rhc_latest;
+  unsigned rhc_prealloc_max;
+  int xmit_batch_size;
+  enum ddsi_sock_waitset_mode sock_waitset_mode;
+  int64_t coalescing_max_delay;
 
   unsigned primary_reorder_maxsamples;
   unsigned secondary_reorder_maxsamples;
@@ -389,6 +402,8 @@ struct ddsi_config
   uint32_t rbuf_size;                /* << size of a single receiver buffer */
   enum ddsi_besmode besmode;
   int meas_hb_to_ack_latency;
+  int adaptive_heartbeat;
+  int congestion_control;
   int synchronous_delivery_priority_threshold;
   int64_t synchronous_delivery_latency_bound;
 
@@ -399,9 +414,15 @@ struct ddsi_config
   uint32_t whc_highwater_mark;
   struct ddsi_config_maybe_uint32 whc_init_highwater_mark;
   int whc_adaptive;
+  int whc_ring;
+  int async_write;
+  int async_write_queue_depth;
+  int async_write_threads;
 
   unsigned defrag_unreliable_maxsamples;
   unsigned defrag_reliable_maxsamples;
+  uint32_t direct_defrag_min_size;
+  uint32_t direct_defrag_max_size;
   unsigned accelerate_rexmit_block_size;
   int64_t responsiveness_timeout;
   uint32_t max_participants;
@@ -0,0 +1,42 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI_CONGESTION_H
+#define DDSI_CONGESTION_H
+
+#include <stdint.h>
+#include "dds/features.h"
+#include "dds/ddsrt/time.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/// @brief Congestion control state of a reliable writer (per writer, used only if Internal/CongestionControl is set)
+///
+/// The window limits the amount of unacknowledged data, it grows with acknowledgements (exponentially
+/// below the slow-start threshold, linearly above it) and is halved on loss, i.e., on a retransmit request
+/// from a reader that is in sync, at most once per round-trip time.  New data is paced out at a rate of
+/// a small multiple of window / round-trip time, so that a full window doesn't hit the network (and the
+/// readers' socket receive buffers) in a single burst.
+struct ddsi_congestion {
+  uint32_t cwnd;               ///< Congestion window in bytes
+  uint32_t ssthresh;           ///< Slow-start threshold in bytes
+  uint64_t rate;               ///< Pacing rate in bytes/s, 0 if no round-trip time known yet
+  ddsrt_mtime_t t_pace;        ///< Earliest time at which the next data may be sent
+  ddsrt_mtime_t t_last_loss;   ///< Time of the most recent window reduction
+  uint32_t loss_events;        ///< Number of window reductions
+};
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSI_CONGESTION_H */
@@ -66,13 +66,29 @@ enum ddsi_recvips_mode {
 
 enum ddsi_recv_thread_mode {
   DDSI_RTM_SINGLE,
-  DDSI_RTM_MANY
+  DDSI_RTM_MANY,
+  DDSI_RTM_SHARD /* single socket sharing its port with others, waitset for triggering */
+};
+
+/* Maximum number of sockets bound to the unicast data port, see Internal/ReceiveShards */
+#define MAX_RECV_SHARDS 8
+
+struct ddsi_recv_thread_stats {
+  ddsrt_atomic_uint64_t reads;   /* number of read operations that returned at least one packet */
+  ddsrt_atomic_uint64_t packets; /* number of packets received */
+};
+
+struct ddsi_xmit_stats {
+  ddsrt_atomic_uint64_t flushes;  /* number of xpacks sent */
+  ddsrt_atomic_uint64_t packets;  /* number of packets sent, an xpack is sent to one or more destinations */
+  ddsrt_atomic_uint64_t syscalls; /* number of system calls used for sending them */
 };
 
 struct ddsi_recv_thread_arg {
   enum ddsi_recv_thread_mode mode;
   struct ddsi_rbufpool *rbpool;
   struct ddsi_domaingv *gv;
+  struct ddsi_recv_thread_stats stats;
   union {
     struct {
       const ddsi_locator_t *loc;
@@ -81,6 +97,10 @@ struct ddsi_recv_thread_arg {
     struct {
       struct ddsi_sock_waitset *ws;
     } many;
+    struct {
+      struct ddsi_sock_waitset *ws;
+      struct ddsi_tran_conn *conn;
+    } shard;
   } u;
 };
 
@@ -124,6 +144,12 @@ struct ddsi_domaingv {
   struct ddsi_tran_conn * disc_conn_uc;
   struct ddsi_tran_conn * data_conn_uc;
 
+  /* Additional sockets bound to the unicast data port, so that the kernel
+     distributes incoming data over multiple receive threads (only if
+     Internal/ReceiveShards > 1) */
+  uint32_t n_data_conn_uc_shards;
+  struct ddsi_tran_conn * data_conn_uc_shards[MAX_RECV_SHARDS - 1];
+
   /* Connection used for all output (for connectionless transports), this
      used to simply be data_conn_uc, but:
 
@@ -203,7 +229,7 @@ struct ddsi_domaingv {
      trigger socket.) Receive buffer pool is per receive thread,
      it is only a global variable because it needs to be freed way later
      than the receive thread itself terminates */
-#define MAX_RECV_THREADS 3
+#define MAX_RECV_THREADS (2 + MAX_RECV_SHARDS)
   uint32_t n_recv_threads;
   struct recv_thread {
     const char *name;
@@ -282,7 +308,7 @@ struct ddsi_domaingv {
 #endif
 
   ddsrt_mutex_t sendq_lock;
-  ddsrt_cond_t sendq_cond;
+  ddsrt_cond_mtime_t sendq_cond;
   unsigned sendq_length;
   struct ddsi_xpack *sendq_head;
   struct ddsi_xpack *sendq_tail;
@@ -291,6 +317,8 @@ struct ddsi_domaingv {
   bool sendq_running;
   ddsrt_mutex_t sendq_running_lock;
 
+  struct ddsi_xmit_stats xmit_stats;
+
   /* File for dumping captured packets, NULL if disabled */
   FILE *pcap_fp;
   ddsrt_mutex_t pcap_lock;
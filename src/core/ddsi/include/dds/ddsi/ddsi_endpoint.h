@@ -17,6 +17,7 @@
 #include "dds/ddsrt/fibheap.h"
 #include "dds/ddsi/ddsi_entity.h"
 #include "dds/ddsi/ddsi_hbcontrol.h"
+#include "dds/ddsi/ddsi_congestion.h"
 #include "dds/dds.h"
 
 #if defined (__cplusplus)
@@ -106,6 +107,7 @@ struct ddsi_writer
   ddsrt_etime_t t_rexmit_start;
   ddsrt_etime_t t_rexmit_end; /* time of last 1->0 transition of "retransmitting" */
   ddsrt_etime_t t_whc_high_upd; /* time "whc_high" was last updated for controlled ramp-up of throughput */
+  struct ddsi_congestion cc; /* congestion window and pacing (if enabled) */
   uint32_t init_burst_size_limit; /* derived from reader's receive_buffer_size */
   uint32_t rexmit_burst_size_limit; /* derived from reader's receive_buffer_size */
   uint32_t num_readers; /* total number of matching PROXY readers */
@@ -46,6 +46,19 @@ dds_return_t ddsi_reader_get_matched_publications (struct ddsi_reader *rd, uint6
  */
 bool ddsi_writer_find_matched_reader (struct ddsi_writer *wr, uint64_t ih, const struct ddsi_entity_common **rdc, const struct dds_qos **rdqos, const struct ddsi_entity_common **ppc);
 
+/** @brief Get the heartbeat-to-acknack round-trip time estimate for a matching reader
+ * @component endpoint_matching
+ *
+ * @param[in] wr writer for which to lookup ih in the setting of matching readers
+ * @param[in] ih instance handle of a reader
+ * @param[out] srtt smoothed round-trip time (ns)
+ * @param[out] rttvar mean deviation of the round-trip time (ns)
+ * @return DDS_RETCODE_OK if an estimate is available, DDS_RETCODE_NO_DATA if ih is a
+ *   matched reader without an estimate (a local or best-effort reader, or one that hasn't
+ *   responded to a heartbeat yet), DDS_RETCODE_BAD_PARAMETER if it is not a matched reader
+ */
+dds_return_t ddsi_writer_get_matched_reader_rtt (struct ddsi_writer *wr, uint64_t ih, int64_t *srtt, int64_t *rttvar);
+
 /** @brief Lookup the instance handle of a matching writer and return it, it's qos and participant
  * @component endpoint_matching
  *
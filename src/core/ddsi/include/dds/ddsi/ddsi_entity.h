@@ -87,6 +87,7 @@ struct ddsi_local_reader_ary {
   unsigned fastpath_ok: 1; /* if not ok, fall back to using GUIDs (gives access to the reader-writer match data for handling readers that bumped into resource limits, hence can flip-flop, unlike "valid") */
   uint32_t n_readers;
   struct ddsi_reader **rdary; /* for efficient delivery, null-pointer terminated, grouped by topic */
+  ddsrt_atomic_voidp_t single_type; /* sertype of all readers if fastpath_ok and they all have the same type, else null; may be read without the lock while awake */
 };
 
 /** @component ddsi_generic_entity */
@@ -32,6 +32,7 @@ struct ddsi_hbcontrol {
   ddsrt_mtime_t t_of_last_ackhb; ///< Time of last heartbeat sent that requires a response
   ddsrt_mtime_t tsched;          ///< Time at which next asynchronous heartbeat is scheduled
   uint32_t hbs_since_last_write; ///< Number of heartbeats sent since last write
+  uint32_t ackhbs;               ///< Number of heartbeats sent that require a response (wraps around)
   uint32_t last_packetid;        ///< Last RTPS message id containing a heartbeat from this writer
 };
 
@@ -28,6 +28,14 @@ struct ddsi_lat_estim {
   float smoothed;
 };
 
+struct ddsi_rtt_estim {
+  /* smoothed round-trip time and its mean deviation in nanoseconds,
+     following RFC 6298; both are 0 until the first sample arrives */
+  int64_t srtt;
+  int64_t rttvar;
+  uint32_t nsamples;
+};
+
 #if defined (__cplusplus)
 }
 #endif
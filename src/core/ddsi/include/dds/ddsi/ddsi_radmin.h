@@ -27,6 +27,7 @@ extern "C" {
 
 struct ddsi_rbuf;
 struct ddsi_rmsg;
+struct ddsi_rmsg_serdata;
 struct ddsi_rdata;
 struct ddsi_rsample_info;
 struct ddsi_tran_conn;
@@ -85,6 +86,11 @@ struct ddsi_rmsg {
      the real packet. */
   struct ddsi_rmsg_chunk *lastchunk;
 
+  /* Serdatas allocated from the receive thread into which fragments
+     of samples are copied as they arrive, released when the message is
+     freed.  Normally null. */
+  struct ddsi_rmsg_serdata *serdatas;
+
   /* whether to log */
   bool trace;
 
@@ -66,6 +66,24 @@ typedef struct ddsi_serdata * (*ddsi_serdata_from_ser_t) (const struct ddsi_sert
 typedef struct ddsi_serdata * (*ddsi_serdata_from_ser_iov_t) (const struct ddsi_sertype *type, enum ddsi_serdata_kind kind, ddsrt_msg_iovlen_t niov, const ddsrt_iovec_t *iov, size_t size)
   ddsrt_nonnull_all ddsrt_attribute_warn_unused_result;
 
+/* Allocate a serdata into which serialised data received over the network can be written
+   directly, avoiding the copy from the fragchain made by from_ser
+   - "kind" and "size" are as in from_ser
+   - "size" is what the sender claims, a failure to allocate it must result in a null
+     pointer rather than an abort
+   - on success, *buf points to "size" bytes of writable memory that must be filled
+     with the serialised data, inclusive of the DDSI encoding header, in any order
+   - the result may not be used for anything other than from_ser_finish or unref
+   - optional, a null pointer means it is not supported */
+typedef struct ddsi_serdata * (*ddsi_serdata_from_ser_prealloc_t) (const struct ddsi_sertype *type, enum ddsi_serdata_kind kind, size_t size, void **buf)
+  ddsrt_nonnull_all ddsrt_attribute_warn_unused_result;
+
+/* Complete a serdata obtained from from_ser_prealloc once all serialised data has been
+   written into it, doing the validation &c. from_ser would do
+   - returns d on success, on failure it unrefs d and returns a null pointer */
+typedef struct ddsi_serdata * (*ddsi_serdata_from_ser_finish_t) (struct ddsi_serdata *d)
+  ddsrt_nonnull_all ddsrt_attribute_warn_unused_result;
+
 /* Construct a serdata from a keyhash (an SDK_KEY by definition) */
 typedef struct ddsi_serdata * (*ddsi_serdata_from_keyhash_t) (const struct ddsi_sertype *type, const struct ddsi_keyhash *keyhash)
   ddsrt_nonnull_all ddsrt_attribute_warn_unused_result;
@@ -180,11 +198,14 @@ struct ddsi_serdata_ops {
   ddsi_serdata_get_keyhash_t get_keyhash;
   ddsi_serdata_from_loan_t from_loaned_sample;
   ddsi_serdata_from_psmx_t from_psmx;
+  ddsi_serdata_from_ser_prealloc_t from_ser_prealloc;
+  ddsi_serdata_from_ser_finish_t from_ser_finish;
 };
 
 #define DDSI_SERDATA_HAS_PRINT 1
 #define DDSI_SERDATA_HAS_FROM_SER_IOV 1
 #define DDSI_SERDATA_HAS_GET_KEYHASH 1
+#define DDSI_SERDATA_HAS_FROM_SER_PREALLOC 1
 
 /** @component typesupport_if */
 DDS_EXPORT void ddsi_serdata_init (struct ddsi_serdata *d, const struct ddsi_sertype *tp, enum ddsi_serdata_kind kind)
@@ -285,6 +306,25 @@ inline struct ddsi_serdata *ddsi_serdata_from_ser_iov (const struct ddsi_sertype
   return type->serdata_ops->from_ser_iov (type, kind, niov, iov, size);
 }
 
+/** @component typesupport_if */
+DDS_INLINE_EXPORT inline struct ddsi_serdata *ddsi_serdata_from_ser_prealloc (const struct ddsi_sertype *type, enum ddsi_serdata_kind kind, size_t size, void **buf)
+  ddsrt_nonnull_all ddsrt_attribute_warn_unused_result;
+
+inline struct ddsi_serdata *ddsi_serdata_from_ser_prealloc (const struct ddsi_sertype *type, enum ddsi_serdata_kind kind, size_t size, void **buf) {
+  if (type->serdata_ops->from_ser_prealloc)
+    return type->serdata_ops->from_ser_prealloc (type, kind, size, buf);
+  else
+    return NULL;
+}
+
+/** @component typesupport_if */
+DDS_INLINE_EXPORT inline struct ddsi_serdata *ddsi_serdata_from_ser_finish (struct ddsi_serdata *d)
+  ddsrt_nonnull_all ddsrt_attribute_warn_unused_result;
+
+inline struct ddsi_serdata *ddsi_serdata_from_ser_finish (struct ddsi_serdata *d) {
+  return d->ops->from_ser_finish (d);
+}
+
 /** @component typesupport_if */
 DDS_INLINE_EXPORT inline struct ddsi_serdata *ddsi_serdata_from_keyhash (const struct ddsi_sertype *type, const struct ddsi_keyhash *keyhash)
   ddsrt_nonnull_all ddsrt_attribute_warn_unused_result;
@@ -19,13 +19,30 @@ extern "C" {
 
 struct ddsi_reader;
 struct ddsi_writer;
+struct ddsi_domaingv;
 
 /** @component ddsi_statistics */
 void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint32_t *throttle_count, uint64_t *time_throttled, uint64_t *time_retransmit);
 
+/** @brief Congestion window (bytes), pacing rate (bytes/s) and number of loss events, all 0 if congestion control doesn't apply
+ * @component ddsi_statistics */
+void ddsi_get_writer_congestion_stats (struct ddsi_writer *wr, uint32_t *window, uint64_t *rate, uint32_t *loss_events);
+
 /** @component ddsi_statistics */
 void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes);
 
+/** @component ddsi_statistics */
+void ddsi_get_recv_stats (const struct ddsi_domaingv *gv, uint64_t *reads, uint64_t *packets);
+
+/** @component ddsi_statistics */
+void ddsi_get_xmit_stats (const struct ddsi_domaingv *gv, uint64_t *flushes, uint64_t *packets, uint64_t *syscalls);
+
+/** @component ddsi_statistics */
+void ddsi_get_dqueue_stats (const struct ddsi_domaingv *gv, uint64_t *samples, uint64_t *max_samples, uint64_t *wakeups);
+
+/** @component ddsi_statistics */
+void ddsi_get_rbuf_stats (const struct ddsi_domaingv *gv, uint64_t *live_bytes, uint64_t *pinned_bytes, uint64_t *allocs, uint64_t *reuses);
+
 #if defined (__cplusplus)
 }
 #endif
@@ -37,6 +37,29 @@ struct ddsi_thread_state;
  */
 DDS_EXPORT int ddsi_write_sample_gc (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, struct ddsi_serdata *serdata, struct ddsi_tkmap_instance *tk);
 
+/**
+ * @component outgoing_rtps
+ *
+ * Writing a sequence of new samples as if by calling ddsi_write_sample_gc for each, but
+ * with a single acquisition of the writer lock, a single check for space in the writer
+ * history cache and a single heartbeat following the last sample.  All samples are
+ * unref'd.  If writing one of the samples fails, the ones preceding it have been written
+ * and the remaining ones are dropped.
+ *
+ * @param thrst     Thread state
+ * @param xp        xpack (may not be NULL)
+ * @param wr        writer
+ * @param max_blocking_time  maximum time to wait for space in the writer history cache
+ *                  or for congestion control to allow sending, used instead of the
+ *                  writer's reliability QoS
+ * @param n         number of samples
+ * @param serdata   array of n serialized samples
+ * @param tk        array of n key-instance map instances, corresponding to serdata
+ * @param nwritten  set to the number of samples written
+ * @return int
+ */
+int ddsi_write_sample_batch_gc (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, dds_duration_t max_blocking_time, uint32_t n, struct ddsi_serdata **serdata, struct ddsi_tkmap_instance **tk, uint32_t *nwritten);
+
 /**
  * @component outgoing_rtps
  *
@@ -1407,6 +1407,28 @@ static struct cfgelem internal_cfgelems[] = {
       "defragmented simultaneously for a reliable writer. This has to be "
       "large enough to handle retransmissions of historical data in addition "
       "to new samples.</p>")),
+  STRING("DirectDefragMinSize", NULL, 1, "128 kB",
+    MEMBER(direct_defrag_min_size),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This element sets the minimum size of a fragmented sample for it "
+      "to be defragmented directly into the buffer from which the readers "
+      "deserialize it, rather than first collecting all fragments and then "
+      "copying them into that buffer. This saves copying the data but means "
+      "memory for the entire sample is allocated as soon as a fragment "
+      "arrives. It is only done when all local readers of the writer use the "
+      "same type representation.</p>"),
+    UNIT("memsize")),
+  STRING("DirectDefragMaxSize", NULL, 1, "16 MB",
+    MEMBER(direct_defrag_max_size),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This element sets the maximum size of a fragmented sample for it "
+      "to be defragmented directly (see DirectDefragMinSize). The memory is "
+      "allocated based on the sample size claimed by the first fragment that "
+      "arrives, larger samples are always defragmented by collecting the "
+      "fragments first.</p>"),
+    UNIT("memsize")),
   ENUM("BuiltinEndpointSet", NULL, 1, "writers",
     MEMBER(besmode),
     FUNCTIONS(0, uf_besmode, 0, pf_besmode),
@@ -1428,8 +1450,38 @@ static struct cfgelem internal_cfgelems[] = {
       "<p>This element enables heartbeat-to-ack latency among Cyclone DDS "
       "services by prepending timestamps to Heartbeat and AckNack messages "
       "and calculating round trip times. This is non-standard behaviour. The "
-      "measured latencies are quite noisy and are currently not used "
-      "anywhere.</p>")),
+      "measured latencies are quite noisy and are only used for pacing "
+      "heartbeats if Internal/AdaptiveHeartbeat is enabled.</p>")),
+  BOOL("AdaptiveHeartbeat", NULL, 1, "false",
+    MEMBER(adaptive_heartbeat),
+    FUNCTIONS(0, uf_boolean, 0, pf_boolean),
+    DESCRIPTION(
+      "<p>This element enables pacing of heartbeats and retransmits by the "
+      "round-trip time to the remote readers, measured from a heartbeat "
+      "requesting an acknowledgement to the first AckNack received after "
+      "it. When enabled, the base heartbeat interval of a writer is the "
+      "retransmission timeout (smoothed round-trip time plus four times its "
+      "variation) of its slowest reader, limited by the minimum and maximum "
+      "heartbeat intervals; acknowledgements are not requested more often "
+      "than they can be expected back; and retransmit merging covers at "
+      "least one round-trip time. The estimates are maintained regardless "
+      "of this setting and can be retrieved using "
+      "dds_get_matched_subscription_rtt.</p>")),
+  BOOL("CongestionControl", NULL, 1, "false",
+    MEMBER(congestion_control),
+    FUNCTIONS(0, uf_boolean, 0, pf_boolean),
+    DESCRIPTION(
+      "<p>This element enables congestion control for reliable keep-all "
+      "writers. Each writer then maintains a congestion window that limits "
+      "the amount of unacknowledged data in addition to the WHC watermarks. "
+      "The window grows as data is acknowledged and is halved, at most once "
+      "per round-trip time, when a reader requests a retransmit. New data is "
+      "paced out at a rate slightly higher than the window divided by the "
+      "round-trip time to the slowest reader, and retransmit bursts are "
+      "limited to the window. The window ranges from two times "
+      "Internal/MaxMessageSize to Internal/Watermarks/WhcHigh, starting at "
+      "Internal/Watermarks/WhcHighInit. The window size, pacing rate and "
+      "number of loss events are available as writer statistics.</p>")),
   INT("SynchronousDeliveryPriorityThreshold", NULL, 1, "0",
     MEMBER(synchronous_delivery_priority_threshold),
     FUNCTIONS(0, uf_int, 0, pf_int),
@@ -1655,6 +1707,86 @@ static struct cfgelem internal_cfgelems[] = {
       "the application may have to use the dds_write_flush function to "
       "ensure that all samples are written.</p>"
     )),
+  BOOL("WhcRing", NULL, 1, "true",
+    MEMBER(whc_ring),
+    FUNCTIONS(0, uf_boolean, 0, pf_boolean),
+    DESCRIPTION(
+      "<p>This element controls whether writers of topics without a key that "
+      "are volatile and have neither a deadline nor a lifespan use a writer "
+      "history cache that stores the samples in a ring buffer indexed by "
+      "sequence number instead of the general-purpose one.</p>"
+    )),
+  BOOL("AsyncWrite", NULL, 1, "false",
+    MEMBER(async_write),
+    FUNCTIONS(0, uf_boolean, 0, pf_boolean),
+    DESCRIPTION(
+      "<p>This element enables asynchronous writing for writers that do not "
+      "use a PSMX interface. A write then only serializes the sample and "
+      "appends it to a queue of the writer, and a transmit worker thread "
+      "takes care of storing it in the writer history cache, sending it and "
+      "delivering it to local readers. Samples of a writer are handled in "
+      "the order they were written. If the queue is full, a write waits for "
+      "at most the max_blocking_time of the reliability QoS and returns a "
+      "timeout if no space became available in that time.</p>"
+      "<p>A sample that was accepted in the queue is not dropped when the "
+      "writer history cache is full: it stays in the queue until there is "
+      "space. A worker does wait up to max_blocking_time for that space "
+      "before turning to another writer, so with a single worker thread, a "
+      "throttled writer delays the other asynchronous writers by as much.</p>"
+    )),
+  INT("AsyncWriteQueueDepth", NULL, 1, "256",
+    MEMBER(async_write_queue_depth),
+    FUNCTIONS(0, uf_async_write_queue_depth, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the number of samples the queue of a writer in "
+      "asynchronous mode can hold, rounded up to a power of 2.</p>"),
+    RANGE("1;65536")),
+  INT("AsyncWriteThreads", NULL, 1, "1",
+    MEMBER(async_write_threads),
+    FUNCTIONS(0, uf_async_write_threads, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the number of transmit worker threads that "
+      "handle the queues of the writers in asynchronous mode. A writer is "
+      "handled by one worker at a time, different writers can be handled "
+      "in parallel.</p>"),
+    RANGE("1;8")),
+  INT("ReaderCacheShards", NULL, 1, "1",
+    MEMBER(rhc_shards),
+    FUNCTIONS(0, uf_rhc_shards, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the number of shards the instances in the "
+      "history cache of a reader are partitioned into, each with its own "
+      "lock, so that data for instances in different shards can be stored "
+      "and read in parallel. A reader returns the samples of different "
+      "instances shard by shard, rather than in the order the instances "
+      "received data.</p>"
+      "<p>It only applies to readers of topics with a key for which the "
+      "resource limits on the total number of samples and instances are "
+      "unlimited. The default of 1 disables sharding.</p>"),
+    RANGE("1;64")),
+  INT("ReaderCacheMaxPrealloc", NULL, 1, "1024",
+    MEMBER(rhc_prealloc_max),
+    FUNCTIONS(0, uf_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This element sets an upper bound on the number of samples and on "
+      "the number of instances for which a reader history cache reserves "
+      "memory when it is created, based on the limits on the number of "
+      "samples and instances in the resource limits QoS of the reader. "
+      "Beyond this, memory is reserved in increasingly large chunks as "
+      "needed. A value of 0 disables preallocation.</p>"
+    )),
+  BOOL("LatestValueReaderCache", NULL, 1, "true",
+    MEMBER(rhc_latest),
+    FUNCTIONS(0, uf_boolean, 0, pf_boolean),
+    DESCRIPTION(
+      "<p>This element controls whether readers of topics without a key "
+      "with a KEEP_LAST history of depth 1 use a history cache that keeps "
+      "the latest sample in a slot that can be read and taken without "
+      "locking. It switches to the general-purpose history cache as soon "
+      "as a read condition is attached, data from a second writer arrives, "
+      "the instance is disposed or unregistered, or a sample with a "
+      "lifespan or a topic filter is encountered.</p>"
+    )),
   BOOL("LivelinessMonitoring", liveliness_monitoring_attrs, 1, "false",
     MEMBER(liveliness_monitoring),
     FUNCTIONS(0, uf_boolean, 0, pf_boolean),
@@ -1723,6 +1855,71 @@ static struct cfgelem internal_cfgelems[] = {
     "transport (e.g., UDP) and ManySocketsMode not set to single (the "
     "default).</p>"),
     VALUES("false","true","default")),
+  INT("ReceiveShards", NULL, 1, "1",
+    MEMBER(recv_shards),
+    FUNCTIONS(0, uf_recv_shards, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the number of sockets bound to the unicast data "
+      "port, each served by its own receive thread. The network stack "
+      "distributes the incoming traffic over these sockets based on the "
+      "source address and port, so that the data from one remote participant "
+      "always arrives in the same socket and the data from different remote "
+      "participants can be processed in parallel.</p>"
+      "<p>It is only used for UDP on platforms where binding multiple sockets "
+      "to a single port distributes the traffic (e.g., SO_REUSEPORT on "
+      "Linux), when MultipleReceiveThreads is enabled, ManySocketsMode is set "
+      "to single and the unicast data port differs from the unicast discovery "
+      "port.</p>"),
+    RANGE("1;8")),
+  STRING("CoalescingMaxDelay", NULL, 1, "0 s",
+    MEMBER(coalescing_max_delay),
+    FUNCTIONS(0, uf_duration_us_1s, 0, pf_duration),
+    DESCRIPTION(
+      "<p>This element sets the maximum time the data of writers with a "
+      "non-zero latency budget is held back for combining it with data "
+      "of other such writers into fewer, larger packets. The data is held "
+      "for at most the smaller of this setting and the writer's latency "
+      "budget, combining it with other data for the same destinations. The "
+      "default of 0 disables this.</p>"),
+    UNIT("duration"),
+    RANGE("0;1s")),
+  ENUM("SocketWaitsetMode", NULL, 1, "default",
+    MEMBER(sock_waitset_mode),
+    FUNCTIONS(0, uf_sock_waitset_mode, 0, pf_sock_waitset_mode),
+    DESCRIPTION(
+      "<p>This element selects the mechanism the receive threads use for "
+      "waiting on multiple sockets at the same time:</p>\n"
+      "<ul><li><i>default</i>: the platform's default mechanism (e.g., epoll "
+      "on Linux);</li>\n"
+      "<li><i>io_uring</i>: io_uring poll requests, submitted together with "
+      "the wait for the next event, on Linux only.</li></ul>\n"
+      "<p>If the selected mechanism is not available, the default is used "
+      "instead.</p>"),
+    VALUES("default","io_uring")),
+  INT("ReceiveBatchSize", NULL, 1, "1",
+    MEMBER(recv_batch_size),
+    FUNCTIONS(0, uf_batch_size, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the maximum number of packets a receive thread "
+      "reads from a socket in a single system call. Values greater than 1 "
+      "enable batched receiving on platforms that support it (e.g., using "
+      "recvmmsg on Linux), which reduces the system call overhead at high "
+      "packet rates. Each receive thread then needs an additional "
+      "(ReceiveBatchSize-1) times 64kB of memory for staging packets. It "
+      "only applies to datagram-based transports (e.g., UDP).</p>"),
+    RANGE("1;32")),
+  INT("SendBatchSize", NULL, 1, "1",
+    MEMBER(xmit_batch_size),
+    FUNCTIONS(0, uf_batch_size, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the maximum number of destinations to which a "
+      "packet is sent in a single system call. Values greater than 1 enable "
+      "batched sending on platforms that support it (e.g., using sendmmsg on "
+      "Linux), which reduces the system call overhead when data has to be "
+      "sent to many unicast addresses. It only applies to datagram-based "
+      "transports (e.g., UDP) and is not used for messages that require "
+      "RTPS-level protection by DDS Security.</p>"),
+    RANGE("1;32")),
   GROUP("ControlTopic", control_topic_cfgelems, control_topic_cfgattrs, 1,
     NOMEMBER,
     NOFUNCTIONS,
@@ -0,0 +1,55 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI__CONGESTION_H
+#define DDSI__CONGESTION_H
+
+#include "dds/features.h"
+#include "dds/ddsi/ddsi_congestion.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct ddsi_writer;
+struct ddsi_domaingv;
+
+/** @component outgoing_rtps */
+void ddsi_congestion_init (struct ddsi_congestion *cc, const struct ddsi_domaingv *gv);
+
+/** @brief Whether congestion control applies to the writer
+ * @component outgoing_rtps
+ *
+ * Only writers that may block on a full WHC (i.e., reliable, keep-all and not built-in)
+ * are subject to congestion control.
+ */
+bool ddsi_congestion_enabled (const struct ddsi_writer *wr);
+
+/** @brief Grows the window after `acked` bytes were acknowledged by all readers
+ * @component outgoing_rtps */
+void ddsi_congestion_note_ack (struct ddsi_writer *wr, size_t acked);
+
+/** @brief Shrinks the window in response to a retransmit request
+ * @component outgoing_rtps */
+void ddsi_congestion_note_loss (struct ddsi_writer *wr, ddsrt_mtime_t tnow);
+
+/** @brief Returns how long to wait before sending more data
+ * @component outgoing_rtps */
+int64_t ddsi_congestion_pacing_delay (struct ddsi_writer *wr, ddsrt_mtime_t tnow);
+
+/** @brief Charges the transmission of `size` bytes of new data to the pacing schedule
+ * @component outgoing_rtps */
+void ddsi_congestion_note_sent (struct ddsi_writer *wr, uint32_t size, ddsrt_mtime_t tnow);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSI__CONGESTION_H */
@@ -107,6 +107,10 @@ struct ddsi_wr_prd_match {
   ddsrt_etime_t t_nackfrag_accepted; /* (local) time a nackfrag was last accepted */
   struct ddsi_lat_estim hb_to_ack_latency;
   ddsrt_wctime_t hb_to_ack_latency_tlastlog;
+  struct ddsi_rtt_estim rtt; /* heartbeat-to-acknack round-trip time */
+  uint32_t rtt_ackhbs; /* writer's count of ack-requesting heartbeats as of the last AckNack considered for an rtt sample */
+  int64_t max_srtt; /* largest srtt in subtree (0 if none known) */
+  int64_t max_rto; /* largest retransmission timeout in subtree (0 if none known) */
   uint32_t non_responsive_count;
   uint32_t rexmit_requests;
 #ifdef DDS_HAS_SECURITY
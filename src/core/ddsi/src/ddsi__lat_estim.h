@@ -30,6 +30,18 @@ void ddsi_lat_estim_update (struct ddsi_lat_estim *le, int64_t est);
 /** @component latency_estim */
 double ddsi_lat_estim_current (const struct ddsi_lat_estim *le);
 
+/** @brief Resets a round-trip time estimator to "no estimate yet"
+ * @component latency_estim */
+void ddsi_rtt_estim_init (struct ddsi_rtt_estim *re);
+
+/** @brief Adds a round-trip time sample (in ns) to the estimate, non-positive values are ignored
+ * @component latency_estim */
+void ddsi_rtt_estim_update (struct ddsi_rtt_estim *re, int64_t sample);
+
+/** @brief Retransmission timeout derived from the estimate: SRTT + 4 RTTVAR, or 0 if there is no estimate
+ * @component latency_estim */
+int64_t ddsi_rtt_estim_rto (const struct ddsi_rtt_estim *re);
+
 /** @component latency_estim */
 int ddsi_lat_estim_log (uint32_t logcat, const struct ddsrt_log_cfg *logcfg, const char *tag, const struct ddsi_lat_estim *le);
 
@@ -40,6 +40,8 @@ struct ddsi_dqueue;
 struct ddsi_guid;
 struct ddsi_tran_conn;
 struct ddsi_proxy_writer;
+struct ddsi_sertype;
+struct ddsi_serdata;
 struct ddsrt_log_cfg;
 struct ddsi_fragment_number_set_header;
 struct ddsi_sequence_number_set_header;
@@ -70,6 +72,8 @@ struct ddsi_rsample_info {
   uint32_t fragsize;
   ddsrt_wctime_t timestamp;
   ddsrt_wctime_t reception_timestamp; /* OpenSplice extension -- but we get it essentially for free, so why not? */
+  const struct ddsi_sertype *assembly_type; /* if non-null, defragment directly into a serdata of this type */
+  struct ddsi_serdata *assembled; /* complete sample if defragmented directly, owned by the rmsg */
   unsigned statusinfo: 2;       /* just the two defined bits from the status info */
   unsigned bswap: 1;            /* so we can extract well formatted writer info quicker */
   unsigned complex_qos: 1;      /* includes QoS other than keyhash, 2-bit statusinfo, PT writer info */
@@ -128,6 +132,10 @@ void ddsi_rbufpool_setowner (struct ddsi_rbufpool *rbp, ddsrt_thread_t tid);
 /** @component receive_buffers */
 void ddsi_rbufpool_free (struct ddsi_rbufpool *rbp);
 
+/** @brief bytes in receive buffers in use and of those the ones only kept because they are still referenced, number of buffers allocated and reused
+    @component receive_buffers */
+void ddsi_rbufpool_stats (struct ddsi_rbufpool *rbp, uint64_t *live_bytes, uint64_t *pinned_bytes, uint64_t *allocs, uint64_t *reuses);
+
 /** @component receive_buffers */
 struct ddsi_rmsg *ddsi_rmsg_new (struct ddsi_rbufpool *rbufpool);
 
@@ -157,7 +165,7 @@ void ddsi_fragchain_unref (struct ddsi_rdata *frag);
 
 
 /** @component receive_buffers */
-struct ddsi_defrag *ddsi_defrag_new (const struct ddsrt_log_cfg *logcfg, enum ddsi_defrag_drop_mode drop_mode, uint32_t max_samples);
+struct ddsi_defrag *ddsi_defrag_new (const struct ddsrt_log_cfg *logcfg, enum ddsi_defrag_drop_mode drop_mode, uint32_t max_samples, uint32_t direct_max_size);
 
 /** @component receive_buffers */
 void ddsi_defrag_free (struct ddsi_defrag *defrag);
@@ -248,6 +256,10 @@ void ddsi_dqueue_wait_until_empty_if_full (struct ddsi_dqueue *q);
     @component receive_buffers */
 bool ddsi_dqueue_step_deaf (struct ddsi_dqueue *q);
 
+/** @brief current and maximum observed number of samples in the queue, and the number of times the delivery thread had to be woken up
+    @component receive_buffers */
+void ddsi_dqueue_stats (struct ddsi_dqueue *q, uint32_t *nof_samples, uint32_t *max_nof_samples, uint64_t *wakeups);
+
 
 /** @component receive_buffers */
 void ddsi_defrag_stats (struct ddsi_defrag *defrag, uint64_t *discarded_bytes);
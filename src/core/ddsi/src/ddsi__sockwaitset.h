@@ -12,6 +12,7 @@
 #define DDSI__SOCKWAITSET_H
 
 #include "dds/ddsi/ddsi_sockwaitset.h"
+#include "dds/ddsi/ddsi_config.h"
 
 #if defined (__cplusplus)
 extern "C" {
@@ -28,9 +29,13 @@ struct ddsi_tran_conn;
  * may process events from the wait set using the Wait and NextEvent functions
  * in a single handling loop.
  *
- * @return struct ddsi_sock_waitset*
+ * The mode selects the underlying mechanism, DDSI_SOCK_WAITSET_DEFAULT is
+ * always available, other modes only on some platforms.
+ *
+ * @param mode  Mechanism to use for waiting
+ * @return struct ddsi_sock_waitset*, NULL on failure or if mode is unsupported
  */
-struct ddsi_sock_waitset * ddsi_sock_waitset_new (void);
+struct ddsi_sock_waitset * ddsi_sock_waitset_new (enum ddsi_sock_waitset_mode mode);
 
 /**
  * @brief Frees the waitset
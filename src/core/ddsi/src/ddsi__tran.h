@@ -115,6 +115,25 @@ struct ddsi_network_packet_info {
  * @retval other error codes possible as well (from ddsrt) */
 typedef dds_return_t (*ddsi_tran_read_fn_t) (struct ddsi_tran_conn *conn, unsigned char *buf, size_t sz, bool allow_spurious, struct ddsi_network_packet_info *pktinfo, size_t *bytes_read) ddsrt_nonnull((1, 2, 6)) ddsrt_attribute_warn_unused_result;
 
+/** @brief Maximum number of packets read in one call to a @ref ddsi_tran_read_multiple_fn_t */
+#define DDSI_TRAN_READ_MULTIPLE_MAX 32
+
+/** @brief Read multiple packets from a connectionless connection in one operation
+ * @param[in,out] conn connection to read data from
+ * @param[in] n number of buffers, in [1,DDSI_TRAN_READ_MULTIPLE_MAX]
+ * @param[out] bufs array of n buffers, each of at least sz bytes
+ * @param[in] sz size of each buffer pointed to by bufs[i]
+ * @param[in] allow_spurious if true, return TRY_AGAIN if no packets available
+ * @param[out] pktinfo array of n source & destination IP address information structures
+ * @param[out] bytes_read array of n sizes, entry i is the number of bytes read into bufs[i] if i < npackets
+ * @param[out] npackets number of packets read, in [1,n] on successful completion, 0 in all other cases
+ * @return return code indicating success or failure
+ * @retval `DDS_RETCODE_OK` at least one packet read
+ * @retval `DDS_RETCODE_TRY_AGAIN` no packets available (only if `allow_spurious`)
+ * @retval `DDS_RETCODE_ERROR` unspecified error
+ * @retval other error codes possible as well (from ddsrt) */
+typedef dds_return_t (*ddsi_tran_read_multiple_fn_t) (struct ddsi_tran_conn *conn, size_t n, unsigned char * const *bufs, size_t sz, bool allow_spurious, struct ddsi_network_packet_info *pktinfo, size_t *bytes_read, size_t *npackets) ddsrt_nonnull((1, 3, 6, 7, 8)) ddsrt_attribute_warn_unused_result;
+
 /** @brief Write a message to a destination address
  * @param[in,out] conn  connection to write data to
  * @param[in] dst destination address
@@ -128,6 +147,22 @@ typedef dds_return_t (*ddsi_tran_read_fn_t) (struct ddsi_tran_conn *conn, unsign
  * @retval other error codes possible as well (from ddsrt) */
 typedef dds_return_t (*ddsi_tran_write_fn_t) (struct ddsi_tran_conn *conn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags, size_t *bytes_written) ddsrt_nonnull((1, 2, 3));
 
+/** @brief Maximum number of destinations in one call to a @ref ddsi_tran_write_multiple_fn_t */
+#define DDSI_TRAN_WRITE_MULTIPLE_MAX 32
+
+/** @brief Write a message to multiple destination addresses in as few operations as possible
+ * @param[in,out] conn  connection to write data to
+ * @param[in] n number of destination addresses, in [1,DDSI_TRAN_WRITE_MULTIPLE_MAX]
+ * @param[in] dsts array of n destination addresses
+ * @param[in] msgfrags message contents
+ * @param[in] flags write flags
+ * @param[out] nsyscalls number of system calls used
+ * @return return code indicating success or failure
+ * @retval `DDS_RETCODE_OK` message written to all destinations
+ * @retval `DDS_RETCODE_ERROR` unspecified error
+ * @retval other error codes possible as well (from ddsrt), the last error encountered is returned */
+typedef dds_return_t (*ddsi_tran_write_multiple_fn_t) (struct ddsi_tran_conn *conn, size_t n, const ddsi_locator_t *dsts, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags, size_t *nsyscalls) ddsrt_nonnull((1, 3, 4, 6));
+
 typedef int (*ddsi_tran_locator_fn_t) (struct ddsi_tran_factory *, struct ddsi_tran_base *, ddsi_locator_t *);
 typedef bool (*ddsi_tran_supports_fn_t) (const struct ddsi_tran_factory *, int32_t);
 typedef ddsrt_socket_t (*ddsi_tran_handle_fn_t) (struct ddsi_tran_base *);
@@ -200,7 +235,9 @@ struct ddsi_tran_conn
   /* Functions */
 
   ddsi_tran_read_fn_t m_read_fn;
+  ddsi_tran_read_multiple_fn_t m_read_multiple_fn; // optional, NULL if not supported
   ddsi_tran_write_fn_t m_write_fn;
+  ddsi_tran_write_multiple_fn_t m_write_multiple_fn; // optional, NULL if not supported
   ddsi_tran_peer_locator_fn_t m_peer_locator_fn;
   ddsi_tran_disable_multiplexing_fn_t m_disable_multiplexing_fn;
   ddsi_tran_locator_fn_t m_locator_fn;
@@ -305,6 +342,7 @@ struct ddsi_tran_qos
   enum ddsi_tran_qos_purpose m_purpose;
   int m_diffserv;
   struct ddsi_network_interface *m_interface; // only for purpose = XMIT
+  bool m_reuse_port; // only for purpose = RECV_UC: allow other sockets to bind to the same port and share the incoming traffic
 };
 
 /** @component transport */
@@ -428,6 +466,29 @@ inline dds_return_t ddsi_conn_write (struct ddsi_tran_conn * conn, const ddsi_lo
   return conn->m_closed ? DDS_RETCODE_ALREADY_DELETED : (conn->m_write_fn) (conn, dst, msgfrags, flags, bytes_written);
 }
 
+/** @brief Whether the connection supports writing a message to multiple destinations in one operation
+ * @component transport
+ * @param[in] conn connection
+ * @return true iff @ref ddsi_conn_write_multiple may be used on `conn` */
+inline bool ddsi_conn_supports_write_multiple (const struct ddsi_tran_conn *conn) {
+  return conn->m_write_multiple_fn != 0;
+}
+
+/** @brief Write a message to multiple destinations in as few operations as possible
+ * @component transport
+ *
+ * See @ref ddsi_tran_write_multiple_fn_t, may only be used if @ref ddsi_conn_supports_write_multiple
+ * returns true. */
+ddsrt_nonnull ((1, 3, 4, 6))
+inline dds_return_t ddsi_conn_write_multiple (struct ddsi_tran_conn * conn, size_t n, const ddsi_locator_t *dsts, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags, size_t *nsyscalls) {
+  if (conn->m_closed)
+  {
+    *nsyscalls = 0;
+    return DDS_RETCODE_ALREADY_DELETED;
+  }
+  return conn->m_write_multiple_fn (conn, n, dsts, msgfrags, flags, nsyscalls);
+}
+
 /** @brief Read bytes from an connection that may have SSL enabled
  * @component transport
  * @param[in,out] conn connection to read data from
@@ -446,6 +507,29 @@ inline dds_return_t ddsi_conn_read (struct ddsi_tran_conn * conn, unsigned char
   return conn->m_closed ? DDS_RETCODE_ALREADY_DELETED : conn->m_read_fn (conn, buf, sz, allow_spurious, pktinfo, bytes_read);
 }
 
+/** @brief Whether the connection supports reading multiple packets in one operation
+ * @component transport
+ * @param[in] conn connection
+ * @return true iff @ref ddsi_conn_read_multiple may be used on `conn` */
+inline bool ddsi_conn_supports_read_multiple (const struct ddsi_tran_conn *conn) {
+  return conn->m_read_multiple_fn != 0;
+}
+
+/** @brief Read multiple packets from a connectionless connection in one operation
+ * @component transport
+ *
+ * See @ref ddsi_tran_read_multiple_fn_t, may only be used if @ref ddsi_conn_supports_read_multiple
+ * returns true. */
+ddsrt_nonnull ((1, 3, 6, 7, 8)) ddsrt_attribute_warn_unused_result
+inline dds_return_t ddsi_conn_read_multiple (struct ddsi_tran_conn * conn, size_t n, unsigned char * const *bufs, size_t sz, bool allow_spurious, struct ddsi_network_packet_info *pktinfo, size_t *bytes_read, size_t *npackets) {
+  if (conn->m_closed)
+  {
+    *npackets = 0;
+    return DDS_RETCODE_ALREADY_DELETED;
+  }
+  return conn->m_read_multiple_fn (conn, n, bufs, sz, allow_spurious, pktinfo, bytes_read, npackets);
+}
+
 /** @component transport */
 bool ddsi_conn_peer_locator (struct ddsi_tran_conn * conn, ddsi_locator_t * loc);
 
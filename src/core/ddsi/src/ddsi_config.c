@@ -164,6 +164,11 @@ DUPF(uint32);
 #endif
 DU(natint);
 DU(natint_255);
+DU(batch_size);
+DU(recv_shards);
+DU(rhc_shards);
+DU(async_write_threads);
+DU(async_write_queue_depth);
 DU(pos_uint);
 DUPF(participantIndex);
 #ifdef DDS_HAS_TCP
@@ -192,6 +197,7 @@ DUPF(maybe_int32);
 DUPF(domainId);
 DUPF(transport_selector);
 DUPF(many_sockets_mode);
+DUPF(sock_waitset_mode);
 DU(deaf_mute);
 #ifdef DDS_HAS_TCP_TLS
 DUPF(min_tls_version);
@@ -1017,6 +1023,10 @@ static const enum ddsi_many_sockets_mode en_many_sockets_mode_ms[] = {
   DDSI_MSM_SINGLE_UNICAST, DDSI_MSM_NO_UNICAST, DDSI_MSM_MANY_UNICAST, DDSI_MSM_SINGLE_UNICAST, DDSI_MSM_MANY_UNICAST, 0 };
 GENERIC_ENUM_CTYPE (many_sockets_mode, enum ddsi_many_sockets_mode)
 
+static const char *en_sock_waitset_mode_vs[] = { "default", "io_uring", NULL };
+static const enum ddsi_sock_waitset_mode en_sock_waitset_mode_ms[] = { DDSI_SOCK_WAITSET_DEFAULT, DDSI_SOCK_WAITSET_IO_URING, 0 };
+GENERIC_ENUM_CTYPE (sock_waitset_mode, enum ddsi_sock_waitset_mode)
+
 static const char *en_standards_conformance_vs[] = { "pedantic", "strict", "lax", NULL };
 static const enum ddsi_standards_conformance en_standards_conformance_ms[] = { DDSI_SC_PEDANTIC, DDSI_SC_STRICT, DDSI_SC_LAX, 0 };
 GENERIC_ENUM_CTYPE (standards_conformance, enum ddsi_standards_conformance)
@@ -1519,6 +1529,31 @@ static enum update_result uf_natint_255(struct ddsi_cfgst *cfgst, void *parent,
   return uf_int_min_max(cfgst, parent, cfgelem, first, value, 0, 255);
 }
 
+static enum update_result uf_batch_size(struct ddsi_cfgst *cfgst, void *parent, struct cfgelem const * const cfgelem, int first, const char *value)
+{
+  return uf_int_min_max(cfgst, parent, cfgelem, first, value, 1, 32);
+}
+
+static enum update_result uf_recv_shards(struct ddsi_cfgst *cfgst, void *parent, struct cfgelem const * const cfgelem, int first, const char *value)
+{
+  return uf_int_min_max(cfgst, parent, cfgelem, first, value, 1, 8);
+}
+
+static enum update_result uf_rhc_shards(struct ddsi_cfgst *cfgst, void *parent, struct cfgelem const * const cfgelem, int first, const char *value)
+{
+  return uf_int_min_max(cfgst, parent, cfgelem, first, value, 1, 64);
+}
+
+static enum update_result uf_async_write_threads(struct ddsi_cfgst *cfgst, void *parent, struct cfgelem const * const cfgelem, int first, const char *value)
+{
+  return uf_int_min_max(cfgst, parent, cfgelem, first, value, 1, 8);
+}
+
+static enum update_result uf_async_write_queue_depth(struct ddsi_cfgst *cfgst, void *parent, struct cfgelem const * const cfgelem, int first, const char *value)
+{
+  return uf_int_min_max(cfgst, parent, cfgelem, first, value, 1, 65536);
+}
+
 static enum update_result uf_uint (struct ddsi_cfgst *cfgst, void *parent, struct cfgelem const * const cfgelem, UNUSED_ARG (int first), const char *value)
 {
   uint32_t * const elem = cfg_address (cfgst, parent, cfgelem);
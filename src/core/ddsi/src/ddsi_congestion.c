@@ -0,0 +1,138 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+
+#include "dds/ddsrt/avl.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "dds/ddsi/ddsi_proxy_endpoint.h"
+#include "ddsi__sysdeps.h"
+#include "ddsi__endpoint.h"
+#include "ddsi__endpoint_match.h"
+#include "ddsi__congestion.h"
+
+static uint32_t min_cwnd (const struct ddsi_domaingv *gv)
+{
+  return 2 * gv->config.max_msg_size;
+}
+
+static uint32_t max_cwnd (const struct ddsi_domaingv *gv)
+{
+  /* the WHC high-water mark may be configured (absurdly) low, but the window must never be 0 */
+  const uint32_t mincw = min_cwnd (gv);
+  return (gv->config.whc_highwater_mark > mincw) ? gv->config.whc_highwater_mark : mincw;
+}
+
+void ddsi_congestion_init (struct ddsi_congestion *cc, const struct ddsi_domaingv *gv)
+{
+  const uint32_t mincw = min_cwnd (gv), maxcw = max_cwnd (gv);
+  const uint32_t cw = gv->config.whc_init_highwater_mark.value;
+  cc->cwnd = (cw < mincw) ? mincw : (cw > maxcw) ? maxcw : cw;
+  cc->ssthresh = maxcw;
+  cc->rate = 0;
+  cc->t_pace.v = 0;
+  cc->t_last_loss.v = 0;
+  cc->loss_events = 0;
+}
+
+bool ddsi_congestion_enabled (const struct ddsi_writer *wr)
+{
+  return wr->e.gv->config.congestion_control && wr->reliable && wr->whc_low != INT32_MAX;
+}
+
+static int64_t writer_srtt (const struct ddsi_writer *wr)
+{
+  const struct ddsi_wr_prd_match *root = ddsrt_avl_root (&ddsi_wr_readers_treedef, &wr->readers);
+  return (root == NULL) ? 0 : root->max_srtt;
+}
+
+static void update_rate (struct ddsi_writer *wr)
+{
+  /* Pace at twice window/RTT in slow start and 5/4 window/RTT otherwise: slightly
+     faster than the window would allow, so that pacing spreads the transmissions
+     without becoming the bottleneck (cf. the gains used by Linux TCP pacing) */
+  struct ddsi_congestion * const cc = &wr->cc;
+  const int64_t srtt = writer_srtt (wr);
+  if (srtt <= 0)
+    cc->rate = 0;
+  else
+  {
+    const uint64_t w = (cc->cwnd < cc->ssthresh) ? 2 * (uint64_t) cc->cwnd : (uint64_t) cc->cwnd + cc->cwnd / 4;
+    cc->rate = (uint64_t) ((double) w * 1e9 / (double) srtt);
+  }
+}
+
+void ddsi_congestion_note_ack (struct ddsi_writer *wr, size_t acked)
+{
+  struct ddsi_domaingv const * const gv = wr->e.gv;
+  struct ddsi_congestion * const cc = &wr->cc;
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  if (acked == 0)
+    return;
+  uint64_t inc;
+  if (cc->cwnd < cc->ssthresh)
+    inc = acked;
+  else
+  {
+    inc = (uint64_t) gv->config.max_msg_size * acked / cc->cwnd;
+    if (inc == 0)
+      inc = 1;
+  }
+  const uint64_t w = cc->cwnd + inc;
+  const uint32_t maxcw = max_cwnd (gv);
+  cc->cwnd = (w > maxcw) ? maxcw : (uint32_t) w;
+  update_rate (wr);
+}
+
+void ddsi_congestion_note_loss (struct ddsi_writer *wr, ddsrt_mtime_t tnow)
+{
+  struct ddsi_domaingv const * const gv = wr->e.gv;
+  struct ddsi_congestion * const cc = &wr->cc;
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  /* Multiple readers requesting the same data and a reader repeating its request
+     before the retransmit arrived all stem from a single loss event: react at most
+     once per round-trip time */
+  int64_t srtt = writer_srtt (wr);
+  if (srtt <= 0)
+    srtt = gv->config.const_hb_intv_sched;
+  if (cc->t_last_loss.v != 0 && tnow.v < cc->t_last_loss.v + srtt)
+    return;
+  const uint32_t mincw = min_cwnd (gv);
+  cc->ssthresh = (cc->cwnd / 2 > mincw) ? cc->cwnd / 2 : mincw;
+  cc->cwnd = cc->ssthresh;
+  cc->t_last_loss = tnow;
+  cc->loss_events++;
+  update_rate (wr);
+  ETRACE (wr, "congestion: wr "PGUIDFMT" loss, cwnd %"PRIu32" rate %"PRIu64"\n", PGUID (wr->e.guid), cc->cwnd, cc->rate);
+}
+
+int64_t ddsi_congestion_pacing_delay (struct ddsi_writer *wr, ddsrt_mtime_t tnow)
+{
+  struct ddsi_congestion * const cc = &wr->cc;
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  /* the round-trip time estimate changes independently of the window */
+  update_rate (wr);
+  if (cc->rate == 0 || cc->t_pace.v <= tnow.v)
+    return 0;
+  return cc->t_pace.v - tnow.v;
+}
+
+void ddsi_congestion_note_sent (struct ddsi_writer *wr, uint32_t size, ddsrt_mtime_t tnow)
+{
+  struct ddsi_congestion * const cc = &wr->cc;
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  if (cc->rate == 0)
+    return;
+  /* no credit for idle time: bursts after a pause are limited by the window */
+  if (cc->t_pace.v < tnow.v)
+    cc->t_pace = tnow;
+  cc->t_pace.v += (int64_t) ((double) size * 1e9 / (double) cc->rate);
+}
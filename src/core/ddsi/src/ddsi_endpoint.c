@@ -46,6 +46,8 @@
 #include "ddsi__xqos.h"
 #include "ddsi__hbcontrol.h"
 #include "ddsi__lease.h"
+#include "ddsi__lat_estim.h"
+#include "ddsi__congestion.h"
 #include "dds/dds.h"
 #include "dds__types.h"
 
@@ -557,6 +559,26 @@ static void augment_wr_prd_match (void *vnode, const void *vleft, const void *vr
   n->max_seq = max_seq;
   n->all_have_replied_to_hb = have_replied ? 1 : 0;
 
+  /* 1b. Compute worst-case round-trip time estimates, these are used to
+     pace heartbeats to the slowest reader */
+  int64_t max_srtt = n->rtt.srtt, max_rto = ddsi_rtt_estim_rto (&n->rtt);
+  if (left)
+  {
+    if (left->max_srtt > max_srtt)
+      max_srtt = left->max_srtt;
+    if (left->max_rto > max_rto)
+      max_rto = left->max_rto;
+  }
+  if (right)
+  {
+    if (right->max_srtt > max_srtt)
+      max_srtt = right->max_srtt;
+    if (right->max_rto > max_rto)
+      max_rto = right->max_rto;
+  }
+  n->max_srtt = max_srtt;
+  n->max_rto = max_rto;
+
   /* 2. Compute num_reliable_readers_where_seq_equals_max */
   if (max_seq == 0)
   {
@@ -682,7 +704,16 @@ unsigned ddsi_remove_acked_messages (struct ddsi_writer *wr, struct ddsi_whc_sta
   unsigned n;
   assert (wr->e.guid.entityid.u != DDSI_ENTITYID_SPDP_BUILTIN_PARTICIPANT_WRITER);
   ASSERT_MUTEX_HELD (&wr->e.lock);
-  n = ddsi_whc_remove_acked_messages (wr->whc, ddsi_writer_max_drop_seq (wr), whcst, deferred_free_list);
+  if (!ddsi_congestion_enabled (wr))
+    n = ddsi_whc_remove_acked_messages (wr->whc, ddsi_writer_max_drop_seq (wr), whcst, deferred_free_list);
+  else
+  {
+    struct ddsi_whc_state whcst_before;
+    ddsi_whc_get_state (wr->whc, &whcst_before);
+    n = ddsi_whc_remove_acked_messages (wr->whc, ddsi_writer_max_drop_seq (wr), whcst, deferred_free_list);
+    if (whcst_before.unacked_bytes > whcst->unacked_bytes)
+      ddsi_congestion_note_ack (wr, whcst_before.unacked_bytes - whcst->unacked_bytes);
+  }
   /* trigger anyone waiting in throttle_writer() or wait_for_acks() */
   ddsrt_cond_mtime_broadcast (&wr->throttle_cond);
   if (wr->retransmitting && whcst->unacked_bytes == 0)
@@ -791,6 +822,7 @@ static void ddsi_new_writer_guid_common_init (struct ddsi_writer *wr, const char
   wr->state = WRST_OPERATIONAL;
   wr->hbfragcount = 1;
   ddsi_writer_hbcontrol_init (&wr->hbcontrol);
+  ddsi_congestion_init (&wr->cc, gv);
   wr->throttling = 0;
   wr->retransmitting = 0;
   wr->t_rexmit_end.v = 0;
@@ -787,10 +787,12 @@ void ddsi_writer_add_connection (struct ddsi_writer *wr, struct ddsi_proxy_reade
   m->prev_nackfrag = 0;
   ddsi_lat_estim_init (&m->hb_to_ack_latency);
   m->hb_to_ack_latency_tlastlog = ddsrt_time_wallclock ();
+  ddsi_rtt_estim_init (&m->rtt);
   m->t_acknack_accepted.v = 0;
   m->t_nackfrag_accepted.v = 0;
 
   ddsrt_mutex_lock (&wr->e.lock);
+  m->rtt_ackhbs = wr->hbcontrol.ackhbs;
   if (pretend_everything_acked)
     m->seq = DDSI_MAX_SEQ_NUMBER;
   else
@@ -1402,6 +1404,15 @@ void ddsi_proxy_reader_drop_connection (const struct ddsi_guid *prd_guid, struct
   }
 }
 
+static void local_reader_ary_update_single_type (struct ddsi_local_reader_ary *x)
+{
+  /* readers are grouped by type, so comparing the first and the last one suffices */
+  const struct ddsi_sertype *type = NULL;
+  if (x->fastpath_ok && x->n_readers > 0 && x->rdary[0]->type == x->rdary[x->n_readers - 1]->type)
+    type = x->rdary[0]->type;
+  ddsrt_atomic_stvoidp (&x->single_type, (void *) type);
+}
+
 void ddsi_local_reader_ary_init (struct ddsi_local_reader_ary *x)
 {
   ddsrt_mutex_init (&x->rdary_lock);
@@ -1410,6 +1421,7 @@ void ddsi_local_reader_ary_init (struct ddsi_local_reader_ary *x)
   x->n_readers = 0;
   x->rdary = ddsrt_malloc (sizeof (*x->rdary));
   x->rdary[0] = NULL;
+  ddsrt_atomic_stvoidp (&x->single_type, NULL);
 }
 
 void ddsi_local_reader_ary_fini (struct ddsi_local_reader_ary *x)
@@ -1452,6 +1464,7 @@ void ddsi_local_reader_ary_insert (struct ddsi_local_reader_ary *x, struct ddsi_
   }
   x->rdary[x->n_readers + 1] = NULL;
   x->n_readers++;
+  local_reader_ary_update_single_type (x);
   ddsrt_mutex_unlock (&x->rdary_lock);
 }
 
@@ -1480,6 +1493,7 @@ void ddsi_local_reader_ary_remove (struct ddsi_local_reader_ary *x, struct ddsi_
   x->n_readers--;
   x->rdary[x->n_readers] = NULL;
   x->rdary = ddsrt_realloc (x->rdary, (x->n_readers + 1) * sizeof (*x->rdary));
+  local_reader_ary_update_single_type (x);
   ddsrt_mutex_unlock (&x->rdary_lock);
 }
 
@@ -1487,7 +1501,10 @@ void ddsi_local_reader_ary_setfastpath_ok (struct ddsi_local_reader_ary *x, bool
 {
   ddsrt_mutex_lock (&x->rdary_lock);
   if (x->valid)
+  {
     x->fastpath_ok = fastpath_ok;
+    local_reader_ary_update_single_type (x);
+  }
   ddsrt_mutex_unlock (&x->rdary_lock);
 }
 
@@ -1496,6 +1513,7 @@ void ddsi_local_reader_ary_setinvalid (struct ddsi_local_reader_ary *x)
   ddsrt_mutex_lock (&x->rdary_lock);
   x->valid = 0;
   x->fastpath_ok = 0;
+  local_reader_ary_update_single_type (x);
   ddsrt_mutex_unlock (&x->rdary_lock);
 }
 
@@ -1914,6 +1932,42 @@ bool ddsi_writer_find_matched_reader (struct ddsi_writer *wr, uint64_t ih, const
   return found;
 }
 
+dds_return_t ddsi_writer_get_matched_reader_rtt (struct ddsi_writer *wr, uint64_t ih, int64_t *srtt, int64_t *rttvar)
+{
+  struct ddsi_domaingv *gv = wr->e.gv;
+  dds_return_t ret = DDS_RETCODE_BAD_PARAMETER;
+  ddsrt_avl_iter_t it;
+  assert (ddsi_thread_is_awake ());
+  ddsrt_mutex_lock (&wr->e.lock);
+  for (const struct ddsi_wr_prd_match *m = ddsrt_avl_iter_first (&ddsi_wr_readers_treedef, &wr->readers, &it);
+        m != NULL && ret == DDS_RETCODE_BAD_PARAMETER;
+        m = ddsrt_avl_iter_next (&it))
+  {
+    struct ddsi_proxy_reader *prd;
+    if ((prd = ddsi_entidx_lookup_proxy_reader_guid (gv->entity_index, &m->prd_guid)) != NULL && prd->e.iid == ih)
+    {
+      if (m->rtt.nsamples == 0)
+        ret = DDS_RETCODE_NO_DATA;
+      else
+      {
+        *srtt = m->rtt.srtt;
+        *rttvar = m->rtt.rttvar;
+        ret = DDS_RETCODE_OK;
+      }
+    }
+  }
+  for (const struct ddsi_wr_rd_match *m = ddsrt_avl_iter_first (&ddsi_wr_local_readers_treedef, &wr->local_readers, &it);
+        m != NULL && ret == DDS_RETCODE_BAD_PARAMETER;
+        m = ddsrt_avl_iter_next (&it))
+  {
+    struct ddsi_reader *rd;
+    if ((rd = ddsi_entidx_lookup_reader_guid (gv->entity_index, &m->rd_guid)) != NULL && rd->e.iid == ih)
+      ret = DDS_RETCODE_NO_DATA;
+  }
+  ddsrt_mutex_unlock (&wr->e.lock);
+  return ret;
+}
+
 bool ddsi_reader_find_matched_writer (struct ddsi_reader *rd, uint64_t ih, const struct ddsi_entity_common **wrc, const struct dds_qos **wrqos, const struct ddsi_entity_common **ppc)
 {
   /* FIXME: this ought not be so inefficient */
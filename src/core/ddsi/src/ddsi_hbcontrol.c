@@ -33,6 +33,32 @@ static const struct ddsi_wr_prd_match *root_rdmatch (const struct ddsi_writer *w
   return ddsrt_avl_root (&ddsi_wr_readers_treedef, &wr->readers);
 }
 
+static bool writer_rtt_estimate (const struct ddsi_writer *wr, int64_t *srtt, int64_t *rto)
+{
+  /* Worst-case estimate over all proxy readers, false if adaptive pacing is disabled
+     or none of the readers has responded to a heartbeat yet */
+  const struct ddsi_wr_prd_match *root;
+  if (!wr->e.gv->config.adaptive_heartbeat || (root = root_rdmatch (wr)) == NULL || root->max_rto == 0)
+    return false;
+  *srtt = root->max_srtt;
+  *rto = root->max_rto;
+  return true;
+}
+
+static int64_t writer_hbcontrol_base_intv (const struct ddsi_writer *wr)
+{
+  struct ddsi_domaingv const * const gv = wr->e.gv;
+  int64_t srtt, rto;
+  if (!writer_rtt_estimate (wr, &srtt, &rto))
+    return gv->config.const_hb_intv_sched;
+  else if (rto < gv->config.const_hb_intv_sched_min)
+    return gv->config.const_hb_intv_sched_min;
+  else if (rto > gv->config.const_hb_intv_sched_max)
+    return gv->config.const_hb_intv_sched_max;
+  else
+    return rto;
+}
+
 void ddsi_writer_hbcontrol_init (struct ddsi_hbcontrol *hbc)
 {
   hbc->t_of_last_write.v = 0;
@@ -40,6 +66,7 @@ void ddsi_writer_hbcontrol_init (struct ddsi_hbcontrol *hbc)
   hbc->t_of_last_ackhb.v = 0;
   hbc->tsched = DDSRT_MTIME_NEVER;
   hbc->hbs_since_last_write = 0;
+  hbc->ackhbs = 0;
   hbc->last_packetid = 0;
 }
 
@@ -48,7 +75,10 @@ static void writer_hbcontrol_note_hb (struct ddsi_writer *wr, ddsrt_mtime_t tnow
   struct ddsi_hbcontrol * const hbc = &wr->hbcontrol;
 
   if (ansreq != DDSI_HBC_ACK_REQ_NO)
+  {
     hbc->t_of_last_ackhb = tnow;
+    hbc->ackhbs++;
+  }
   hbc->t_of_last_hb = tnow;
 
   /* Count number of heartbeats since last write, used to lower the
@@ -61,7 +91,7 @@ int64_t ddsi_writer_hbcontrol_intv (const struct ddsi_writer *wr, const struct d
 {
   struct ddsi_domaingv const * const gv = wr->e.gv;
   struct ddsi_hbcontrol const * const hbc = &wr->hbcontrol;
-  int64_t ret = gv->config.const_hb_intv_sched;
+  int64_t ret = writer_hbcontrol_base_intv (wr);
   size_t n_unacked;
 
   if (hbc->hbs_since_last_write > 5)
@@ -85,7 +115,6 @@ int64_t ddsi_writer_hbcontrol_intv (const struct ddsi_writer *wr, const struct d
 
 void ddsi_writer_hbcontrol_note_asyncwrite (struct ddsi_writer *wr, ddsrt_mtime_t tnow)
 {
-  struct ddsi_domaingv const * const gv = wr->e.gv;
   struct ddsi_hbcontrol * const hbc = &wr->hbcontrol;
   ddsrt_mtime_t tnext;
 
@@ -95,7 +124,7 @@ void ddsi_writer_hbcontrol_note_asyncwrite (struct ddsi_writer *wr, ddsrt_mtime_
 
   /* We know this is new data, so we want a heartbeat event after one
      base interval */
-  tnext.v = tnow.v + gv->config.const_hb_intv_sched;
+  tnext.v = tnow.v + writer_hbcontrol_base_intv (wr);
   if (tnext.v < hbc->tsched.v)
   {
     /* Insertion of a message with WHC locked => must now have at
@@ -213,9 +242,22 @@ static enum ddsi_hbcontrol_ack_required writer_hbcontrol_ack_required_generic (c
 {
   struct ddsi_domaingv const * const gv = wr->e.gv;
   struct ddsi_hbcontrol const * const hbc = &wr->hbcontrol;
-  const int64_t hb_intv_ack = gv->config.const_hb_intv_sched;
+  const int64_t hb_intv_ack = writer_hbcontrol_base_intv (wr);
+  int64_t intv_min = gv->config.const_hb_intv_min;
+  int64_t intv_sched_min = gv->config.const_hb_intv_sched_min;
+  int64_t srtt, rto;
   assert(wr->heartbeat_xevent != NULL && whcst != NULL);
 
+  if (writer_rtt_estimate (wr, &srtt, &rto))
+  {
+    /* Requesting acks more often than they can come back only results in
+       duplicate AckNacks (and, if anything is lost, duplicate retransmits) */
+    if (srtt > intv_min)
+      intv_min = srtt;
+    if (rto > intv_sched_min)
+      intv_sched_min = rto;
+  }
+
   if (piggyback)
   {
     /* If it is likely that a heartbeat requiring an ack will go out
@@ -236,9 +278,9 @@ static enum ddsi_hbcontrol_ack_required writer_hbcontrol_ack_required_generic (c
 
   if (whcst->unacked_bytes >= wr->whc_low + (wr->whc_high - wr->whc_low) / 2)
   {
-    if (tnow.v >= hbc->t_of_last_ackhb.v + gv->config.const_hb_intv_sched_min)
+    if (tnow.v >= hbc->t_of_last_ackhb.v + intv_sched_min)
       return DDSI_HBC_ACK_REQ_YES_AND_FLUSH;
-    else if (tnow.v >= hbc->t_of_last_ackhb.v + gv->config.const_hb_intv_min)
+    else if (tnow.v >= hbc->t_of_last_ackhb.v + intv_min)
       return DDSI_HBC_ACK_REQ_YES;
   }
 
@@ -257,8 +299,12 @@ struct ddsi_xmsg *ddsi_writer_hbcontrol_piggyback (struct ddsi_writer *wr, const
   uint32_t last_packetid;
   ddsrt_mtime_t tlast;
   ddsrt_mtime_t t_of_last_hb;
+  int64_t min_hb_gap = DDS_USECS (100), srtt, rto;
   struct ddsi_xmsg *msg;
 
+  if (writer_rtt_estimate (wr, &srtt, &rto) && srtt / 2 > min_hb_gap)
+    min_hb_gap = srtt / 2;
+
   tlast = hbc->t_of_last_write;
   last_packetid = hbc->last_packetid;
   t_of_last_hb = hbc->t_of_last_hb;
@@ -278,7 +324,7 @@ struct ddsi_xmsg *ddsi_writer_hbcontrol_piggyback (struct ddsi_writer *wr, const
     msg = ddsi_writer_hbcontrol_create_heartbeat (wr, whcst, tnow, *hbansreq, 1);
     if (wr->test_suppress_flush_on_sync_heartbeat)
       *hbansreq = DDSI_HBC_ACK_REQ_YES;
-  } else if (last_packetid != packetid && tnow.v - t_of_last_hb.v > DDS_USECS (100)) {
+  } else if (last_packetid != packetid && tnow.v - t_of_last_hb.v > min_hb_gap) {
     /* If we crossed a packet boundary since the previous write,
        piggyback a heartbeat, with *hbansreq determining whether or
        not an ACK is needed.  We don't force the packet out either:
@@ -289,7 +335,7 @@ struct ddsi_xmsg *ddsi_writer_hbcontrol_piggyback (struct ddsi_writer *wr, const
        an ACK yet, the FINAL flag will be cleared and so we get an ACK
        storm if writing at a high rate without batching which eats up
        a *large* amount of time because there are out-of-order readers
-       present. */
+       present.  With a known round-trip time, at most two per round trip. */
     msg = ddsi_writer_hbcontrol_create_heartbeat (wr, whcst, tnow, *hbansreq, 1);
   } else {
     *hbansreq = DDSI_HBC_ACK_REQ_NO;
@@ -82,6 +82,26 @@ enum make_uc_sockets_ret {
   MUSRET_ERROR          /* generic error, no use continuing */
 };
 
+static bool use_recv_shards (const struct ddsi_domaingv *gv);
+
+static void make_uc_data_shards (struct ddsi_domaingv *gv)
+{
+  const uint32_t port = ddsi_conn_port (gv->data_conn_uc);
+  const struct ddsi_tran_qos qos = { .m_purpose = DDSI_TRAN_QOS_RECV_UC, .m_diffserv = 0, .m_interface = NULL, .m_reuse_port = true };
+  assert (gv->n_data_conn_uc_shards == 0);
+  while (gv->n_data_conn_uc_shards + 1 < (uint32_t) gv->config.recv_shards)
+  {
+    dds_return_t rc;
+    if ((rc = ddsi_factory_create_conn (&gv->data_conn_uc_shards[gv->n_data_conn_uc_shards], gv->m_factory, port, &qos)) != DDS_RETCODE_OK)
+    {
+      GVWARNING ("failed to create additional socket for unicast data port %"PRIu32": %s, continuing with %"PRIu32"\n",
+                 port, dds_strretcode (rc), gv->n_data_conn_uc_shards + 1);
+      break;
+    }
+    gv->n_data_conn_uc_shards++;
+  }
+}
+
 static enum make_uc_sockets_ret make_uc_sockets (struct ddsi_domaingv *gv, uint32_t * pdisc, uint32_t * pdata, int ppid)
 {
   dds_return_t rc;
@@ -118,9 +138,21 @@ static enum make_uc_sockets_ret make_uc_sockets (struct ddsi_domaingv *gv, uint3
     gv->data_conn_uc = gv->disc_conn_uc;
   else
   {
-    rc = ddsi_factory_create_conn (&gv->data_conn_uc, gv->m_factory, *pdata, &qos);
+    // The data port is exclusive to this process because the discovery port
+    // is, so it can safely be shared with additional sockets
+    struct ddsi_tran_qos qos_data = qos;
+    qos_data.m_reuse_port = use_recv_shards (gv);
+    rc = ddsi_factory_create_conn (&gv->data_conn_uc, gv->m_factory, *pdata, &qos_data);
+    if (rc == DDS_RETCODE_UNSUPPORTED && qos_data.m_reuse_port)
+    {
+      GVLOG (DDS_LC_CONFIG, "make_uc_sockets: multiple sockets for the unicast data port not supported\n");
+      qos_data.m_reuse_port = false;
+      rc = ddsi_factory_create_conn (&gv->data_conn_uc, gv->m_factory, *pdata, &qos_data);
+    }
     if (rc != DDS_RETCODE_OK)
       goto fail_data;
+    if (qos_data.m_reuse_port)
+      make_uc_data_shards (gv);
   }
   ddsi_conn_locator (gv->disc_conn_uc, &gv->loc_meta_uc);
   ddsi_conn_locator (gv->data_conn_uc, &gv->loc_default_uc);
@@ -862,6 +894,26 @@ static bool use_multiple_receive_threads (const struct ddsi_config *cfg)
   return false;
 }
 
+static bool use_recv_shards (const struct ddsi_domaingv *gv)
+{
+  return (gv->config.recv_shards > 1 && gv->m_factory->m_connless &&
+          gv->config.many_sockets_mode == DDSI_MSM_SINGLE_UNICAST &&
+          use_multiple_receive_threads (&gv->config));
+}
+
+DDSRT_STATIC_ASSERT (MAX_RECV_SHARDS >= 8); // Internal/ReceiveShards allows up to 8
+
+static struct ddsi_sock_waitset *new_recv_thread_waitset (struct ddsi_domaingv *gv)
+{
+  struct ddsi_sock_waitset *ws;
+  if ((ws = ddsi_sock_waitset_new (gv->config.sock_waitset_mode)) == NULL && gv->config.sock_waitset_mode != DDSI_SOCK_WAITSET_DEFAULT)
+  {
+    GVWARNING ("SocketWaitsetMode: selected mechanism not available, using default\n");
+    ws = ddsi_sock_waitset_new (DDSI_SOCK_WAITSET_DEFAULT);
+  }
+  return ws;
+}
+
 static int setup_and_start_recv_threads (struct ddsi_domaingv *gv)
 {
   const bool multi_recv_thr = use_multiple_receive_threads (&gv->config);
@@ -874,6 +926,8 @@ static int setup_and_start_recv_threads (struct ddsi_domaingv *gv)
     gv->recv_threads[i].arg.gv = gv;
     gv->recv_threads[i].arg.u.single.loc = NULL;
     gv->recv_threads[i].arg.u.single.conn = NULL;
+    ddsrt_atomic_st64 (&gv->recv_threads[i].arg.stats.reads, 0);
+    ddsrt_atomic_st64 (&gv->recv_threads[i].arg.stats.packets, 0);
   }
 
   /* First thread always uses a waitset and gobbles up all sockets not handled by dedicated threads - FIXME: DDSI_MSM_NO_UNICAST mode with UDP probably doesn't even need this one to use a waitset */
@@ -896,7 +950,24 @@ static int setup_and_start_recv_threads (struct ddsi_domaingv *gv)
       ddsi_conn_disable_multiplexing (gv->data_conn_mc);
       gv->n_recv_threads++;
     }
-    if (gv->config.many_sockets_mode == DDSI_MSM_SINGLE_UNICAST)
+    if (gv->config.many_sockets_mode == DDSI_MSM_SINGLE_UNICAST && gv->n_data_conn_uc_shards > 0)
+    {
+      /* Multiple sockets bound to the data port => one thread for each.  Waking up these threads
+         by sending a packet to the port doesn't work because there is no way of controlling which
+         socket receives it, hence the waitset */
+      static const char *names[MAX_RECV_SHARDS] = {
+        "recvUC", "recvUC1", "recvUC2", "recvUC3", "recvUC4", "recvUC5", "recvUC6", "recvUC7"
+      };
+      for (uint32_t i = 0; i <= gv->n_data_conn_uc_shards; i++)
+      {
+        gv->recv_threads[gv->n_recv_threads].name = names[i];
+        gv->recv_threads[gv->n_recv_threads].arg.mode = DDSI_RTM_SHARD;
+        gv->recv_threads[gv->n_recv_threads].arg.u.shard.ws = NULL;
+        gv->recv_threads[gv->n_recv_threads].arg.u.shard.conn = (i == 0) ? gv->data_conn_uc : gv->data_conn_uc_shards[i - 1];
+        gv->n_recv_threads++;
+      }
+    }
+    else if (gv->config.many_sockets_mode == DDSI_MSM_SINGLE_UNICAST)
     {
       /* No per-participant sockets => handle data unicasts on a separate thread as well */
       gv->recv_threads[gv->n_recv_threads].name = "recvUC";
@@ -922,11 +993,24 @@ static int setup_and_start_recv_threads (struct ddsi_domaingv *gv)
     }
     if (gv->recv_threads[i].arg.mode == DDSI_RTM_MANY)
     {
-      if ((gv->recv_threads[i].arg.u.many.ws = ddsi_sock_waitset_new ()) == NULL)
+      if ((gv->recv_threads[i].arg.u.many.ws = new_recv_thread_waitset (gv)) == NULL)
+      {
+        GVERROR ("rtps_init: can't allocate sock waitset for thread %s\n", gv->recv_threads[i].name);
+        goto fail;
+      }
+    }
+    else if (gv->recv_threads[i].arg.mode == DDSI_RTM_SHARD)
+    {
+      if ((gv->recv_threads[i].arg.u.shard.ws = new_recv_thread_waitset (gv)) == NULL)
       {
         GVERROR ("rtps_init: can't allocate sock waitset for thread %s\n", gv->recv_threads[i].name);
         goto fail;
       }
+      if (ddsi_sock_waitset_add (gv->recv_threads[i].arg.u.shard.ws, gv->recv_threads[i].arg.u.shard.conn) < 0)
+      {
+        GVERROR ("rtps_init: can't add socket to sock waitset for thread %s\n", gv->recv_threads[i].name);
+        goto fail;
+      }
     }
     if (ddsi_create_thread (&gv->recv_threads[i].thrst, gv, gv->recv_threads[i].name, ddsi_recv_thread, &gv->recv_threads[i].arg) != DDS_RETCODE_OK)
     {
@@ -944,6 +1028,8 @@ fail:
   {
     if (gv->recv_threads[i].arg.mode == DDSI_RTM_MANY && gv->recv_threads[i].arg.u.many.ws)
       ddsi_sock_waitset_free (gv->recv_threads[i].arg.u.many.ws);
+    else if (gv->recv_threads[i].arg.mode == DDSI_RTM_SHARD && gv->recv_threads[i].arg.u.shard.ws)
+      ddsi_sock_waitset_free (gv->recv_threads[i].arg.u.shard.ws);
     if (gv->recv_threads[i].arg.rbpool)
       ddsi_rbufpool_free (gv->recv_threads[i].arg.rbpool);
   }
@@ -997,9 +1083,11 @@ static void free_conns (struct ddsi_domaingv *gv)
 {
   // Depending on settings, various "conn"s can alias others, this makes sure we free each one only once
   // FIXME: perhaps store them in a table instead?
-  struct ddsi_tran_conn * cs[4 + MAX_XMIT_CONNS] = { gv->disc_conn_mc, gv->data_conn_mc, gv->disc_conn_uc, gv->data_conn_uc };
+  struct ddsi_tran_conn * cs[4 + MAX_XMIT_CONNS + MAX_RECV_SHARDS - 1] = { gv->disc_conn_mc, gv->data_conn_mc, gv->disc_conn_uc, gv->data_conn_uc };
   for (size_t i = 0; i < MAX_XMIT_CONNS; i++)
     cs[4 + i] = gv->xmit_conns[i];
+  for (size_t i = 0; i < gv->n_data_conn_uc_shards; i++)
+    cs[4 + MAX_XMIT_CONNS + i] = gv->data_conn_uc_shards[i];
   for (size_t i = 0; i < sizeof (cs) / sizeof (cs[0]); i++)
   {
     if (cs[i] == NULL)
@@ -1120,6 +1208,7 @@ int ddsi_init (struct ddsi_domaingv *gv, struct ddsi_psmx_instance_locators *psm
 
   gv->disc_conn_uc = NULL;
   gv->data_conn_uc = NULL;
+  gv->n_data_conn_uc_shards = 0;
   gv->disc_conn_mc = NULL;
   gv->data_conn_mc = NULL;
   for (size_t i = 0; i < MAX_XMIT_CONNS; i++)
@@ -1139,6 +1228,10 @@ int ddsi_init (struct ddsi_domaingv *gv, struct ddsi_psmx_instance_locators *psm
     GVLOG (DDS_LC_CONFIG, "Version: %s %s %s \n", DDS_PROJECT_NAME, DDS_VERSION, DDS_GIT_HASH);
   }
 
+  ddsrt_atomic_st64 (&gv->xmit_stats.flushes, 0);
+  ddsrt_atomic_st64 (&gv->xmit_stats.packets, 0);
+  ddsrt_atomic_st64 (&gv->xmit_stats.syscalls, 0);
+
   /* Allow configuration to set "deaf_mute" in case we want to start out that way */
   gv->deaf = gv->config.initial_deaf;
   gv->mute = gv->config.initial_mute;
@@ -1402,7 +1495,7 @@ int ddsi_init (struct ddsi_domaingv *gv, struct ddsi_psmx_instance_locators *psm
   }
 
   ddsrt_mutex_init (&gv->spdp_lock);
-  gv->spdp_defrag = ddsi_defrag_new (&gv->logconfig, DDSI_DEFRAG_DROP_OLDEST, gv->config.defrag_unreliable_maxsamples);
+  gv->spdp_defrag = ddsi_defrag_new (&gv->logconfig, DDSI_DEFRAG_DROP_OLDEST, gv->config.defrag_unreliable_maxsamples, 0);
   gv->spdp_reorder = ddsi_reorder_new (&gv->logconfig, DDSI_REORDER_MODE_ALWAYS_DELIVER, gv->config.primary_reorder_maxsamples, false);
 
   gv->m_tkmap = ddsi_tkmap_new (gv);
@@ -1949,6 +2042,8 @@ void ddsi_fini (struct ddsi_domaingv *gv)
   {
     if (gv->recv_threads[i].arg.mode == DDSI_RTM_MANY)
       ddsi_sock_waitset_free (gv->recv_threads[i].arg.u.many.ws);
+    else if (gv->recv_threads[i].arg.mode == DDSI_RTM_SHARD)
+      ddsi_sock_waitset_free (gv->recv_threads[i].arg.u.shard.ws);
     ddsi_rbufpool_free (gv->recv_threads[i].arg.rbpool);
   }
 
@@ -76,8 +76,38 @@ int ddsi_lat_estim_log (uint32_t logcat, const struct ddsrt_log_cfg *logcfg, con
   }
 }
 
-#if 0 /* not implemented yet */
 double ddsi_lat_estim_current (const struct ddsi_lat_estim *le)
 {
+  /* in microseconds, 0 if no estimate yet */
+  return le->smoothed;
+}
+
+void ddsi_rtt_estim_init (struct ddsi_rtt_estim *re)
+{
+  re->srtt = 0;
+  re->rttvar = 0;
+  re->nsamples = 0;
+}
+
+void ddsi_rtt_estim_update (struct ddsi_rtt_estim *re, int64_t sample)
+{
+  if (sample <= 0)
+    return;
+  if (re->nsamples++ == 0)
+  {
+    re->srtt = sample;
+    re->rttvar = sample / 2;
+  }
+  else
+  {
+    /* alpha = 1/8, beta = 1/4 as in RFC 6298, rttvar must use the old srtt */
+    const int64_t dev = (sample > re->srtt) ? sample - re->srtt : re->srtt - sample;
+    re->rttvar = re->rttvar - re->rttvar / 4 + dev / 4;
+    re->srtt = re->srtt - re->srtt / 8 + sample / 8;
+  }
+}
+
+int64_t ddsi_rtt_estim_rto (const struct ddsi_rtt_estim *re)
+{
+  return (re->nsamples == 0) ? 0 : re->srtt + 4 * re->rttvar;
 }
-#endif
@@ -13,6 +13,7 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <string.h>
 
 #if HAVE_VALGRIND && ! defined (NDEBUG)
 #include <memcheck.h>
@@ -25,10 +26,13 @@
 #include "dds/ddsrt/threads.h"
 #include "dds/ddsrt/sync.h"
 #include "dds/ddsrt/string.h"
+#include "dds/ddsrt/time.h"
 #include "dds/ddsrt/avl.h"
 #include "dds/ddsi/ddsi_log.h"
 #include "dds/ddsi/ddsi_plist.h"
 #include "dds/ddsi/ddsi_unused.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_sertype.h"
 #include "dds/ddsi/ddsi_domaingv.h" /* for mattr, cattr */
 #include "ddsi__protocol.h"
 #include "ddsi__log.h"
@@ -267,19 +271,32 @@ struct ddsi_rbufpool {
      be releasing buffers to the pool as they become empty.
 
      Currently, we only have maintain a current rbuf, which gets
-     replaced when allocating a new one from it fails. Any rbufs that
-     are released are freed completely if different from the current
-     one.
-
-     Could trivially be done lockless, except that it requires
-     compare-and-swap, and we don't have that. But it hardly ever
-     happens anyway. */
+     replaced when allocating a new one from it fails. A retired rbuf
+     stays around for as long as any message in it is referenced (it
+     is then said to be "pinned"), and once it has been released
+     completely it is kept in a small cache of free rbufs so the
+     owning thread can reuse it without going through malloc/free
+     (or, more likely, mmap/munmap given the size of an rbuf). Only
+     if that cache is full, the rbuf is freed.
+
+     The lock protects the cache. It is only used when switching to a
+     new rbuf and when an rbuf has been released completely, so it
+     hardly ever gets used anyway. */
   ddsrt_mutex_t lock;
   struct ddsi_rbuf *current;
+  struct ddsi_rbuf *freelist;
+  uint32_t nfree;
   uint32_t rbuf_size;
   uint32_t max_rmsg_size;
   const struct ddsrt_log_cfg *logcfg;
   bool trace;
+
+  /* Statistics: number of rbufs in use (including the current one),
+     number of rbufs allocated from the heap and number of times an
+     rbuf was taken from the cache instead */
+  ddsrt_atomic_uint32_t nlive;
+  ddsrt_atomic_uint64_t nallocs;
+  ddsrt_atomic_uint64_t nreuses;
 #ifndef NDEBUG
   /* Thread that owns this pool, so we can check that no other thread
      is calling functions only the owner may use. */
@@ -287,8 +304,12 @@ struct ddsi_rbufpool {
 #endif
 };
 
+/* Maximum number of completely released rbufs kept for reuse */
+#define RBUFPOOL_MAX_FREE 2
+
 static struct ddsi_rbuf *ddsi_rbuf_alloc_new (struct ddsi_rbufpool *rbp);
 static void ddsi_rbuf_release (struct ddsi_rbuf *rbuf);
+static void ddsi_rbuf_free_cached (struct ddsi_rbufpool *rbp);
 
 #define TRACE_CFG(obj, logcfg, ...) ((obj)->trace ? (void) DDS_CLOG (DDS_LC_RADMIN, (logcfg), __VA_ARGS__) : (void) 0)
 #define TRACE(obj, ...)             TRACE_CFG ((obj), (obj)->logcfg, __VA_ARGS__)
@@ -355,6 +376,11 @@ struct ddsi_rbufpool *ddsi_rbufpool_new (const struct ddsrt_log_cfg *logcfg, uin
   rbp->max_rmsg_size = max_rmsg_size;
   rbp->logcfg = logcfg;
   rbp->trace = (logcfg->c.mask & DDS_LC_RADMIN) != 0;
+  rbp->freelist = NULL;
+  rbp->nfree = 0;
+  ddsrt_atomic_st32 (&rbp->nlive, 0);
+  ddsrt_atomic_st64 (&rbp->nallocs, 0);
+  ddsrt_atomic_st64 (&rbp->nreuses, 0);
 
 #if USE_VALGRIND
   VALGRIND_CREATE_MEMPOOL (rbp, 0, 0);
@@ -391,6 +417,7 @@ void ddsi_rbufpool_free (struct ddsi_rbufpool *rbp)
   ASSERT_RBUFPOOL_OWNER (rbp);
 #endif
   ddsi_rbuf_release (rbp->current);
+  ddsi_rbuf_free_cached (rbp);
 #if USE_VALGRIND
   VALGRIND_DESTROY_MEMPOOL (rbp);
 #endif
@@ -398,6 +425,17 @@ void ddsi_rbufpool_free (struct ddsi_rbufpool *rbp)
   ddsrt_free (rbp);
 }
 
+void ddsi_rbufpool_stats (struct ddsi_rbufpool *rbp, uint64_t *live_bytes, uint64_t *pinned_bytes, uint64_t *allocs, uint64_t *reuses)
+{
+  /* All rbufs other than the current one are kept alive only because
+     some message in it is still referenced */
+  const uint32_t nlive = ddsrt_atomic_ld32 (&rbp->nlive);
+  *live_bytes = (uint64_t) nlive * rbp->rbuf_size;
+  *pinned_bytes = (nlive > 0) ? (uint64_t) (nlive - 1) * rbp->rbuf_size : 0;
+  *allocs = ddsrt_atomic_ld64 (&rbp->nallocs);
+  *reuses = ddsrt_atomic_ld64 (&rbp->nreuses);
+}
+
 /* RBUF ---------------------------------------------------------------- */
 
 struct ddsi_rbuf {
@@ -405,6 +443,7 @@ struct ddsi_rbuf {
   uint32_t size;
   uint32_t max_rmsg_size;
   struct ddsi_rbufpool *rbufpool;
+  struct ddsi_rbuf *nextfree;
   bool trace;
 
   /* Allocating sequentially, releasing in random order, not bothering
@@ -429,13 +468,26 @@ static struct ddsi_rbuf *ddsi_rbuf_alloc_new (struct ddsi_rbufpool *rbp)
   struct ddsi_rbuf *rb;
   ASSERT_RBUFPOOL_OWNER (rbp);
 
-  if ((rb = ddsrt_malloc (sizeof (struct ddsi_rbuf) + rbp->rbuf_size)) == NULL)
+  ddsrt_mutex_lock (&rbp->lock);
+  if ((rb = rbp->freelist) != NULL)
+  {
+    rbp->freelist = rb->nextfree;
+    rbp->nfree--;
+  }
+  ddsrt_mutex_unlock (&rbp->lock);
+  if (rb != NULL)
+    ddsrt_atomic_inc64 (&rbp->nreuses);
+  else if ((rb = ddsrt_malloc (sizeof (struct ddsi_rbuf) + rbp->rbuf_size)) != NULL)
+    ddsrt_atomic_inc64 (&rbp->nallocs);
+  else
     return NULL;
+  ddsrt_atomic_inc32 (&rbp->nlive);
 #if USE_VALGRIND
   VALGRIND_MAKE_MEM_NOACCESS (rb->raw, rbp->rbuf_size);
 #endif
 
   rb->rbufpool = rbp;
+  rb->nextfree = NULL;
   ddsrt_atomic_st32 (&rb->n_live_rmsg_chunks, 1);
   rb->size = rbp->rbuf_size;
   rb->max_rmsg_size = rbp->max_rmsg_size;
@@ -452,10 +504,9 @@ static struct ddsi_rbuf *ddsi_rbuf_new (struct ddsi_rbufpool *rbp)
   ASSERT_RBUFPOOL_OWNER (rbp);
   if ((rb = ddsi_rbuf_alloc_new (rbp)) != NULL)
   {
-    ddsrt_mutex_lock (&rbp->lock);
-    ddsi_rbuf_release (rbp->current);
+    struct ddsi_rbuf * const old = rbp->current;
     rbp->current = rb;
-    ddsrt_mutex_unlock (&rbp->lock);
+    ddsi_rbuf_release (old);
   }
   return rb;
 }
@@ -466,9 +517,37 @@ static void ddsi_rbuf_release (struct ddsi_rbuf *rbuf)
   RBPTRACE ("rbuf_release(%p) pool %p current %p\n", (void *) rbuf, (void *) rbp, (void *) rbp->current);
   if (ddsrt_atomic_dec32_ov (&rbuf->n_live_rmsg_chunks) == 1)
   {
-    RBPTRACE ("rbuf_release(%p) free\n", (void *) rbuf);
-    ddsrt_free (rbuf);
+    bool cached = false;
+    ddsrt_atomic_dec32 (&rbp->nlive);
+    /* The current rbuf is only released when the pool is freed, and
+       then there is no point in caching it */
+    if (rbuf != rbp->current)
+    {
+      ddsrt_mutex_lock (&rbp->lock);
+      if (rbp->nfree < RBUFPOOL_MAX_FREE)
+      {
+        rbuf->nextfree = rbp->freelist;
+        rbp->freelist = rbuf;
+        rbp->nfree++;
+        cached = true;
+      }
+      ddsrt_mutex_unlock (&rbp->lock);
+    }
+    RBPTRACE ("rbuf_release(%p) %s\n", (void *) rbuf, cached ? "cache" : "free");
+    if (!cached)
+      ddsrt_free (rbuf);
+  }
+}
+
+static void ddsi_rbuf_free_cached (struct ddsi_rbufpool *rbp)
+{
+  while (rbp->freelist)
+  {
+    struct ddsi_rbuf *rb = rbp->freelist;
+    rbp->freelist = rb->nextfree;
+    ddsrt_free (rb);
   }
+  rbp->nfree = 0;
 }
 
 /* RMSG ---------------------------------------------------------------- */
@@ -488,6 +567,14 @@ static void ddsi_rbuf_release (struct ddsi_rbuf *rbuf)
 #define ASSERT_RMSG_UNCOMMITTED(rmsg) ((void) 0)
 #endif
 
+/* Serdata (and a reference to its type) whose lifetime is tied to
+   that of the rmsg in which this is allocated, see DEFRAG */
+struct ddsi_rmsg_serdata {
+  struct ddsi_rmsg_serdata *next;
+  struct ddsi_serdata *serdata;
+  struct ddsi_sertype *type;
+};
+
 static void *ddsi_rbuf_alloc (struct ddsi_rbufpool *rbp)
 {
   /* Note: only one thread calls ddsi_rmsg_new on a pool */
@@ -541,6 +628,7 @@ struct ddsi_rmsg *ddsi_rmsg_new (struct ddsi_rbufpool *rbp)
   init_rmsg_chunk (&rmsg->chunk, rbp->current);
   rmsg->trace = rbp->trace;
   rmsg->lastchunk = &rmsg->chunk;
+  rmsg->serdatas = NULL;
   /* Incrementing freeptr happens in commit(), so that discarding the
      message is really simple. */
   RBPTRACE ("rmsg_new(%p) = %p\n", (void *) rbp, (void *) rmsg);
@@ -575,6 +663,12 @@ void ddsi_rmsg_free (struct ddsi_rmsg *rmsg)
   struct ddsi_rmsg_chunk *c;
   RMSGTRACE ("rmsg_free(%p)\n", (void *) rmsg);
   assert (ddsrt_atomic_ld32 (&rmsg->refcount) == 0);
+  /* the list lives in the chunks, so it must be done before releasing them */
+  for (struct ddsi_rmsg_serdata *rs = rmsg->serdatas; rs; rs = rs->next)
+  {
+    ddsi_serdata_unref (rs->serdata);
+    ddsi_sertype_unref (rs->type);
+  }
   c = &rmsg->chunk;
   while (c)
   {
@@ -819,6 +913,32 @@ static void ddsi_rdata_unref (struct ddsi_rdata *rdata)
    fragmented message will have at least one interval allocated to it
    and thus have sufficient space for the chain node.
 
+   Large samples can also be defragmented directly into a serdata:
+   if the receiver sets "assembly_type" in the sample info of the
+   first fragment that arrives, the defragmenter allocates a serdata
+   of that type with room for the full sample and copies each
+   fragment into place as it arrives (any new bytes, that is).  On
+   completion it is finished (validation, key extraction) and
+   returned in "assembled" in the sample info, so that the delivery
+   path can simply take a reference to it instead of copying the
+   fragment chain.  The fragment chain is retained regardless, and
+   the serdata is owned by the rmsg in which the sample info was
+   allocated, which guarantees it is released whether the sample gets
+   delivered, dropped by the defragmenter or rejected by the reorder
+   admin.  The size is merely what the first fragment claims, so this
+   is limited to samples of at most "direct_max_size" bytes, and a
+   failure to allocate the serdata simply means the fragment chain is
+   used instead.
+
+   For samples consisting of at most DEFRAG_FRAGBITS_MAX_FRAGS
+   fragments, a bitmap of the fragments received in full is
+   maintained alongside the interval tree.  Retransmitted fragments
+   that add nothing new can be discarded using the bitmap alone, and
+   NACK_FRAG sets can be derived from it directly instead of by walking
+   the tree.  The bitmap is abandoned (and the interval tree used for
+   everything) if fragments with a different fragment size or sample
+   size show up.
+
    FIXME: These AVL trees are overkill.  Either switch to parent-less
    red-black trees (they have better performance anyway and only need
    a single bit of state) or to splay trees (must have a parent
@@ -841,6 +961,15 @@ struct ddsi_rsample {
       struct ddsi_defrag_iv *lastfrag;
       struct ddsi_rsample_info *sampleinfo;
       ddsi_seqno_t seq;
+      struct ddsi_serdata *assembly; /* serdata being filled or null */
+      unsigned char *assembly_buf;
+      uint32_t assembly_size;
+      uint32_t *fragbits; /* fragments received in full, or null */
+      uint32_t fragbits_fragsize;
+      uint32_t fragbits_size;
+      uint32_t fragbits_nfrags;
+      uint32_t fragbits_first_missing;
+      uint32_t fragbits_end; /* 1 + highest fragment received */
     } defrag;
     struct ddsi_rsample_reorder {
       ddsrt_avl_node_t avlnode;       /* for ddsi_reorder::sampleivtree, if head of a chain */
@@ -851,11 +980,14 @@ struct ddsi_rsample {
   } u;
 };
 
+#define DEFRAG_FRAGBITS_MAX_FRAGS 4096
+
 struct ddsi_defrag {
   ddsrt_avl_tree_t sampletree;
   struct ddsi_rsample *max_sample; /* = max(sampletree) */
   uint32_t n_samples;
   uint32_t max_samples;
+  uint32_t direct_max_size;
   enum ddsi_defrag_drop_mode drop_mode;
   uint64_t discarded_bytes;
   const struct ddsrt_log_cfg *logcfg;
@@ -882,7 +1014,7 @@ static int compare_seqno (const void *va, const void *vb)
   return (a == b) ? 0 : (a < b) ? -1 : 1;
 }
 
-struct ddsi_defrag *ddsi_defrag_new (const struct ddsrt_log_cfg *logcfg, enum ddsi_defrag_drop_mode drop_mode, uint32_t max_samples)
+struct ddsi_defrag *ddsi_defrag_new (const struct ddsrt_log_cfg *logcfg, enum ddsi_defrag_drop_mode drop_mode, uint32_t max_samples, uint32_t direct_max_size)
 {
   struct ddsi_defrag *d;
   assert (max_samples >= 1);
@@ -891,6 +1023,7 @@ struct ddsi_defrag *ddsi_defrag_new (const struct ddsrt_log_cfg *logcfg, enum dd
   ddsrt_avl_init (&defrag_sampletree_treedef, &d->sampletree);
   d->drop_mode = drop_mode;
   d->max_samples = max_samples;
+  d->direct_max_size = direct_max_size;
   d->n_samples = 0;
   d->max_sample = NULL;
   d->discarded_bytes = 0;
@@ -1035,7 +1168,137 @@ static void rsample_init_common (UNUSED_ARG (struct ddsi_rsample *rsample), UNUS
 {
 }
 
-static struct ddsi_rsample *defrag_rsample_new (struct ddsi_rdata *rdata, const struct ddsi_rsample_info *sampleinfo)
+static void defrag_assembly_new (struct ddsi_rsample_defrag *dfsample, struct ddsi_rmsg *rmsg, const struct ddsi_sertype *type, uint32_t size)
+{
+  struct ddsi_rmsg_serdata *rs;
+  void *buf;
+  /* failure only means falling back to copying the fragment chain on delivery */
+  if ((rs = ddsi_rmsg_alloc (rmsg, sizeof (*rs))) == NULL)
+    return;
+  if ((rs->serdata = ddsi_serdata_from_ser_prealloc (type, SDK_DATA, size, &buf)) == NULL)
+    return;
+  rs->type = ddsi_sertype_ref (type);
+  rs->next = rmsg->serdatas;
+  rmsg->serdatas = rs;
+  dfsample->assembly = rs->serdata;
+  dfsample->assembly_buf = buf;
+  dfsample->assembly_size = size;
+}
+
+static void defrag_assembly_copy (struct ddsi_rsample_defrag *dfsample, const struct ddsi_rdata *rdata)
+{
+  /* fragments may extend beyond the end of the sample, and in any case
+     mustn't write outside the buffer should the writer change the sample
+     size midway */
+  const uint32_t maxp1 = (rdata->maxp1 < dfsample->assembly_size) ? rdata->maxp1 : dfsample->assembly_size;
+  if (dfsample->assembly != NULL && rdata->min < maxp1)
+  {
+    const unsigned char *payload = DDSI_RMSG_PAYLOADOFF (rdata->rmsg, DDSI_RDATA_PAYLOAD_OFF (rdata));
+    memcpy (dfsample->assembly_buf + rdata->min, payload, maxp1 - rdata->min);
+  }
+}
+
+static void defrag_assembly_finish (struct ddsi_defrag *defrag, struct ddsi_rsample_defrag *dfsample)
+{
+  /* sampleinfo may have been replaced by the one of the first fragment,
+     which is the one that determines whether this is normal data */
+  struct ddsi_rsample_info *sampleinfo = dfsample->sampleinfo;
+  sampleinfo->assembled = NULL;
+  if (dfsample->assembly == NULL)
+    return;
+  if (sampleinfo->size != dfsample->assembly_size || sampleinfo->statusinfo != 0 || sampleinfo->complex_qos)
+    TRACE (defrag, "  not using assembled serdata\n");
+  else if (ddsi_serdata_from_ser_finish (ddsi_serdata_ref (dfsample->assembly)) == NULL)
+    TRACE (defrag, "  assembled serdata invalid\n");
+  else
+  {
+    /* the reference held by the rmsg suffices; statusinfo is known to be 0
+       and the timestamp is set the same way delivery does it */
+    ddsi_serdata_unref (dfsample->assembly);
+    if (sampleinfo->timestamp.v != DDSRT_WCTIME_INVALID.v)
+      dfsample->assembly->timestamp = sampleinfo->timestamp;
+    else
+      dfsample->assembly->timestamp.v = 0;
+    sampleinfo->assembled = dfsample->assembly;
+  }
+}
+
+static void defrag_fragbits_init (struct ddsi_rsample_defrag *dfsample, struct ddsi_rmsg *rmsg, const struct ddsi_rsample_info *sampleinfo)
+{
+  uint32_t nfrags;
+  dfsample->fragbits = NULL;
+  if (sampleinfo->fragsize == 0)
+    return;
+  nfrags = (uint32_t) (((uint64_t) sampleinfo->size + sampleinfo->fragsize - 1) / sampleinfo->fragsize);
+  if (nfrags == 0 || nfrags > DEFRAG_FRAGBITS_MAX_FRAGS)
+    return;
+  /* failure only means the interval tree is used for everything */
+  if ((dfsample->fragbits = ddsi_rmsg_alloc (rmsg, 4 * ((nfrags + 31) / 32))) == NULL)
+    return;
+  ddsi_bitset_zero (nfrags, dfsample->fragbits);
+  dfsample->fragbits_fragsize = sampleinfo->fragsize;
+  dfsample->fragbits_size = sampleinfo->size;
+  dfsample->fragbits_nfrags = nfrags;
+  dfsample->fragbits_first_missing = 0;
+  dfsample->fragbits_end = 0;
+}
+
+static bool defrag_fragbits_valid (const struct ddsi_rsample_defrag *dfsample, const struct ddsi_rsample_info *sampleinfo)
+{
+  return (dfsample->fragbits != NULL &&
+          sampleinfo->fragsize == dfsample->fragbits_fragsize &&
+          sampleinfo->size == dfsample->fragbits_size);
+}
+
+static bool defrag_fragbits_covered (const struct ddsi_rsample_defrag *dfsample, const struct ddsi_rdata *rdata, const struct ddsi_rsample_info *sampleinfo)
+{
+  /* true if all fragments overlapping with rdata have been received already */
+  if (!defrag_fragbits_valid (dfsample, sampleinfo))
+    return false;
+  const uint32_t fs = dfsample->fragbits_fragsize;
+  uint32_t f0 = rdata->min / fs;
+  uint32_t f1 = (uint32_t) (((uint64_t) rdata->maxp1 + fs - 1) / fs);
+  if (f1 > dfsample->fragbits_nfrags)
+    f1 = dfsample->fragbits_nfrags;
+  if (f0 < dfsample->fragbits_first_missing)
+    f0 = dfsample->fragbits_first_missing;
+  for (; f0 < f1; f0++)
+    if (!ddsi_bitset_isset (dfsample->fragbits_nfrags, dfsample->fragbits, f0))
+      return false;
+  return true;
+}
+
+static void defrag_fragbits_mark (struct ddsi_rsample_defrag *dfsample, const struct ddsi_rdata *rdata, const struct ddsi_rsample_info *sampleinfo)
+{
+  if (dfsample->fragbits == NULL)
+    return;
+  else if (!defrag_fragbits_valid (dfsample, sampleinfo))
+  {
+    /* writer changed its mind on how to fragment this sample */
+    dfsample->fragbits = NULL;
+    return;
+  }
+  /* only fragments fully contained in rdata, partially covered ones
+     simply remain marked as missing */
+  const uint32_t fs = dfsample->fragbits_fragsize;
+  const uint32_t nfrags = dfsample->fragbits_nfrags;
+  uint32_t f = (uint32_t) (((uint64_t) rdata->min + fs - 1) / fs);
+  const uint32_t f1 = (rdata->maxp1 >= dfsample->fragbits_size) ? nfrags : rdata->maxp1 / fs;
+  if (f1 > dfsample->fragbits_end)
+    dfsample->fragbits_end = f1;
+  for (; f < f1; f++)
+    ddsi_bitset_set (nfrags, dfsample->fragbits, f);
+  while (dfsample->fragbits_first_missing < nfrags && ddsi_bitset_isset (nfrags, dfsample->fragbits, dfsample->fragbits_first_missing))
+    dfsample->fragbits_first_missing++;
+}
+
+static void defrag_note_fragment (struct ddsi_rsample_defrag *dfsample, const struct ddsi_rdata *rdata, const struct ddsi_rsample_info *sampleinfo)
+{
+  defrag_assembly_copy (dfsample, rdata);
+  defrag_fragbits_mark (dfsample, rdata, sampleinfo);
+}
+
+static struct ddsi_rsample *defrag_rsample_new (const struct ddsi_defrag *defrag, struct ddsi_rdata *rdata, const struct ddsi_rsample_info *sampleinfo)
 {
   struct ddsi_rsample *rsample;
   struct ddsi_rsample_defrag *dfsample;
@@ -1050,6 +1313,13 @@ static struct ddsi_rsample *defrag_rsample_new (struct ddsi_rdata *rdata, const
   if ((dfsample->sampleinfo = ddsi_rmsg_alloc (rdata->rmsg, sizeof (*dfsample->sampleinfo))) == NULL)
     return NULL;
   *dfsample->sampleinfo = *sampleinfo;
+  dfsample->assembly = NULL;
+  dfsample->assembly_buf = NULL;
+  dfsample->assembly_size = 0;
+  if (sampleinfo->assembly_type && sampleinfo->size <= defrag->direct_max_size)
+    defrag_assembly_new (dfsample, rdata->rmsg, sampleinfo->assembly_type, sampleinfo->size);
+  defrag_fragbits_init (dfsample, rdata->rmsg, sampleinfo);
+  defrag_note_fragment (dfsample, rdata, sampleinfo);
 
   ddsrt_avl_init (&rsample_defrag_fragtree_treedef, &dfsample->fragtree);
 
@@ -1178,6 +1448,15 @@ static struct ddsi_rsample *defrag_add_fragment (struct ddsi_defrag *defrag, str
 
   TRACE (defrag, "  lastfrag %p [%"PRIu32"..%"PRIu32")\n", (void *) dfsample->lastfrag, dfsample->lastfrag->min, dfsample->lastfrag->maxp1);
 
+  /* Retransmits of fragments we already have are common enough on
+     lossy networks to warrant avoiding the tree search */
+  if (defrag_fragbits_covered (dfsample, rdata, sampleinfo))
+  {
+    TRACE (defrag, "  new covered by received fragments\n");
+    defrag->discarded_bytes += maxp1 - min;
+    return NULL;
+  }
+
   /* Interval tree is sorted on min offset; each key is unique:
      otherwise one would be wholly contained in another. */
   if (min >= dfsample->lastfrag->min)
@@ -1213,6 +1492,7 @@ static struct ddsi_rsample *defrag_add_fragment (struct ddsi_defrag *defrag, str
        end); this may close the gap to the successor of predeq; predeq
        need not have a fragment chain yet (it may be the sentinel) */
     TRACE (defrag, "  grow predeq with new\n");
+    defrag_note_fragment (dfsample, rdata, sampleinfo);
     ddsi_rdata_addbias (rdata);
     rdata->nextfrag = NULL;
     if (predeq->first)
@@ -1241,6 +1521,7 @@ static struct ddsi_rsample *defrag_add_fragment (struct ddsi_defrag *defrag, str
        predeq so the tree structure doesn't change even though the key
        does change */
     TRACE (defrag, "  extending succ %p [%"PRIu32"..%"PRIu32") at head\n", (void *) succ, succ->min, succ->maxp1);
+    defrag_note_fragment (dfsample, rdata, sampleinfo);
     ddsi_rdata_addbias (rdata);
     rdata->nextfrag = succ->first;
     succ->first = rdata;
@@ -1264,6 +1545,7 @@ static struct ddsi_rsample *defrag_add_fragment (struct ddsi_defrag *defrag, str
        new interval; rdata did not cause completion of sample */
     ddsrt_avl_ipath_t path;
     TRACE (defrag, "  new interval\n");
+    defrag_note_fragment (dfsample, rdata, sampleinfo);
     if (ddsrt_avl_lookup_ipath (&rsample_defrag_fragtree_treedef, &dfsample->fragtree, &min, &path))
       assert (0);
     defrag_rsample_addiv (dfsample, rdata, &path);
@@ -1384,7 +1666,7 @@ struct ddsi_rsample *ddsi_defrag_rsample (struct ddsi_defrag *defrag, struct dds
     /* FIXME: MERGE THIS ONE WITH THE NEXT */
     TRACE (defrag, "  new max sample\n");
     ddsrt_avl_lookup_ipath (&defrag_sampletree_treedef, &defrag->sampletree, &sampleinfo->seq, &path);
-    if ((sample = defrag_rsample_new (rdata, sampleinfo)) == NULL)
+    if ((sample = defrag_rsample_new (defrag, rdata, sampleinfo)) == NULL)
       return NULL;
     ddsrt_avl_insert_ipath (&defrag_sampletree_treedef, &defrag->sampletree, sample, &path);
     defrag->max_sample = sample;
@@ -1396,7 +1678,7 @@ struct ddsi_rsample *ddsi_defrag_rsample (struct ddsi_defrag *defrag, struct dds
     /* a new sequence number, but smaller than the maximum */
     TRACE (defrag, "  new sample less than max\n");
     assert (sampleinfo->seq < max_seq);
-    if ((sample = defrag_rsample_new (rdata, sampleinfo)) == NULL)
+    if ((sample = defrag_rsample_new (defrag, rdata, sampleinfo)) == NULL)
       return NULL;
     ddsrt_avl_insert_ipath (&defrag_sampletree_treedef, &defrag->sampletree, sample, &path);
     defrag->n_samples++;
@@ -1424,6 +1706,7 @@ struct ddsi_rsample *ddsi_defrag_rsample (struct ddsi_defrag *defrag, struct dds
       TRACE (defrag, "  updating max_sample: now %p %"PRIu64"\n",
              (void *) defrag->max_sample, defrag->max_sample ? defrag->max_sample->u.defrag.seq : 0);
     }
+    defrag_assembly_finish (defrag, &result->u.defrag);
     rsample_convert_defrag_to_reorder (result);
   }
 
@@ -1446,6 +1729,35 @@ void ddsi_defrag_notegap (struct ddsi_defrag *defrag, ddsi_seqno_t min, ddsi_seq
   defrag->max_sample = ddsrt_avl_find_max (&defrag_sampletree_treedef, &defrag->sampletree);
 }
 
+static enum ddsi_defrag_nackmap_result defrag_nackmap_fragbits (const struct ddsi_rsample_defrag *dfsample, uint32_t maxfragnum, struct ddsi_fragment_number_set_header *map, uint32_t *mapbits, uint32_t maxsz)
+{
+  const uint32_t nfrags = dfsample->fragbits_nfrags;
+  uint32_t map_end;
+  /* the sample info is only ever replaced by one matching the bitmap */
+  assert (defrag_fragbits_valid (dfsample, dfsample->sampleinfo));
+  assert (maxfragnum < nfrags);
+  /* having received a fragment implies all preceding ones have been
+     published, even if maxfragnum says otherwise */
+  if (dfsample->fragbits_end > 0 && dfsample->fragbits_end - 1 > maxfragnum)
+    maxfragnum = dfsample->fragbits_end - 1;
+  if (dfsample->fragbits_first_missing > maxfragnum)
+    return DDSI_DEFRAG_NACKMAP_ALL_ADVERTISED_FRAGMENTS_KNOWN;
+  /* bitmap runs from first missing to last missing fragment not
+     beyond maxfragnum, the first missing one bounds the search */
+  map->bitmap_base = dfsample->fragbits_first_missing;
+  map_end = maxfragnum;
+  while (ddsi_bitset_isset (nfrags, dfsample->fragbits, map_end))
+    map_end--;
+  map->numbits = map_end - map->bitmap_base + 1;
+  if (map->numbits > maxsz)
+    map->numbits = maxsz;
+  ddsi_bitset_zero (map->numbits, mapbits);
+  for (uint32_t i = 0; i < map->numbits; i++)
+    if (!ddsi_bitset_isset (nfrags, dfsample->fragbits, map->bitmap_base + i))
+      ddsi_bitset_set (map->numbits, mapbits, i);
+  return DDSI_DEFRAG_NACKMAP_FRAGMENTS_MISSING;
+}
+
 enum ddsi_defrag_nackmap_result ddsi_defrag_nackmap (struct ddsi_defrag *defrag, ddsi_seqno_t seq, uint32_t maxfragnum, struct ddsi_fragment_number_set_header *map, uint32_t *mapbits, uint32_t maxsz)
 {
   struct ddsi_rsample *s;
@@ -1483,6 +1795,9 @@ enum ddsi_defrag_nackmap_result ddsi_defrag_nackmap (struct ddsi_defrag *defrag,
   if (maxfragnum >= nfrags)
     maxfragnum = nfrags - 1;
 
+  if (s->u.defrag.fragbits != NULL)
+    return defrag_nackmap_fragbits (&s->u.defrag, maxfragnum, map, mapbits, maxsz);
+
   /* Determine bitmap start & size */
   {
     /* We always have an interval starting at 0, which is empty if we
@@ -1648,11 +1963,29 @@ void ddsi_defrag_prune (struct ddsi_defrag *defrag, ddsi_guid_prefix_t *dst, dds
    admins that accepted it, less BIAS for the initial reference.  We
    can't use the original sample because of [CASE I], so we adjust
    based on the fragment chain instead of the sample.  Example code is
-   in the overview comment at the top of this file. */
+   in the overview comment at the top of this file.
+
+   The common case of a little bit of reordering (say a lost packet
+   followed by a handful of successors) is handled without the
+   interval tree: samples with sequence numbers in [next_seq+1,
+   next_seq+REORDER_RING_SIZE) are stored in a ring indexed by
+   sequence number for as long as the interval tree is empty, which
+   makes inserting them, delivering them once the missing one arrives
+   and generating NACK bitmaps cheap.  The ring is allocated the first
+   time a sample is stored in it.  A sample outside the window, a gap
+   or a change of next_seq other than by delivering the contents of
+   the ring moves all samples in the ring to the interval tree, after
+   which everything proceeds as before until the tree becomes empty
+   again.  Thus, at any one time at most one of them contains data. */
+
+#define REORDER_RING_SIZE 256
 
 struct ddsi_reorder {
   ddsrt_avl_tree_t sampleivtree;
   struct ddsi_rsample *max_sampleiv; /* = max(sampleivtree) */
+  struct ddsi_rsample **ring; /* ring[seq % REORDER_RING_SIZE], or null if not allocated */
+  uint32_t ring_n; /* number of samples in ring */
+  ddsi_seqno_t ring_max; /* highest sequence number in ring if ring_n > 0 */
   ddsi_seqno_t next_seq;
   enum ddsi_reorder_mode mode;
   uint32_t max_samples;
@@ -1673,6 +2006,9 @@ struct ddsi_reorder *ddsi_reorder_new (const struct ddsrt_log_cfg *logcfg, enum
     return NULL;
   ddsrt_avl_init (&reorder_sampleivtree_treedef, &r->sampleivtree);
   r->max_sampleiv = NULL;
+  r->ring = NULL;
+  r->ring_n = 0;
+  r->ring_max = 0;
   r->next_seq = 1;
   r->mode = mode;
   r->max_samples = max_samples;
@@ -1718,6 +2054,17 @@ void ddsi_reorder_free (struct ddsi_reorder *r)
     }
     iv = ddsrt_avl_find_min (&reorder_sampleivtree_treedef, &r->sampleivtree);
   }
+  for (ddsi_seqno_t seq = r->next_seq + 1; r->ring_n > 0; seq++)
+  {
+    struct ddsi_rsample * const rs = r->ring[seq % REORDER_RING_SIZE];
+    if (rs != NULL)
+    {
+      r->ring[seq % REORDER_RING_SIZE] = NULL;
+      r->ring_n--;
+      ddsi_fragchain_unref (rs->u.reorder.sc.first->fragchain);
+    }
+  }
+  ddsrt_free (r->ring);
   ddsrt_free (r);
 }
 
@@ -1892,6 +2239,149 @@ static void delete_last_sample (struct ddsi_reorder *reorder)
   ddsi_fragchain_unref (fragchain);
 }
 
+static bool reorder_ring_inwindow (const struct ddsi_reorder *reorder, ddsi_seqno_t seq)
+{
+  return seq > reorder->next_seq && seq - reorder->next_seq < REORDER_RING_SIZE;
+}
+
+static struct ddsi_rsample **reorder_ring_slot (const struct ddsi_reorder *reorder, ddsi_seqno_t seq)
+{
+  assert (reorder_ring_inwindow (reorder, seq));
+  return &reorder->ring[seq % REORDER_RING_SIZE];
+}
+
+static void reorder_ring_to_tree (struct ddsi_reorder *reorder)
+{
+  /* Moves the samples in the ring to the (empty) interval tree,
+     consecutive ones are combined in a single interval headed by the
+     first one like they would have been had they been inserted in the
+     tree in the first place */
+  struct ddsi_rsample *cur = NULL;
+  assert (ddsrt_avl_is_empty (&reorder->sampleivtree));
+  TRACE (reorder, "  ring_to_tree: %"PRIu32" samples in [%"PRIu64",%"PRIu64"]\n", reorder->ring_n, reorder->next_seq + 1, reorder->ring_max);
+  for (ddsi_seqno_t seq = reorder->next_seq + 1; reorder->ring_n > 0; seq++)
+  {
+    struct ddsi_rsample ** const slot = reorder_ring_slot (reorder, seq);
+    struct ddsi_rsample * const rs = *slot;
+    if (rs == NULL)
+      continue;
+    assert (rsample_is_singleton (&rs->u.reorder) && rs->u.reorder.min == seq);
+    *slot = NULL;
+    reorder->ring_n--;
+    if (cur != NULL && cur->u.reorder.maxp1 == seq)
+      append_rsample_interval (cur, rs);
+    else
+    {
+      reorder_add_rsampleiv (reorder, rs);
+      cur = rs;
+    }
+  }
+  reorder->max_sampleiv = cur;
+}
+
+static void reorder_ring_take_consecutive (struct ddsi_reorder *reorder, struct ddsi_rsample *rsampleiv)
+{
+  /* Appends the samples in the ring that immediately follow rsampleiv
+     to it, rsampleiv being the next one to deliver */
+  struct ddsi_rsample *rs;
+  ddsi_seqno_t seq = rsampleiv->u.reorder.maxp1;
+  while (reorder->ring_n > 0 && (rs = *reorder_ring_slot (reorder, seq)) != NULL)
+  {
+    assert (rsample_is_singleton (&rs->u.reorder) && rs->u.reorder.min == seq);
+    *reorder_ring_slot (reorder, seq) = NULL;
+    reorder->ring_n--;
+    append_rsample_interval (rsampleiv, rs);
+    seq++;
+  }
+  TRACE (reorder, "  ring: took [%"PRIu64",%"PRIu64"), %"PRIu32" samples left\n", rsampleiv->u.reorder.min, rsampleiv->u.reorder.maxp1, reorder->ring_n);
+}
+
+static void reorder_ring_delete_last (struct ddsi_reorder *reorder)
+{
+  struct ddsi_rsample ** const slot = reorder_ring_slot (reorder, reorder->ring_max);
+  struct ddsi_rsample * const rs = *slot;
+  /* never called with only one sample in the ring */
+  assert (rs != NULL && reorder->ring_n > 1);
+  TRACE (reorder, "  ring: delete_last_sample %"PRIu64"\n", reorder->ring_max);
+  *slot = NULL;
+  reorder->ring_n--;
+  do {
+    reorder->ring_max--;
+  } while (*reorder_ring_slot (reorder, reorder->ring_max) == NULL);
+  reorder->discarded_bytes += rs->u.reorder.sc.first->sampleinfo->size;
+  ddsi_fragchain_unref (rs->u.reorder.sc.first->fragchain);
+}
+
+static ddsi_reorder_result_t reorder_ring_insert (struct ddsi_reorder *reorder, struct ddsi_rsample *rsampleiv, int *refcount_adjust, int delivery_queue_full_p)
+{
+  /* Same policy as for the interval tree, except that there is no
+     need to worry about intervals */
+  struct ddsi_rsample_reorder *s = &rsampleiv->u.reorder;
+  struct ddsi_rsample ** const slot = reorder_ring_slot (reorder, s->min);
+  bool delete_last = false;
+  if (reorder->ring_n == 0)
+  {
+    assert (reorder->n_samples == 0);
+    TRACE (reorder, "  ring: adding to empty store\n");
+    if (reorder->max_samples == 0)
+    {
+      TRACE (reorder, "  NOT - max_samples hit\n");
+      goto reject;
+    }
+    reorder->ring_max = s->min;
+  }
+  else if (s->min > reorder->ring_max)
+  {
+    if (delivery_queue_full_p)
+    {
+      TRACE (reorder, "  discarding sample: only accepting delayed samples due to backlog in delivery queue\n");
+      goto reject;
+    }
+    else if (reorder->n_samples == reorder->max_samples)
+    {
+      TRACE (reorder, "  discarding sample: max_samples reached and sample at end\n");
+      goto reject;
+    }
+    TRACE (reorder, "  ring: new last sample\n");
+    reorder->ring_max = s->min;
+  }
+  else
+  {
+    if (reorder->late_ack_mode && delivery_queue_full_p)
+    {
+      TRACE (reorder, "  discarding sample: delivery queue full\n");
+      goto reject;
+    }
+    else if (*slot != NULL)
+    {
+      TRACE (reorder, "  discard: duplicate\n");
+      goto reject;
+    }
+    TRACE (reorder, "  ring: filling hole\n");
+    delete_last = (reorder->n_samples == reorder->max_samples);
+  }
+  *slot = rsampleiv;
+  reorder->ring_n++;
+  if (delete_last)
+    reorder_ring_delete_last (reorder);
+  else
+    reorder->n_samples++;
+  (*refcount_adjust)++;
+  return DDSI_REORDER_ACCEPT;
+
+reject:
+  reorder->discarded_bytes += s->sc.first->sampleinfo->size;
+  return DDSI_REORDER_REJECT;
+}
+
+static bool reorder_ring_alloc (struct ddsi_reorder *reorder)
+{
+  /* failure to allocate means using the interval tree */
+  if (reorder->ring == NULL && (reorder->ring = ddsrt_malloc_s (REORDER_RING_SIZE * sizeof (*reorder->ring))) != NULL)
+    memset (reorder->ring, 0, REORDER_RING_SIZE * sizeof (*reorder->ring));
+  return reorder->ring != NULL;
+}
+
 ddsi_reorder_result_t ddsi_reorder_rsample (struct ddsi_rsample_chain *sc, struct ddsi_reorder *reorder, struct ddsi_rsample *rsampleiv, int *refcount_adjust, int delivery_queue_full_p)
 {
   /* Adds an rsample (represented as an interval) to the reorder admin
@@ -1925,9 +2415,15 @@ ddsi_reorder_result_t ddsi_reorder_rsample (struct ddsi_rsample_chain *sc, struc
   assert ((!!ddsrt_avl_is_empty (&reorder->sampleivtree)) == (reorder->max_sampleiv == NULL));
   assert (reorder->max_sampleiv == NULL || reorder->max_sampleiv == ddsrt_avl_find_max (&reorder_sampleivtree_treedef, &reorder->sampleivtree));
   assert (reorder->n_samples <= reorder->max_samples);
+  assert (reorder->ring_n == 0 || (reorder->max_sampleiv == NULL && reorder->mode == DDSI_REORDER_MODE_NORMAL));
   if (reorder->max_sampleiv)
     TRACE (reorder, "  max = [%"PRIu64",%"PRIu64") @ %p\n", reorder->max_sampleiv->u.reorder.min,
            reorder->max_sampleiv->u.reorder.maxp1, (void *) reorder->max_sampleiv);
+  else if (reorder->ring_n > 0)
+    TRACE (reorder, "  ring = %"PRIu32" samples, max %"PRIu64"\n", reorder->ring_n, reorder->ring_max);
+
+  if (reorder->ring_n > 0 && s->min > reorder->next_seq && !reorder_ring_inwindow (reorder, s->min))
+    reorder_ring_to_tree (reorder);
 
   if (s->min == reorder->next_seq ||
       (s->min > reorder->next_seq && reorder->mode == DDSI_REORDER_MODE_MONOTONICALLY_INCREASING) ||
@@ -1950,7 +2446,9 @@ ddsi_reorder_result_t ddsi_reorder_rsample (struct ddsi_rsample_chain *sc, struc
        first interval in the tree to it.  We can avoid all processing
        if the index is empty, which is the normal case.  Unreliable
        out-of-order either ends up here or in discard.)  */
-    if (reorder->max_sampleiv != NULL)
+    if (reorder->ring_n > 0)
+      reorder_ring_take_consecutive (reorder, rsampleiv);
+    else if (reorder->max_sampleiv != NULL)
     {
       struct ddsi_rsample *min = ddsrt_avl_find_min (&reorder_sampleivtree_treedef, &reorder->sampleivtree);
       TRACE (reorder, "  try append_and_discard\n");
@@ -1978,6 +2476,10 @@ ddsi_reorder_result_t ddsi_reorder_rsample (struct ddsi_rsample_chain *sc, struc
     reorder->discarded_bytes += s->sc.first->sampleinfo->size;
     return DDSI_REORDER_TOO_OLD; /* don't want refcount increment */
   }
+  else if (ddsrt_avl_is_empty (&reorder->sampleivtree) && reorder_ring_inwindow (reorder, s->min) && reorder_ring_alloc (reorder))
+  {
+    return reorder_ring_insert (reorder, rsampleiv, refcount_adjust, delivery_queue_full_p);
+  }
   else if (ddsrt_avl_is_empty (&reorder->sampleivtree))
   {
     /* else, if nothing's stored simply add this one, max_samples = 0
@@ -2265,6 +2767,8 @@ ddsi_reorder_result_t ddsi_reorder_gap (struct ddsi_rsample_chain *sc, struct dd
     TRACE (reorder, "  special mode => don't care\n");
     return DDSI_REORDER_REJECT;
   }
+  if (reorder->ring_n > 0)
+    reorder_ring_to_tree (reorder);
 
   /* Coalesce all intervals [m,n) with n >= min or m <= maxp1 */
   if ((coalesced = coalesce_intervals_touching_range (reorder, min, maxp1, &valuable)) == NULL)
@@ -2341,6 +2845,7 @@ void ddsi_reorder_drop_upto (struct ddsi_reorder *reorder, ddsi_seqno_t maxp1)
   // Requiring that no samples are present beyond maxp1 means we're not dropping
   // too much.  That's good enough for the current purpose.
   assert (reorder->max_sampleiv == NULL || reorder->max_sampleiv->u.reorder.maxp1 <= maxp1);
+  assert (reorder->ring_n == 0 || reorder->ring_max < maxp1);
   // gap won't be stored, so can safely be stack-allocated for the purpose of calling
   // ddsi_reorder_gap
   struct ddsi_rdata gap = {
@@ -2370,6 +2875,8 @@ int ddsi_reorder_wantsample (const struct ddsi_reorder *reorder, ddsi_seqno_t se
   if (seq < reorder->next_seq)
     /* trivially not interesting */
     return 0;
+  if (reorder->ring_n > 0)
+    return !reorder_ring_inwindow (reorder, seq) || *reorder_ring_slot (reorder, seq) == NULL;
   /* Find interval that contains seq, if we know seq.  We are
      interested if seq is outside this interval (if any). */
   s = ddsrt_avl_lookup_pred_eq (&reorder_sampleivtree_treedef, &reorder->sampleivtree, &seq);
@@ -2430,6 +2937,25 @@ enum ddsi_reorder_nackmap_result ddsi_reorder_nackmap (const struct ddsi_reorder
   assert (iv == NULL || iv->u.reorder.min > base);
   ddsi_seqno_t i = base;
   ddsi_seqno_t last_nacked_p1 = 0;
+  if (reorder->ring_n > 0)
+  {
+    // Same thing, but with the intervals given by runs of consecutive samples in the ring
+    ddsi_seqno_t seq = reorder->next_seq + 1;
+    while (seq <= reorder->ring_max && i < base + map->numbits)
+    {
+      while (*reorder_ring_slot (reorder, seq) == NULL)
+        seq++;
+      for (; i < base + map->numbits && i < seq; i++)
+      {
+        uint32_t x = (uint32_t) (i - base);
+        ddsi_bitset_set (map->numbits, mapbits, x);
+      }
+      last_nacked_p1 = i;
+      while (seq <= reorder->ring_max && *reorder_ring_slot (reorder, seq) != NULL)
+        seq++;
+      i = seq;
+    }
+  }
   while (iv && i < base + map->numbits)
   {
     for (; i < base + map->numbits && i < iv->u.reorder.min; i++)
@@ -2486,24 +3012,48 @@ ddsi_seqno_t ddsi_reorder_next_seq (const struct ddsi_reorder *reorder)
 
 void ddsi_reorder_set_next_seq (struct ddsi_reorder *reorder, ddsi_seqno_t seq)
 {
+  if (reorder->ring_n > 0)
+    reorder_ring_to_tree (reorder);
   reorder->next_seq = seq;
 }
 
 /* DQUEUE -------------------------------------------------------------- */
 
+/* The delivery queue is an intrusive multi-producer, single-consumer
+   queue of sample chain elements: producers append a chain by swapping
+   the tail pointer and then linking the old tail to the first element
+   of the chain; the delivery thread takes elements off the head
+   without any locking. Because the last element can only be removed
+   once a successor has been linked to it, a stub element is appended
+   whenever the consumer catches up with the producers, and so an empty
+   queue is one where head and tail both point to the stub.
+
+   The lock and the condition variable are only used for sleeping: the
+   delivery thread sets "sleeping" and then checks once more that the
+   queue is empty before blocking, a producer only takes the lock if
+   its chain made the queue go from empty to non-empty while the
+   delivery thread is sleeping. */
+
 struct ddsi_dqueue {
+  ddsrt_atomic_voidp_t tail;
+  ddsrt_atomic_uint32_t nof_samples;
+  ddsrt_atomic_uint32_t max_nof_samples;
+
   ddsrt_mutex_t lock;
   ddsrt_cond_t cond;
+  ddsrt_atomic_uint32_t sleeping;
+  ddsrt_atomic_uint32_t nwaiters;
+  ddsrt_atomic_uint64_t wakeups;
+
+  struct ddsi_rsample_chain_elem *head;
+  struct ddsi_rsample_chain_elem stub;
   ddsi_dqueue_handler_t handler;
   void *handler_arg;
 
-  struct ddsi_rsample_chain sc;
-
   struct ddsi_thread_state *thrst;
   struct ddsi_domaingv *gv;
   char *name;
   uint32_t max_samples;
-  ddsrt_atomic_uint32_t nof_samples;
 };
 
 enum dqueue_elem_kind {
@@ -2547,21 +3097,125 @@ static enum dqueue_elem_kind dqueue_elem_kind (const struct ddsi_rsample_chain_e
     return DQEK_BUBBLE;
 }
 
-bool ddsi_dqueue_step_deaf (struct ddsi_dqueue *q)
+static struct ddsi_rsample_chain_elem *dqueue_load_next (const struct ddsi_rsample_chain_elem *e)
 {
-  struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
-  struct ddsi_rsample_chain sc;
+  struct ddsi_rsample_chain_elem *next = *((struct ddsi_rsample_chain_elem * const volatile *) &e->next);
+  ddsrt_atomic_fence_acq ();
+  return next;
+}
+
+static void dqueue_store_next (struct ddsi_rsample_chain_elem *e, struct ddsi_rsample_chain_elem *next)
+{
+  ddsrt_atomic_fence_rel ();
+  *((struct ddsi_rsample_chain_elem * volatile *) &e->next) = next;
+}
+
+static bool dqueue_push (struct ddsi_dqueue *q, struct ddsi_rsample_chain_elem *first, struct ddsi_rsample_chain_elem *last)
+{
+  /* Returns true if the tail was the stub, which is the case whenever
+     the queue goes from empty to non-empty. Until the old tail has
+     been linked to "first", the consumer can't get past the old tail
+     and will wait for it (see dqueue_wait). */
+  struct ddsi_rsample_chain_elem *prev;
+  assert (last->next == NULL);
+  do {
+    prev = ddsrt_atomic_ldvoidp (&q->tail);
+  } while (!ddsrt_atomic_casvoidp (&q->tail, prev, last));
+  dqueue_store_next (prev, first);
+  return prev == &q->stub;
+}
+
+static struct ddsi_rsample_chain_elem *dqueue_pop (struct ddsi_dqueue *q)
+{
+  /* Returns NULL if the queue is empty, but also if a producer is
+     halfway through appending a chain */
+  struct ddsi_rsample_chain_elem *head = q->head, *next = dqueue_load_next (head);
+  if (head == &q->stub)
+  {
+    if (next == NULL)
+      return NULL;
+    q->head = head = next;
+    next = dqueue_load_next (next);
+  }
+  if (next == NULL)
+  {
+    if (head != ddsrt_atomic_ldvoidp (&q->tail))
+      return NULL;
+    q->stub.next = NULL;
+    (void) dqueue_push (q, &q->stub, &q->stub);
+    if ((next = dqueue_load_next (head)) == NULL)
+      return NULL;
+  }
+  q->head = next;
+  return head;
+}
+
+static bool dqueue_is_empty (struct ddsi_dqueue *q)
+{
+  return q->head == &q->stub && ddsrt_atomic_ldvoidp (&q->tail) == &q->stub;
+}
+
+static void dqueue_wait (struct ddsi_dqueue *q)
+{
+  if (!dqueue_is_empty (q))
+  {
+    /* a producer got interrupted between updating the tail and linking
+       its chain in, that'll be fixed momentarily */
+    dds_sleepfor (DDS_USECS (1));
+    return;
+  }
   ddsrt_mutex_lock (&q->lock);
-  while ((sc = q->sc).first != NULL)
+  ddsrt_atomic_st32 (&q->sleeping, 1);
+  ddsrt_atomic_fence ();
+  if (dqueue_is_empty (q))
+  {
+    ddsrt_cond_wait (&q->cond, &q->lock);
+    ddsrt_atomic_inc64 (&q->wakeups);
+  }
+  ddsrt_atomic_st32 (&q->sleeping, 0);
+  ddsrt_mutex_unlock (&q->lock);
+}
+
+static void dqueue_wakeup (struct ddsi_dqueue *q)
+{
+  /* The update of the tail is a full barrier, so either this sees the
+     delivery thread is sleeping, or the delivery thread sees that the
+     queue is not empty */
+  if (ddsrt_atomic_ld32 (&q->sleeping))
+  {
+    ddsrt_mutex_lock (&q->lock);
+    ddsrt_cond_broadcast (&q->cond);
+    ddsrt_mutex_unlock (&q->lock);
+  }
+}
+
+static void dqueue_add_samples (struct ddsi_dqueue *q, uint32_t n)
+{
+  const uint32_t count = ddsrt_atomic_add32_nv (&q->nof_samples, n);
+  uint32_t max;
+  while (count > (max = ddsrt_atomic_ld32 (&q->max_nof_samples)) && !ddsrt_atomic_cas32 (&q->max_nof_samples, max, count))
+    ;
+}
+
+static void dqueue_remove_sample (struct ddsi_dqueue *q)
+{
+  if (ddsrt_atomic_dec32_ov (&q->nof_samples) == 1 && ddsrt_atomic_ld32 (&q->nwaiters) > 0)
   {
-    q->sc.first = q->sc.last = NULL;
+    ddsrt_mutex_lock (&q->lock);
+    ddsrt_cond_broadcast (&q->cond);
     ddsrt_mutex_unlock (&q->lock);
+  }
+}
 
+bool ddsi_dqueue_step_deaf (struct ddsi_dqueue *q)
+{
+  struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  struct ddsi_rsample_chain_elem *e;
+  if ((e = dqueue_pop (q)) != NULL)
+  {
     ddsi_thread_state_awake (thrst, q->gv);
-    while (sc.first)
-    {
-      struct ddsi_rsample_chain_elem *e = sc.first;
-      sc.first = e->next;
+    do {
+      dqueue_remove_sample (q);
       ddsi_thread_state_awake_to_awake_no_nest (thrst);
       switch (dqueue_elem_kind (e))
       {
@@ -2585,13 +3239,10 @@ bool ddsi_dqueue_step_deaf (struct ddsi_dqueue *q)
           break;
         }
       }
-    }
+    } while ((e = dqueue_pop (q)) != NULL);
     ddsi_thread_state_asleep (thrst);
-    ddsrt_mutex_lock (&q->lock);
   }
-  const bool ret = q->sc.first != NULL;
-  ddsrt_mutex_unlock (&q->lock);
-  return ret;
+  return !dqueue_is_empty (q);
 }
 
 static uint32_t dqueue_thread (void *vq)
@@ -2606,28 +3257,22 @@ static uint32_t dqueue_thread (void *vq)
   ddsi_guid_t rdguid, *prdguid = NULL;
   uint32_t rdguid_count = 0;
 
-  ddsrt_mutex_lock (&q->lock);
   while (keepgoing)
   {
-    struct ddsi_rsample_chain sc;
+    struct ddsi_rsample_chain_elem *e;
 
     LOG_THREAD_CPUTIME (&gv->logconfig, next_thread_cputime);
 
-    if (q->sc.first == NULL)
-      ddsrt_cond_wait (&q->cond, &q->lock);
-    sc = q->sc;
-    q->sc.first = q->sc.last = NULL;
-    ddsrt_mutex_unlock (&q->lock);
+    if ((e = dqueue_pop (q)) == NULL)
+    {
+      dqueue_wait (q);
+      continue;
+    }
 
     ddsi_thread_state_awake_fixed_domain (thrst);
-    while (sc.first)
-    {
-      struct ddsi_rsample_chain_elem *e = sc.first;
+    do {
       int ret;
-      sc.first = e->next;
-      if (ddsrt_atomic_dec32_ov (&q->nof_samples) == 1) {
-        ddsrt_cond_broadcast (&q->cond);
-      }
+      dqueue_remove_sample (q);
       ddsi_thread_state_awake_to_awake_no_nest (thrst);
       switch (dqueue_elem_kind (e))
       {
@@ -2650,10 +3295,8 @@ static uint32_t dqueue_thread (void *vq)
             struct ddsi_dqueue_bubble *b = (struct ddsi_dqueue_bubble *) e->sampleinfo;
             if (b->kind == DDSI_DQBK_STOP)
             {
-              /* Stuff enqueued behind the bubble will still be
-                 processed, we do want to drain the queue.  Nothing
-                 may be queued anymore once we queue the stop bubble,
-                 so q->sc.first should be empty.  If it isn't
+              /* Nothing may be queued anymore once we queue the stop
+                 bubble, so the queue should be empty now.  If it isn't
                  ... dqueue_free fail an assertion.  STOP bubble
                  doesn't get malloced, and hence not freed. */
               keepgoing = 0;
@@ -2678,12 +3321,9 @@ static uint32_t dqueue_thread (void *vq)
             break;
           }
       }
-    }
-
+    } while (keepgoing && (e = dqueue_pop (q)) != NULL);
     ddsi_thread_state_asleep (thrst);
-    ddsrt_mutex_lock (&q->lock);
   }
-  ddsrt_mutex_unlock (&q->lock);
   return 0;
 }
 
@@ -2697,9 +3337,15 @@ struct ddsi_dqueue *ddsi_dqueue_new (const char *name, const struct ddsi_domaing
     goto fail_name;
   q->max_samples = max_samples;
   ddsrt_atomic_st32 (&q->nof_samples, 0);
+  ddsrt_atomic_st32 (&q->max_nof_samples, 0);
+  ddsrt_atomic_st32 (&q->sleeping, 0);
+  ddsrt_atomic_st32 (&q->nwaiters, 0);
+  ddsrt_atomic_st64 (&q->wakeups, 0);
   q->handler = handler;
   q->handler_arg = arg;
-  q->sc.first = q->sc.last = NULL;
+  memset (&q->stub, 0, sizeof (q->stub));
+  q->head = &q->stub;
+  ddsrt_atomic_stvoidp (&q->tail, &q->stub);
   q->gv = (struct ddsi_domaingv *) gv;
   q->thrst = NULL;
 
@@ -2726,41 +3372,18 @@ bool ddsi_dqueue_start (struct ddsi_dqueue *q)
   return ret == DDS_RETCODE_OK;
 }
 
-static int ddsi_dqueue_enqueue_locked (struct ddsi_dqueue *q, struct ddsi_rsample_chain *sc)
-{
-  int must_signal;
-  if (q->sc.first == NULL)
-  {
-    must_signal = 1;
-    q->sc = *sc;
-  }
-  else
-  {
-    must_signal = 0;
-    q->sc.last->next = sc->first;
-    q->sc.last = sc->last;
-  }
-  return must_signal;
-}
-
 bool ddsi_dqueue_enqueue_deferred_wakeup (struct ddsi_dqueue *q, struct ddsi_rsample_chain *sc, ddsi_reorder_result_t rres)
 {
-  bool signal;
   assert (rres > 0);
   assert (sc->first);
   assert (sc->last->next == NULL);
-  ddsrt_mutex_lock (&q->lock);
-  ddsrt_atomic_add32 (&q->nof_samples, (uint32_t) rres);
-  signal = ddsi_dqueue_enqueue_locked (q, sc);
-  ddsrt_mutex_unlock (&q->lock);
-  return signal;
+  dqueue_add_samples (q, (uint32_t) rres);
+  return dqueue_push (q, sc->first, sc->last);
 }
 
 void ddsi_dqueue_enqueue_trigger (struct ddsi_dqueue *q)
 {
-  ddsrt_mutex_lock (&q->lock);
-  ddsrt_cond_broadcast (&q->cond);
-  ddsrt_mutex_unlock (&q->lock);
+  dqueue_wakeup (q);
 }
 
 void ddsi_dqueue_enqueue (struct ddsi_dqueue *q, struct ddsi_rsample_chain *sc, ddsi_reorder_result_t rres)
@@ -2768,30 +3391,24 @@ void ddsi_dqueue_enqueue (struct ddsi_dqueue *q, struct ddsi_rsample_chain *sc,
   assert (rres > 0);
   assert (sc->first);
   assert (sc->last->next == NULL);
-  ddsrt_mutex_lock (&q->lock);
-  ddsrt_atomic_add32 (&q->nof_samples, (uint32_t) rres);
-  if (ddsi_dqueue_enqueue_locked (q, sc))
-    ddsrt_cond_broadcast (&q->cond);
-  ddsrt_mutex_unlock (&q->lock);
+  dqueue_add_samples (q, (uint32_t) rres);
+  if (dqueue_push (q, sc->first, sc->last))
+    dqueue_wakeup (q);
 }
 
-static int ddsi_dqueue_enqueue_bubble_locked (struct ddsi_dqueue *q, struct ddsi_dqueue_bubble *b)
+static void dqueue_init_bubble (struct ddsi_dqueue_bubble *b)
 {
-  struct ddsi_rsample_chain sc;
   b->sce.next = NULL;
   b->sce.fragchain = NULL;
   b->sce.sampleinfo = (struct ddsi_rsample_info *) b;
-  sc.first = sc.last = &b->sce;
-  return ddsi_dqueue_enqueue_locked (q, &sc);
 }
 
 static void ddsi_dqueue_enqueue_bubble (struct ddsi_dqueue *q, struct ddsi_dqueue_bubble *b)
 {
-  ddsrt_mutex_lock (&q->lock);
-  ddsrt_atomic_inc32 (&q->nof_samples);
-  if (ddsi_dqueue_enqueue_bubble_locked (q, b))
-    ddsrt_cond_broadcast (&q->cond);
-  ddsrt_mutex_unlock (&q->lock);
+  dqueue_init_bubble (b);
+  dqueue_add_samples (q, 1);
+  if (dqueue_push (q, &b->sce, &b->sce))
+    dqueue_wakeup (q);
 }
 
 void ddsi_dqueue_enqueue_callback (struct ddsi_dqueue *q, ddsi_dqueue_callback_t cb, void *arg)
@@ -2817,12 +3434,12 @@ void ddsi_dqueue_enqueue1 (struct ddsi_dqueue *q, const ddsi_guid_t *rdguid, str
   assert (rdguid != NULL);
   assert (sc->first);
   assert (sc->last->next == NULL);
-  ddsrt_mutex_lock (&q->lock);
-  ddsrt_atomic_add32 (&q->nof_samples, 1 + (uint32_t) rres);
-  if (ddsi_dqueue_enqueue_bubble_locked (q, b))
-    ddsrt_cond_broadcast (&q->cond);
-  (void) ddsi_dqueue_enqueue_locked (q, sc);
-  ddsrt_mutex_unlock (&q->lock);
+  /* the bubble and the samples it applies to must be appended in one go */
+  dqueue_init_bubble (b);
+  b->sce.next = sc->first;
+  dqueue_add_samples (q, 1 + (uint32_t) rres);
+  if (dqueue_push (q, &b->sce, sc->last))
+    dqueue_wakeup (q);
 }
 
 int ddsi_dqueue_is_full (struct ddsi_dqueue *q)
@@ -2844,21 +3461,29 @@ void ddsi_dqueue_wait_until_empty_if_full (struct ddsi_dqueue *q)
   if (count >= q->max_samples)
   {
     ddsrt_mutex_lock (&q->lock);
+    ddsrt_atomic_inc32 (&q->nwaiters);
     /* In case the wakeups are were all deferred */
     ddsrt_cond_broadcast (&q->cond);
     while (ddsrt_atomic_ld32 (&q->nof_samples) > 0)
       ddsrt_cond_wait (&q->cond, &q->lock);
+    ddsrt_atomic_dec32 (&q->nwaiters);
     ddsrt_mutex_unlock (&q->lock);
   }
 }
 
+void ddsi_dqueue_stats (struct ddsi_dqueue *q, uint32_t *nof_samples, uint32_t *max_nof_samples, uint64_t *wakeups)
+{
+  *nof_samples = ddsrt_atomic_ld32 (&q->nof_samples);
+  *max_nof_samples = ddsrt_atomic_ld32 (&q->max_nof_samples);
+  *wakeups = ddsrt_atomic_ld64 (&q->wakeups);
+}
+
 static void dqueue_free_remaining_elements (struct ddsi_dqueue *q)
 {
+  struct ddsi_rsample_chain_elem *e;
   assert (q->thrst == NULL);
-  while (q->sc.first)
+  while ((e = dqueue_pop (q)) != NULL)
   {
-    struct ddsi_rsample_chain_elem *e = q->sc.first;
-    q->sc.first = e->next;
     switch (dqueue_elem_kind (e))
     {
       case DQEK_DATA:
@@ -2873,6 +3498,7 @@ static void dqueue_free_remaining_elements (struct ddsi_dqueue *q)
       }
     }
   }
+  assert (dqueue_is_empty (q));
 }
 
 void ddsi_dqueue_free (struct ddsi_dqueue *q)
@@ -2889,7 +3515,7 @@ void ddsi_dqueue_free (struct ddsi_dqueue *q)
     ddsi_dqueue_enqueue_bubble (q, &b);
 
     ddsi_join_thread (q->thrst);
-    assert (q->sc.first == NULL);
+    assert (dqueue_is_empty (q));
   }
   else
   {
@@ -324,6 +324,10 @@ static dds_return_t ddsi_raweth_create_conn (struct ddsi_tran_conn **conn_out, s
   struct ddsi_domaingv const * const gv = fact->gv;
   struct ddsi_network_interface const * const intf = qos->m_interface ? qos->m_interface : &gv->interfaces[0];
 
+  /* Every raw socket gets a copy of all packets, so they can't share the load */
+  if (qos->m_reuse_port)
+    return DDS_RETCODE_UNSUPPORTED;
+
   /* If port is zero, need to create dynamic port */
 
   if (port == 0 || port > 65535)
@@ -396,7 +400,9 @@ static dds_return_t ddsi_raweth_create_conn (struct ddsi_tran_conn **conn_out, s
   uc->m_base.m_base.m_handle_fn = ddsi_raweth_conn_handle;
   uc->m_base.m_locator_fn = ddsi_raweth_conn_locator;
   uc->m_base.m_read_fn = ddsi_raweth_conn_read;
+  uc->m_base.m_read_multiple_fn = 0;
   uc->m_base.m_write_fn = ddsi_raweth_conn_write;
+  uc->m_base.m_write_multiple_fn = 0;
   uc->m_base.m_disable_multiplexing_fn = 0;
 
   DDS_CTRACE (&fact->gv->logconfig, "ddsi_raweth_create_conn %s socket %d port %u\n", mcast ? "multicast" : "unicast", uc->m_sockext.sock, uc->m_base.m_base.m_port);
@@ -585,6 +591,10 @@ static dds_return_t ddsi_raweth_create_conn (struct ddsi_tran_conn **conn_out, s
   struct ddsi_network_interface const * const intf = qos->m_interface ? qos->m_interface : &gv->interfaces[0];
   uint32_t buflen;
 
+  /* Every raw socket gets a copy of all packets, so they can't share the load */
+  if (qos->m_reuse_port)
+    return DDS_RETCODE_UNSUPPORTED;
+
   if (port == 0 || port > 65535)
   {
     DDS_CERROR (&fact->gv->logconfig, "ddsi_raweth_create_conn %s port %u - using port number as ethernet type, %u won't do\n", mcast ? "multicast" : "unicast", port, port);
@@ -679,7 +689,9 @@ static dds_return_t ddsi_raweth_create_conn (struct ddsi_tran_conn **conn_out, s
   uc->m_base.m_base.m_handle_fn = ddsi_raweth_conn_handle;
   uc->m_base.m_locator_fn = ddsi_raweth_conn_locator;
   uc->m_base.m_read_fn = ddsi_raweth_conn_read;
+  uc->m_base.m_read_multiple_fn = 0;
   uc->m_base.m_write_fn = ddsi_raweth_conn_write;
+  uc->m_base.m_write_multiple_fn = 0;
   uc->m_base.m_disable_multiplexing_fn = 0;
   uc->buffer = ddsrt_malloc(buflen);
   uc->buflen = buflen;
@@ -31,6 +31,7 @@
 #include "ddsi__misc.h"
 #include "ddsi__bswap.h"
 #include "ddsi__lat_estim.h"
+#include "ddsi__congestion.h"
 #include "ddsi__bitset.h"
 #include "ddsi__xevent.h"
 #include "ddsi__addrset.h"
@@ -884,6 +885,36 @@ static int handle_AckNack (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
     }
   }
 
+  /* Round-trip time estimate for pacing heartbeats and retransmits: at most one sample
+     per heartbeat that requested an ack, taken from the first AckNack accepted after it.
+     The timestamp echoed by the reader is accurate, but only Cyclone DDS readers do that
+     and only if configured to.  Otherwise, following Karn's rule, there is no sample if
+     more than one such heartbeat went out since the previous AckNack: there is then no
+     telling which one it answers, and assuming the latest one underestimates the rtt,
+     which in turn would make the writer request acks even more often. */
+  if (!is_preemptive_ack && wr->hbcontrol.ackhbs != rn->rtt_ackhbs)
+  {
+    const bool echoed = rst->gv->config.meas_hb_to_ack_latency && timestamp.v;
+    if (echoed || wr->hbcontrol.ackhbs - rn->rtt_ackhbs == 1)
+    {
+      int64_t sample;
+      if (echoed)
+        sample = ddsrt_time_wallclock ().v - timestamp.v;
+      else
+        sample = ddsrt_time_monotonic ().v - wr->hbcontrol.t_of_last_ackhb.v;
+      ddsi_rtt_estim_update (&rn->rtt, sample);
+      ddsrt_avl_augment_update (&ddsi_wr_readers_treedef, rn);
+      RSTTRACE (" rtt %"PRId64"/%"PRId64, rn->rtt.srtt, rn->rtt.rttvar);
+    }
+    rn->rtt_ackhbs = wr->hbcontrol.ackhbs;
+  }
+
+  /* A retransmit request from a reader that was in sync means data got lost on
+     the way, which is what the congestion window reacts to.  Readers still catching
+     up on historical data request retransmits as a matter of course. */
+  if (!is_pure_ack && !is_preemptive_ack && rn->assumed_in_sync && ddsi_congestion_enabled (wr))
+    ddsi_congestion_note_loss (wr, ddsrt_time_monotonic ());
+
   /* First, the ACK part: if the AckNack advances the highest sequence
      number ack'd by the remote reader, update state & try dropping
      some messages */
@@ -1011,6 +1042,12 @@ static int handle_AckNack (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
   const bool gap_for_already_acked = ddsi_vendor_is_eclipse (rst->vendor) && prd->c.xqos->durability.kind == DDS_DURABILITY_VOLATILE && seqbase <= rn->seq;
   const ddsi_seqno_t min_seq_to_rexmit = gap_for_already_acked ? rn->seq + 1 : 0;
   uint32_t limit = wr->rexmit_burst_size_limit;
+  if (ddsi_congestion_enabled (wr) && wr->cc.cwnd < limit)
+    limit = wr->cc.cwnd;
+  /* a NACK arriving within one round-trip time of a retransmit most likely crossed it */
+  int64_t merging_period = rst->gv->config.retransmit_merging_period;
+  if (rst->gv->config.adaptive_heartbeat && rn->rtt.srtt > merging_period)
+    merging_period = rn->rtt.srtt;
   for (uint32_t i = 0; i < numbits && seqbase + i <= seq_xmit && enqueued && limit > 0; i++)
   {
     /* Accelerated schedule may run ahead of sequence number set
@@ -1030,7 +1067,7 @@ static int handle_AckNack (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
         {
           /* send retransmit to all receivers, but skip if recently done */
           ddsrt_mtime_t tstamp = ddsrt_time_monotonic ();
-          if (tstamp.v > sample.last_rexmit_ts.v + rst->gv->config.retransmit_merging_period)
+          if (tstamp.v > sample.last_rexmit_ts.v + merging_period)
           {
             RSTTRACE (" RX%"PRIu64, seqbase + i);
             enqueued = (ddsi_enqueue_sample_wrlock_held (wr, seq, sample.serdata, NULL, 0) >= 0);
@@ -1663,13 +1700,19 @@ static int handle_NackFrag (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
   }
   RSTTRACE (" "PGUIDFMT" -> "PGUIDFMT"", PGUID (src), PGUID (dst));
 
+  if (rn->assumed_in_sync && ddsi_congestion_enabled (wr))
+    ddsi_congestion_note_loss (wr, ddsrt_time_monotonic ());
+
   /* Resend the requested fragments if we still have the sample, send
      a Gap if we don't have them anymore. */
   if (ddsi_whc_borrow_sample (wr->whc, seq, &sample))
   {
     const uint32_t base = msg->fragmentNumberState.bitmap_base - 1;
     assert (wr->rexmit_burst_size_limit <= UINT32_MAX - UINT16_MAX);
-    uint32_t nfrags_lim = (wr->rexmit_burst_size_limit + wr->e.gv->config.fragment_size - 1) / wr->e.gv->config.fragment_size;
+    uint32_t burst_limit = wr->rexmit_burst_size_limit;
+    if (ddsi_congestion_enabled (wr) && wr->cc.cwnd < burst_limit)
+      burst_limit = wr->cc.cwnd;
+    uint32_t nfrags_lim = (burst_limit + wr->e.gv->config.fragment_size - 1) / wr->e.gv->config.fragment_size;
     bool sent = false;
     RSTTRACE (" scheduling requested frags ...\n");
     for (uint32_t i = 0; i < msg->fragmentNumberState.numbits && nfrags_lim > 0; i++)
@@ -2046,7 +2089,16 @@ static struct ddsi_serdata *remote_make_sample (struct ddsi_tkmap_instance **tk,
                   si->data_smhdr_flags, sampleinfo->size);
       return NULL;
     }
-    sample = get_serdata (type, fragchain, sampleinfo->size, 0, statusinfo, tstamp);
+    if (sampleinfo->assembled && sampleinfo->assembled->type == type)
+    {
+      /* defragmented directly into a serdata of the right type, with statusinfo
+         and timestamp already set: no need to copy it yet again */
+      sample = ddsi_serdata_ref (sampleinfo->assembled);
+    }
+    else
+    {
+      sample = get_serdata (type, fragchain, sampleinfo->size, 0, statusinfo, tstamp);
+    }
   }
   else if (sampleinfo->size)
   {
@@ -2324,7 +2376,16 @@ static void clean_defrag (struct ddsi_proxy_writer *pwr)
   ddsi_defrag_notegap (pwr->defrag, 1, seq);
 }
 
-static void handle_regular (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow, struct ddsi_rmsg *rmsg, const ddsi_rtps_data_datafrag_common_t *msg, const struct ddsi_rsample_info *sampleinfo,
+static const struct ddsi_sertype *defrag_assembly_type (struct ddsi_proxy_writer *pwr)
+{
+  /* Defragmenting directly into a serdata only pays off if all local readers
+     can use it, i.e., if they all use the same sertype.  That is maintained in
+     the reader array on (un)matching, so this is cheap enough to do for every
+     fragment.  The type remains valid because the receive thread is awake. */
+  return ddsrt_atomic_ldvoidp (&pwr->rdary.single_type);
+}
+
+static void handle_regular (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow, struct ddsi_rmsg *rmsg, const ddsi_rtps_data_datafrag_common_t *msg, struct ddsi_rsample_info *sampleinfo,
     uint32_t max_fragnum_in_msg, struct ddsi_rdata *rdata, struct ddsi_dqueue **deferred_wakeup, bool renew_manbypp_lease)
 {
   struct ddsi_proxy_writer *pwr;
@@ -2407,6 +2468,9 @@ static void handle_regular (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
 
   clean_defrag (pwr);
 
+  if (sampleinfo->size >= rst->gv->config.direct_defrag_min_size && rdata->maxp1 - rdata->min < sampleinfo->size)
+    sampleinfo->assembly_type = defrag_assembly_type (pwr);
+
   if ((rsample = ddsi_defrag_rsample (pwr->defrag, rdata, sampleinfo)) != NULL)
   {
     int refc_adjust = 0;
@@ -3172,6 +3236,8 @@ static int handle_submsg_sequence
         } else {
           sampleinfo.timestamp = timestamp;
           sampleinfo.reception_timestamp = tnowWC;
+          sampleinfo.assembly_type = NULL;
+          sampleinfo.assembled = NULL;
           handle_DataFrag (rst, tnowE, rmsg, &sm->datafrag, submsg_len, &sampleinfo, keyhash, datap, &deferred_wakeup, prev_smid);
           rst_live = 1;
         }
@@ -3193,6 +3259,8 @@ static int handle_submsg_sequence
         } else {
           sampleinfo.timestamp = timestamp;
           sampleinfo.reception_timestamp = tnowWC;
+          sampleinfo.assembly_type = NULL;
+          sampleinfo.assembled = NULL;
           handle_Data (rst, tnowE, rmsg, &sm->data, submsg_len, &sampleinfo, keyhash, datap, &deferred_wakeup, prev_smid);
           rst_live = 1;
         }
@@ -3358,14 +3426,109 @@ framing_error:
   return DDS_RETCODE_ERROR;
 }
 
-static bool do_packet (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool)
+static size_t max_packet_size (const struct ddsi_domaingv *gv)
 {
   /* UDP max packet size is 64kB, we always limit RTPS messages always to 64kB */
-  const size_t maxsz = gv->config.rmsg_chunk_size < 65536 ? gv->config.rmsg_chunk_size : 65536;
+  return gv->config.rmsg_chunk_size < 65536 ? gv->config.rmsg_chunk_size : 65536;
+}
+
+// Internal/ReceiveBatchSize allows up to 32
+DDSRT_STATIC_ASSERT (DDSI_TRAN_READ_MULTIPLE_MAX >= 32);
+
+struct recv_batch {
+  size_t maxn;
+  size_t maxsz;
+  /* Staging area for packets 1 .. maxn-1 of a batch, packet 0 always goes
+     directly into a receive buffer */
+  unsigned char *stage;
+  struct ddsi_network_packet_info pktinfo[DDSI_TRAN_READ_MULTIPLE_MAX];
+  size_t sz[DDSI_TRAN_READ_MULTIPLE_MAX];
+};
+
+static struct recv_batch *recv_batch_new (const struct ddsi_domaingv *gv)
+{
+  if (gv->config.recv_batch_size <= 1)
+    return NULL;
+  struct recv_batch *batch = ddsrt_malloc (sizeof (*batch));
+  batch->maxn = (size_t) gv->config.recv_batch_size;
+  batch->maxsz = max_packet_size (gv);
+  batch->stage = ddsrt_malloc ((batch->maxn - 1) * batch->maxsz);
+  return batch;
+}
+
+static void recv_batch_free (struct recv_batch *batch)
+{
+  if (batch)
+  {
+    ddsrt_free (batch->stage);
+    ddsrt_free (batch);
+  }
+}
+
+static void recv_thread_stats_update (struct ddsi_recv_thread_stats *stats, size_t npackets)
+{
+  /* only the receive thread itself updates these, so there is no need for
+     atomic read-modify-write operations, atomic loads/stores suffice to
+     allow reading them from other threads */
+  ddsrt_atomic_st64 (&stats->reads, ddsrt_atomic_ld64 (&stats->reads) + 1);
+  ddsrt_atomic_st64 (&stats->packets, ddsrt_atomic_ld64 (&stats->packets) + npackets);
+}
+
+static bool do_packet_batch (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool, struct recv_batch *batch, struct ddsi_recv_thread_stats *stats)
+{
+  unsigned char *bufs[DDSI_TRAN_READ_MULTIPLE_MAX];
+  size_t npackets;
+  dds_return_t rc;
+
+  /* Only one uncommitted rmsg can exist in a pool at any time, because the
+     processing of a message allocates memory directly following the payload.
+     So the first packet is received directly into an rmsg, the others into
+     the staging area, from where they get copied into a fresh rmsg once the
+     preceding one has been committed. */
+  struct ddsi_rmsg *rmsg = ddsi_rmsg_new (rbpool);
+  if (rmsg == NULL)
+    return false;
+  bufs[0] = DDSI_RMSG_PAYLOAD (rmsg);
+  for (size_t i = 1; i < batch->maxn; i++)
+    bufs[i] = batch->stage + (i - 1) * batch->maxsz;
+
+  rc = ddsi_conn_read_multiple (conn, batch->maxn, bufs, batch->maxsz, true, batch->pktinfo, batch->sz, &npackets);
+  if (rc != DDS_RETCODE_OK || npackets == 0)
+  {
+    ddsi_rmsg_commit (rmsg);
+    return false;
+  }
+
+  recv_thread_stats_update (stats, npackets);
+  for (size_t i = 0; i < npackets; i++)
+  {
+    const size_t sz = (batch->sz[i] < batch->maxsz) ? batch->sz[i] : batch->maxsz;
+    if (i > 0)
+    {
+      if ((rmsg = ddsi_rmsg_new (rbpool)) == NULL)
+        return false;
+      memcpy (DDSI_RMSG_PAYLOAD (rmsg), bufs[i], sz);
+    }
+    if (sz > 0 && !gv->deaf)
+    {
+      ddsi_rmsg_setsize (rmsg, (uint32_t) sz);
+      handle_rtps_message (thrst, gv, conn, guidprefix, rbpool, rmsg, sz, &batch->pktinfo[i]);
+    }
+    ddsi_rmsg_commit (rmsg);
+  }
+  return true;
+}
+
+static bool do_packet (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool, struct recv_batch *batch, struct ddsi_recv_thread_stats *stats)
+{
+  const size_t maxsz = max_packet_size (gv);
   struct ddsi_network_packet_info pktinfo;
   size_t sz;
   dds_return_t rc;
 
+  if (batch && !conn->m_stream && ddsi_conn_supports_read_multiple (conn))
+    return do_packet_batch (thrst, gv, conn, guidprefix, rbpool, batch, stats);
+
   struct ddsi_rmsg * const rmsg = ddsi_rmsg_new (rbpool);
   if (rmsg == NULL)
     return false;
@@ -3379,6 +3542,8 @@ static bool do_packet (struct ddsi_thread_state * const thrst, struct ddsi_domai
     rc = DDS_RETCODE_OK;
     sz = 0;
   }
+  if (rc == DDS_RETCODE_OK && sz > 0)
+    recv_thread_stats_update (stats, 1);
   if (rc == DDS_RETCODE_OK && sz > 0 && !gv->deaf)
   {
     ddsi_rmsg_setsize (rmsg, (uint32_t) sz);
@@ -3540,8 +3705,12 @@ static int recv_thread_waitset_add_conn (struct ddsi_sock_waitset * ws, struct d
   {
     struct ddsi_domaingv *gv = conn->m_base.gv;
     for (uint32_t i = 0; i < gv->n_recv_threads; i++)
+    {
       if (gv->recv_threads[i].arg.mode == DDSI_RTM_SINGLE && gv->recv_threads[i].arg.u.single.conn == conn)
         return 0;
+      if (gv->recv_threads[i].arg.mode == DDSI_RTM_SHARD && gv->recv_threads[i].arg.u.shard.conn == conn)
+        return 0;
+    }
     return ddsi_sock_waitset_add (ws, conn);
   }
 }
@@ -3569,6 +3738,11 @@ void ddsi_trigger_recv_threads (const struct ddsi_domaingv *gv)
         ddsi_sock_waitset_trigger (gv->recv_threads[i].arg.u.many.ws);
         break;
       }
+      case DDSI_RTM_SHARD: {
+        GVTRACE ("ddsi_trigger_recv_threads: %"PRIu32" shard %p\n", i, (void *) gv->recv_threads[i].arg.u.shard.ws);
+        ddsi_sock_waitset_trigger (gv->recv_threads[i].arg.u.shard.ws);
+        break;
+      }
     }
   }
 }
@@ -3580,16 +3754,33 @@ uint32_t ddsi_recv_thread (void *vrecv_thread_arg)
   struct ddsi_domaingv * const gv = recv_thread_arg->gv;
   struct ddsi_rbufpool *rbpool = recv_thread_arg->rbpool;
   struct ddsi_sock_waitset * waitset = recv_thread_arg->mode == DDSI_RTM_MANY ? recv_thread_arg->u.many.ws : NULL;
+  struct ddsi_recv_thread_stats * const stats = &recv_thread_arg->stats;
+  struct recv_batch * const batch = recv_batch_new (gv);
   ddsrt_mtime_t next_thread_cputime = { 0 };
 
   ddsi_rbufpool_setowner (rbpool, ddsrt_thread_self ());
-  if (waitset == NULL)
+  if (recv_thread_arg->mode == DDSI_RTM_SINGLE)
   {
     struct ddsi_tran_conn *conn = recv_thread_arg->u.single.conn;
     while (ddsrt_atomic_ld32 (&gv->rtps_keepgoing))
     {
       LOG_THREAD_CPUTIME (&gv->logconfig, next_thread_cputime);
-      (void) do_packet (thrst, gv, conn, NULL, rbpool);
+      (void) do_packet (thrst, gv, conn, NULL, rbpool, batch, stats);
+    }
+  }
+  else if (recv_thread_arg->mode == DDSI_RTM_SHARD)
+  {
+    /* The waitset contains just the one socket, it exists only so the thread can be triggered */
+    struct ddsi_sock_waitset_ctx * ctx;
+    while (ddsrt_atomic_ld32 (&gv->rtps_keepgoing))
+    {
+      LOG_THREAD_CPUTIME (&gv->logconfig, next_thread_cputime);
+      if ((ctx = ddsi_sock_waitset_wait (recv_thread_arg->u.shard.ws)) != NULL)
+      {
+        struct ddsi_tran_conn * conn;
+        while (ddsi_sock_waitset_next_event (ctx, &conn) >= 0)
+          (void) do_packet (thrst, gv, conn, NULL, rbpool, batch, stats);
+      }
     }
   }
   else
@@ -3667,7 +3858,7 @@ uint32_t ddsi_recv_thread (void *vrecv_thread_arg)
           else
             guid_prefix = &lps.ps[(unsigned)idx - num_fixed].guid_prefix;
           /* Process message and clean out connection if failed or closed */
-          if (!do_packet (thrst, gv, conn, guid_prefix, rbpool) && !conn->m_connless)
+          if (!do_packet (thrst, gv, conn, guid_prefix, rbpool, batch, stats) && !conn->m_connless)
             ddsi_conn_free (conn);
         }
       }
@@ -3675,6 +3866,7 @@ uint32_t ddsi_recv_thread (void *vrecv_thread_arg)
     local_participant_set_fini (&lps);
   }
 
+  recv_batch_free (batch);
   GVTRACE ("done\n");
   return 0;
 }
@@ -68,6 +68,8 @@ DDS_EXPORT extern inline void ddsi_serdata_unref (struct ddsi_serdata *serdata);
 DDS_EXPORT extern inline uint32_t ddsi_serdata_size (const struct ddsi_serdata *d);
 DDS_EXPORT extern inline struct ddsi_serdata *ddsi_serdata_from_ser (const struct ddsi_sertype *type, enum ddsi_serdata_kind kind, const struct ddsi_rdata *fragchain, size_t size);
 DDS_EXPORT extern inline struct ddsi_serdata *ddsi_serdata_from_ser_iov (const struct ddsi_sertype *type, enum ddsi_serdata_kind kind, ddsrt_msg_iovlen_t niov, const ddsrt_iovec_t *iov, size_t size);
+DDS_EXPORT extern inline struct ddsi_serdata *ddsi_serdata_from_ser_prealloc (const struct ddsi_sertype *type, enum ddsi_serdata_kind kind, size_t size, void **buf);
+DDS_EXPORT extern inline struct ddsi_serdata *ddsi_serdata_from_ser_finish (struct ddsi_serdata *d);
 DDS_EXPORT extern inline struct ddsi_serdata *ddsi_serdata_from_keyhash (const struct ddsi_sertype *type, const struct ddsi_keyhash *keyhash);
 DDS_EXPORT extern inline struct ddsi_serdata *ddsi_serdata_from_sample (const struct ddsi_sertype *type, enum ddsi_serdata_kind kind, const void *sample);
 DDS_EXPORT extern inline struct ddsi_serdata *ddsi_serdata_to_untyped (const struct ddsi_serdata *d);
@@ -12,6 +12,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "dds/config.h"
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/sockets.h"
 #include "dds/ddsrt/sync.h"
@@ -106,11 +107,13 @@ static int add_entry_locked (struct ddsi_sock_waitset * ws, struct ddsi_tran_con
   return 1;
 }
 
-struct ddsi_sock_waitset * ddsi_sock_waitset_new (void)
+struct ddsi_sock_waitset * ddsi_sock_waitset_new (enum ddsi_sock_waitset_mode mode)
 {
   const uint32_t sz = WAITSET_DELTA;
   struct ddsi_sock_waitset * ws;
   uint32_t i;
+  if (mode != DDSI_SOCK_WAITSET_DEFAULT)
+    goto fail_waitset;
   if ((ws = ddsrt_malloc (sizeof (*ws))) == NULL)
     goto fail_waitset;
   ddsrt_atomic_st32 (&ws->sz, sz);
@@ -291,6 +294,14 @@ int ddsi_sock_waitset_next_event (struct ddsi_sock_waitset_ctx * ctx, struct dds
 #include <fcntl.h>
 #include <sys/epoll.h>
 
+#if DDSRT_HAVE_IO_URING
+#include "dds/ddsrt/endian.h"
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
 struct ddsi_sock_waitset_ctx
 {
   struct epoll_event *evs;
@@ -301,13 +312,17 @@ struct ddsi_sock_waitset_ctx
 
 struct entry {
   uint32_t index;
+  uint32_t gen; /* io_uring: distinguishes completions for a previous use of the slot */
   int fd;
   struct ddsi_tran_conn * conn;
 };
 
+struct uring;
+
 struct ddsi_sock_waitset
 {
-  int epfd;
+  int epfd; /* -1 when using io_uring */
+  struct uring *uring; /* NULL when using epoll */
   int pipe[2]; /* pipe used for triggering */
   ddsrt_atomic_uint32_t sz;
   struct entry *entries;
@@ -315,6 +330,281 @@ struct ddsi_sock_waitset
   ddsrt_mutex_t lock; /* for add/delete */
 };
 
+#if DDSRT_HAVE_IO_URING
+
+/* The io_uring variant uses one-shot poll requests rather than multishot ones, because
+   a multishot poll only produces a completion when new data arrives and the receive
+   thread need not drain a socket when handling an event.  Polls that completed are
+   re-armed on the next call to wait, in the same system call as the one used for
+   waiting, so the number of system calls is the same as for epoll.
+
+   All submissions are done while holding the waitset lock, only the thread handling
+   the events consumes completions.  Failing to queue a request (which can only happen
+   if the kernel refuses to consume the submission queue) is not fatal: re-arms stay
+   in the list of fired polls and removes are remembered, and both are retried on the
+   next call to wait. */
+
+#define URING_SQ_ENTRIES 64u
+#define URING_CQ_ENTRIES 256u
+#define URING_UDATA_IGNORE UINT64_MAX /* for requests of which the completion is irrelevant */
+
+struct uring {
+  int fd;
+  void *ring;
+  size_t ring_sz;
+  struct io_uring_sqe *sqes;
+  size_t sqes_sz;
+  uint32_t *sq_head, *sq_tail, *sq_array, sq_mask, sq_entries;
+  uint32_t *cq_head, *cq_tail, cq_mask;
+  struct io_uring_cqe *cqes;
+  uint64_t *fired; /* user data of the polls that completed in the last call to wait */
+  uint32_t nfired, fired_sz;
+  uint64_t *removes; /* user data of the polls for which queueing a remove failed */
+  uint32_t nremoves, removes_sz;
+};
+
+static uint64_t uring_udata (uint32_t idx, uint32_t gen)
+{
+  return ((uint64_t) gen << 32) | idx;
+}
+
+static int uring_enter (const struct uring *r, uint32_t to_submit, uint32_t min_complete, uint32_t flags)
+{
+  return (int) syscall (__NR_io_uring_enter, r->fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static uint32_t uring_sq_queued (const struct uring *r)
+{
+  return *r->sq_tail - __atomic_load_n (r->sq_head, __ATOMIC_ACQUIRE);
+}
+
+static struct uring *uring_new (void)
+{
+  struct io_uring_params p;
+  struct uring *r;
+  memset (&p, 0, sizeof (p));
+  p.flags = IORING_SETUP_CQSIZE;
+  p.cq_entries = URING_CQ_ENTRIES;
+  if ((r = ddsrt_malloc (sizeof (*r))) == NULL)
+    goto fail_uring;
+  if ((r->fd = (int) syscall (__NR_io_uring_setup, URING_SQ_ENTRIES, &p)) == -1)
+    goto fail_setup;
+  /* single mmap and no dropped completions are available since Linux 5.5; the headers
+     may be newer than the kernel, so check at run time */
+  if (!(p.features & IORING_FEAT_SINGLE_MMAP) || !(p.features & IORING_FEAT_NODROP))
+    goto fail_features;
+  const size_t sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof (uint32_t);
+  const size_t cq_ring_sz = p.cq_off.cqes + p.cq_entries * sizeof (struct io_uring_cqe);
+  r->ring_sz = (sq_ring_sz > cq_ring_sz) ? sq_ring_sz : cq_ring_sz;
+  if ((r->ring = mmap (NULL, r->ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING)) == MAP_FAILED)
+    goto fail_ring;
+  r->sqes_sz = p.sq_entries * sizeof (struct io_uring_sqe);
+  if ((r->sqes = mmap (NULL, r->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES)) == MAP_FAILED)
+    goto fail_sqes;
+  char * const ring = r->ring;
+  r->sq_head = (uint32_t *) (ring + p.sq_off.head);
+  r->sq_tail = (uint32_t *) (ring + p.sq_off.tail);
+  r->sq_array = (uint32_t *) (ring + p.sq_off.array);
+  r->sq_mask = *(uint32_t *) (ring + p.sq_off.ring_mask);
+  r->sq_entries = p.sq_entries;
+  r->cq_head = (uint32_t *) (ring + p.cq_off.head);
+  r->cq_tail = (uint32_t *) (ring + p.cq_off.tail);
+  r->cq_mask = *(uint32_t *) (ring + p.cq_off.ring_mask);
+  r->cqes = (struct io_uring_cqe *) (ring + p.cq_off.cqes);
+  r->fired = NULL;
+  r->nfired = r->fired_sz = 0;
+  r->removes = NULL;
+  r->nremoves = r->removes_sz = 0;
+  return r;
+
+fail_sqes:
+  munmap (r->ring, r->ring_sz);
+fail_ring:
+fail_features:
+  close (r->fd);
+fail_setup:
+  ddsrt_free (r);
+fail_uring:
+  return NULL;
+}
+
+static void uring_free (struct uring *r)
+{
+  /* closing the ring cancels all outstanding requests */
+  munmap (r->sqes, r->sqes_sz);
+  munmap (r->ring, r->ring_sz);
+  close (r->fd);
+  ddsrt_free (r->fired);
+  ddsrt_free (r->removes);
+  ddsrt_free (r);
+}
+
+static struct io_uring_sqe *uring_get_sqe_locked (struct uring *r)
+{
+  /* no other thread can add requests, but kernel may need some persuasion to consume them */
+  while (uring_sq_queued (r) == r->sq_entries)
+  {
+    if (uring_enter (r, r->sq_entries, 0, 0) < 0 && errno != EINTR)
+      return NULL;
+  }
+  const uint32_t tail = *r->sq_tail;
+  struct io_uring_sqe * const sqe = &r->sqes[tail & r->sq_mask];
+  memset (sqe, 0, sizeof (*sqe));
+  r->sq_array[tail & r->sq_mask] = tail & r->sq_mask;
+  return sqe;
+}
+
+static void uring_commit_sqe_locked (struct uring *r)
+{
+  __atomic_store_n (r->sq_tail, *r->sq_tail + 1, __ATOMIC_RELEASE);
+}
+
+static int uring_push_poll_add_locked (struct uring *r, int fd, uint64_t udata)
+{
+  struct io_uring_sqe *sqe;
+  if ((sqe = uring_get_sqe_locked (r)) == NULL)
+    return -1;
+  uint32_t mask = POLLIN;
+#if DDSRT_ENDIAN == DDSRT_BIG_ENDIAN
+  mask = (mask << 16) | (mask >> 16);
+#endif
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = mask;
+  sqe->user_data = udata;
+  uring_commit_sqe_locked (r);
+  return 0;
+}
+
+static int uring_push_poll_remove_locked (struct uring *r, uint64_t udata)
+{
+  struct io_uring_sqe *sqe;
+  if ((sqe = uring_get_sqe_locked (r)) == NULL)
+    return -1;
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = udata;
+  sqe->user_data = URING_UDATA_IGNORE;
+  uring_commit_sqe_locked (r);
+  return 0;
+}
+
+static int uring_submit_locked (struct uring *r)
+{
+  const uint32_t n = uring_sq_queued (r);
+  if (n > 0 && uring_enter (r, n, 0, 0) < 0 && errno != EINTR)
+    return -1;
+  return 0;
+}
+
+static void uring_submit_or_defer_locked (struct ddsi_sock_waitset * ws)
+{
+  /* the waiting thread would submit it too, but there's no telling when that'll happen
+     unless it is woken up */
+  if (uring_submit_locked (ws->uring) < 0)
+    ddsi_sock_waitset_trigger (ws);
+}
+
+static int uring_add_entry_locked (struct ddsi_sock_waitset * ws, uint32_t idx, int fd)
+{
+  struct uring * const r = ws->uring;
+  ws->entries[idx].gen++;
+  if (uring_push_poll_add_locked (r, fd, uring_udata (idx, ws->entries[idx].gen)) < 0)
+    return -1;
+  uring_submit_or_defer_locked (ws);
+  return 0;
+}
+
+static void uring_remove_entry_locked (struct ddsi_sock_waitset * ws, uint32_t idx)
+{
+  struct uring * const r = ws->uring;
+  const uint64_t udata = uring_udata (idx, ws->entries[idx].gen);
+  /* failure of the remove itself is fine if the poll already completed: it won't be
+     re-armed because the entry no longer matches */
+  if (uring_push_poll_remove_locked (r, udata) < 0)
+  {
+    if (r->nremoves == r->removes_sz)
+    {
+      r->removes_sz = (r->removes_sz == 0) ? WAITSET_DELTA : 2 * r->removes_sz;
+      r->removes = ddsrt_realloc (r->removes, r->removes_sz * sizeof (*r->removes));
+    }
+    r->removes[r->nremoves++] = udata;
+    ddsi_sock_waitset_trigger (ws);
+  }
+  ws->entries[idx].fd = -1;
+  ws->entries[idx].conn = NULL;
+}
+
+static int uring_wait (struct ddsi_sock_waitset * ws)
+{
+  struct uring * const r = ws->uring;
+  uint32_t sz, to_submit, n = 0;
+
+  ddsrt_mutex_lock (&ws->lock);
+  sz = ddsrt_atomic_ld32 (&ws->sz);
+  uint32_t i = 0, nleft = 0;
+  for (; i < r->nremoves; i++)
+    if (uring_push_poll_remove_locked (r, r->removes[i]) < 0)
+      break;
+  while (i < r->nremoves)
+    r->removes[nleft++] = r->removes[i++];
+  r->nremoves = nleft;
+  /* polls that can't be re-armed now stay at the front of the list of fired polls and
+     new completions get appended */
+  for (i = 0, nleft = 0; i < r->nfired; i++)
+  {
+    const uint32_t idx = (uint32_t) r->fired[i];
+    if (idx < sz && ws->entries[idx].fd >= 0 && uring_udata (idx, ws->entries[idx].gen) == r->fired[i])
+    {
+      if (nleft > 0 || uring_push_poll_add_locked (r, ws->entries[idx].fd, r->fired[i]) < 0)
+        r->fired[nleft++] = r->fired[i];
+    }
+  }
+  r->nfired = nleft;
+  to_submit = uring_sq_queued (r);
+  if (r->fired_sz < ws->ctx.evs_sz)
+  {
+    r->fired_sz = ws->ctx.evs_sz;
+    r->fired = ddsrt_realloc (r->fired, r->fired_sz * sizeof (*r->fired));
+  }
+  ddsrt_mutex_unlock (&ws->lock);
+
+  /* requests added by other threads in the mean time simply get submitted by whichever
+     call gets there first, and anything not submitted is simply submitted next time */
+  if (uring_enter (r, to_submit, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+    return -1;
+
+  ddsrt_mutex_lock (&ws->lock);
+  sz = ddsrt_atomic_ld32 (&ws->sz);
+  uint32_t head = *r->cq_head;
+  const uint32_t tail = __atomic_load_n (r->cq_tail, __ATOMIC_ACQUIRE);
+  /* entries added while waiting can complete too, those that don't fit are left for
+     the next call */
+  for (; head != tail && n < ws->ctx.evs_sz && r->nfired < r->fired_sz; head++)
+  {
+    const struct io_uring_cqe *cqe = &r->cqes[head & r->cq_mask];
+    const uint32_t idx = (uint32_t) cqe->user_data;
+    /* completions of removes and of removed polls are of no interest */
+    if (cqe->user_data == URING_UDATA_IGNORE)
+      continue;
+    if (idx >= sz || ws->entries[idx].fd < 0 || uring_udata (idx, ws->entries[idx].gen) != cqe->user_data)
+      continue;
+    /* the poll of a live entry always gets re-armed; a transient failure is otherwise
+       ignored, any other error is reported as an event so that the error surfaces when
+       the receive thread tries to read from the socket */
+    r->fired[r->nfired++] = cqe->user_data;
+    if (cqe->res == -ECANCELED || cqe->res == -ENOMEM || cqe->res == -EAGAIN || cqe->res == -EINTR)
+      continue;
+    ws->ctx.evs[n].data.ptr = &ws->entries[idx];
+    n++;
+  }
+  __atomic_store_n (r->cq_head, head, __ATOMIC_RELEASE);
+  ddsrt_mutex_unlock (&ws->lock);
+  return (int) n;
+}
+
+#endif /* DDSRT_HAVE_IO_URING */
+
 static int add_entry_locked (struct ddsi_sock_waitset * ws, struct ddsi_tran_conn * conn, int fd)
 {
   uint32_t idx, fidx, sz, n;
@@ -336,45 +626,77 @@ static int add_entry_locked (struct ddsi_sock_waitset * ws, struct ddsi_tran_con
     const uint32_t newsz = ddsrt_atomic_add32_nv (&ws->sz, WAITSET_DELTA);
     ws->entries = ddsrt_realloc (ws->entries, newsz * sizeof (*ws->entries));
     for (idx = sz; idx < newsz; idx++)
+    {
       ws->entries[idx].fd = -1;
+      ws->entries[idx].gen = 0;
+    }
     fidx = sz;
   }
-  ev.events = EPOLLIN;
-  ev.data.ptr = &ws->entries[fidx];
-  if (epoll_ctl (ws->epfd, EPOLL_CTL_ADD, fd, &ev) == -1)
-    return -1;
+#if DDSRT_HAVE_IO_URING
+  if (ws->uring)
+  {
+    if (uring_add_entry_locked (ws, fidx, fd) < 0)
+      return -1;
+  }
+  else
+#endif
+  {
+    ev.events = EPOLLIN;
+    ev.data.ptr = &ws->entries[fidx];
+    if (epoll_ctl (ws->epfd, EPOLL_CTL_ADD, fd, &ev) == -1)
+      return -1;
+  }
   ws->entries[fidx].conn = conn;
   ws->entries[fidx].fd = fd;
   ws->entries[fidx].index = n;
   return 1;
 }
 
-struct ddsi_sock_waitset * ddsi_sock_waitset_new (void)
+struct ddsi_sock_waitset * ddsi_sock_waitset_new (enum ddsi_sock_waitset_mode mode)
 {
   const uint32_t sz = WAITSET_DELTA;
   struct ddsi_sock_waitset * ws;
   uint32_t i;
+#if ! DDSRT_HAVE_IO_URING
+  if (mode != DDSI_SOCK_WAITSET_DEFAULT)
+    goto fail_waitset;
+#endif
   if ((ws = ddsrt_malloc (sizeof (*ws))) == NULL)
     goto fail_waitset;
   ddsrt_atomic_st32 (&ws->sz, sz);
   if ((ws->entries = ddsrt_malloc (sz * sizeof (*ws->entries))) == NULL)
     goto fail_entries;
   for (i = 0; i < sz; i++)
+  {
     ws->entries[i].fd = -1;
+    ws->entries[i].gen = 0;
+  }
   ws->ctx.nevs = 0;
   ws->ctx.index = 0;
   ws->ctx.evs_sz = sz;
   if ((ws->ctx.evs = ddsrt_malloc (ws->ctx.evs_sz * sizeof (*ws->ctx.evs))) == NULL)
     goto fail_ctx_evs;
-  if ((ws->epfd = epoll_create (1)) == -1)
-    goto fail_epoll_create;
+  ws->epfd = -1;
+  ws->uring = NULL;
+#if DDSRT_HAVE_IO_URING
+  if (mode == DDSI_SOCK_WAITSET_IO_URING)
+  {
+    if ((ws->uring = uring_new ()) == NULL)
+      goto fail_epoll_create;
+  }
+  else
+#endif
+  {
+    if ((ws->epfd = epoll_create (1)) == -1)
+      goto fail_epoll_create;
+    if (fcntl (ws->epfd, F_SETFD, fcntl (ws->epfd, F_GETFD) | FD_CLOEXEC) == -1)
+      goto fail_pipe;
+  }
   if (pipe (ws->pipe) == -1)
     goto fail_pipe;
   if (add_entry_locked (ws, NULL, ws->pipe[0]) < 0)
     goto fail_add_trigger;
   assert (ws->entries[0].fd == ws->pipe[0]);
-  if (fcntl (ws->epfd, F_SETFD, fcntl (ws->epfd, F_GETFD) | FD_CLOEXEC) == -1)
-    goto fail_fcntl;
   if (fcntl (ws->pipe[0], F_SETFD, fcntl (ws->pipe[0], F_GETFD) | FD_CLOEXEC) == -1)
     goto fail_fcntl;
   if (fcntl (ws->pipe[1], F_SETFD, fcntl (ws->pipe[1], F_GETFD) | FD_CLOEXEC) == -1)
@@ -387,7 +709,12 @@ fail_add_trigger:
   close (ws->pipe[0]);
   close (ws->pipe[1]);
 fail_pipe:
-  close (ws->epfd);
+#if DDSRT_HAVE_IO_URING
+  if (ws->uring)
+    uring_free (ws->uring);
+#endif
+  if (ws->epfd != -1)
+    close (ws->epfd);
 fail_epoll_create:
   ddsrt_free (ws->ctx.evs);
 fail_ctx_evs:
@@ -401,9 +728,14 @@ fail_waitset:
 void ddsi_sock_waitset_free (struct ddsi_sock_waitset * ws)
 {
   ddsrt_mutex_destroy (&ws->lock);
+#if DDSRT_HAVE_IO_URING
+  if (ws->uring)
+    uring_free (ws->uring);
+#endif
   close (ws->pipe[0]);
   close (ws->pipe[1]);
-  close (ws->epfd);
+  if (ws->epfd != -1)
+    close (ws->epfd);
   ddsrt_free (ws->entries);
   ddsrt_free (ws->ctx.evs);
   ddsrt_free (ws);
@@ -439,18 +771,50 @@ void ddsi_sock_waitset_purge (struct ddsi_sock_waitset * ws, unsigned index)
   struct epoll_event ev;
   ddsrt_mutex_lock (&ws->lock);
   sz = ddsrt_atomic_ld32 (&ws->sz);
-  close (ws->epfd);
-  if ((ws->epfd = epoll_create (1)) == -1)
-    abort (); /* FIXME */
-  for (i = 0; i <= index; i++)
+#if DDSRT_HAVE_IO_URING
+  if (ws->uring)
   {
-    assert (ws->entries[i].fd >= 0);
-    ev.events = EPOLLIN;
-    ev.data.ptr = &ws->entries[i];
-    if (epoll_ctl (ws->epfd, EPOLL_CTL_ADD, ws->entries[i].fd, &ev) == -1)
-      abort (); /* FIXME */
+    /* io_uring polls refer to the file rather than the descriptor, and keep the socket
+       alive until removed, so there is no such problem */
+    for (i = index + 1; i < sz; i++)
+    {
+      if (ws->entries[i].fd >= 0)
+        uring_remove_entry_locked (ws, i);
+    }
+    uring_submit_or_defer_locked (ws);
+    ddsrt_mutex_unlock (&ws->lock);
+    return;
   }
-  for (; i < sz; i++)
+#endif
+  const int epfd = epoll_create (1);
+  if (epfd == -1 || fcntl (epfd, F_SETFD, fcntl (epfd, F_GETFD) | FD_CLOEXEC) == -1)
+  {
+    /* keep the old one, deleting whatever is still in there: closed sockets are gone
+       already and the only risk is that of receiving an event for a reused descriptor
+       if its deletion fails */
+    DDS_WARNING("ddsi_sock_waitset_purge: failed to create epoll descriptor, errno = %d\n", errno);
+    if (epfd != -1)
+      close (epfd);
+    for (i = index + 1; i < sz; i++)
+    {
+      if (ws->entries[i].fd >= 0)
+        (void) epoll_ctl (ws->epfd, EPOLL_CTL_DEL, ws->entries[i].fd, &ev);
+    }
+  }
+  else
+  {
+    close (ws->epfd);
+    ws->epfd = epfd;
+    for (i = 0; i <= index; i++)
+    {
+      assert (ws->entries[i].fd >= 0);
+      ev.events = EPOLLIN;
+      ev.data.ptr = &ws->entries[i];
+      if (epoll_ctl (ws->epfd, EPOLL_CTL_ADD, ws->entries[i].fd, &ev) == -1)
+        DDS_WARNING("ddsi_sock_waitset_purge: epoll_ctl failed for socket %d, errno = %d\n", ws->entries[i].fd, errno);
+    }
+  }
+  for (i = index + 1; i < sz; i++)
   {
     ws->entries[i].conn = NULL;
     ws->entries[i].fd = -1;
@@ -470,11 +834,22 @@ void ddsi_sock_waitset_remove (struct ddsi_sock_waitset * ws, struct ddsi_tran_c
       break;
   if (i < sz)
   {
-    // pre linux 2.6.9, a non-null event pointer was required, contents don't matter
-    struct epoll_event ev;
-    if (epoll_ctl (ws->epfd, EPOLL_CTL_DEL, ws->entries[i].fd, &ev) == -1)
-      abort (); /* FIXME */
-    ws->entries[i].fd = -1;
+#if DDSRT_HAVE_IO_URING
+    if (ws->uring)
+    {
+      uring_remove_entry_locked (ws, i);
+      uring_submit_or_defer_locked (ws);
+    }
+    else
+#endif
+    {
+      // pre linux 2.6.9, a non-null event pointer was required, contents don't matter
+      struct epoll_event ev;
+      // the descriptor is gone from the set if the socket has been closed already
+      if (epoll_ctl (ws->epfd, EPOLL_CTL_DEL, ws->entries[i].fd, &ev) == -1 && errno != EBADF && errno != ENOENT)
+        DDS_WARNING("ddsi_sock_waitset_remove: epoll_ctl failed for socket %d, errno = %d\n", fd, errno);
+      ws->entries[i].fd = -1;
+    }
   }
   ddsrt_mutex_unlock (&ws->lock);
 }
@@ -491,17 +866,30 @@ struct ddsi_sock_waitset_ctx * ddsi_sock_waitset_wait (struct ddsi_sock_waitset
     ws->ctx.evs_sz = ws_sz;
     ws->ctx.evs = ddsrt_realloc (ws->ctx.evs, ws_sz * sizeof(*ws->ctx.evs));
   }
-  nevs = epoll_wait (ws->epfd, ws->ctx.evs, (int)ws->ctx.evs_sz, -1);
-  if (nevs < 0)
+#if DDSRT_HAVE_IO_URING
+  if (ws->uring)
   {
-    if (errno == EINTR)
-      nevs = 0;
-    else
+    if ((nevs = uring_wait (ws)) < 0)
     {
-      DDS_WARNING("ddsi_sock_waitset_wait: kevent failed, errno = %d\n", errno);
+      DDS_WARNING("ddsi_sock_waitset_wait: io_uring_enter failed, errno = %d\n", errno);
       return NULL;
     }
   }
+  else
+#endif
+  {
+    nevs = epoll_wait (ws->epfd, ws->ctx.evs, (int)ws->ctx.evs_sz, -1);
+    if (nevs < 0)
+    {
+      if (errno == EINTR)
+        nevs = 0;
+      else
+      {
+        DDS_WARNING("ddsi_sock_waitset_wait: kevent failed, errno = %d\n", errno);
+        return NULL;
+      }
+    }
+  }
   ws->ctx.nevs = (uint32_t)nevs;
   ws->ctx.index = 0;
   return &ws->ctx;
@@ -546,8 +934,10 @@ struct ddsi_sock_waitset
   struct ddsi_sock_waitset_ctx ctx0;
 };
 
-struct ddsi_sock_waitset * ddsi_sock_waitset_new (void)
+struct ddsi_sock_waitset * ddsi_sock_waitset_new (enum ddsi_sock_waitset_mode mode)
 {
+  if (mode != DDSI_SOCK_WAITSET_DEFAULT)
+    return NULL;
   struct ddsi_sock_waitset * ws = ddsrt_malloc (sizeof (*ws));
   ws->ctx.conns[0] = NULL;
   ws->ctx.events[0] = WSACreateEvent ();
@@ -895,9 +1285,11 @@ static void ddsi_sock_waitset_free_ctx (struct ddsi_sock_waitset_ctx * ctx)
   ddsi_sock_waitset_free_set (&ctx->set);
 }
 
-struct ddsi_sock_waitset * ddsi_sock_waitset_new (void)
+struct ddsi_sock_waitset * ddsi_sock_waitset_new (enum ddsi_sock_waitset_mode mode)
 {
   int result;
+  if (mode != DDSI_SOCK_WAITSET_DEFAULT)
+    return NULL;
   struct ddsi_sock_waitset * ws = ddsrt_malloc (sizeof (*ws));
 
   ddsi_sock_waitset_new_set (&ws->set);
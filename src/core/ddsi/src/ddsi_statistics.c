@@ -18,6 +18,7 @@
 #include "ddsi__endpoint_match.h"
 #include "ddsi__radmin.h"
 #include "ddsi__proxy_endpoint.h"
+#include "ddsi__congestion.h"
 
 void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint32_t *throttle_count, uint64_t *time_throttled, uint64_t *time_retransmit)
 {
@@ -29,6 +30,24 @@ void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint
   ddsrt_mutex_unlock (&wr->e.lock);
 }
 
+void ddsi_get_writer_congestion_stats (struct ddsi_writer *wr, uint32_t *window, uint64_t *rate, uint32_t *loss_events)
+{
+  ddsrt_mutex_lock (&wr->e.lock);
+  if (!ddsi_congestion_enabled (wr))
+  {
+    *window = 0;
+    *rate = 0;
+    *loss_events = 0;
+  }
+  else
+  {
+    *window = wr->cc.cwnd;
+    *rate = wr->cc.rate;
+    *loss_events = wr->cc.loss_events;
+  }
+  ddsrt_mutex_unlock (&wr->e.lock);
+}
+
 void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes)
 {
   struct ddsi_rd_pwr_match *m;
@@ -65,3 +84,56 @@ void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes)
   }
   ddsrt_mutex_unlock (&rd->e.lock);
 }
+
+void ddsi_get_recv_stats (const struct ddsi_domaingv *gv, uint64_t *reads, uint64_t *packets)
+{
+  *reads = *packets = 0;
+  for (uint32_t i = 0; i < gv->n_recv_threads; i++)
+  {
+    *reads += ddsrt_atomic_ld64 (&gv->recv_threads[i].arg.stats.reads);
+    *packets += ddsrt_atomic_ld64 (&gv->recv_threads[i].arg.stats.packets);
+  }
+}
+
+void ddsi_get_xmit_stats (const struct ddsi_domaingv *gv, uint64_t *flushes, uint64_t *packets, uint64_t *syscalls)
+{
+  *flushes = ddsrt_atomic_ld64 (&gv->xmit_stats.flushes);
+  *packets = ddsrt_atomic_ld64 (&gv->xmit_stats.packets);
+  *syscalls = ddsrt_atomic_ld64 (&gv->xmit_stats.syscalls);
+}
+
+void ddsi_get_dqueue_stats (const struct ddsi_domaingv *gv, uint64_t *samples, uint64_t *max_samples, uint64_t *wakeups)
+{
+  // the occupancy limit applies to each delivery queue individually, so report the
+  // largest observed occupancy of any one queue rather than the sum
+  struct ddsi_dqueue * const qs[] = { gv->builtins_dqueue, gv->user_dqueue };
+  *samples = *max_samples = *wakeups = 0;
+  for (size_t i = 0; i < sizeof (qs) / sizeof (qs[0]); i++)
+  {
+    uint32_t n, max;
+    uint64_t w;
+    if (qs[i] == NULL)
+      continue;
+    ddsi_dqueue_stats (qs[i], &n, &max, &w);
+    *samples += n;
+    if (max > *max_samples)
+      *max_samples = max;
+    *wakeups += w;
+  }
+}
+
+void ddsi_get_rbuf_stats (const struct ddsi_domaingv *gv, uint64_t *live_bytes, uint64_t *pinned_bytes, uint64_t *allocs, uint64_t *reuses)
+{
+  *live_bytes = *pinned_bytes = *allocs = *reuses = 0;
+  for (uint32_t i = 0; i < gv->n_recv_threads; i++)
+  {
+    uint64_t l, p, a, r;
+    if (gv->recv_threads[i].arg.rbpool == NULL)
+      continue;
+    ddsi_rbufpool_stats (gv->recv_threads[i].arg.rbpool, &l, &p, &a, &r);
+    *live_bytes += l;
+    *pinned_bytes += p;
+    *allocs += a;
+    *reuses += r;
+  }
+}
@@ -1033,7 +1033,9 @@ static void ddsi_tcp_base_init (const struct ddsi_tran_factory_tcp *fact, const
   base->m_base.m_trantype = DDSI_TRAN_CONN;
   base->m_base.m_handle_fn = ddsi_tcp_conn_handle;
   base->m_read_fn = ddsi_tcp_conn_read;
+  base->m_read_multiple_fn = 0;
   base->m_write_fn = ddsi_tcp_conn_write;
+  base->m_write_multiple_fn = 0;
   base->m_peer_locator_fn = ddsi_tcp_conn_peer_locator;
   base->m_disable_multiplexing_fn = 0;
   base->m_locator_fn = ddsi_tcp_locator;
@@ -36,7 +36,11 @@ extern inline int ddsi_listener_locator (struct ddsi_tran_listener * listener, d
 extern inline int ddsi_listener_listen (struct ddsi_tran_listener * listener);
 extern inline struct ddsi_tran_conn * ddsi_listener_accept (struct ddsi_tran_listener * listener);
 extern inline dds_return_t ddsi_conn_read (struct ddsi_tran_conn * conn, unsigned char * buf, size_t len, bool allow_spurious, struct ddsi_network_packet_info *pktinfo, size_t *bytes_read);
+extern inline bool ddsi_conn_supports_read_multiple (const struct ddsi_tran_conn *conn);
+extern inline dds_return_t ddsi_conn_read_multiple (struct ddsi_tran_conn * conn, size_t n, unsigned char * const *bufs, size_t sz, bool allow_spurious, struct ddsi_network_packet_info *pktinfo, size_t *bytes_read, size_t *npackets);
 extern inline dds_return_t ddsi_conn_write (struct ddsi_tran_conn * conn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags, size_t *bytes_written);
+extern inline bool ddsi_conn_supports_write_multiple (const struct ddsi_tran_conn *conn);
+extern inline dds_return_t ddsi_conn_write_multiple (struct ddsi_tran_conn * conn, size_t n, const ddsi_locator_t *dsts, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags, size_t *nsyscalls);
 extern inline uint32_t ddsi_tran_get_locator_port (const struct ddsi_tran_factory *factory, const ddsi_locator_t *loc);
 extern inline void ddsi_tran_set_locator_port (const struct ddsi_tran_factory *factory, ddsi_locator_t *loc, uint32_t port);
 extern inline uint32_t ddsi_tran_get_locator_aux (const struct ddsi_tran_factory *factory, const ddsi_locator_t *loc);
@@ -151,6 +155,10 @@ void ddsi_conn_free (struct ddsi_tran_conn * conn)
                 if (conn->m_base.gv->recv_threads[i].arg.u.single.conn == conn)
                   abort();
                 break;
+              case DDSI_RTM_SHARD:
+                if (conn->m_base.gv->recv_threads[i].arg.u.shard.conn == conn)
+                  abort();
+                break;
             }
           }
         }
@@ -31,6 +31,7 @@
 #include "ddsi__xevent.h"
 #include "ddsi__transmit.h"
 #include "ddsi__hbcontrol.h"
+#include "ddsi__congestion.h"
 #include "ddsi__receive.h"
 #include "ddsi__lease.h"
 #include "ddsi__security_omg.h"
@@ -421,15 +422,12 @@ static void transmit_sample_lgmsg_unlocks_wr (struct ddsi_xpack *xp, struct ddsi
   }
 }
 
-static void transmit_sample_unlocks_wr (struct ddsi_xpack *xp, struct ddsi_writer *wr, const struct ddsi_whc_state *whcst, ddsi_seqno_t seq, struct ddsi_serdata *serdata, struct ddsi_proxy_reader *prd, int isnew)
+static void transmit_sample_wrlock_held (struct ddsi_xpack *xp, struct ddsi_writer *wr, ddsi_seqno_t seq, struct ddsi_serdata *serdata, struct ddsi_proxy_reader *prd, int isnew)
 {
-  /* on entry: &wr->e.lock held; on exit: lock no longer held */
+  /* on entry and on exit: &wr->e.lock held, but it may be released temporarily for large samples */
   struct ddsi_domaingv const * const gv = wr->e.gv;
-  struct ddsi_xmsg *hmsg = NULL;
-  enum ddsi_hbcontrol_ack_required hbansreq = DDSI_HBC_ACK_REQ_NO;
   uint32_t sz;
   assert(xp);
-  assert((wr->heartbeat_xevent != NULL) == (whcst != NULL));
 
   sz = ddsi_serdata_size (serdata);
   if (sz > gv->config.fragment_size || !isnew || prd != NULL || ddsi_omg_writer_is_submessage_protected (wr))
@@ -452,17 +450,38 @@ static void transmit_sample_unlocks_wr (struct ddsi_xpack *xp, struct ddsi_write
     if (ddsi_create_fragment_message_simple (wr, seq, serdata, &fmsg) >= 0)
       ddsi_xpack_addmsg (xp, fmsg, 0);
   }
+}
+
+static void transmit_heartbeat_unlocks_wr (struct ddsi_xpack *xp, struct ddsi_writer *wr, const struct ddsi_whc_state *whcst, ddsrt_mtime_t twrite)
+{
+  /* on entry: &wr->e.lock held; on exit: lock no longer held */
+  struct ddsi_xmsg *hmsg = NULL;
+  enum ddsi_hbcontrol_ack_required hbansreq = DDSI_HBC_ACK_REQ_NO;
+  assert((wr->heartbeat_xevent != NULL) == (whcst != NULL));
 
   if (wr->heartbeat_xevent)
-    hmsg = ddsi_writer_hbcontrol_piggyback (wr, whcst, serdata->twrite, ddsi_xpack_packetid (xp), &hbansreq);
+    hmsg = ddsi_writer_hbcontrol_piggyback (wr, whcst, twrite, ddsi_xpack_packetid (xp), &hbansreq);
   ddsrt_mutex_unlock (&wr->e.lock);
 
   if(hmsg)
+  {
+    /* a piggybacked heartbeat that doesn't need to go out immediately may be delayed as
+       long as the data it accompanies, else it would defeat coalescing in the send queue */
+    if (hbansreq < DDSI_HBC_ACK_REQ_YES_AND_FLUSH)
+      ddsi_xmsg_setmaxdelay (hmsg, wr->xqos->latency_budget.duration);
     ddsi_xpack_addmsg (xp, hmsg, 0);
+  }
   if (hbansreq >= DDSI_HBC_ACK_REQ_YES_AND_FLUSH)
     ddsi_xpack_send (xp, true);
 }
 
+static void transmit_sample_unlocks_wr (struct ddsi_xpack *xp, struct ddsi_writer *wr, const struct ddsi_whc_state *whcst, ddsi_seqno_t seq, struct ddsi_serdata *serdata, struct ddsi_proxy_reader *prd, int isnew)
+{
+  /* on entry: &wr->e.lock held; on exit: lock no longer held */
+  transmit_sample_wrlock_held (xp, wr, seq, serdata, prd, isnew);
+  transmit_heartbeat_unlocks_wr (xp, wr, whcst, serdata->twrite);
+}
+
 void ddsi_enqueue_spdp_sample_wrlock_held (struct ddsi_writer *wr, ddsi_seqno_t seq, struct ddsi_serdata *serdata, struct ddsi_proxy_reader *prd)
 {
   assert (wr->e.guid.entityid.u == DDSI_ENTITYID_SPDP_BUILTIN_PARTICIPANT_WRITER);
@@ -615,12 +634,29 @@ static int insert_sample_in_whc (struct ddsi_writer *wr, ddsi_seqno_t seq, struc
   return res;
 }
 
+static uint32_t writer_whc_high (const struct ddsi_writer *wr)
+{
+  /* with congestion control, the window may be the tighter limit */
+  if (ddsi_congestion_enabled (wr) && wr->cc.cwnd < wr->whc_high)
+    return wr->cc.cwnd;
+  return wr->whc_high;
+}
+
+static uint32_t writer_whc_low (const struct ddsi_writer *wr)
+{
+  /* waiting until (almost) everything has been acknowledged would leave the
+     network idle for a round trip each time the congestion window fills up */
+  if (ddsi_congestion_enabled (wr) && wr->cc.cwnd < wr->whc_high && wr->cc.cwnd / 2 > wr->whc_low)
+    return wr->cc.cwnd / 2;
+  return wr->whc_low;
+}
+
 static int writer_may_continue (const struct ddsi_writer *wr, const struct ddsi_whc_state *whcst)
 {
-  return (whcst->unacked_bytes <= wr->whc_low && !wr->retransmitting) || (wr->state != WRST_OPERATIONAL);
+  return (whcst->unacked_bytes <= writer_whc_low (wr) && !wr->retransmitting) || (wr->state != WRST_OPERATIONAL);
 }
 
-static dds_return_t throttle_writer (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr)
+static dds_return_t throttle_writer (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, dds_duration_t max_blocking_time)
 {
   /* Sleep (cond_wait) without updating the thread's vtime: the
      garbage collector won't free the writer while we leave it
@@ -658,14 +694,13 @@ static dds_return_t throttle_writer (struct ddsi_thread_state * const thrst, str
   struct ddsi_domaingv const * const gv = wr->e.gv;
   dds_return_t result = DDS_RETCODE_OK;
   const ddsrt_mtime_t throttle_start = ddsrt_time_monotonic ();
-  const ddsrt_mtime_t abstimeout = ddsrt_mtime_add_duration (throttle_start, wr->xqos->reliability.max_blocking_time);
+  const ddsrt_mtime_t abstimeout = ddsrt_mtime_add_duration (throttle_start, max_blocking_time);
   ddsrt_mtime_t tnow = throttle_start;
   struct ddsi_whc_state whcst;
   ddsi_whc_get_state (wr->whc, &whcst);
 
   {
     ASSERT_MUTEX_HELD (&wr->e.lock);
-    assert (wr->throttling == 0);
     assert (ddsi_thread_is_awake ());
     assert (!ddsi_is_builtin_entityid(wr->e.guid.entityid, DDSI_VENDORID_ECLIPSE));
   }
@@ -804,18 +839,9 @@ prd_is_deleting:
   return r;
 }
 
-static int write_sample (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, struct ddsi_serdata *serdata, struct ddsi_tkmap_instance *tk, int gc_allowed)
+static bool sample_size_acceptable (const struct ddsi_writer *wr, const struct ddsi_serdata *serdata)
 {
   struct ddsi_domaingv const * const gv = wr->e.gv;
-  int r;
-  ddsi_seqno_t seq;
-  ddsrt_mtime_t tnow;
-  struct ddsi_lease *lease;
-
-  /* If GC not allowed, we must be sure to never block when writing.  That is only the case for (true, aggressive) KEEP_LAST writers, and also only if there is no limit to how much unacknowledged data the WHC may contain. */
-  assert (gc_allowed || (wr->xqos->history.kind == DDS_HISTORY_KEEP_LAST && wr->whc_low == INT32_MAX));
-  (void) gc_allowed;
-
   if (gv->config.max_sample_size < (uint32_t) INT32_MAX && ddsi_serdata_size (serdata) > gv->config.max_sample_size)
   {
     char ppbuf[1024];
@@ -826,46 +852,120 @@ static int write_sample (struct ddsi_thread_state * const thrst, struct ddsi_xpa
                ddsi_serdata_size (serdata), gv->config.max_sample_size,
                PGUID (wr->e.guid), wr->xqos->topic_name, wr->type->type_name, ppbuf,
                tmp < (int) sizeof (ppbuf) ? "" : " (trunc)");
-    r = DDS_RETCODE_BAD_PARAMETER;
-    goto drop;
+    return false;
   }
+  return true;
+}
 
+static void renew_manual_liveliness (struct ddsi_writer *wr)
+{
+  struct ddsi_lease *lease;
   if (wr->xqos->liveliness.kind == DDS_LIVELINESS_MANUAL_BY_PARTICIPANT && ((lease = ddsrt_atomic_ldvoidp (&wr->c.pp->minl_man)) != NULL))
     ddsi_lease_renew (lease, ddsrt_time_elapsed());
   else if (wr->xqos->liveliness.kind == DDS_LIVELINESS_MANUAL_BY_TOPIC && wr->lease != NULL)
     ddsi_lease_renew (wr->lease, ddsrt_time_elapsed());
+}
+
+static dds_return_t wait_for_whc_space (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, int gc_allowed, dds_duration_t max_blocking_time)
+{
+  /* If WHC overfull, block; on entry and on exit: &wr->e.lock held */
+  struct ddsi_domaingv const * const gv = wr->e.gv;
+  struct ddsi_whc_state whcst;
+  dds_return_t ores = DDS_RETCODE_OK;
+  ddsi_whc_get_state(wr->whc, &whcst);
+  if (whcst.unacked_bytes > writer_whc_high (wr))
+  {
+    assert(gc_allowed); /* also see beginning of write_sample */
+    (void) gc_allowed;
+    if (gv->config.prioritize_retransmit && wr->retransmitting)
+      ores = throttle_writer (thrst, xp, wr, max_blocking_time);
+    else
+    {
+      maybe_grow_whc (wr);
+      if (whcst.unacked_bytes > writer_whc_high (wr))
+        ores = throttle_writer (thrst, xp, wr, max_blocking_time);
+    }
+  }
+  return ores;
+}
+
+static void pace_writer (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, dds_duration_t max_blocking_time)
+{
+  /* If congestion control says new data can't go out yet, push out whatever is
+     pending and wait; on entry and on exit: &wr->e.lock held.  Delays shorter
+     than a millisecond are not worth waiting for, and the delay is bounded by
+     max_blocking_time like any other blocking in the write path.  The wait is
+     the same as in throttle_writer: asleep, so as not to hold up the garbage
+     collector, with "throttling" set, so that the writer doesn't get freed, and
+     cut short by a state change of the writer. */
+  if (!ddsi_congestion_enabled (wr) || wr->num_reliable_readers == 0)
+    return;
+  const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+  int64_t delay = ddsi_congestion_pacing_delay (wr, tnow);
+  if (delay < DDS_MSECS (1))
+    return;
+  if (delay > max_blocking_time)
+    delay = max_blocking_time;
+  const ddsrt_mtime_t abstimeout = ddsrt_mtime_add_duration (tnow, delay);
+
+  wr->throttling++;
+  if (xp)
+  {
+    ddsrt_mutex_unlock (&wr->e.lock);
+    ddsi_xpack_send (xp, true);
+    ddsrt_mutex_lock (&wr->e.lock);
+  }
+  while (ddsrt_atomic_ld32 (&wr->e.gv->rtps_keepgoing) && wr->state == WRST_OPERATIONAL && ddsrt_time_monotonic ().v < abstimeout.v)
+  {
+    ddsi_thread_state_asleep (thrst);
+    (void) ddsrt_cond_mtime_waituntil (&wr->throttle_cond, &wr->e.lock, abstimeout);
+    ddsi_thread_state_awake_domain_ok (thrst);
+  }
+  wr->throttling--;
+  if (wr->state != WRST_OPERATIONAL)
+  {
+    /* gc_delete_writer may be waiting */
+    ddsrt_cond_mtime_broadcast (&wr->throttle_cond);
+  }
+}
+
+static void charge_pacing (struct ddsi_writer *wr, uint32_t size, ddsrt_mtime_t tnow)
+{
+  if (ddsi_congestion_enabled (wr) && wr->num_reliable_readers > 0)
+    ddsi_congestion_note_sent (wr, size, tnow);
+}
+
+static int write_sample (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, struct ddsi_serdata *serdata, struct ddsi_tkmap_instance *tk, int gc_allowed)
+{
+  struct ddsi_domaingv const * const gv = wr->e.gv;
+  int r;
+  ddsi_seqno_t seq;
+  ddsrt_mtime_t tnow;
+
+  /* If GC not allowed, we must be sure to never block when writing.  That is only the case for (true, aggressive) KEEP_LAST writers, and also only if there is no limit to how much unacknowledged data the WHC may contain. */
+  assert (gc_allowed || (wr->xqos->history.kind == DDS_HISTORY_KEEP_LAST && wr->whc_low == INT32_MAX));
+
+  if (!sample_size_acceptable (wr, serdata))
+  {
+    r = DDS_RETCODE_BAD_PARAMETER;
+    goto drop;
+  }
+
+  renew_manual_liveliness (wr);
 
   ddsrt_mutex_lock (&wr->e.lock);
 
   if (!wr->alive)
     ddsi_writer_set_alive_may_unlock (wr, true);
 
-  /* If WHC overfull, block. */
+  if (wait_for_whc_space (thrst, xp, wr, gc_allowed, wr->xqos->reliability.max_blocking_time) == DDS_RETCODE_TIMEOUT)
   {
-    struct ddsi_whc_state whcst;
-    ddsi_whc_get_state(wr->whc, &whcst);
-    if (whcst.unacked_bytes > wr->whc_high)
-    {
-      dds_return_t ores;
-      assert(gc_allowed); /* also see beginning of the function */
-      if (gv->config.prioritize_retransmit && wr->retransmitting)
-        ores = throttle_writer (thrst, xp, wr);
-      else
-      {
-        maybe_grow_whc (wr);
-        if (whcst.unacked_bytes <= wr->whc_high)
-          ores = DDS_RETCODE_OK;
-        else
-          ores = throttle_writer (thrst, xp, wr);
-      }
-      if (ores == DDS_RETCODE_TIMEOUT)
-      {
-        ddsrt_mutex_unlock (&wr->e.lock);
-        r = DDS_RETCODE_TIMEOUT;
-        goto drop;
-      }
-    }
+    ddsrt_mutex_unlock (&wr->e.lock);
+    r = DDS_RETCODE_TIMEOUT;
+    goto drop;
   }
+  if (gc_allowed)
+    pace_writer (thrst, xp, wr, wr->xqos->reliability.max_blocking_time);
 
   if (wr->state != WRST_OPERATIONAL)
   {
@@ -880,7 +980,12 @@ static int write_sample (struct ddsi_thread_state * const thrst, struct ddsi_xpa
 
   seq = ++wr->seq;
   wr->sent_bytes += ddsi_serdata_size (serdata);
-  if ((r = insert_sample_in_whc (wr, seq, serdata, tk)) < 0)
+  if ((r = insert_sample_in_whc (wr, seq, serdata, tk)) >= 0 && gc_allowed)
+  {
+    /* Only data accepted into the WHC counts for pacing */
+    charge_pacing (wr, ddsi_serdata_size (serdata), tnow);
+  }
+  if (r < 0)
   {
     /* Failure of some kind */
     ddsrt_mutex_unlock (&wr->e.lock);
@@ -969,6 +1074,95 @@ int ddsi_write_sample_nogc_notk (struct ddsi_thread_state * const thrst, struct
   return res;
 }
 
+int ddsi_write_sample_batch_gc (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, dds_duration_t max_blocking_time, uint32_t n, struct ddsi_serdata **serdata, struct ddsi_tkmap_instance **tk, uint32_t *nwritten)
+{
+  /* Same as write_sample, but for a sequence of samples: the writer lock is taken once,
+     the WHC is checked for space once (so a batch can exceed the high-water mark by at most
+     its own size), all samples are packed in xp and a single heartbeat is piggybacked on
+     the last one. */
+  int r = 0;
+  uint32_t i;
+  assert (xp != NULL);
+  *nwritten = 0;
+
+  for (i = 0; i < n; i++)
+  {
+    if (!sample_size_acceptable (wr, serdata[i]))
+    {
+      r = DDS_RETCODE_BAD_PARAMETER;
+      goto drop;
+    }
+  }
+  if (n == 0)
+    return 0;
+
+  renew_manual_liveliness (wr);
+
+  ddsrt_mutex_lock (&wr->e.lock);
+
+  if (!wr->alive)
+    ddsi_writer_set_alive_may_unlock (wr, true);
+
+  if (wait_for_whc_space (thrst, xp, wr, 1, max_blocking_time) == DDS_RETCODE_TIMEOUT)
+  {
+    ddsrt_mutex_unlock (&wr->e.lock);
+    r = DDS_RETCODE_TIMEOUT;
+    goto drop;
+  }
+  pace_writer (thrst, xp, wr, max_blocking_time);
+
+  if (wr->state != WRST_OPERATIONAL)
+  {
+    r = DDS_RETCODE_PRECONDITION_NOT_MET;
+    ddsrt_mutex_unlock (&wr->e.lock);
+    goto drop;
+  }
+
+  const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+  bool transmitted = false;
+  for (i = 0; i < n; i++)
+  {
+    const ddsi_seqno_t seq = ++wr->seq;
+    serdata[i]->twrite = tnow;
+    wr->sent_bytes += ddsi_serdata_size (serdata[i]);
+    if ((r = insert_sample_in_whc (wr, seq, serdata[i], tk[i])) < 0)
+      break;
+    (*nwritten)++;
+    charge_pacing (wr, ddsi_serdata_size (serdata[i]), tnow);
+    /* the lock may have been released while transmitting a large sample, so the set of
+       addresses needs to be checked for every sample */
+    if (wr->test_drop_outgoing_data || ddsi_addrset_empty (wr->as))
+      ddsi_writer_update_seq_xmit (wr, seq);
+    else
+    {
+      transmit_sample_wrlock_held (xp, wr, seq, serdata[i], NULL, 1);
+      transmitted = true;
+    }
+  }
+
+  if (!transmitted)
+    ddsrt_mutex_unlock (&wr->e.lock);
+  else
+  {
+    struct ddsi_whc_state whcst, *whcstptr;
+    if (wr->heartbeat_xevent == NULL)
+      whcstptr = NULL;
+    else
+    {
+      ddsi_whc_get_state(wr->whc, &whcst);
+      whcstptr = &whcst;
+    }
+    transmit_heartbeat_unlocks_wr (xp, wr, whcstptr, tnow);
+  }
+  if (r > 0)
+    r = 0;
+
+drop:
+  for (i = 0; i < n; i++)
+    ddsi_serdata_unref (serdata[i]);
+  return r;
+}
+
 int ddsi_write_and_fini_plist (struct ddsi_writer *wr, ddsi_plist_t *ps, bool alive)
 {
   struct ddsi_serdata *serdata = ddsi_serdata_from_sample (wr->type, alive ? SDK_DATA : SDK_KEY, ps);
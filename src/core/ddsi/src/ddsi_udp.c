@@ -78,6 +78,7 @@ typedef struct ddsi_udp_conn {
 #endif
   int m_diffserv;
   union addr m_addr;
+  bool m_in_ownaddrs; // false if another (receive shard) socket has the same address
 } *ddsi_udp_conn_t;
 
 typedef struct ddsi_udp_tran_factory {
@@ -157,6 +158,63 @@ static void translate_pktinfo (struct ddsi_network_packet_info *pktinfo, ddsrt_m
   pktinfo->if_index = 0;
 }
 
+#if PACKET_DESTINATION_INFO
+union in_pktinfo_4_6 {
+#if defined IP_PKTINFO
+  struct in_pktinfo ip4;
+#endif
+#if DDSRT_HAVE_IPV6 && defined IPV6_PKTINFO
+  struct in6_pktinfo ip6;
+#endif
+};
+#endif // PACKET_DESTINATION_INFO
+
+static void ddsi_udp_conn_read_postprocess (ddsi_udp_conn_t conn, unsigned char *buf, size_t len, const union addr *src, ddsrt_msghdr_t *msghdr, size_t nrecv, struct ddsi_network_packet_info *pktinfo)
+{
+  struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
+
+  if (pktinfo)
+  {
+    addr_to_loc (conn->m_base.m_factory, &pktinfo->src, src);
+    translate_pktinfo (pktinfo, msghdr, conn->m_base.m_base.m_port, src->a.sa_family == AF_INET6);
+  }
+
+  if (gv->pcap_fp)
+  {
+    struct ddsi_udp_tran_factory * const fact = (struct ddsi_udp_tran_factory *) conn->m_base.m_factory;
+    ddsrt_mutex_lock (&fact->ownaddrs_lock);
+    const bool drop = ddsrt_hh_lookup (fact->ownaddrs, src);
+    ddsrt_mutex_unlock (&fact->ownaddrs_lock);
+    if (!drop)
+    {
+      union addr dest;
+      socklen_t dest_len = sizeof (dest);
+      if (pktinfo && pktinfo->dst.kind != DDSI_LOCATOR_KIND_INVALID)
+        ddsi_ipaddr_from_loc (&dest.x, &pktinfo->dst);
+      else if (ddsrt_getsockname (conn->m_sockext.sock, &dest.a, &dest_len) != DDS_RETCODE_OK)
+        memset (&dest, 0, sizeof (dest));
+      ddsi_write_pcap_received (gv, ddsrt_time_wallclock (), &src->x, &dest.x, buf, nrecv);
+    }
+  }
+
+  /* Check for udp packet truncation */
+#if ! DDSRT_MSGHDR_FLAGS
+  const bool trunc_flag = false;
+#elif defined MSG_CTRUNC
+  const bool trunc_flag = (msghdr->msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0;
+#else
+  const bool trunc_flag = (msghdr->msg_flags & MSG_TRUNC) != 0;
+#endif
+  if (nrecv > len || trunc_flag)
+  {
+    char addrbuf[DDSI_LOCSTRLEN];
+    ddsi_locator_t tmp;
+    addr_to_loc (conn->m_base.m_factory, &tmp, src);
+    ddsi_locator_to_string (addrbuf, sizeof (addrbuf), &tmp);
+    GVWARNING ("%s => %"PRIuSIZE" truncated to %"PRIuSIZE"\n", addrbuf, nrecv, len);
+  }
+}
+
 ddsrt_nonnull((1, 2, 6)) ddsrt_attribute_warn_unused_result
 static dds_return_t ddsi_udp_conn_read (struct ddsi_tran_conn * conn_cmn, unsigned char * buf, size_t len, bool allow_spurious, struct ddsi_network_packet_info *pktinfo, size_t *bytes_read)
 {
@@ -164,14 +222,6 @@ static dds_return_t ddsi_udp_conn_read (struct ddsi_tran_conn * conn_cmn, unsign
   struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
   union addr src;
 #if PACKET_DESTINATION_INFO
-  union in_pktinfo_4_6 {
-#if defined IP_PKTINFO
-    struct in_pktinfo ip4;
-#endif
-#if DDSRT_HAVE_IPV6 && defined IPV6_PKTINFO
-    struct in6_pktinfo ip6;
-#endif
-  };
   char incmsg[CMSG_SPACE (sizeof (union in_pktinfo_4_6))];
 #endif // PACKET_DESTINATION_INFO
   ddsrt_iovec_t msg_iov = {
@@ -206,48 +256,56 @@ static dds_return_t ddsi_udp_conn_read (struct ddsi_tran_conn * conn_cmn, unsign
     return rc;
   }
 
-  if (pktinfo)
-  {
-    addr_to_loc (conn->m_base.m_factory, &pktinfo->src, &src);
-    translate_pktinfo (pktinfo, &msghdr, conn->m_base.m_base.m_port, src.a.sa_family == AF_INET6);
-  }
+  ddsi_udp_conn_read_postprocess (conn, buf, len, &src, &msghdr, nrecv, pktinfo);
+  *bytes_read = (size_t) nrecv;
+  return DDS_RETCODE_OK;
+}
 
-  if (gv->pcap_fp)
+DDSRT_STATIC_ASSERT (DDSI_TRAN_READ_MULTIPLE_MAX <= DDSRT_RECVMMSG_MAX);
+
+ddsrt_nonnull((1, 3, 6, 7, 8)) ddsrt_attribute_warn_unused_result
+static dds_return_t ddsi_udp_conn_read_multiple (struct ddsi_tran_conn * conn_cmn, size_t n, unsigned char * const *bufs, size_t len, bool allow_spurious, struct ddsi_network_packet_info *pktinfo, size_t *bytes_read, size_t *npackets)
+{
+  ddsi_udp_conn_t conn = (ddsi_udp_conn_t) conn_cmn;
+  struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
+  union addr src[DDSI_TRAN_READ_MULTIPLE_MAX];
+#if PACKET_DESTINATION_INFO
+  char incmsg[DDSI_TRAN_READ_MULTIPLE_MAX][CMSG_SPACE (sizeof (union in_pktinfo_4_6))];
+#endif // PACKET_DESTINATION_INFO
+  ddsrt_iovec_t msg_iov[DDSI_TRAN_READ_MULTIPLE_MAX];
+  ddsrt_msghdr_t msghdr[DDSI_TRAN_READ_MULTIPLE_MAX];
+  assert (n > 0 && n <= DDSI_TRAN_READ_MULTIPLE_MAX);
+  (void) allow_spurious;
+
+  memset (msghdr, 0, n * sizeof (msghdr[0]));
+  for (size_t i = 0; i < n; i++)
   {
-    struct ddsi_udp_tran_factory * const fact = (struct ddsi_udp_tran_factory *) conn->m_base.m_factory;
-    ddsrt_mutex_lock (&fact->ownaddrs_lock);
-    const bool drop = ddsrt_hh_lookup (fact->ownaddrs, &src);
-    ddsrt_mutex_unlock (&fact->ownaddrs_lock);
-    if (!drop)
-    {
-      union addr dest;
-      socklen_t dest_len = sizeof (dest);
-      if (pktinfo && pktinfo->dst.kind != DDSI_LOCATOR_KIND_INVALID)
-        ddsi_ipaddr_from_loc (&dest.x, &pktinfo->dst);
-      else if (ddsrt_getsockname (conn->m_sockext.sock, &dest.a, &dest_len) != DDS_RETCODE_OK)
-        memset (&dest, 0, sizeof (dest));
-      ddsi_write_pcap_received (gv, ddsrt_time_wallclock (), &src.x, &dest.x, buf, nrecv);
-    }
+    msg_iov[i].iov_base = (void *) bufs[i];
+    msg_iov[i].iov_len = (ddsrt_iov_len_t) len;
+    msghdr[i].msg_name = &src[i].x;
+    msghdr[i].msg_namelen = (socklen_t) sizeof (src[i]);
+    msghdr[i].msg_iov = &msg_iov[i];
+    msghdr[i].msg_iovlen = 1;
+#if PACKET_DESTINATION_INFO
+    msghdr[i].msg_controllen = sizeof (incmsg[i]);
+    msghdr[i].msg_control = incmsg[i];
+#endif // PACKET_DESTINATION_INFO
   }
 
-  /* Check for udp packet truncation */
-#if ! DDSRT_MSGHDR_FLAGS
-  const bool trunc_flag = false;
-#elif defined MSG_CTRUNC
-  const bool trunc_flag = (msghdr.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0;
-#else
-  const bool trunc_flag = (msghdr.msg_flags & MSG_TRUNC) != 0;
-#endif
-  if (nrecv > len || trunc_flag)
+  dds_return_t rc;
+  do {
+    rc = ddsrt_recvmmsg (&conn->m_sockext, msghdr, bytes_read, n, 0, npackets);
+  } while (rc == DDS_RETCODE_INTERRUPTED);
+
+  if (rc != DDS_RETCODE_OK)
   {
-    char addrbuf[DDSI_LOCSTRLEN];
-    ddsi_locator_t tmp;
-    addr_to_loc (conn->m_base.m_factory, &tmp, &src);
-    ddsi_locator_to_string (addrbuf, sizeof (addrbuf), &tmp);
-    GVWARNING ("%s => %"PRIuSIZE" truncated to %"PRIuSIZE"\n", addrbuf, nrecv, len);
+    if (rc != DDS_RETCODE_BAD_PARAMETER && rc != DDS_RETCODE_NO_CONNECTION)
+      GVERROR ("UDP recvmmsg sock %d: retcode %"PRId32"\n", (int) conn->m_sockext.sock, rc);
+    return rc;
   }
 
-  *bytes_read = (size_t) nrecv;
+  for (size_t i = 0; i < *npackets; i++)
+    ddsi_udp_conn_read_postprocess (conn, bufs[i], len, &src[i], &msghdr[i], bytes_read[i], &pktinfo[i]);
   return DDS_RETCODE_OK;
 }
 
@@ -334,6 +392,68 @@ static dds_return_t ddsi_udp_conn_write (struct ddsi_tran_conn * conn_cmn, const
   return rc;
 }
 
+DDSRT_STATIC_ASSERT (DDSI_TRAN_WRITE_MULTIPLE_MAX <= DDSRT_SENDMMSG_MAX);
+
+static dds_return_t ddsi_udp_conn_write_multiple (struct ddsi_tran_conn * conn_cmn, size_t n, const ddsi_locator_t *dsts, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags, size_t *nsyscalls)
+{
+  ddsi_udp_conn_t conn = (ddsi_udp_conn_t) conn_cmn;
+  struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
+  union addr dstaddrs[DDSI_TRAN_WRITE_MULTIPLE_MAX];
+  ddsrt_msghdr_t msgs[DDSI_TRAN_WRITE_MULTIPLE_MAX];
+  size_t nsent[DDSI_TRAN_WRITE_MULTIPLE_MAX];
+  dds_return_t ret = DDS_RETCODE_OK;
+  int sendflags = 0;
+  assert (n >= 1 && n <= DDSI_TRAN_WRITE_MULTIPLE_MAX);
+  assert (msgfrags->niov <= INT_MAX);
+  for (size_t i = 0; i < n; i++)
+  {
+    ddsi_ipaddr_from_loc (&dstaddrs[i].x, &dsts[i]);
+    memset (&msgs[i], 0, sizeof (msgs[i]));
+    msgs[i].msg_name = &dstaddrs[i].x;
+    msgs[i].msg_namelen = (socklen_t) ddsrt_sockaddr_get_size (&dstaddrs[i].a);
+    msgs[i].msg_iov = (ddsrt_iovec_t *) msgfrags->iov;
+    msgs[i].msg_iovlen = (ddsrt_msg_iovlen_t) msgfrags->niov;
+#if DDSRT_MSGHDR_FLAGS
+    msgs[i].msg_flags = (int) flags;
+#endif
+  }
+
+#if MSG_NOSIGNAL && !LWIP_SOCKET
+  sendflags |= MSG_NOSIGNAL;
+#endif
+  *nsyscalls = 0;
+  size_t i = 0;
+  while (i < n)
+  {
+    size_t nmsgs;
+    dds_return_t rc = ddsrt_sendmmsg (conn->m_sockext.sock, &msgs[i], &nsent[i], n - i, sendflags, &nmsgs);
+    (*nsyscalls)++;
+    if (rc == DDS_RETCODE_OK)
+    {
+      if (gv->pcap_fp)
+      {
+        union addr sa;
+        socklen_t alen = sizeof (sa);
+        if (ddsrt_getsockname (conn->m_sockext.sock, &sa.a, &alen) != DDS_RETCODE_OK)
+          memset (&sa, 0, sizeof (sa));
+        for (size_t j = i; j < i + nmsgs; j++)
+          ddsi_write_pcap_sent (gv, ddsrt_time_wallclock (), &sa.x, &msgs[j], nsent[j]);
+      }
+      i += nmsgs;
+    }
+    else
+    {
+      // Failing to send to the first destination: leave the retrying and error reporting to
+      // the single-destination path, then continue with the remaining ones.
+      if ((rc = ddsi_udp_conn_write (conn_cmn, &dsts[i], msgfrags, flags, NULL)) != DDS_RETCODE_OK)
+        ret = rc;
+      (*nsyscalls)++;
+      i++;
+    }
+  }
+  return ret;
+}
+
 static void ddsi_udp_disable_multiplexing (struct ddsi_tran_conn * conn_cmn)
 {
 #if defined _WIN32 && !defined WINCE
@@ -617,7 +737,7 @@ static dds_return_t ddsi_udp_create_conn (struct ddsi_tran_conn **conn_out, stru
       purpose_str = "transmit(uc/mc)";
       break;
     case DDSI_TRAN_QOS_RECV_UC:
-      reuse_addr = false;
+      reuse_addr = qos->m_reuse_port;
       bind_to_any = true;
       set_mc_xmit_options = false;
       purpose_str = "unicast";
@@ -631,6 +751,13 @@ static dds_return_t ddsi_udp_create_conn (struct ddsi_tran_conn **conn_out, stru
   }
   assert (purpose_str != NULL);
 
+#if ! DDSRT_HAVE_REUSEPORT_LB
+  // Binding multiple unicast sockets to the same port is pointless if the network stack
+  // doesn't distribute the incoming traffic over them
+  if (qos->m_purpose == DDSI_TRAN_QOS_RECV_UC && qos->m_reuse_port)
+    return DDS_RETCODE_UNSUPPORTED;
+#endif
+
   union addr socketname;
   ddsi_locator_t ownloc_w_port = intf->loc;
   assert (ownloc_w_port.port == DDSI_LOCATOR_PORT_INVALID);
@@ -701,9 +828,10 @@ static dds_return_t ddsi_udp_create_conn (struct ddsi_tran_conn **conn_out, stru
 
   if ((rc = ddsrt_bind (sock, &socketname.a, ddsrt_sockaddr_get_size (&socketname.a))) != DDS_RETCODE_OK)
   {
-    /* PRECONDITION_NOT_MET (= EADDRINUSE) is expected if reuse_addr isn't set, should be handled at
-       a higher level and therefore needs to return a specific error message */
-    if (!reuse_addr && rc == DDS_RETCODE_PRECONDITION_NOT_MET)
+    /* PRECONDITION_NOT_MET (= EADDRINUSE) is expected for non-multicast sockets (also if the port is
+       shared for spreading the load, because another process may have bound it without sharing), should
+       be handled at a higher level and therefore needs to return a specific error message */
+    if (qos->m_purpose != DDSI_TRAN_QOS_RECV_MC && rc == DDS_RETCODE_PRECONDITION_NOT_MET)
       goto fail_addrinuse;
 
     char buf[DDSI_LOCSTRLEN];
@@ -740,7 +868,9 @@ static dds_return_t ddsi_udp_create_conn (struct ddsi_tran_conn **conn_out, stru
   conn->m_base.m_base.m_handle_fn = ddsi_udp_conn_handle;
 
   conn->m_base.m_read_fn = ddsi_udp_conn_read;
+  conn->m_base.m_read_multiple_fn = ddsi_udp_conn_read_multiple;
   conn->m_base.m_write_fn = ddsi_udp_conn_write;
+  conn->m_base.m_write_multiple_fn = ddsi_udp_conn_write_multiple;
   conn->m_base.m_disable_multiplexing_fn = ddsi_udp_disable_multiplexing;
   conn->m_base.m_locator_fn = ddsi_udp_conn_locator;
 
@@ -749,7 +879,7 @@ static dds_return_t ddsi_udp_create_conn (struct ddsi_tran_conn **conn_out, stru
   if (fact->ownaddrs)
   {
     ddsrt_mutex_lock (&fact->ownaddrs_lock);
-    ddsrt_hh_add_absent (fact->ownaddrs, &conn->m_addr);
+    conn->m_in_ownaddrs = ddsrt_hh_add (fact->ownaddrs, &conn->m_addr);
     ddsrt_mutex_unlock (&fact->ownaddrs_lock);
   }
 
@@ -874,7 +1004,7 @@ static void ddsi_udp_release_conn (struct ddsi_tran_conn * conn_cmn)
   GVTRACE ("ddsi_udp_release_conn %s socket %"PRIdSOCK" port %"PRIu32"\n",
            conn_cmn->m_base.m_multicast ? "multicast" : "unicast",
            conn->m_sockext.sock, conn->m_base.m_base.m_port);
-  if (fact->ownaddrs)
+  if (fact->ownaddrs && conn->m_in_ownaddrs)
   {
     ddsrt_mutex_lock (&fact->ownaddrs_lock);
     ddsrt_hh_remove_present (fact->ownaddrs, &conn->m_addr);
@@ -90,7 +90,9 @@ static dds_return_t ddsi_vnet_create_conn (struct ddsi_tran_conn **conn_out, str
   x->m_base.m_base.m_handle_fn = ddsi_vnet_conn_handle;
   x->m_base.m_locator_fn = ddsi_vnet_conn_locator;
   x->m_base.m_read_fn = 0;
+  x->m_base.m_read_multiple_fn = 0;
   x->m_base.m_write_fn = ddsi_vnet_conn_write;
+  x->m_base.m_write_multiple_fn = 0;
   x->m_base.m_disable_multiplexing_fn = 0;
 
   DDS_CTRACE (&fact->m_base.gv->logconfig, "ddsi_vnet_create_conn intf %s kind %s\n", x->m_base.m_interf->name, fact->m_base.m_typename);
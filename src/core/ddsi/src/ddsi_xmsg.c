@@ -141,6 +141,7 @@ struct ddsi_xpack
 {
   struct ddsi_xpack *sendq_next;
   bool async_mode;
+  bool sendq_immediately; /* for copies in the send queue: flushed explicitly */
   ddsi_rtps_header_t hdr;
   ddsi_rtps_msg_len_t msg_len;
   ddsi_guid_prefix_t *last_src;
@@ -1208,6 +1209,92 @@ static void ddsi_xpack_send1v (const ddsi_xlocator_t *loc, void * varg)
   (void) ddsi_xpack_send1 (loc, varg, NULL);
 }
 
+/* Sending a packet to many destinations one at a time costs a system call for each
+   destination.  If the transport supports it and it is enabled in the configuration,
+   consecutive destinations using the same connection are collected and sent in a single
+   operation (which may, e.g., use sendmmsg). */
+struct ddsi_xpack_send_batch {
+  struct ddsi_xpack *xp;
+  struct ddsi_tran_conn *conn;
+  size_t maxn, n, syscalls;
+  ddsi_locator_t dsts[DDSI_TRAN_WRITE_MULTIPLE_MAX];
+};
+
+DDSRT_STATIC_ASSERT (DDSI_TRAN_WRITE_MULTIPLE_MAX >= 32); // Internal/SendBatchSize allows up to 32
+
+static bool ddsi_xpack_send_batch_enabled (const struct ddsi_xpack *xp)
+{
+#ifdef DDS_HAS_SECURITY
+  /* RTPS-level protection is applied per destination by the security plugins */
+  if (xp->sec_info.use_rtps_encoding)
+    return false;
+#endif
+  return xp->gv->config.xmit_batch_size > 1 && !xp->gv->mute;
+}
+
+static void ddsi_xpack_send_batch_flush (struct ddsi_xpack_send_batch *b)
+{
+  if (b->n > 0)
+  {
+    size_t nsyscalls;
+    (void) ddsi_conn_write_multiple (b->conn, b->n, b->dsts, b->xp->msgfrags, b->xp->call_flags, &nsyscalls);
+    b->syscalls += nsyscalls;
+    /* Clear call flags, as used on a per call basis */
+    b->xp->call_flags = 0;
+    b->n = 0;
+  }
+}
+
+ddsrt_nonnull ((1))
+static void ddsi_xpack_send_batch1 (const ddsi_xlocator_t *loc, void * varg)
+{
+  struct ddsi_xpack_send_batch * const b = varg;
+  struct ddsi_domaingv const * const gv = b->xp->gv;
+
+  assert (loc->c.kind != DDSI_LOCATOR_KIND_PSMX);
+  if (!ddsi_conn_supports_write_multiple (loc->conn))
+  {
+    (void) ddsi_xpack_send1 (loc, b->xp, NULL);
+    b->syscalls++;
+    return;
+  }
+
+  if (gv->logconfig.c.mask & DDS_LC_TRACE)
+  {
+    char buf[DDSI_LOCSTRLEN];
+    GVTRACE (" %s", ddsi_xlocator_to_string (buf, sizeof(buf), loc));
+  }
+  if (gv->config.xmit_lossiness > 0 && (ddsrt_random () % 1000) < (uint32_t) gv->config.xmit_lossiness)
+  {
+    GVTRACE ("(dropped)");
+    return;
+  }
+
+  if (b->n > 0 && (loc->conn != b->conn || b->n == b->maxn))
+    ddsi_xpack_send_batch_flush (b);
+  b->conn = loc->conn;
+  b->dsts[b->n++] = loc->c;
+}
+
+ddsrt_nonnull_all
+static size_t ddsi_xpack_send_addrset (struct ddsi_xpack *xp, struct ddsi_addrset *as, size_t (*forall_count) (struct ddsi_addrset *as, ddsi_addrset_forall_fun_t f, void *arg), size_t *syscalls)
+{
+  if (!ddsi_xpack_send_batch_enabled (xp))
+  {
+    const size_t calls = forall_count (as, ddsi_xpack_send1v, xp);
+    *syscalls = calls;
+    return calls;
+  }
+  else
+  {
+    struct ddsi_xpack_send_batch b = { .xp = xp, .conn = NULL, .maxn = (size_t) xp->gv->config.xmit_batch_size, .n = 0, .syscalls = 0 };
+    const size_t calls = forall_count (as, ddsi_xpack_send_batch1, &b);
+    ddsi_xpack_send_batch_flush (&b);
+    *syscalls = b.syscalls;
+    return calls;
+  }
+}
+
 ddsrt_nonnull_all
 static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
 {
@@ -1232,7 +1319,7 @@ static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
     }
   }
 
-  size_t calls = 0;
+  size_t calls = 0, syscalls = 0;
   GVTRACE (" [");
   switch (xp->dstmode)
   {
@@ -1241,7 +1328,7 @@ static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
       break;
     case NN_XMSG_DST_ONE:
       (void) ddsi_xpack_send1 (&xp->dstaddr.loc, xp, NULL);
-      calls++;
+      calls = syscalls = 1;
       break;
     case NN_XMSG_DST_ALL:
       /* Send to all addresses in as - as ultimately references the writer's
@@ -1249,14 +1336,14 @@ static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
          it is updated, but that might not be something we want to guarantee */
       if (xp->dstaddr.all.as)
       {
-        calls = ddsi_addrset_forall_count (xp->dstaddr.all.as, ddsi_xpack_send1v, xp);
+        calls = ddsi_xpack_send_addrset (xp, xp->dstaddr.all.as, ddsi_addrset_forall_count, &syscalls);
         ddsi_unref_addrset (xp->dstaddr.all.as);
       }
       break;
     case NN_XMSG_DST_ALL_UC:
       if (xp->dstaddr.all_uc.as)
       {
-        calls = ddsi_addrset_forall_uc_count (xp->dstaddr.all_uc.as, ddsi_xpack_send1v, xp);
+        calls = ddsi_xpack_send_addrset (xp, xp->dstaddr.all_uc.as, ddsi_addrset_forall_uc_count, &syscalls);
         ddsi_unref_addrset (xp->dstaddr.all_uc.as);
       }
       break;
@@ -1265,6 +1352,9 @@ static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
   if (calls)
   {
     GVLOG (DDS_LC_TRAFFIC, "traffic-xmit (%lu) %"PRIu32"\n", (unsigned long) calls, xp->msg_len.length);
+    ddsrt_atomic_inc64 (&xp->gv->xmit_stats.flushes);
+    ddsrt_atomic_add64 (&xp->gv->xmit_stats.packets, calls);
+    ddsrt_atomic_add64 (&xp->gv->xmit_stats.syscalls, syscalls);
   }
   ddsi_xmsg_chain_release (xp->gv, &xp->included_msgs);
   ddsi_xpack_reinit (xp);
@@ -1272,10 +1362,171 @@ static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
 
 #define SENDQ_MAX 200
 
+/* Coalescing of the packets in the send queue: the send queue thread merges the
+   messages in the packets it dequeues into a small number of pending packets, one
+   for each set of destinations, holding on to them for as long as the latency budget
+   allows (bounded by Internal/CoalescingMaxDelay).  Pending packets are always sent
+   in the order in which they were created, so that flushing one also flushes all
+   older ones, and adding to one first flushes the older ones.  This maintains the
+   order of the messages for each destination, barring imprecision in comparing
+   address sets. */
+#define SENDQ_COALESCE_MAX 16
+
+struct sendq_coalescer {
+  uint32_t npending;
+  /* [0,npending) pending in order of creation, the remainder are empty */
+  struct ddsi_xpack *xps[SENDQ_COALESCE_MAX];
+  ddsrt_mtime_t tflush[SENDQ_COALESCE_MAX];
+};
+
+static int addressing_info_eq_onesidederr (const struct ddsi_xpack *xp, const struct ddsi_xmsg *m);
+
+static void release_addressing_info (struct ddsi_xpack *xp)
+{
+  switch (xp->dstmode)
+  {
+    case NN_XMSG_DST_UNSET:
+    case NN_XMSG_DST_ONE:
+      break;
+    case NN_XMSG_DST_ALL:
+      ddsi_unref_addrset (xp->dstaddr.all.as);
+      break;
+    case NN_XMSG_DST_ALL_UC:
+      ddsi_unref_addrset (xp->dstaddr.all_uc.as);
+      break;
+  }
+}
+
+static void sendq_coalescer_init (struct sendq_coalescer *co, struct ddsi_domaingv *gv)
+{
+  co->npending = 0;
+  for (uint32_t i = 0; i < SENDQ_COALESCE_MAX; i++)
+    co->xps[i] = ddsi_xpack_new (gv, false);
+}
+
+static void sendq_coalescer_flush (struct sendq_coalescer *co, uint32_t n)
+{
+  struct ddsi_xpack *sent[SENDQ_COALESCE_MAX];
+  assert (n <= co->npending);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    ddsi_xpack_send_real (co->xps[i]);
+    sent[i] = co->xps[i];
+  }
+  memmove (co->xps, co->xps + n, (co->npending - n) * sizeof (*co->xps));
+  memmove (co->tflush, co->tflush + n, (co->npending - n) * sizeof (*co->tflush));
+  co->npending -= n;
+  memcpy (co->xps + co->npending, sent, n * sizeof (*sent));
+}
+
+static void sendq_coalescer_fini (struct sendq_coalescer *co)
+{
+  sendq_coalescer_flush (co, co->npending);
+  for (uint32_t i = 0; i < SENDQ_COALESCE_MAX; i++)
+    ddsi_xpack_free (co->xps[i]);
+}
+
+static void sendq_coalescer_flush_expired (struct sendq_coalescer *co, ddsrt_mtime_t tnow)
+{
+  uint32_t n = co->npending;
+  while (n > 0 && co->tflush[n - 1].v > tnow.v)
+    n--;
+  sendq_coalescer_flush (co, n);
+}
+
+static ddsrt_mtime_t sendq_coalescer_next_flush (const struct sendq_coalescer *co)
+{
+  ddsrt_mtime_t t = DDSRT_MTIME_NEVER;
+  for (uint32_t i = 0; i < co->npending; i++)
+    if (co->tflush[i].v < t.v)
+      t = co->tflush[i];
+  return t;
+}
+
+static void sendq_coalesce (struct sendq_coalescer *co, struct ddsi_xpack *xp, ddsrt_mtime_t tnow)
+{
+  struct ddsi_domaingv * const gv = xp->gv;
+  if (xp->msgfrags == NULL || xp->msgfrags->niov == 0)
+    return;
+#ifdef DDS_HAS_SECURITY
+  if (xp->sec_info.use_rtps_encoding)
+  {
+    sendq_coalescer_flush (co, co->npending);
+    ddsi_xpack_send_real (xp);
+    return;
+  }
+#endif
+
+  /* messages are in reverse order, the oldest one is what matters for the addressing */
+  struct ddsi_xmsg_chain_elem *ce = xp->included_msgs.latest, *oldest = NULL;
+  while (ce)
+  {
+    struct ddsi_xmsg_chain_elem * const older = ce->older;
+    ce->older = oldest;
+    oldest = ce;
+    ce = older;
+  }
+  const struct ddsi_xmsg *m0 = (const struct ddsi_xmsg *) ((char *) oldest - offsetof (struct ddsi_xmsg, link));
+
+  uint32_t i;
+  for (i = 0; i < co->npending; i++)
+  {
+    const struct ddsi_xpack *pxp = co->xps[i];
+    if (pxp->call_flags == xp->call_flags &&
+#ifdef DDS_HAS_SECURITY
+        !pxp->sec_info.use_rtps_encoding &&
+#endif
+        addressing_info_eq_onesidederr (pxp, m0))
+      break;
+  }
+  if (i == co->npending)
+  {
+    if (co->npending == SENDQ_COALESCE_MAX)
+    {
+      sendq_coalescer_flush (co, 1);
+      i--;
+    }
+    co->tflush[i] = DDSRT_MTIME_NEVER;
+    co->npending++;
+  }
+  else if (i > 0)
+  {
+    /* adding messages may cause the pending packet to be sent, and that mustn't happen
+       before the older ones are sent (an empty one gets no more than what fit in xp) */
+    sendq_coalescer_flush (co, i);
+    i = 0;
+  }
+
+  struct ddsi_xpack * const pxp = co->xps[i];
+  while (oldest)
+  {
+    struct ddsi_xmsg *m = (struct ddsi_xmsg *) ((char *) oldest - offsetof (struct ddsi_xmsg, link));
+    oldest = oldest->older;
+    (void) ddsi_xpack_addmsg (pxp, m, xp->call_flags);
+  }
+  xp->included_msgs.latest = NULL;
+  release_addressing_info (xp);
+  ddsi_xpack_reinit (xp);
+
+  /* an explicit flush or a message without a latency budget (e.g., a heartbeat) means
+     it needs to go out now, which can only be done by also sending the older ones */
+  int64_t delay = xp->sendq_immediately ? 0 : pxp->maxdelay;
+  if (delay > gv->config.coalescing_max_delay)
+    delay = gv->config.coalescing_max_delay;
+  const ddsrt_mtime_t tflush = ddsrt_mtime_add_duration (tnow, delay);
+  if (tflush.v < co->tflush[i].v)
+    co->tflush[i] = tflush;
+  sendq_coalescer_flush_expired (co, tnow);
+}
+
 static uint32_t ddsi_xpack_sendq_thread (void *vgv)
 {
   struct ddsi_domaingv *gv = vgv;
   struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  const bool coalesce = (gv->config.coalescing_max_delay > 0);
+  struct sendq_coalescer co;
+  if (coalesce)
+    sendq_coalescer_init (&co, gv);
   ddsi_thread_state_awake_fixed_domain (thrst);
   ddsrt_mutex_lock (&gv->sendq_lock);
   while (!(gv->sendq_stop && gv->sendq_head == NULL))
@@ -1283,22 +1534,47 @@ static uint32_t ddsi_xpack_sendq_thread (void *vgv)
     struct ddsi_xpack *xp;
     if ((xp = gv->sendq_head) == NULL)
     {
-      ddsi_thread_state_asleep (thrst);
-      (void) ddsrt_cond_wait (&gv->sendq_cond, &gv->sendq_lock);
-      ddsi_thread_state_awake_fixed_domain (thrst);
+      if (coalesce && co.npending > 0)
+      {
+        const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+        const ddsrt_mtime_t tflush = sendq_coalescer_next_flush (&co);
+        if (tflush.v <= tnow.v)
+        {
+          ddsrt_mutex_unlock (&gv->sendq_lock);
+          sendq_coalescer_flush_expired (&co, tnow);
+          ddsrt_mutex_lock (&gv->sendq_lock);
+        }
+        else
+        {
+          ddsi_thread_state_asleep (thrst);
+          (void) ddsrt_cond_mtime_waituntil (&gv->sendq_cond, &gv->sendq_lock, tflush);
+          ddsi_thread_state_awake_fixed_domain (thrst);
+        }
+      }
+      else
+      {
+        ddsi_thread_state_asleep (thrst);
+        (void) ddsrt_cond_mtime_wait (&gv->sendq_cond, &gv->sendq_lock);
+        ddsi_thread_state_awake_fixed_domain (thrst);
+      }
     }
     else
     {
       gv->sendq_head = xp->sendq_next;
       if (--gv->sendq_length == 0)
-        ddsrt_cond_broadcast (&gv->sendq_cond);
+        ddsrt_cond_mtime_broadcast (&gv->sendq_cond);
       ddsrt_mutex_unlock (&gv->sendq_lock);
-      ddsi_xpack_send_real (xp);
+      if (coalesce)
+        sendq_coalesce (&co, xp, ddsrt_time_monotonic ());
+      else
+        ddsi_xpack_send_real (xp);
       ddsi_xpack_free (xp);
       ddsrt_mutex_lock (&gv->sendq_lock);
     }
   }
   ddsrt_mutex_unlock (&gv->sendq_lock);
+  if (coalesce)
+    sendq_coalescer_fini (&co);
   ddsi_thread_state_asleep (thrst);
   return 0;
 }
@@ -1310,7 +1586,7 @@ void ddsi_xpack_sendq_init (struct ddsi_domaingv *gv)
   gv->sendq_tail = NULL;
   gv->sendq_length = 0;
   ddsrt_mutex_init (&gv->sendq_lock);
-  ddsrt_cond_init (&gv->sendq_cond);
+  ddsrt_cond_mtime_init (&gv->sendq_cond);
 }
 
 void ddsi_xpack_sendq_start (struct ddsi_domaingv *gv)
@@ -1324,7 +1600,7 @@ void ddsi_xpack_sendq_stop (struct ddsi_domaingv *gv)
 {
   ddsrt_mutex_lock (&gv->sendq_lock);
   gv->sendq_stop = 1;
-  ddsrt_cond_broadcast (&gv->sendq_cond);
+  ddsrt_cond_mtime_broadcast (&gv->sendq_cond);
   ddsrt_mutex_unlock (&gv->sendq_lock);
 }
 
@@ -1332,7 +1608,7 @@ void ddsi_xpack_sendq_fini (struct ddsi_domaingv *gv)
 {
   ddsi_join_thread (gv->sendq_ts);
   assert (gv->sendq_head == NULL);
-  ddsrt_cond_destroy (&gv->sendq_cond);
+  ddsrt_cond_mtime_destroy (&gv->sendq_cond);
   ddsrt_mutex_destroy (&gv->sendq_lock);
 }
 
@@ -1353,11 +1629,12 @@ void ddsi_xpack_send (struct ddsi_xpack *xp, bool immediately)
     }
     ddsi_xpack_reinit (xp);
     xp1->sendq_next = NULL;
+    xp1->sendq_immediately = immediately;
     ddsrt_mutex_lock (&gv->sendq_lock);
     while (gv->sendq_length >= SENDQ_MAX)
-      ddsrt_cond_wait (&gv->sendq_cond, &gv->sendq_lock);
+      ddsrt_cond_mtime_wait (&gv->sendq_cond, &gv->sendq_lock);
     if (immediately || gv->sendq_length == 0)
-      ddsrt_cond_broadcast (&gv->sendq_cond);
+      ddsrt_cond_mtime_broadcast (&gv->sendq_cond);
     if (gv->sendq_head)
       gv->sendq_tail->sendq_next = xp1;
     else
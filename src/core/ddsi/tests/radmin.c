@@ -11,10 +11,15 @@
 #include "CUnit/Theory.h"
 
 #include "dds/features.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/threads.h"
 #include "dds/ddsi/ddsi_iid.h"
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_init.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_sertype.h"
 #include "ddsi__radmin.h"
+#include "ddsi__bitset.h"
 #include "ddsi__thread.h"
 #include "ddsi__misc.h"
 
@@ -130,7 +135,7 @@ static void insert_sample (struct ddsi_defrag *defrag, struct ddsi_reorder *reor
 CU_Test (ddsi_radmin, drop_gap_at_end, .init = setup, .fini = teardown)
 {
   // not doing fragmented samples in this test, so defragmenter mode & size limits are irrelevant
-  struct ddsi_defrag *defrag = ddsi_defrag_new (&gv.logconfig, DDSI_DEFRAG_DROP_LATEST, 1);
+  struct ddsi_defrag *defrag = ddsi_defrag_new (&gv.logconfig, DDSI_DEFRAG_DROP_LATEST, 1, 0);
   struct ddsi_reorder *reorder = ddsi_reorder_new (&gv.logconfig, DDSI_REORDER_MODE_NORMAL, 3, false);
   CU_ASSERT_EQ_FATAL (ddsi_reorder_next_seq (reorder), 1);
 
@@ -159,3 +164,430 @@ CU_Test (ddsi_radmin, drop_gap_at_end, .init = setup, .fini = teardown)
   ddsi_reorder_free (reorder);
   ddsi_defrag_free (defrag);
 }
+
+static ddsi_reorder_result_t insert_sample_deliver (struct ddsi_defrag *defrag, struct ddsi_reorder *reorder, struct ddsi_rmsg *rmsg, struct ddsi_receiver_state *rst, ddsi_seqno_t seq)
+{
+  // like insert_sample, but allowing any outcome and dropping whatever gets delivered
+  struct ddsi_rsample_info *si = ddsi_rmsg_alloc (rmsg, sizeof (*si));
+  CU_ASSERT_NEQ_FATAL (si, NULL);
+  memset (si, 0, sizeof (*si));
+  si->rst = rst;
+  si->size = 1;
+  si->seq = seq;
+  struct ddsi_rdata *rdata = ddsi_rdata_new (rmsg, 0, si->size, 0, 0, 0);
+  struct ddsi_rsample *rsample = ddsi_defrag_rsample (defrag, rdata, si);
+  CU_ASSERT_NEQ_FATAL (rsample, NULL);
+
+  struct ddsi_rsample_chain sc;
+  int refc_adjust = 0;
+  struct ddsi_rdata *fragchain = ddsi_rsample_fragchain (rsample);
+  ddsi_reorder_result_t res = ddsi_reorder_rsample (&sc, reorder, rsample, &refc_adjust, 0);
+  ddsi_fragchain_adjust_refcount (fragchain, refc_adjust);
+  if (res > 0)
+  {
+    ddsi_seqno_t exp = seq;
+    while (sc.first)
+    {
+      struct ddsi_rsample_chain_elem *e = sc.first;
+      sc.first = e->next;
+      CU_ASSERT_EQ_FATAL (e->sampleinfo->seq, exp);
+      exp++;
+      ddsi_fragchain_unref (e->fragchain);
+    }
+    CU_ASSERT_EQ_FATAL (exp - seq, (ddsi_seqno_t) res);
+  }
+  return res;
+}
+
+static void check_reorder_nackmap (const struct ddsi_reorder *reorder, ddsi_seqno_t maxseq, uint32_t numbits, const ddsi_seqno_t *missing)
+{
+  struct ddsi_sequence_number_set_header map;
+  uint32_t mapbits[256 / 32];
+  const ddsi_seqno_t base = ddsi_reorder_next_seq (reorder);
+  enum ddsi_reorder_nackmap_result res = ddsi_reorder_nackmap (reorder, base, maxseq, &map, mapbits, 256, 0);
+  CU_ASSERT_EQ_FATAL (res, DDSI_REORDER_NACKMAP_NACK);
+  CU_ASSERT_EQ_FATAL (ddsi_from_seqno (map.bitmap_base), base);
+  CU_ASSERT_EQ_FATAL (map.numbits, numbits);
+  int j = 0;
+  for (uint32_t i = 0; i < numbits; i++)
+  {
+    const bool exp = (missing[j] == base + i);
+    if (exp)
+      j++;
+    CU_ASSERT_EQ_FATAL (ddsi_bitset_isset (map.numbits, mapbits, i) != 0, exp);
+  }
+  CU_ASSERT_EQ_FATAL (missing[j], 0);
+}
+
+CU_Test (ddsi_radmin, reorder_window, .init = setup, .fini = teardown)
+{
+  struct ddsi_defrag *defrag = ddsi_defrag_new (&gv.logconfig, DDSI_DEFRAG_DROP_LATEST, 1, 0);
+  struct ddsi_reorder *reorder = ddsi_reorder_new (&gv.logconfig, DDSI_REORDER_MODE_NORMAL, 10, false);
+  struct ddsi_rmsg *rmsg = ddsi_rmsg_new (rbpool);
+  ddsi_rmsg_setsize (rmsg, 0);
+  struct ddsi_receiver_state *rst = ddsi_rmsg_alloc (rmsg, sizeof (*rst));
+  memset (rst, 0, sizeof (*rst));
+  uint64_t discarded_bytes;
+
+  // a little bit of reordering
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 3), DDSI_REORDER_ACCEPT);
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 5), DDSI_REORDER_ACCEPT);
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 4), DDSI_REORDER_ACCEPT);
+  check_reorder (reorder, 0, 1, 8, (const ddsi_seqno_t[]){3,4,5,0});
+  check_reorder_nackmap (reorder, 7, 7, (const ddsi_seqno_t[]){1,2,6,7,0});
+  // duplicates are rejected
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 4), DDSI_REORDER_REJECT);
+  ddsi_reorder_stats (reorder, &discarded_bytes);
+  CU_ASSERT_EQ_FATAL (discarded_bytes, 1);
+  // next expected one gets delivered, then all consecutive ones with it
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 1), 1);
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 2), 4);
+  check_reorder (reorder, 1, 6, 8, (const ddsi_seqno_t[]){0});
+
+  // a sample far ahead moves everything to the interval tree, without affecting
+  // the outcome
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 10), DDSI_REORDER_ACCEPT);
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 8), DDSI_REORDER_ACCEPT);
+  check_reorder_nackmap (reorder, 12, 7, (const ddsi_seqno_t[]){6,7,9,11,12,0});
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 1000), DDSI_REORDER_ACCEPT);
+  check_reorder_nackmap (reorder, 12, 7, (const ddsi_seqno_t[]){6,7,9,11,12,0});
+  check_reorder (reorder, 1, 6, 12, (const ddsi_seqno_t[]){8,10,0});
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 9), DDSI_REORDER_ACCEPT);
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 7), DDSI_REORDER_ACCEPT);
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 6), 5);
+  check_reorder (reorder, 1, 11, 12, (const ddsi_seqno_t[]){0});
+
+  // max_samples still applies: the last one gets dropped when filling a hole
+  ddsi_reorder_drop_upto (reorder, 1001);
+  for (ddsi_seqno_t seq = 1002; seq <= 1020; seq += 2)
+    CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, seq), DDSI_REORDER_ACCEPT);
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 1022), DDSI_REORDER_REJECT);
+  CU_ASSERT_EQ_FATAL (insert_sample_deliver (defrag, reorder, rmsg, rst, 1003), DDSI_REORDER_ACCEPT);
+  check_reorder (reorder, 3, 1001, 1022, (const ddsi_seqno_t[]){1002,1003,1004,1006,1008,1010,1012,1014,1016,1018,0});
+  ddsi_reorder_stats (reorder, &discarded_bytes);
+  CU_ASSERT_EQ_FATAL (discarded_bytes, 3);
+
+  ddsi_rmsg_commit (rmsg);
+  ddsi_reorder_free (reorder);
+  ddsi_defrag_free (defrag);
+}
+
+static struct ddsi_rsample *insert_fragments (struct ddsi_defrag *defrag, struct ddsi_rmsg *rmsg, struct ddsi_receiver_state *rst, uint32_t fragsize, uint32_t nfrags, uint32_t f0, uint32_t f1)
+{
+  // inserts fragments [f0,f1) of sample 1 of nfrags fragments in a single rdata
+  struct ddsi_rsample_info *si = ddsi_rmsg_alloc (rmsg, sizeof (*si));
+  CU_ASSERT_NEQ_FATAL (si, NULL);
+  memset (si, 0, sizeof (*si));
+  si->rst = rst;
+  si->size = fragsize * nfrags;
+  si->fragsize = fragsize;
+  si->seq = 1;
+  struct ddsi_rdata *rdata = ddsi_rdata_new (rmsg, f0 * fragsize, f1 * fragsize, 0, 0, 0);
+  CU_ASSERT_NEQ_FATAL (rdata, NULL);
+  return ddsi_defrag_rsample (defrag, rdata, si);
+}
+
+static void check_nackmap (struct ddsi_defrag *defrag, uint32_t maxfragnum, uint32_t nfrags, const uint32_t *present, uint32_t npresent)
+{
+  struct ddsi_fragment_number_set_header map;
+  uint32_t mapbits[256 / 32];
+  enum ddsi_defrag_nackmap_result res = ddsi_defrag_nackmap (defrag, 1, maxfragnum, &map, mapbits, 256);
+  CU_ASSERT_EQ_FATAL (res, DDSI_DEFRAG_NACKMAP_FRAGMENTS_MISSING);
+  // "present" is sorted, starts with 0 and ends with nfrags-1, and there's a gap after the first
+  CU_ASSERT_EQ_FATAL (map.bitmap_base, 1);
+  CU_ASSERT_EQ_FATAL (map.numbits, (nfrags - 2 < 256) ? nfrags - 2 : 256);
+  uint32_t j = 0;
+  for (uint32_t i = 0; i < map.numbits; i++)
+  {
+    const uint32_t f = map.bitmap_base + i;
+    while (j < npresent && present[j] < f)
+      j++;
+    const bool missing = (j == npresent || present[j] != f);
+    CU_ASSERT_EQ_FATAL (ddsi_bitset_isset (map.numbits, mapbits, i) != 0, missing);
+  }
+}
+
+static void do_defrag_fragments (uint32_t fragsize, uint32_t nfrags)
+{
+  struct ddsi_defrag *defrag = ddsi_defrag_new (&gv.logconfig, DDSI_DEFRAG_DROP_LATEST, 1, 0);
+  struct ddsi_rmsg *rmsg = ddsi_rmsg_new (rbpool);
+  ddsi_rmsg_setsize (rmsg, 0);
+  struct ddsi_receiver_state *rst = ddsi_rmsg_alloc (rmsg, sizeof (*rst));
+  memset (rst, 0, sizeof (*rst));
+  const uint32_t present[] = { 0, 2, 5, nfrags - 1 };
+  const uint32_t npresent = (uint32_t) (sizeof (present) / sizeof (present[0]));
+  uint64_t discarded_bytes;
+
+  for (uint32_t i = 0; i < npresent; i++)
+    CU_ASSERT_EQ_FATAL (insert_fragments (defrag, rmsg, rst, fragsize, nfrags, present[i], present[i] + 1), NULL);
+  // fragments that have been received imply all preceding ones have been published
+  check_nackmap (defrag, UINT32_MAX, nfrags, present, npresent);
+  check_nackmap (defrag, 3, nfrags, present, npresent);
+
+  // duplicates get discarded
+  CU_ASSERT_EQ_FATAL (insert_fragments (defrag, rmsg, rst, fragsize, nfrags, 2, 3), NULL);
+  CU_ASSERT_EQ_FATAL (insert_fragments (defrag, rmsg, rst, fragsize, nfrags, nfrags - 1, nfrags), NULL);
+  ddsi_defrag_stats (defrag, &discarded_bytes);
+  CU_ASSERT_EQ_FATAL (discarded_bytes, 2 * fragsize);
+  check_nackmap (defrag, UINT32_MAX, nfrags, present, npresent);
+
+  // filling the gaps completes the sample
+  CU_ASSERT_EQ_FATAL (insert_fragments (defrag, rmsg, rst, fragsize, nfrags, 6, nfrags - 1), NULL);
+  CU_ASSERT_EQ_FATAL (insert_fragments (defrag, rmsg, rst, fragsize, nfrags, 3, 5), NULL);
+  struct ddsi_rsample *rsample = insert_fragments (defrag, rmsg, rst, fragsize, nfrags, 1, 2);
+  CU_ASSERT_NEQ_FATAL (rsample, NULL);
+  ddsi_fragchain_adjust_refcount (ddsi_rsample_fragchain (rsample), 0);
+  ddsi_defrag_stats (defrag, &discarded_bytes);
+  CU_ASSERT_EQ_FATAL (discarded_bytes, 2 * fragsize);
+
+  ddsi_rmsg_commit (rmsg);
+  ddsi_defrag_free (defrag);
+}
+
+CU_Test (ddsi_radmin, defrag_fragments, .init = setup, .fini = teardown)
+{
+  // few fragments: tracked using a bitmap, many fragments: only in the interval tree
+  do_defrag_fragments (100, 10);
+  do_defrag_fragments (1, 10000);
+}
+
+static uint32_t n_from_ser_prealloc;
+
+static struct ddsi_serdata *failing_from_ser_prealloc (const struct ddsi_sertype *type, enum ddsi_serdata_kind kind, size_t size, void **buf)
+{
+  (void) type; (void) kind; (void) size; (void) buf;
+  n_from_ser_prealloc++;
+  return NULL;
+}
+
+static struct ddsi_rsample *insert_fragments_direct (struct ddsi_defrag *defrag, struct ddsi_rmsg *rmsg, struct ddsi_receiver_state *rst, const struct ddsi_sertype *type, ddsi_seqno_t seq, uint32_t size, uint32_t min, uint32_t maxp1)
+{
+  // inserts bytes [min,maxp1) of sample seq of the given size, asking for direct defragmentation
+  struct ddsi_rsample_info *si = ddsi_rmsg_alloc (rmsg, sizeof (*si));
+  CU_ASSERT_NEQ_FATAL (si, NULL);
+  memset (si, 0, sizeof (*si));
+  si->rst = rst;
+  si->size = size;
+  si->fragsize = 100;
+  si->seq = seq;
+  si->assembly_type = type;
+  struct ddsi_rdata *rdata = ddsi_rdata_new (rmsg, min, maxp1, 0, 0, 0);
+  CU_ASSERT_NEQ_FATAL (rdata, NULL);
+  return ddsi_defrag_rsample (defrag, rdata, si);
+}
+
+CU_Test (ddsi_radmin, defrag_direct_max_size, .init = setup, .fini = teardown)
+{
+  // the type is only passed to from_ser_prealloc, which fails here
+  const struct ddsi_serdata_ops ops = { .from_ser_prealloc = failing_from_ser_prealloc };
+  struct ddsi_sertype type;
+  memset (&type, 0, sizeof (type));
+  type.serdata_ops = &ops;
+  struct ddsi_defrag *defrag = ddsi_defrag_new (&gv.logconfig, DDSI_DEFRAG_DROP_LATEST, 2, 1000);
+  struct ddsi_rmsg *rmsg = ddsi_rmsg_new (rbpool);
+  ddsi_rmsg_setsize (rmsg, 0);
+  struct ddsi_receiver_state *rst = ddsi_rmsg_alloc (rmsg, sizeof (*rst));
+  memset (rst, 0, sizeof (*rst));
+  n_from_ser_prealloc = 0;
+
+  // a fragment claiming an absurd sample size mustn't lead to allocating it
+  CU_ASSERT_EQ_FATAL (insert_fragments_direct (defrag, rmsg, rst, &type, 1, INT32_MAX, 0, 100), NULL);
+  CU_ASSERT_EQ_FATAL (n_from_ser_prealloc, 0);
+
+  // one within the limit is tried, and failing to allocate it means the fragment
+  // chain gets used instead
+  CU_ASSERT_EQ_FATAL (insert_fragments_direct (defrag, rmsg, rst, &type, 2, 1000, 0, 500), NULL);
+  CU_ASSERT_EQ_FATAL (n_from_ser_prealloc, 1);
+  struct ddsi_rsample *rsample = insert_fragments_direct (defrag, rmsg, rst, &type, 2, 1000, 500, 1000);
+  CU_ASSERT_NEQ_FATAL (rsample, NULL);
+  CU_ASSERT_EQ_FATAL (n_from_ser_prealloc, 1);
+  struct ddsi_rdata *fragchain = ddsi_rsample_fragchain (rsample);
+  CU_ASSERT_EQ_FATAL (fragchain->min, 0);
+  CU_ASSERT_EQ_FATAL (fragchain->maxp1, 500);
+  CU_ASSERT_NEQ_FATAL (fragchain->nextfrag, NULL);
+  CU_ASSERT_EQ_FATAL (fragchain->nextfrag->maxp1, 1000);
+  ddsi_fragchain_adjust_refcount (fragchain, 0);
+
+  ddsi_rmsg_commit (rmsg);
+  ddsi_defrag_free (defrag);
+}
+
+static struct ddsi_rmsg *new_held_rmsg (struct ddsi_rbufpool *rbp, struct ddsi_defrag *defrag, struct ddsi_reorder *reorder)
+{
+  // a message with a sample the reorder admin holds on to because it is waiting for an earlier one
+  struct ddsi_rmsg *rmsg = ddsi_rmsg_new (rbp);
+  CU_ASSERT_NEQ_FATAL (rmsg, NULL);
+  ddsi_rmsg_setsize (rmsg, 0);
+  struct ddsi_receiver_state *rst = ddsi_rmsg_alloc (rmsg, sizeof (*rst));
+  memset (rst, 0, sizeof (*rst));
+  insert_sample (defrag, reorder, rmsg, rst, 2);
+  ddsi_rmsg_commit (rmsg);
+  return rmsg;
+}
+
+static void check_rbuf_stats (struct ddsi_rbufpool *rbp, uint32_t rbuf_size, uint32_t nlive, uint32_t npinned, uint64_t nallocs, uint64_t nreuses)
+{
+  uint64_t live_bytes, pinned_bytes, allocs, reuses;
+  ddsi_rbufpool_stats (rbp, &live_bytes, &pinned_bytes, &allocs, &reuses);
+  CU_ASSERT_EQ_FATAL (live_bytes, (uint64_t) nlive * rbuf_size);
+  CU_ASSERT_EQ_FATAL (pinned_bytes, (uint64_t) npinned * rbuf_size);
+  CU_ASSERT_EQ_FATAL (allocs, nallocs);
+  CU_ASSERT_EQ_FATAL (reuses, nreuses);
+}
+
+CU_Test (ddsi_radmin, rbuf_reuse, .init = setup, .fini = teardown)
+{
+  // an rbuf size of 1 gets raised to the minimum, which is exactly one message
+  struct ddsi_rbufpool *rbp = ddsi_rbufpool_new (&gv.logconfig, 1, 1024);
+  CU_ASSERT_NEQ_FATAL (rbp, NULL);
+  uint64_t rbuf_size64, dummy;
+  ddsi_rbufpool_stats (rbp, &rbuf_size64, &dummy, &dummy, &dummy);
+  const uint32_t rbuf_size = (uint32_t) rbuf_size64;
+  check_rbuf_stats (rbp, rbuf_size, 1, 0, 1, 0);
+
+  struct ddsi_defrag *defrag = ddsi_defrag_new (&gv.logconfig, DDSI_DEFRAG_DROP_LATEST, 1, 0);
+  struct ddsi_reorder *reorder = ddsi_reorder_new (&gv.logconfig, DDSI_REORDER_MODE_NORMAL, 3, false);
+  (void) new_held_rmsg (rbp, defrag, reorder);
+  check_rbuf_stats (rbp, rbuf_size, 1, 0, 1, 0);
+
+  // the next message doesn't fit anymore, the old rbuf is retired but pinned by
+  // the stored sample
+  struct ddsi_rmsg *rmsg = ddsi_rmsg_new (rbp);
+  check_rbuf_stats (rbp, rbuf_size, 2, 1, 2, 0);
+  ddsi_rmsg_setsize (rmsg, 0);
+  ddsi_rmsg_commit (rmsg);
+
+  // dropping the stored sample releases the old rbuf to the cache
+  ddsi_reorder_free (reorder);
+  check_rbuf_stats (rbp, rbuf_size, 1, 0, 2, 0);
+
+  // switching rbufs again takes the one from the cache
+  reorder = ddsi_reorder_new (&gv.logconfig, DDSI_REORDER_MODE_NORMAL, 3, false);
+  (void) new_held_rmsg (rbp, defrag, reorder);
+  rmsg = ddsi_rmsg_new (rbp);
+  check_rbuf_stats (rbp, rbuf_size, 2, 1, 2, 1);
+  ddsi_rmsg_setsize (rmsg, 0);
+  ddsi_rmsg_commit (rmsg);
+
+  ddsi_reorder_free (reorder);
+  ddsi_defrag_free (defrag);
+  check_rbuf_stats (rbp, rbuf_size, 1, 0, 2, 1);
+  ddsi_rbufpool_free (rbp);
+}
+
+#define DQUEUE_NPRODUCERS 4
+#define DQUEUE_NSAMPLES 10000
+#define DQUEUE_MAXSAMPLES 16
+
+struct dqueue_item {
+  uint32_t *next_exp;
+  uint32_t seq;
+};
+
+struct dqueue_sync {
+  ddsrt_mutex_t lock;
+  ddsrt_cond_t cond;
+  bool ready;
+};
+
+static uint32_t dqueue_out_of_order;
+
+static void dqueue_item_cb (void *varg)
+{
+  struct dqueue_item const * const item = varg;
+  // only ever called from the delivery thread, so no need for atomics
+  if (item->seq != *item->next_exp)
+    dqueue_out_of_order++;
+  *item->next_exp = item->seq + 1;
+}
+
+static void dqueue_sync_cb (void *varg)
+{
+  struct dqueue_sync *sync = varg;
+  ddsrt_mutex_lock (&sync->lock);
+  sync->ready = true;
+  ddsrt_cond_broadcast (&sync->cond);
+  ddsrt_mutex_unlock (&sync->lock);
+}
+
+static void dqueue_sync (struct ddsi_dqueue *q)
+{
+  struct dqueue_sync sync;
+  ddsrt_mutex_init (&sync.lock);
+  ddsrt_cond_init (&sync.cond);
+  sync.ready = false;
+  ddsi_dqueue_enqueue_callback (q, dqueue_sync_cb, &sync);
+  ddsrt_mutex_lock (&sync.lock);
+  while (!sync.ready)
+    ddsrt_cond_wait (&sync.cond, &sync.lock);
+  ddsrt_mutex_unlock (&sync.lock);
+  ddsrt_cond_destroy (&sync.cond);
+  ddsrt_mutex_destroy (&sync.lock);
+}
+
+struct dqueue_producer_arg {
+  struct ddsi_dqueue *q;
+  struct dqueue_item *items;
+};
+
+static uint32_t dqueue_producer (void *varg)
+{
+  struct dqueue_producer_arg const * const arg = varg;
+  for (uint32_t i = 0; i < DQUEUE_NSAMPLES; i++)
+  {
+    ddsi_dqueue_wait_until_empty_if_full (arg->q);
+    ddsi_dqueue_enqueue_callback (arg->q, dqueue_item_cb, &arg->items[i]);
+  }
+  return 0;
+}
+
+CU_Test (ddsi_radmin, dqueue_multi_producer, .init = setup, .fini = teardown)
+{
+  struct ddsi_dqueue *q = ddsi_dqueue_new ("test", &gv, DQUEUE_MAXSAMPLES, NULL, NULL);
+  CU_ASSERT_NEQ_FATAL (q, NULL);
+  CU_ASSERT_FATAL (ddsi_dqueue_start (q));
+
+  // make sure the delivery thread has to be woken up at least once
+  dqueue_sync (q);
+  dds_sleepfor (DDS_MSECS (10));
+  dqueue_sync (q);
+
+  static uint32_t next_exp[DQUEUE_NPRODUCERS];
+  struct dqueue_producer_arg args[DQUEUE_NPRODUCERS];
+  ddsrt_thread_t tids[DQUEUE_NPRODUCERS];
+  dqueue_out_of_order = 0;
+  for (int p = 0; p < DQUEUE_NPRODUCERS; p++)
+  {
+    ddsrt_threadattr_t tattr;
+    next_exp[p] = 0;
+    args[p].q = q;
+    args[p].items = ddsrt_malloc (DQUEUE_NSAMPLES * sizeof (*args[p].items));
+    for (uint32_t i = 0; i < DQUEUE_NSAMPLES; i++)
+      args[p].items[i] = (struct dqueue_item) { .next_exp = &next_exp[p], .seq = i };
+    ddsrt_threadattr_init (&tattr);
+    dds_return_t rc = ddsrt_thread_create (&tids[p], "dqueue_producer", &tattr, dqueue_producer, &args[p]);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  }
+  for (int p = 0; p < DQUEUE_NPRODUCERS; p++)
+    (void) ddsrt_thread_join (tids[p], NULL);
+  dqueue_sync (q);
+
+  // everything delivered in the order in which each producer enqueued it
+  CU_ASSERT_EQ (dqueue_out_of_order, 0);
+  for (int p = 0; p < DQUEUE_NPRODUCERS; p++)
+  {
+    CU_ASSERT_EQ (next_exp[p], DQUEUE_NSAMPLES);
+    ddsrt_free (args[p].items);
+  }
+
+  // a producer only adds a sample if the queue wasn't full, but several may do so at the same time
+  uint32_t nof_samples, max_nof_samples;
+  uint64_t wakeups;
+  ddsi_dqueue_stats (q, &nof_samples, &max_nof_samples, &wakeups);
+  printf ("dqueue: max samples %"PRIu32" wakeups %"PRIu64"\n", max_nof_samples, wakeups);
+  CU_ASSERT_EQ (nof_samples, 0);
+  CU_ASSERT_GT (max_nof_samples, 0);
+  CU_ASSERT_LEQ (max_nof_samples, DQUEUE_MAXSAMPLES - 1 + DQUEUE_NPRODUCERS);
+  CU_ASSERT_GT (wakeups, 0);
+  ddsi_dqueue_free (q);
+}
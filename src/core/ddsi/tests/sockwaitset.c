@@ -0,0 +1,237 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sockets.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/time.h"
+#include "ddsi__sockwaitset.h"
+#include "ddsi__tran.h"
+#include "CUnit/Test.h"
+
+#define LATENCY_ROUNDS 2000
+
+/* the waitset only needs the socket of a connection */
+struct fake_conn {
+  struct ddsi_tran_conn c;
+  ddsrt_socket_t sock;
+};
+
+static ddsrt_socket_t fake_conn_handle (struct ddsi_tran_base *base)
+{
+  return ((struct fake_conn *) base)->sock;
+}
+
+static void fake_conn_init (struct fake_conn *fc, struct sockaddr_in *addr)
+{
+  socklen_t addrlen = sizeof (*addr);
+  dds_return_t rc;
+  memset (fc, 0, sizeof (*fc));
+  fc->c.m_base.m_handle_fn = fake_conn_handle;
+  memset (addr, 0, sizeof (*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  rc = ddsrt_socket (&fc->sock, AF_INET, SOCK_DGRAM, 0);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  rc = ddsrt_bind (fc->sock, (struct sockaddr *) addr, sizeof (*addr));
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  rc = ddsrt_getsockname (fc->sock, (struct sockaddr *) addr, &addrlen);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+}
+
+static void fake_conn_fini (struct fake_conn *fc)
+{
+  (void) ddsrt_close (fc->sock);
+}
+
+static void send_to (const struct fake_conn *fc, const struct sockaddr_in *addr, int64_t v)
+{
+  ddsrt_iovec_t iov = { .iov_base = (void *) &v, .iov_len = sizeof (v) };
+  ddsrt_msghdr_t msg;
+  size_t sent;
+  memset (&msg, 0, sizeof (msg));
+  msg.msg_name = (void *) addr;
+  msg.msg_namelen = (socklen_t) sizeof (*addr);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  dds_return_t rc = ddsrt_sendmsg (fc->sock, &msg, 0, &sent);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+}
+
+static int64_t recv_from (const struct fake_conn *fc)
+{
+  int64_t v;
+  size_t rcvd;
+  dds_return_t rc = ddsrt_recv (fc->sock, &v, sizeof (v), 0, &rcvd);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  CU_ASSERT_EQ_FATAL (rcvd, sizeof (v));
+  return v;
+}
+
+/* returns the index of the single connection with data, -1 if none */
+static int wait_one (struct ddsi_sock_waitset *ws, struct ddsi_tran_conn **conn)
+{
+  struct ddsi_sock_waitset_ctx *ctx;
+  struct ddsi_tran_conn *c;
+  int idx, res = -1;
+  ctx = ddsi_sock_waitset_wait (ws);
+  CU_ASSERT_FATAL (ctx != NULL);
+  while ((idx = ddsi_sock_waitset_next_event (ctx, &c)) >= 0)
+  {
+    CU_ASSERT_FATAL (res == -1);
+    res = idx;
+    *conn = c;
+  }
+  return res;
+}
+
+static struct ddsi_sock_waitset *new_waitset (enum ddsi_sock_waitset_mode mode)
+{
+  struct ddsi_sock_waitset *ws = ddsi_sock_waitset_new (mode);
+  if (mode == DDSI_SOCK_WAITSET_DEFAULT)
+    CU_ASSERT_FATAL (ws != NULL);
+  else if (ws == NULL)
+    printf ("sock waitset mode %d not supported\n", (int) mode);
+  return ws;
+}
+
+static void do_basic (enum ddsi_sock_waitset_mode mode)
+{
+  struct ddsi_sock_waitset *ws;
+  struct fake_conn fcs[2];
+  struct sockaddr_in addrs[2];
+  struct ddsi_tran_conn *conn;
+
+  if ((ws = new_waitset (mode)) == NULL)
+    return;
+  for (int i = 0; i < 2; i++)
+  {
+    fake_conn_init (&fcs[i], &addrs[i]);
+    CU_ASSERT_EQ_FATAL (ddsi_sock_waitset_add (ws, &fcs[i].c), 1);
+  }
+  CU_ASSERT_EQ_FATAL (ddsi_sock_waitset_add (ws, &fcs[1].c), 0);
+
+  ddsi_sock_waitset_trigger (ws);
+  CU_ASSERT_EQ (wait_one (ws, &conn), -1);
+
+  /* level-triggered: an event keeps being reported until the data has been read */
+  send_to (&fcs[0], &addrs[1], 1);
+  for (int i = 0; i < 2; i++)
+  {
+    CU_ASSERT_EQ_FATAL (wait_one (ws, &conn), 1);
+    CU_ASSERT_FATAL (conn == &fcs[1].c);
+  }
+  CU_ASSERT_EQ (recv_from (&fcs[1]), 1);
+
+  /* after dropping the second one, only the first one gets reported */
+  ddsi_sock_waitset_purge (ws, 1);
+  send_to (&fcs[0], &addrs[1], 2);
+  send_to (&fcs[1], &addrs[0], 3);
+  CU_ASSERT_EQ_FATAL (wait_one (ws, &conn), 0);
+  CU_ASSERT_FATAL (conn == &fcs[0].c);
+  CU_ASSERT_EQ (recv_from (&fcs[0]), 3);
+  ddsi_sock_waitset_trigger (ws);
+  CU_ASSERT_EQ (wait_one (ws, &conn), -1);
+
+  /* re-adding it gets it reported again */
+  CU_ASSERT_EQ_FATAL (ddsi_sock_waitset_add (ws, &fcs[1].c), 1);
+  CU_ASSERT_EQ_FATAL (wait_one (ws, &conn), 1);
+  CU_ASSERT_FATAL (conn == &fcs[1].c);
+  CU_ASSERT_EQ (recv_from (&fcs[1]), 2);
+
+  ddsi_sock_waitset_free (ws);
+  for (int i = 0; i < 2; i++)
+    fake_conn_fini (&fcs[i]);
+}
+
+CU_Test (ddsi_sockwaitset, basic)
+{
+  do_basic (DDSI_SOCK_WAITSET_DEFAULT);
+  do_basic (DDSI_SOCK_WAITSET_IO_URING);
+}
+
+struct latency_arg {
+  struct ddsi_sock_waitset *ws;
+  struct fake_conn *fc;
+  const struct sockaddr_in *peer;
+  int64_t *lat;
+};
+
+static uint32_t latency_thread (void *varg)
+{
+  struct latency_arg * const arg = varg;
+  struct ddsi_tran_conn *conn;
+  for (int i = 0; i < LATENCY_ROUNDS; i++)
+  {
+    while (wait_one (arg->ws, &conn) < 0)
+      ;
+    const int64_t t0 = recv_from (arg->fc);
+    arg->lat[i] = ddsrt_time_monotonic ().v - t0;
+    send_to (arg->fc, arg->peer, 0);
+  }
+  return 0;
+}
+
+static int cmp_int64 (const void *va, const void *vb)
+{
+  const int64_t *a = va, *b = vb;
+  return (*a == *b) ? 0 : (*a < *b) ? -1 : 1;
+}
+
+static void do_latency (enum ddsi_sock_waitset_mode mode, const char *name)
+{
+  struct ddsi_sock_waitset *ws;
+  struct fake_conn fcs[2];
+  struct sockaddr_in addrs[2];
+  int64_t *lat;
+  ddsrt_threadattr_t tattr;
+  ddsrt_thread_t tid;
+  dds_return_t rc;
+
+  if ((ws = new_waitset (mode)) == NULL)
+    return;
+  for (int i = 0; i < 2; i++)
+    fake_conn_init (&fcs[i], &addrs[i]);
+  CU_ASSERT_EQ_FATAL (ddsi_sock_waitset_add (ws, &fcs[1].c), 1);
+  lat = ddsrt_malloc (LATENCY_ROUNDS * sizeof (*lat));
+
+  struct latency_arg arg = { .ws = ws, .fc = &fcs[1], .peer = &addrs[0], .lat = lat };
+  ddsrt_threadattr_init (&tattr);
+  rc = ddsrt_thread_create (&tid, "sockwaitset_latency", &tattr, latency_thread, &arg);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  for (int i = 0; i < LATENCY_ROUNDS; i++)
+  {
+    send_to (&fcs[0], &addrs[1], ddsrt_time_monotonic ().v);
+    (void) recv_from (&fcs[0]);
+  }
+  rc = ddsrt_thread_join (tid, NULL);
+  CU_ASSERT_EQ (rc, DDS_RETCODE_OK);
+
+  /* wake-up-to-handle latency as seen by the thread waiting on the waitset */
+  qsort (lat, LATENCY_ROUNDS, sizeof (*lat), cmp_int64);
+  printf ("sock waitset %-8s latency [us]: min %.1f median %.1f 90%% %.1f 99%% %.1f\n", name,
+          (double) lat[0] / 1e3, (double) lat[LATENCY_ROUNDS / 2] / 1e3,
+          (double) lat[LATENCY_ROUNDS * 9 / 10] / 1e3, (double) lat[LATENCY_ROUNDS * 99 / 100] / 1e3);
+
+  ddsrt_free (lat);
+  ddsi_sock_waitset_free (ws);
+  for (int i = 0; i < 2; i++)
+    fake_conn_fini (&fcs[i]);
+}
+
+CU_Test (ddsi_sockwaitset, latency)
+{
+  do_latency (DDSI_SOCK_WAITSET_DEFAULT, "default");
+  do_latency (DDSI_SOCK_WAITSET_IO_URING, "io_uring");
+}
@@ -90,6 +90,7 @@
 #include "dds/ddsc/dds_psmx.h"
 
 #include "dds/cdr/dds_cdrstream.h"
+#include "dds/cdr/dds_cdrstream_specialized.h"
 
 #include "dds__write.h"
 #include "dds__writer.h"
@@ -210,6 +211,7 @@ int main (int argc, char **argv)
   dds_writecdr (1, ptr);
   dds_forwardcdr (1, ptr);
   dds_write_ts (1, ptr, 0);
+  dds_write_batch (1, ptr, 0, 0);
   dds_create_readcondition (1, 0);
   dds_create_querycondition (1, 0, 0);
   dds_create_guardcondition (1);
@@ -248,6 +250,10 @@ int main (int argc, char **argv)
   dds_take_instance_mask_wl (1, ptr, ptr, 0, 1, 0);
   dds_take_next (1, ptr, ptr);
   dds_take_next_wl (1, ptr, ptr);
+  dds_sample_arena_create (0);
+  dds_sample_arena_reset (ptr);
+  dds_sample_arena_delete (ptr);
+  dds_take_arena (1, ptr, ptr, 0, 0, ptr);
   dds_peekcdr (1, ptr, 0, ptr, 0);
   dds_peekcdr_instance (1, ptr, 0, ptr, 1, 0);
   dds_readcdr (1, ptr, 0, ptr, 0);
@@ -266,6 +272,7 @@ int main (int argc, char **argv)
   dds_get_topic (1);
   dds_get_matched_subscriptions (1, ptr, 0);
   dds_get_matched_subscription_data (1, 1);
+  dds_get_matched_subscription_rtt (1, 1, ptr, ptr);
   dds_get_matched_publications (1, ptr, 0);
   dds_get_matched_publication_data (1, 1);
 #ifdef DDS_HAS_TYPELIB
@@ -482,6 +489,7 @@ int main (int argc, char **argv)
   dds_rhc_take (ptr, 0, 0, 1, ptr, 0, 0);
   dds_rhc_add_readcondition (ptr, ptr);
   dds_rhc_remove_readcondition (ptr, ptr);
+  dds_rhc_get_slab_stats (ptr, ptr);
   dds_reader_data_available_cb (ptr);
 
   // dds_statistics.h
@@ -536,6 +544,10 @@ int main (int argc, char **argv)
   dds_cdrstream_desc_from_topic_desc (ptr, ptr2);
   dds_cdrstream_desc_init_with_nops (ptr, ptr2, 0, 0, 0, ptr3, 0, ptr4, 0);
   dds_cdrstream_desc_init (ptr, ptr2, 0, 0, 0, ptr3, ptr4, 0);
+
+  // dds_cdrstream_specialized.h
+  dds_ostream_reserve (ptr, ptr2, 0);
+  dds_stream_adjust_sequence_buffer (ptr, ptr2, 0, 0, 0);
   dds_cdrstream_desc_fini (ptr, ptr2);
 
   // dds_psmx.h
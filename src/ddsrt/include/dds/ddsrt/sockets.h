@@ -244,6 +244,38 @@ ddsrt_sendmsg(
   size_t *sent)
 ddsrt_nonnull ((2));
 
+/** @brief Maximum number of messages that can be sent in a single call to @ref ddsrt_sendmmsg */
+#define DDSRT_SENDMMSG_MAX 64
+
+/**
+ * @brief Send multiple messages
+ *
+ * - Attempts to send all 'vlen' messages, but may stop early, in which case 'nmsgs' is set to the
+ *   number of messages that were sent. An error is returned only if the first message could not be
+ *   sent.
+ * - On platforms where DDSRT_HAVE_SENDMMSG is false, this sends exactly one message.
+ * - The 'flags' are as for @ref ddsrt_sendmsg.
+ *
+ * @param[in] sock the socket
+ * @param[in] msgs array of 'vlen' messages to send
+ * @param[out] sent array of 'vlen' entries, entry i is set to the number of bytes sent for message i
+ * @param[in] vlen number of entries in 'msgs' and 'sent', must be in [1,DDSRT_SENDMMSG_MAX]
+ * @param[in] flags flags for special options
+ * @param[out] nmsgs number of messages sent (>= 1 if return == OK, 0 if return != OK)
+ * @return a DDS_RETCODE (OK, ERROR, and more)
+ *
+ * See @ref ddsrt_sendmsg
+ */
+dds_return_t
+ddsrt_sendmmsg(
+  ddsrt_socket_t sock,
+  const ddsrt_msghdr_t *msgs,
+  size_t *sent,
+  size_t vlen,
+  int flags,
+  size_t *nmsgs)
+ddsrt_nonnull_all;
+
 /**
  * @brief Receive data into a buffer
  *
@@ -296,6 +328,37 @@ ddsrt_recvmsg(
   size_t *rcvd)
 ddsrt_attribute_warn_unused_result ddsrt_nonnull_all;
 
+/** @brief Maximum number of messages that can be received in a single call to @ref ddsrt_recvmmsg */
+#define DDSRT_RECVMMSG_MAX 64
+
+/**
+ * @brief Receive multiple messages
+ *
+ * - Waits for a message to arrive in the same way as @ref ddsrt_recvmsg, then also receives any further
+ *   messages that are immediately available, up to 'vlen' messages in total.
+ * - On platforms where DDSRT_HAVE_RECVMMSG is false, this receives exactly one message.
+ * - The 'flags' are as for @ref ddsrt_recvmsg.
+ *
+ * @param[in] sockext the socket
+ * @param[in,out] msgs array of 'vlen' message headers
+ * @param[out] rcvd array of 'vlen' entries, entry i is set to the number of bytes received in message i
+ * @param[in] vlen number of entries in 'msgs' and 'rcvd', must be in [1,DDSRT_RECVMMSG_MAX]
+ * @param[in] flags flags for special options
+ * @param[out] nmsgs number of messages received (>= 1 if return == OK, 0 if return != OK)
+ * @return a DDS_RETCODE (OK, ERROR, TRY_AGAIN, BAD_PARAMETER, NO_CONNECTION, INTERRUPTED, OUT_OF_RESOURCES, ILLEGAL_OPERATION)
+ *
+ * See @ref ddsrt_recvmsg
+ */
+dds_return_t
+ddsrt_recvmmsg(
+  const ddsrt_socket_ext_t *sockext,
+  ddsrt_msghdr_t *msgs,
+  size_t *rcvd,
+  size_t vlen,
+  int flags,
+  size_t *nmsgs)
+ddsrt_attribute_warn_unused_result ddsrt_nonnull_all;
+
 /**
  * @brief Get options from the socket.
  *
@@ -40,6 +40,9 @@ typedef struct ddsrt_msghdr {
 } ddsrt_msghdr_t;
 
 #define DDSRT_MSGHDR_FLAGS 1
+#define DDSRT_HAVE_RECVMMSG 0
+#define DDSRT_HAVE_SENDMMSG 0
+#define DDSRT_HAVE_REUSEPORT_LB 0
 
 #if defined(__cplusplus)
 }
@@ -8,6 +8,9 @@
 //
 // SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
 
+/* _GNU_SOURCE is required for recvmmsg, sendmmsg and struct mmsghdr on Linux. */
+#define _GNU_SOURCE
+
 #include <assert.h>
 #include <string.h>
 #include <unistd.h>
@@ -487,6 +490,46 @@ ddsrt_recvmsg(
   return recv_error_to_retcode(errno);
 }
 
+dds_return_t
+ddsrt_recvmmsg(
+  const ddsrt_socket_ext_t *sockext,
+  ddsrt_msghdr_t *msgs,
+  size_t *rcvd,
+  size_t vlen,
+  int flags,
+  size_t *nmsgs)
+{
+  assert(vlen > 0 && vlen <= DDSRT_RECVMMSG_MAX);
+#if DDSRT_HAVE_RECVMMSG
+  struct mmsghdr mmsgs[DDSRT_RECVMMSG_MAX];
+  int n;
+
+  for (size_t i = 0; i < vlen; i++) {
+    mmsgs[i].msg_hdr = msgs[i];
+    mmsgs[i].msg_len = 0;
+  }
+  /* MSG_WAITFORONE: block for the first one only, without it a blocking
+     socket would wait until all 'vlen' messages have been received */
+  if ((n = recvmmsg(sockext->sock, mmsgs, (unsigned) vlen, flags | MSG_WAITFORONE, NULL)) > 0) {
+    for (int i = 0; i < n; i++) {
+      msgs[i] = mmsgs[i].msg_hdr;
+      rcvd[i] = (size_t) mmsgs[i].msg_len;
+    }
+    *nmsgs = (size_t) n;
+    return DDS_RETCODE_OK;
+  }
+
+  *nmsgs = 0;
+  return (n == 0) ? DDS_RETCODE_TRY_AGAIN : recv_error_to_retcode(errno);
+#else
+  dds_return_t rc;
+  (void) vlen;
+  rc = ddsrt_recvmsg(sockext, &msgs[0], flags, &rcvd[0]);
+  *nmsgs = (rc == DDS_RETCODE_OK) ? 1 : 0;
+  return rc;
+#endif
+}
+
 static inline dds_return_t
 send_error_to_retcode(int errnum)
 {
@@ -570,6 +613,42 @@ ddsrt_sendmsg(
   return send_error_to_retcode(errno);
 }
 
+dds_return_t
+ddsrt_sendmmsg(
+  ddsrt_socket_t sock,
+  const ddsrt_msghdr_t *msgs,
+  size_t *sent,
+  size_t vlen,
+  int flags,
+  size_t *nmsgs)
+{
+  assert(vlen > 0 && vlen <= DDSRT_SENDMMSG_MAX);
+#if DDSRT_HAVE_SENDMMSG
+  struct mmsghdr mmsgs[DDSRT_SENDMMSG_MAX];
+  int n;
+
+  for (size_t i = 0; i < vlen; i++) {
+    mmsgs[i].msg_hdr = msgs[i];
+    mmsgs[i].msg_len = 0;
+  }
+  if ((n = sendmmsg(sock, mmsgs, (unsigned) vlen, flags)) > 0) {
+    for (int i = 0; i < n; i++)
+      sent[i] = (size_t) mmsgs[i].msg_len;
+    *nmsgs = (size_t) n;
+    return DDS_RETCODE_OK;
+  }
+
+  *nmsgs = 0;
+  return (n == 0) ? DDS_RETCODE_TRY_AGAIN : send_error_to_retcode(errno);
+#else
+  dds_return_t rc;
+  (void) vlen;
+  rc = ddsrt_sendmsg(sock, &msgs[0], flags, &sent[0]);
+  *nmsgs = (rc == DDS_RETCODE_OK) ? 1 : 0;
+  return rc;
+#endif
+}
+
 dds_return_t
 ddsrt_select(
   int32_t nfds,
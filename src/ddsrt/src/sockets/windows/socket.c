@@ -626,6 +626,23 @@ ddsrt_recvmsg(
     return ddsrt_recvmsg_recvfrom (sockext, msg, flags, rcvd);
 }
 
+dds_return_t
+ddsrt_recvmmsg(
+  const ddsrt_socket_ext_t *sockext,
+  ddsrt_msghdr_t *msgs,
+  size_t *rcvd,
+  size_t vlen,
+  int flags,
+  size_t *nmsgs)
+{
+  dds_return_t rc;
+  assert(vlen > 0 && vlen <= DDSRT_RECVMMSG_MAX);
+  (void)vlen;
+  rc = ddsrt_recvmsg(sockext, &msgs[0], flags, &rcvd[0]);
+  *nmsgs = (rc == DDS_RETCODE_OK) ? 1 : 0;
+  return rc;
+}
+
 static dds_return_t
 send_error_to_retcode(int errnum)
 {
@@ -729,6 +746,23 @@ ddsrt_sendmsg(
   return send_error_to_retcode(WSAGetLastError());
 }
 
+dds_return_t
+ddsrt_sendmmsg(
+  ddsrt_socket_t sock,
+  const ddsrt_msghdr_t *msgs,
+  size_t *sent,
+  size_t vlen,
+  int flags,
+  size_t *nmsgs)
+{
+  dds_return_t rc;
+  assert(vlen > 0 && vlen <= DDSRT_SENDMMSG_MAX);
+  (void)vlen;
+  rc = ddsrt_sendmsg(sock, &msgs[0], flags, &sent[0]);
+  *nmsgs = (rc == DDS_RETCODE_OK) ? 1 : 0;
+  return rc;
+}
+
 dds_return_t
 ddsrt_select(
   int32_t nfds,
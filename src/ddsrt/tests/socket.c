@@ -225,3 +225,124 @@ CU_Theory((char *name, int af, dds_return_t exp), ddsrt_gethostbyname, ipv6, .in
   CU_PASS("DNS and IPv6 are not supported");
 #endif /* DDSRT_HAVE_IPV6 */
 }
+
+CU_Test(ddsrt_sockets, recvmmsg, .init=setup, .fini=teardown)
+{
+  dds_return_t rc;
+  ddsrt_socket_t sock;
+  ddsrt_socket_ext_t sockext;
+  struct sockaddr_in addr = ipv4_loopback;
+  socklen_t addrlen = sizeof (addr);
+
+  rc = ddsrt_socket (&sock, AF_INET, SOCK_DGRAM, 0);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  rc = ddsrt_bind (sock, (struct sockaddr *) &addr, sizeof (addr));
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  rc = ddsrt_getsockname (sock, (struct sockaddr *) &addr, &addrlen);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  ddsrt_socket_ext_init (&sockext, sock);
+
+  for (uint32_t i = 0; i < 3; i++)
+  {
+    ddsrt_iovec_t iov = { .iov_base = (void *) &i, .iov_len = sizeof (i) };
+    ddsrt_msghdr_t msg;
+    size_t sent;
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_name = &addr;
+    msg.msg_namelen = (socklen_t) sizeof (addr);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    rc = ddsrt_sendmsg (sock, &msg, 0, &sent);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    CU_ASSERT_EQ (sent, sizeof (i));
+  }
+
+  uint32_t bufs[4];
+  ddsrt_iovec_t iovs[4];
+  ddsrt_msghdr_t msgs[4];
+  size_t rcvd[4], nmsgs = 0, nrecv = 0;
+  while (nrecv < 3)
+  {
+    for (size_t i = 0; i < 4; i++)
+    {
+      iovs[i].iov_base = (void *) &bufs[i];
+      iovs[i].iov_len = sizeof (bufs[i]);
+      memset (&msgs[i], 0, sizeof (msgs[i]));
+      msgs[i].msg_iov = &iovs[i];
+      msgs[i].msg_iovlen = 1;
+    }
+    rc = ddsrt_recvmmsg (&sockext, msgs, rcvd, 4, 0, &nmsgs);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    CU_ASSERT_FATAL (nmsgs >= 1 && nrecv + nmsgs <= 3);
+#if DDSRT_HAVE_RECVMMSG
+    /* loopback delivery is synchronous, so all are available at once */
+    CU_ASSERT_EQ (nmsgs, 3);
+#endif
+    for (size_t i = 0; i < nmsgs; i++)
+    {
+      CU_ASSERT_EQ (rcvd[i], sizeof (bufs[i]));
+      CU_ASSERT_EQ (bufs[i], (uint32_t) (nrecv + i));
+    }
+    nrecv += nmsgs;
+  }
+
+  ddsrt_socket_ext_fini (&sockext);
+  rc = ddsrt_close (sock);
+  CU_ASSERT_EQ (rc, DDS_RETCODE_OK);
+}
+
+CU_Test(ddsrt_sockets, sendmmsg, .init=setup, .fini=teardown)
+{
+  dds_return_t rc;
+  ddsrt_socket_t sock;
+  struct sockaddr_in addr = ipv4_loopback;
+  socklen_t addrlen = sizeof (addr);
+
+  rc = ddsrt_socket (&sock, AF_INET, SOCK_DGRAM, 0);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  rc = ddsrt_bind (sock, (struct sockaddr *) &addr, sizeof (addr));
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+  rc = ddsrt_getsockname (sock, (struct sockaddr *) &addr, &addrlen);
+  CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+
+  uint32_t bufs[3];
+  ddsrt_iovec_t iovs[3];
+  ddsrt_msghdr_t msgs[3];
+  size_t sent[3], nmsgs = 0, nsent = 0;
+  for (uint32_t i = 0; i < 3; i++)
+  {
+    bufs[i] = i;
+    iovs[i].iov_base = (void *) &bufs[i];
+    iovs[i].iov_len = sizeof (bufs[i]);
+    memset (&msgs[i], 0, sizeof (msgs[i]));
+    msgs[i].msg_name = &addr;
+    msgs[i].msg_namelen = (socklen_t) sizeof (addr);
+    msgs[i].msg_iov = &iovs[i];
+    msgs[i].msg_iovlen = 1;
+  }
+  while (nsent < 3)
+  {
+    rc = ddsrt_sendmmsg (sock, &msgs[nsent], &sent[nsent], 3 - nsent, 0, &nmsgs);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    CU_ASSERT_FATAL (nmsgs >= 1 && nsent + nmsgs <= 3);
+#if DDSRT_HAVE_SENDMMSG
+    CU_ASSERT_EQ (nmsgs, 3);
+#endif
+    for (size_t i = nsent; i < nsent + nmsgs; i++)
+      CU_ASSERT_EQ (sent[i], sizeof (bufs[i]));
+    nsent += nmsgs;
+  }
+
+  for (uint32_t i = 0; i < 3; i++)
+  {
+    uint32_t buf;
+    size_t rcvd;
+    rc = ddsrt_recv (sock, &buf, sizeof (buf), 0, &rcvd);
+    CU_ASSERT_EQ_FATAL (rc, DDS_RETCODE_OK);
+    CU_ASSERT_EQ (rcvd, sizeof (buf));
+    CU_ASSERT_EQ (buf, i);
+  }
+
+  rc = ddsrt_close (sock);
+  CU_ASSERT_EQ (rc, DDS_RETCODE_OK);
+}
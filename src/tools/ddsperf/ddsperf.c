@@ -1973,6 +1973,11 @@ EXAMPLES:\n\
   ddsperf -L -TOU -D10 pub sub\n\
     basic throughput test within the process with tiny, keyless samples,\n\
     running for 10s\n\
+  CYCLONEDDS_URI=\"<Internal><WhcRing>false</WhcRing></Internal>\" \\\n\
+      ddsperf -L -TOU -D10 pub sub\n\
+    the same, but using the general-purpose writer history cache instead of\n\
+    the ring buffer that is used by default for keyless topics, so that the\n\
+    two can be compared\n\
 ", argv0, argv0, argv0);
   fflush (stdout);
   exit (3);
@@ -26,6 +26,7 @@
 
 #include "libidlc__generator.h"
 #include "libidlc__descriptor.h"
+#include "libidlc__specialized.h"
 #include "hashid.h"
 #ifdef DDS_HAS_TYPELIB
 #include "idl/descriptor_type_meta.h"
@@ -2613,6 +2614,8 @@ static int print_flags(FILE *fp, struct descriptor *descriptor, bool type_info)
 
   if (descriptor->flags & DDS_TOPIC_RESTRICT_DATA_REPRESENTATION)
     vec[len++] = "DDS_TOPIC_RESTRICT_DATA_REPRESENTATION";
+  if (descriptor->flags & DDS_TOPIC_SPECIALIZED_OPS)
+    vec[len++] = "DDS_TOPIC_SPECIALIZED_OPS";
 
   bool fixed_size = true;
   for (struct constructed_type *ctype = descriptor->constructed_types; ctype && fixed_size; ctype = ctype->next) {
@@ -2722,6 +2725,11 @@ static int print_descriptor(FILE *fp, struct descriptor *descriptor, bool type_i
     }
   }
 
+  if (descriptor->flags & DDS_TOPIC_SPECIALIZED_OPS) {
+    if (idl_fprintf(fp, ",\n  .specialized_ops = &%1$s_specialized_ops", type) < 0)
+      return -1;
+  }
+
   if (idl_fprintf(fp, "\n};\n\n") < 0)
     return -1;
 
@@ -2777,10 +2785,15 @@ static int print_cdrstream_descriptor(FILE *fp, struct descriptor *descriptor, u
   // a problem for our purpose and avoids making the output dependent on
   // platform-specific details (such as alignment)
   fmt = "  .opt_size_xcdr1 = 0,\n"
-        "  .opt_size_xcdr2 = 0\n"
-        "};\n\n";
+        "  .opt_size_xcdr2 = 0";
   if (idl_fprintf(fp, "%s", fmt) < 0)
     return -1;
+  if (descriptor->flags & DDS_TOPIC_SPECIALIZED_OPS) {
+    if (idl_fprintf(fp, ",\n  .specialized = &%1$s_specialized_ops", type) < 0)
+      return -1;
+  }
+  if (idl_fprintf(fp, "\n};\n\n") < 0)
+    return -1;
   return 0;
 }
 
@@ -2982,6 +2995,11 @@ generate_descriptor(
 
   if ((ret = generate_descriptor_impl(pstate, node, &descriptor)) < 0)
     goto err_gen;
+  if (generator->config.generate_specialized_ops && specialized_ops_supported(node)) {
+    if ((ret = generate_specialized_ops(generator, &descriptor)) < 0)
+      goto err_print;
+    descriptor.flags |= DDS_TOPIC_SPECIALIZED_OPS;
+  }
   if (print_opcodes(generator->source.handle, &descriptor, &kof_offs) < 0)
     { ret = IDL_RETCODE_NO_MEMORY; goto err_print; }
   if (print_keys(generator->source.handle, &descriptor, kof_offs) < 0)
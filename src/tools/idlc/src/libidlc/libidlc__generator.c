@@ -27,10 +27,12 @@
 #include "idl/processor.h"
 #include "idl/print.h"
 #include "libidlc__types.h"
+#include "libidlc__specialized.h"
 
 const char *export_macro = NULL;
 const char *header_guard_prefix = "DDSC_";
 int generate_cdrstream_desc = 0;
+int generate_specialized_ops_flag = 0;
 
 static idl_retcode_t print_header(FILE *fh, const char *in, const char *out)
 {
@@ -147,7 +149,11 @@ generate_nosetup(const idl_pstate_t *pstate, struct generator *generator)
   for (const char *ptr = sep; *ptr; ptr++)
     if (idl_isseparator((unsigned char)*ptr))
       sep = ptr+1;
-  if (idl_fprintf(generator->source.handle, "#include \"%s\"\n\n", sep) < 0)
+  if (idl_fprintf(generator->source.handle, "#include \"%s\"\n", sep) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  if (generator->config.generate_specialized_ops && fputs("#include \"dds/cdr/dds_cdrstream_specialized.h\"\n", generator->source.handle) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  if (fputs("\n", generator->source.handle) < 0)
     return IDL_RETCODE_NO_MEMORY;
   if ((ret = generate_types(pstate, generator)))
     return ret;
@@ -196,6 +202,9 @@ static const idlc_option_t *opts[] = {
   &(idlc_option_t){
     IDLC_FLAG, { .flag = &generate_cdrstream_desc }, 'f', "cdrstream-desc", "",
     "Generate CDR descriptor in addition to regular topic descriptor." },
+  &(idlc_option_t){
+    IDLC_FLAG, { .flag = &generate_specialized_ops_flag }, 'f', "specialized-ops", "",
+    "Generate type-specific (de)serialization functions for topic types that support it." },
   &(idlc_option_t){
     IDLC_STRING, { .string = &header_guard_prefix },
     'f', "header-guard-prefix", "<header guard prefix>",
@@ -240,7 +249,9 @@ generate(const idl_pstate_t *pstate, const idlc_generator_config_t *config)
   if(!(generator.config.guard_macro = create_guard(header_guard_prefix, generator.header.path, pstate->digest)))
     goto err_options;
   generator.config.generate_cdrstream_desc = (generate_cdrstream_desc != 0);
+  generator.config.generate_specialized_ops = (generate_specialized_ops_flag != 0);
   ret = generate_nosetup(pstate, &generator);
+  specialized_ops_fini(&generator);
   if(generator.config.guard_macro)
     idl_free(generator.config.guard_macro);
 
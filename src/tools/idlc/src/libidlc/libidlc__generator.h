@@ -19,6 +19,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+struct specialized_type;
+
 struct generator {
   const char *path;
   struct {
@@ -34,7 +36,9 @@ struct generator {
     char *export_macro;
     char *guard_macro;
     bool generate_cdrstream_desc;
+    bool generate_specialized_ops;
   } config;
+  struct specialized_type *specialized_types; /**< types for which specialized functions were generated */
 };
 
 #endif /* GENERATOR_H */
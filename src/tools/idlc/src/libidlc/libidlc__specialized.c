@@ -0,0 +1,895 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "idl/heap.h"
+#include "idl/print.h"
+#include "idl/processor.h"
+#include "idl/stream.h"
+#include "idl/string.h"
+
+#include "libidlc__generator.h"
+#include "libidlc__descriptor.h"
+#include "libidlc__specialized.h"
+
+/* The generated functions follow the CDR stream interpreter (dds_cdrstream.c) exactly, but
+   without the overhead of interpreting the instructions: they produce the same bytes, accept
+   and reject the same input and read data into a sample in the same way. Serializing is done
+   in two passes, the first validates the sample and computes the size, the second writes the
+   data without any checks. The generated code uses the support functions in
+   dds/cdr/dds_cdrstream_specialized.h. */
+
+struct specialized_type {
+  struct specialized_type *next;
+  const idl_node_t *node;
+  bool skip; /**< entry is for the function skipping over the type in the input */
+};
+
+enum elem_kind {
+  ELEM_PRIM,
+  ELEM_BOOL,
+  ELEM_ENUM,
+  ELEM_STRING,
+  ELEM_BSTRING,
+  ELEM_STRUCT
+};
+
+struct spec_elem {
+  enum elem_kind kind;
+  uint32_t size; /**< serialized size of primitives and enums */
+  uint32_t bound; /**< bound of bounded strings */
+  uint32_t max; /**< maximum value of enums */
+  const idl_node_t *type_spec; /**< enum or struct type */
+};
+
+struct spec_field {
+  const char *name;
+  struct spec_elem elem;
+  uint32_t dims; /**< number of elements in the (flattened) array, 0 if not an array */
+  bool multi_dim;
+  bool seq;
+  uint32_t seq_bound; /**< 0 if unbounded */
+};
+
+#define V2 "DDSI_RTPS_CDR_ENC_VERSION_2"
+
+static const char spaces[] = "            ";
+
+static const char *indent(int n)
+{
+  assert(n >= 0 && (size_t)n < sizeof(spaces));
+  return spaces + (sizeof(spaces) - 1 - (size_t)n);
+}
+
+static bool get_elem(const idl_type_spec_t *type_spec, struct spec_elem *elem)
+{
+  memset(elem, 0, sizeof(*elem));
+  type_spec = idl_strip(type_spec, IDL_STRIP_ALIASES);
+  if (idl_is_alias(type_spec) || idl_is_forward(type_spec))
+    return false;
+  if (idl_is_string(type_spec)) {
+    elem->kind = idl_is_bounded(type_spec) ? ELEM_BSTRING : ELEM_STRING;
+    elem->bound = idl_bound(type_spec);
+    return true;
+  }
+  if (idl_is_enum(type_spec)) {
+    const uint32_t bit_bound = idl_bound(type_spec);
+    elem->kind = ELEM_ENUM;
+    elem->size = (bit_bound > 16) ? 4 : (bit_bound > 8) ? 2 : 1;
+    elem->max = idl_enum_max_value(type_spec);
+    elem->type_spec = type_spec;
+    return true;
+  }
+  if (idl_is_struct(type_spec)) {
+    elem->kind = ELEM_STRUCT;
+    elem->type_spec = type_spec;
+    return specialized_ops_supported(type_spec);
+  }
+  if (!idl_is_base_type(type_spec))
+    return false;
+  elem->kind = ELEM_PRIM;
+  switch (idl_type(type_spec)) {
+    case IDL_BOOL:
+      elem->kind = ELEM_BOOL;
+      elem->size = 1;
+      return true;
+    case IDL_CHAR: case IDL_OCTET: case IDL_INT8: case IDL_UINT8:
+      elem->size = 1;
+      return true;
+    case IDL_SHORT: case IDL_USHORT: case IDL_INT16: case IDL_UINT16:
+      elem->size = 2;
+      return true;
+    case IDL_LONG: case IDL_ULONG: case IDL_INT32: case IDL_UINT32: case IDL_FLOAT:
+      elem->size = 4;
+      return true;
+    case IDL_LLONG: case IDL_ULLONG: case IDL_INT64: case IDL_UINT64: case IDL_DOUBLE:
+      elem->size = 8;
+      return true;
+    default:
+      /* wchar, long double */
+      return false;
+  }
+}
+
+static bool get_field(const idl_declarator_t *declarator, struct spec_field *field)
+{
+  const idl_type_spec_t *type_spec = idl_strip(idl_type_spec(declarator), IDL_STRIP_ALIASES);
+  field->name = idl_identifier(declarator);
+  field->dims = idl_array_size(declarator);
+  field->multi_dim = (field->dims > 0 && idl_next(declarator->const_expr) != NULL);
+  field->seq = idl_is_sequence(type_spec);
+  field->seq_bound = 0;
+  if (field->seq) {
+    /* arrays of sequences are not supported */
+    if (field->dims > 0)
+      return false;
+    field->seq_bound = idl_bound(type_spec);
+    type_spec = idl_type_spec(type_spec);
+  }
+  return get_elem(type_spec, &field->elem);
+}
+
+bool specialized_ops_supported(const idl_node_t *node)
+{
+  const idl_struct_t *_struct = (const idl_struct_t *)node;
+  const idl_member_t *member;
+  const idl_declarator_t *declarator;
+  struct spec_field field;
+
+  if (!idl_is_struct(node) || idl_is_empty(node) || _struct->inherit_spec)
+    return false;
+  if (!idl_is_extensible(node, IDL_FINAL))
+    return false;
+  IDL_FOREACH(member, _struct->members) {
+    if (idl_is_optional((const idl_node_t *)member) || idl_is_external((const idl_node_t *)member))
+      return false;
+    IDL_FOREACH(declarator, member->declarators) {
+      if (!get_field(declarator, &field))
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool is_collection(const struct spec_field *field)
+{
+  return field->seq || field->dims > 0;
+}
+
+/* a DHEADER precedes collections of non-primitive types in XCDR2 */
+static bool has_dheader(const struct spec_field *field)
+{
+  return is_collection(field) && field->elem.kind != ELEM_PRIM && field->elem.kind != ELEM_BOOL;
+}
+
+/* expression for the element at index "i" of a collection (or of the member itself if it
+   isn't a collection), multi-dimensional arrays are accessed as a one-dimensional array */
+static char *elem_expr(const struct spec_field *field, bool constant)
+{
+  char *str = NULL, *type = NULL;
+  const char *cnst = constant ? "const " : "";
+  int cnt;
+
+  if (!is_collection(field))
+    cnt = idl_asprintf(&str, "s->%s", field->name);
+  else if (field->seq)
+    cnt = idl_asprintf(&str, "s->%s._buffer[i]", field->name);
+  else if (!field->multi_dim)
+    cnt = idl_asprintf(&str, "s->%s[i]", field->name);
+  else {
+    switch (field->elem.kind) {
+      case ELEM_STRING:
+        cnt = idl_asprintf(&str, "((char *%s*) s->%s)[i]", cnst, field->name);
+        break;
+      case ELEM_BSTRING:
+        cnt = idl_asprintf(&str, "((%schar (*)[%"PRIu32"]) s->%s)[i]", cnst, field->elem.bound + 1, field->name);
+        break;
+      case ELEM_ENUM: case ELEM_STRUCT:
+        if (IDL_PRINTA(&type, print_type, field->elem.type_spec) < 0)
+          return NULL;
+        cnt = idl_asprintf(&str, "((%s%s *) s->%s)[i]", cnst, type, field->name);
+        break;
+      default:
+        /* not used: collections of primitives are handled in bulk */
+        cnt = idl_asprintf(&str, "s->%s", field->name);
+        break;
+    }
+  }
+  return (cnt < 0) ? NULL : str;
+}
+
+/* number of elements, for sequences either the length in the sample or the local variable "num" */
+static char *count_expr(const struct spec_field *field, bool num)
+{
+  char *str = NULL;
+  int cnt;
+  if (field->seq && num)
+    cnt = idl_asprintf(&str, "num");
+  else if (field->seq)
+    cnt = idl_asprintf(&str, "s->%s._length", field->name);
+  else if (field->dims > 0)
+    cnt = idl_asprintf(&str, "%"PRIu32"u", field->dims);
+  else
+    cnt = idl_asprintf(&str, "1");
+  return (cnt < 0) ? NULL : str;
+}
+
+/* pointer to the first element of a collection of primitives */
+static char *base_expr(const struct spec_field *field)
+{
+  char *str = NULL;
+  int cnt;
+  if (field->seq)
+    cnt = idl_asprintf(&str, "s->%s._buffer", field->name);
+  else if (field->dims > 0)
+    cnt = idl_asprintf(&str, "s->%s", field->name);
+  else
+    cnt = idl_asprintf(&str, "&s->%s", field->name);
+  return (cnt < 0) ? NULL : str;
+}
+
+static int print_loop(FILE *fp, int ind, const struct spec_field *field, const char *from, const char *count)
+{
+  if (!is_collection(field))
+    return 0;
+  return idl_fprintf(fp, "%sfor (uint32_t i = %s; i < %s; i++)\n", indent(ind), from, count);
+}
+
+/* sequences and collections with a DHEADER need local variables */
+static bool needs_block(const struct spec_field *field)
+{
+  return field->seq || has_dheader(field);
+}
+
+static int print_block_open(FILE *fp, const struct spec_field *field)
+{
+  if (!needs_block(field))
+    return 0;
+  return fputs("  {\n", fp) < 0 ? -1 : 0;
+}
+
+static int print_block_close(FILE *fp, const struct spec_field *field)
+{
+  if (!needs_block(field))
+    return 0;
+  return fputs("  }\n", fp) < 0 ? -1 : 0;
+}
+
+/* iterates over all declarators of all members */
+#define FOREACH_FIELD(field_, struct_, member_, declarator_) \
+  IDL_FOREACH((member_), ((const idl_struct_t *)(struct_))->members) \
+    IDL_FOREACH((declarator_), (member_)->declarators) \
+      if (get_field((declarator_), &(field_)))
+
+/* size computation and validation of the sample */
+
+static int print_size_elem(FILE *fp, int ind, const struct spec_field *field, const char *v)
+{
+  const char *in = indent(ind), *in2 = indent(ind + 2);
+  char *type;
+  switch (field->elem.kind) {
+    case ELEM_PRIM: case ELEM_BOOL:
+      abort();
+      break;
+    case ELEM_ENUM:
+      return idl_fprintf(fp, "%sif ((uint32_t) %s > %"PRIu32"u)\n%sreturn false;\n", in, v, field->elem.max, in2);
+    case ELEM_STRING:
+      return idl_fprintf(fp, "%s*off = dds_cdrspec_size_string (*off, %s);\n", in, v);
+    case ELEM_BSTRING:
+      return idl_fprintf(fp, "%sif (!dds_cdrspec_size_bstring (off, %s, %"PRIu32"u))\n%sreturn false;\n", in, v, field->elem.bound, in2);
+    case ELEM_STRUCT:
+      if (IDL_PRINTA(&type, print_type, field->elem.type_spec) < 0)
+        return -1;
+      return idl_fprintf(fp, "%sif (!%s__cdr_size (&%s, off, xcdrv))\n%sreturn false;\n", in, type, v, in2);
+  }
+  return -1;
+}
+
+static int print_size_field(FILE *fp, const struct spec_field *field)
+{
+  const int ind = needs_block(field) ? 4 : 2;
+  const char *in = indent(ind);
+  char *v = NULL, *n = NULL;
+  int ret = -1;
+
+  if (!(v = elem_expr(field, true)) || !(n = count_expr(field, false)))
+    goto err;
+  if (print_block_open(fp, field) < 0)
+    goto err;
+  if (field->seq) {
+    if (field->seq_bound && idl_fprintf(fp, "%sif (%s > %"PRIu32"u)\n%s  return false;\n", in, n, field->seq_bound, in) < 0)
+      goto err;
+    if (idl_fprintf(fp, "%sif (%s > 0 && s->%s._buffer == NULL)\n%s  return false;\n", in, n, field->name, in) < 0)
+      goto err;
+  }
+  if (has_dheader(field) && idl_fprintf(fp, "%sif (xcdrv == "V2")\n%s  *off = dds_cdrspec_size_prim (*off, 4, 1, xcdrv);\n", in, in) < 0)
+    goto err;
+  if (field->seq && idl_fprintf(fp, "%s*off = dds_cdrspec_size_prim (*off, 4, 1, xcdrv);\n", in) < 0)
+    goto err;
+  switch (field->elem.kind) {
+    case ELEM_PRIM: case ELEM_BOOL: case ELEM_ENUM:
+      if (field->elem.kind == ELEM_ENUM) {
+        if (print_loop(fp, ind, field, "0", n) < 0)
+          goto err;
+        if (print_size_elem(fp, is_collection(field) ? ind + 2 : ind, field, v) < 0)
+          goto err;
+      }
+      if (idl_fprintf(fp, "%s*off = dds_cdrspec_size_prim (*off, %"PRIu32", %s, xcdrv);\n", in, field->elem.size, n) < 0)
+        goto err;
+      break;
+    default:
+      if (print_loop(fp, ind, field, "0", n) < 0)
+        goto err;
+      if (print_size_elem(fp, is_collection(field) ? ind + 2 : ind, field, v) < 0)
+        goto err;
+      break;
+  }
+  if (print_block_close(fp, field) < 0)
+    goto err;
+  ret = 0;
+err:
+  if (v) idl_free(v);
+  if (n) idl_free(n);
+  return ret;
+}
+
+/* writing the data */
+
+static int print_put_elem(FILE *fp, int ind, const struct spec_field *field, const char *v)
+{
+  const char *in = indent(ind);
+  char *type;
+  switch (field->elem.kind) {
+    case ELEM_PRIM: case ELEM_BOOL:
+      abort();
+      break;
+    case ELEM_ENUM:
+      return idl_fprintf(fp, "%soff = dds_cdrspec_put_enum (buf, off, (uint32_t) %s, %"PRIu32");\n", in, v, field->elem.size);
+    case ELEM_STRING: case ELEM_BSTRING:
+      return idl_fprintf(fp, "%soff = dds_cdrspec_put_string (buf, off, %s);\n", in, v);
+    case ELEM_STRUCT:
+      if (IDL_PRINTA(&type, print_type, field->elem.type_spec) < 0)
+        return -1;
+      return idl_fprintf(fp, "%soff = %s__cdr_put (&%s, buf, off, xcdrv);\n", in, type, v);
+  }
+  return -1;
+}
+
+static int print_put_field(FILE *fp, const struct spec_field *field)
+{
+  const int ind = needs_block(field) ? 4 : 2;
+  const char *in = indent(ind);
+  char *v = NULL, *n = NULL, *b = NULL;
+  int ret = -1;
+
+  if (!(v = elem_expr(field, true)) || !(n = count_expr(field, false)) || !(b = base_expr(field)))
+    goto err;
+  if (print_block_open(fp, field) < 0)
+    goto err;
+  if (has_dheader(field) && idl_fprintf(fp, "%suint32_t dh = 0;\n%sif (xcdrv == "V2")\n%s  off = dds_cdrspec_reserve_dheader (buf, off, &dh);\n", in, in, in) < 0)
+    goto err;
+  if (field->seq && idl_fprintf(fp, "%soff = dds_cdrspec_put_uint32 (buf, off, %s);\n", in, n) < 0)
+    goto err;
+  switch (field->elem.kind) {
+    case ELEM_PRIM:
+      if (idl_fprintf(fp, "%soff = dds_cdrspec_put_prim (buf, off, %s, %"PRIu32", %s, xcdrv);\n", in, b, field->elem.size, n) < 0)
+        goto err;
+      break;
+    case ELEM_BOOL:
+      if (idl_fprintf(fp, "%soff = dds_cdrspec_put_bool (buf, off, (const bool *) %s, %s);\n", in, b, n) < 0)
+        goto err;
+      break;
+    default:
+      if (print_loop(fp, ind, field, "0", n) < 0)
+        goto err;
+      if (print_put_elem(fp, is_collection(field) ? ind + 2 : ind, field, v) < 0)
+        goto err;
+      break;
+  }
+  if (has_dheader(field) && idl_fprintf(fp, "%sif (xcdrv == "V2")\n%s  dds_cdrspec_put_dheader (buf, dh, off);\n", in, in) < 0)
+    goto err;
+  if (print_block_close(fp, field) < 0)
+    goto err;
+  ret = 0;
+err:
+  if (v) idl_free(v);
+  if (n) idl_free(n);
+  if (b) idl_free(b);
+  return ret;
+}
+
+/* reading (normalized) data into a sample */
+
+static int print_read_elem(FILE *fp, int ind, const struct spec_field *field, const char *v)
+{
+  const char *in = indent(ind);
+  char *type;
+  switch (field->elem.kind) {
+    case ELEM_PRIM: case ELEM_BOOL:
+      abort();
+      break;
+    case ELEM_ENUM:
+      if (IDL_PRINTA(&type, print_type, field->elem.type_spec) < 0)
+        return -1;
+      return idl_fprintf(fp, "%s%s = (%s) dds_cdrspec_get_enum (is, %"PRIu32");\n", in, v, type, field->elem.size);
+    case ELEM_STRING:
+      return idl_fprintf(fp, "%s%s = dds_cdrspec_get_string (is, %s, allocator);\n", in, v, v);
+    case ELEM_BSTRING:
+      return idl_fprintf(fp, "%sdds_cdrspec_get_bstring (is, %s, %"PRIu32"u);\n", in, v, field->elem.bound + 1);
+    case ELEM_STRUCT:
+      if (IDL_PRINTA(&type, print_type, field->elem.type_spec) < 0)
+        return -1;
+      return idl_fprintf(fp, "%s%s__cdr_read (is, &%s, allocator);\n", in, type, v);
+  }
+  return -1;
+}
+
+static int print_skip_elem(FILE *fp, int ind, const struct spec_field *field)
+{
+  const char *in = indent(ind);
+  char *type;
+  switch (field->elem.kind) {
+    case ELEM_PRIM: case ELEM_BOOL: case ELEM_ENUM:
+      return idl_fprintf(fp, "%sdds_cdrspec_skip_prim (is, %"PRIu32", 1);\n", in, field->elem.size);
+    case ELEM_STRING: case ELEM_BSTRING:
+      return idl_fprintf(fp, "%sdds_cdrspec_skip_string (is);\n", in);
+    case ELEM_STRUCT:
+      if (IDL_PRINTA(&type, print_type, field->elem.type_spec) < 0)
+        return -1;
+      return idl_fprintf(fp, "%s%s__cdr_skip (is);\n", in, type);
+  }
+  return -1;
+}
+
+static int print_read_field(FILE *fp, const struct spec_field *field)
+{
+  const int ind = needs_block(field) ? 4 : 2;
+  const char *in = indent(ind);
+  char *v = NULL, *n = NULL, *b = NULL;
+  int ret = -1;
+
+  if (!(v = elem_expr(field, false)) || !(n = count_expr(field, false)) || !(b = base_expr(field)))
+    goto err;
+  if (print_block_open(fp, field) < 0)
+    goto err;
+  if (has_dheader(field) && idl_fprintf(fp, "%sif (is->m_xcdr_version == "V2")\n%s  dds_cdrspec_skip_prim (is, 4, 1);\n", in, in) < 0)
+    goto err;
+  if (field->seq) {
+    /* elements with pointers must be initialized, like the interpreter does */
+    const bool init = (field->elem.kind == ELEM_STRING || field->elem.kind == ELEM_STRUCT);
+    const char *fmt =
+      "%1$sconst uint32_t num = dds_cdrspec_get_uint32 (is);\n"
+      "%1$sdds_stream_adjust_sequence_buffer ((dds_sequence_t *) &s->%2$s, allocator, num, (uint32_t) sizeof (*s->%2$s._buffer), %3$s);\n";
+    if (idl_fprintf(fp, fmt, in, field->name, init ? "true" : "false") < 0)
+      goto err;
+  }
+  switch (field->elem.kind) {
+    case ELEM_PRIM: case ELEM_BOOL:
+      if (idl_fprintf(fp, "%sdds_cdrspec_get_prim (is, %s, %"PRIu32", %s);\n", in, b, field->elem.size, n) < 0)
+        goto err;
+      break;
+    default:
+      if (print_loop(fp, ind, field, "0", n) < 0)
+        goto err;
+      if (print_read_elem(fp, is_collection(field) ? ind + 2 : ind, field, v) < 0)
+        goto err;
+      break;
+  }
+  if (field->seq) {
+    /* skip elements that don't fit in a buffer not owned by the sample */
+    switch (field->elem.kind) {
+      case ELEM_PRIM: case ELEM_BOOL: case ELEM_ENUM:
+        if (idl_fprintf(fp, "%sdds_cdrspec_skip_prim (is, %"PRIu32", num - %s);\n", in, field->elem.size, n) < 0)
+          goto err;
+        break;
+      default:
+        if (print_loop(fp, ind, field, n, "num") < 0)
+          goto err;
+        if (print_skip_elem(fp, ind + 2, field) < 0)
+          goto err;
+        break;
+    }
+  }
+  if (print_block_close(fp, field) < 0)
+    goto err;
+  ret = 0;
+err:
+  if (v) idl_free(v);
+  if (n) idl_free(n);
+  if (b) idl_free(b);
+  return ret;
+}
+
+/* skipping (normalized) data, using the DHEADER where possible */
+
+static int print_skip_field(FILE *fp, const struct spec_field *field)
+{
+  char *n = NULL;
+  int ret = -1;
+
+  if (!is_collection(field))
+    return print_skip_elem(fp, 2, field);
+  if (!(n = count_expr(field, true)))
+    return -1;
+  if (!has_dheader(field)) {
+    if (field->seq) {
+      const char *fmt =
+        "  {\n"
+        "    const uint32_t num = dds_cdrspec_get_uint32 (is);\n"
+        "    dds_cdrspec_skip_prim (is, %"PRIu32", num);\n"
+        "  }\n";
+      if (idl_fprintf(fp, fmt, field->elem.size) < 0)
+        goto err;
+    } else if (idl_fprintf(fp, "  dds_cdrspec_skip_prim (is, %"PRIu32", %s);\n", field->elem.size, n) < 0) {
+      goto err;
+    }
+  } else {
+    const char *fmt =
+      "  if (is->m_xcdr_version == "V2")\n"
+      "  {\n"
+      "    const uint32_t dh = dds_cdrspec_get_uint32 (is);\n"
+      "    is->m_index += dh;\n"
+      "  }\n"
+      "  else\n"
+      "  {\n";
+    if (fputs(fmt, fp) < 0)
+      goto err;
+    if (field->seq && fputs("    const uint32_t num = dds_cdrspec_get_uint32 (is);\n", fp) < 0)
+      goto err;
+    if (field->elem.kind == ELEM_ENUM) {
+      if (idl_fprintf(fp, "    dds_cdrspec_skip_prim (is, %"PRIu32", %s);\n", field->elem.size, n) < 0)
+        goto err;
+    } else {
+      if (print_loop(fp, 4, field, "0", n) < 0 || print_skip_elem(fp, 6, field) < 0)
+        goto err;
+    }
+    if (fputs("  }\n", fp) < 0)
+      goto err;
+  }
+  ret = 0;
+err:
+  idl_free(n);
+  return ret;
+}
+
+/* validating and normalizing received data */
+
+static int print_normalize_elem(FILE *fp, int ind, const struct spec_field *field, const char *lim, const char *n)
+{
+  const char *in = indent(ind), *in2 = indent(ind + 2);
+  char *type;
+  switch (field->elem.kind) {
+    case ELEM_PRIM:
+      return idl_fprintf(fp, "%sif (!dds_cdrspec_norm_prim (data, off, %s, bswap, %"PRIu32", %s, xcdrv))\n%sreturn false;\n", in, lim, field->elem.size, n, in2);
+    case ELEM_BOOL:
+      /* like the interpreter: invalid booleans are corrected, except in sequences */
+      return idl_fprintf(fp, "%sif (!dds_cdrspec_norm_bool (data, off, %s, %s, %s))\n%sreturn false;\n", in, lim, n, field->seq ? "true" : "false", in2);
+    case ELEM_ENUM:
+      return idl_fprintf(fp, "%sif (!dds_cdrspec_norm_enum (data, off, %s, bswap, %"PRIu32", %s, %"PRIu32"u))\n%sreturn false;\n", in, lim, field->elem.size, n, field->elem.max, in2);
+    case ELEM_STRING:
+      return idl_fprintf(fp, "%sif (!dds_cdrspec_norm_string (data, off, %s, bswap, UINT32_MAX))\n%sreturn false;\n", in, lim, in2);
+    case ELEM_BSTRING:
+      return idl_fprintf(fp, "%sif (!dds_cdrspec_norm_string (data, off, %s, bswap, %"PRIu32"u))\n%sreturn false;\n", in, lim, field->elem.bound + 1, in2);
+    case ELEM_STRUCT:
+      if (IDL_PRINTA(&type, print_type, field->elem.type_spec) < 0)
+        return -1;
+      return idl_fprintf(fp, "%sif (!%s__cdr_normalize (data, off, %s, bswap, xcdrv))\n%sreturn false;\n", in, type, lim, in2);
+  }
+  return -1;
+}
+
+static int print_normalize_field(FILE *fp, const struct spec_field *field)
+{
+  const int ind = needs_block(field) ? 4 : 2;
+  const char *in = indent(ind);
+  const char *lim = has_dheader(field) ? "size1" : "size";
+  char *n = NULL;
+  int ret = -1;
+
+  if (!(n = count_expr(field, true)))
+    goto err;
+  if (print_block_open(fp, field) < 0)
+    goto err;
+  if (has_dheader(field)) {
+    const char *fmt =
+      "%1$suint32_t size1 = size;\n"
+      "%1$sif (xcdrv == "V2" && !dds_cdrspec_norm_dheader (data, off, size, bswap, &size1))\n"
+      "%1$s  return false;\n";
+    if (idl_fprintf(fp, fmt, in) < 0)
+      goto err;
+  }
+  if (field->seq) {
+    const char *fmt =
+      "%1$suint32_t num;\n"
+      "%1$sif (!dds_cdrspec_norm_uint32 (data, off, %2$s, bswap, &num))\n"
+      "%1$s  return false;\n";
+    if (idl_fprintf(fp, fmt, in, lim) < 0)
+      goto err;
+    if (field->seq_bound && idl_fprintf(fp, "%sif (num > %"PRIu32"u)\n%s  return false;\n", in, field->seq_bound, in) < 0)
+      goto err;
+  }
+  switch (field->elem.kind) {
+    case ELEM_PRIM: case ELEM_BOOL: case ELEM_ENUM:
+      if (print_normalize_elem(fp, ind, field, lim, n) < 0)
+        goto err;
+      break;
+    default:
+      if (print_loop(fp, ind, field, "0", n) < 0)
+        goto err;
+      if (print_normalize_elem(fp, is_collection(field) ? ind + 2 : ind, field, lim, "1") < 0)
+        goto err;
+      break;
+  }
+  if (has_dheader(field) && idl_fprintf(fp, "%sif (xcdrv == "V2" && *off != size1)\n%s  return false;\n", in, in) < 0)
+    goto err;
+  if (print_block_close(fp, field) < 0)
+    goto err;
+  ret = 0;
+err:
+  if (n) idl_free(n);
+  return ret;
+}
+
+/* bookkeeping of the types for which functions have been generated in the current file */
+
+static bool is_generated(const struct generator *gen, const idl_node_t *node, bool skip)
+{
+  for (const struct specialized_type *t = gen->specialized_types; t; t = t->next)
+    if (t->node == node && t->skip == skip)
+      return true;
+  return false;
+}
+
+static idl_retcode_t set_generated(struct generator *gen, const idl_node_t *node, bool skip)
+{
+  struct specialized_type *t;
+  if (!(t = idl_malloc(sizeof(*t))))
+    return IDL_RETCODE_NO_MEMORY;
+  t->node = node;
+  t->skip = skip;
+  t->next = gen->specialized_types;
+  gen->specialized_types = t;
+  return IDL_RETCODE_OK;
+}
+
+void specialized_ops_fini(struct generator *generator)
+{
+  while (generator->specialized_types) {
+    struct specialized_type *t = generator->specialized_types;
+    generator->specialized_types = t->next;
+    idl_free(t);
+  }
+}
+
+static idl_retcode_t generate_skip(struct generator *gen, const idl_node_t *node)
+{
+  FILE *fp = gen->source.handle;
+  const idl_member_t *member;
+  const idl_declarator_t *declarator;
+  struct spec_field field;
+  char *type;
+  idl_retcode_t ret;
+
+  if (is_generated(gen, node, true))
+    return IDL_RETCODE_OK;
+  if ((ret = set_generated(gen, node, true)) < 0)
+    return ret;
+  FOREACH_FIELD(field, node, member, declarator) {
+    if (field.elem.kind == ELEM_STRUCT && (ret = generate_skip(gen, field.elem.type_spec)) < 0)
+      return ret;
+  }
+
+  if (IDL_PRINTA(&type, print_type, node) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  if (idl_fprintf(fp, "static void %s__cdr_skip (dds_istream_t *is)\n{\n", type) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  FOREACH_FIELD(field, node, member, declarator) {
+    if (print_skip_field(fp, &field) < 0)
+      return IDL_RETCODE_NO_MEMORY;
+  }
+  if (fputs("}\n\n", fp) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  return IDL_RETCODE_OK;
+}
+
+static idl_retcode_t generate_type(struct generator *gen, const idl_node_t *node)
+{
+  FILE *fp = gen->source.handle;
+  const idl_member_t *member;
+  const idl_declarator_t *declarator;
+  struct spec_field field;
+  char *type;
+  idl_retcode_t ret;
+
+  if (is_generated(gen, node, false))
+    return IDL_RETCODE_OK;
+  if ((ret = set_generated(gen, node, false)) < 0)
+    return ret;
+  FOREACH_FIELD(field, node, member, declarator) {
+    if (field.elem.kind != ELEM_STRUCT)
+      continue;
+    if ((ret = generate_type(gen, field.elem.type_spec)) < 0)
+      return ret;
+    /* reading a sequence may require skipping elements */
+    if (field.seq && (ret = generate_skip(gen, field.elem.type_spec)) < 0)
+      return ret;
+  }
+
+  if (IDL_PRINTA(&type, print_type, node) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+
+  if (idl_fprintf(fp, "static bool %1$s__cdr_size (const %1$s *s, uint32_t *off, uint32_t xcdrv)\n{\n  (void) s;\n  (void) xcdrv;\n", type) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  FOREACH_FIELD(field, node, member, declarator) {
+    if (print_size_field(fp, &field) < 0)
+      return IDL_RETCODE_NO_MEMORY;
+  }
+  if (fputs("  return true;\n}\n\n", fp) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+
+  if (idl_fprintf(fp, "static uint32_t %1$s__cdr_put (const %1$s *s, unsigned char *buf, uint32_t off, uint32_t xcdrv)\n{\n  (void) xcdrv;\n", type) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  FOREACH_FIELD(field, node, member, declarator) {
+    if (print_put_field(fp, &field) < 0)
+      return IDL_RETCODE_NO_MEMORY;
+  }
+  if (fputs("  return off;\n}\n\n", fp) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+
+  if (idl_fprintf(fp, "static void %1$s__cdr_read (dds_istream_t *is, %1$s *s, const struct dds_cdrstream_allocator *allocator)\n{\n  (void) allocator;\n", type) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  FOREACH_FIELD(field, node, member, declarator) {
+    if (print_read_field(fp, &field) < 0)
+      return IDL_RETCODE_NO_MEMORY;
+  }
+  if (fputs("}\n\n", fp) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+
+  if (idl_fprintf(fp, "static bool %1$s__cdr_normalize (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t xcdrv)\n{\n  (void) xcdrv;\n", type) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  FOREACH_FIELD(field, node, member, declarator) {
+    if (print_normalize_field(fp, &field) < 0)
+      return IDL_RETCODE_NO_MEMORY;
+  }
+  if (fputs("  return true;\n}\n\n", fp) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  return IDL_RETCODE_OK;
+}
+
+static bool is_top_level_key(const struct descriptor *descriptor, const struct spec_field *field)
+{
+  for (uint32_t k = 0; k < descriptor->n_keys; k++)
+    if (strcmp(descriptor->keys[k].name, field->name) == 0)
+      return true;
+  return false;
+}
+
+/* Extracting the key from the data is supported if all key fields are members of the
+   top-level type of a primitive, enum or string type. The keys are then written in the
+   order of the members, which is the order in which the interpreter writes them too. */
+static bool key_extraction_supported(const struct descriptor *descriptor)
+{
+  const idl_member_t *member;
+  const idl_declarator_t *declarator;
+  struct spec_field field;
+  uint32_t n = 0;
+
+  if (descriptor->n_keys == 0)
+    return false;
+  FOREACH_FIELD(field, descriptor->topic, member, declarator) {
+    if (!is_top_level_key(descriptor, &field))
+      continue;
+    if (is_collection(&field) || field.elem.kind == ELEM_STRUCT)
+      return false;
+    n++;
+  }
+  return n == descriptor->n_keys;
+}
+
+static idl_retcode_t generate_extract_key(struct generator *gen, const struct descriptor *descriptor, const char *type)
+{
+  FILE *fp = gen->source.handle;
+  const idl_member_t *member;
+  const idl_declarator_t *declarator;
+  struct spec_field field;
+  uint32_t n;
+  idl_retcode_t ret;
+
+  n = 0;
+  FOREACH_FIELD(field, descriptor->topic, member, declarator) {
+    if (n == descriptor->n_keys)
+      break;
+    if (is_top_level_key(descriptor, &field))
+      n++;
+    else if (field.elem.kind == ELEM_STRUCT && (ret = generate_skip(gen, field.elem.type_spec)) < 0)
+      return ret;
+  }
+
+  if (idl_fprintf(fp, "static bool %s__cdr_extract_key_from_data (dds_istream_t *is, dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator)\n{\n", type) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  n = 0;
+  FOREACH_FIELD(field, descriptor->topic, member, declarator) {
+    int cnt;
+    if (n == descriptor->n_keys)
+      break;
+    if (!is_top_level_key(descriptor, &field))
+      cnt = print_skip_field(fp, &field);
+    else {
+      n++;
+      if (field.elem.kind == ELEM_STRING || field.elem.kind == ELEM_BSTRING)
+        cnt = idl_fprintf(fp, "  dds_cdrspec_copy_string (is, os, allocator);\n");
+      else
+        cnt = idl_fprintf(fp, "  dds_cdrspec_copy_prim (is, os, allocator, %"PRIu32");\n", field.elem.size);
+    }
+    if (cnt < 0)
+      return IDL_RETCODE_NO_MEMORY;
+  }
+  if (fputs("  return true;\n}\n\n", fp) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  return IDL_RETCODE_OK;
+}
+
+idl_retcode_t generate_specialized_ops(struct generator *generator, const struct descriptor *descriptor)
+{
+  FILE *fp = generator->source.handle;
+  const idl_node_t *node = descriptor->topic;
+  const bool extract_key = key_extraction_supported(descriptor);
+  char *type;
+  const char *fmt;
+  idl_retcode_t ret;
+
+  assert(specialized_ops_supported(node));
+  if ((ret = generate_type(generator, node)) < 0)
+    return ret;
+  if (IDL_PRINTA(&type, print_type, node) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  if (extract_key && (ret = generate_extract_key(generator, descriptor, type)) < 0)
+    return ret;
+
+  fmt = "static bool %1$s__cdr_write_sample (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const void *sample)\n"
+        "{\n"
+        "  uint32_t end = os->m_index;\n"
+        "  if (!%1$s__cdr_size (sample, &end, os->m_xcdr_version))\n"
+        "    return false;\n"
+        "  dds_ostream_reserve (os, allocator, end - os->m_index);\n"
+        "  os->m_index = %1$s__cdr_put (sample, os->m_buffer, os->m_index, os->m_xcdr_version);\n"
+        "  return true;\n"
+        "}\n\n"
+        "static void %1$s__cdr_read_sample (dds_istream_t *is, void *sample, const struct dds_cdrstream_allocator *allocator)\n"
+        "{\n"
+        "  %1$s__cdr_read (is, sample, allocator);\n"
+        "}\n\n"
+        "static size_t %1$s__cdr_getsize_sample (const void *sample, uint32_t xcdr_version)\n"
+        "{\n"
+        "  uint32_t off = 0;\n"
+        "  return %1$s__cdr_size (sample, &off, xcdr_version) ? off : SIZE_MAX;\n"
+        "}\n\n"
+        "static const struct dds_cdrstream_specialized_ops %1$s_specialized_ops =\n"
+        "{\n"
+        "  .write = %1$s__cdr_write_sample,\n"
+        "  .read = %1$s__cdr_read_sample,\n"
+        "  .getsize = %1$s__cdr_getsize_sample,\n"
+        "  .normalize = %1$s__cdr_normalize,\n";
+  if (idl_fprintf(fp, fmt, type) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  if (extract_key)
+    fmt = "  .extract_key_from_data = %1$s__cdr_extract_key_from_data\n};\n\n";
+  else
+    fmt = "  .extract_key_from_data = NULL\n};\n\n";
+  if (idl_fprintf(fp, fmt, type) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  return IDL_RETCODE_OK;
+}
@@ -0,0 +1,34 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef SPECIALIZED_H
+#define SPECIALIZED_H
+
+#include <stdbool.h>
+
+#include "idl/processor.h"
+
+struct generator;
+struct descriptor;
+
+/* Whether type-specific serialization functions can be generated for the type: this is
+   limited to final types without inheritance, optionals and externals, with members of
+   primitive types (except wchar and long double), enums, strings, arrays and sequences
+   of those, and of structs that are themselves supported */
+bool specialized_ops_supported(const idl_node_t *node);
+
+/* Generates the functions for the topic type in the descriptor and the functions for
+   the types it uses that were not generated before, as well as a table named
+   <type>_specialized_ops referencing the functions for the topic type */
+idl_retcode_t generate_specialized_ops(struct generator *generator, const struct descriptor *descriptor);
+
+void specialized_ops_fini(struct generator *generator);
+
+#endif /* SPECIALIZED_H */